@@ -51,6 +51,12 @@ if(NOT CMAKE_CROSSCOMPILING)
     elseif(SSE3_FOUND)
         set(SIMD_FLAG ${SSE3_FLAG})
     endif()
+    if(AVX512_TARGET_FOUND)
+        add_definitions(-DPADDLE_WITH_AVX512_DISPATCH)
+    endif()
+    if(F16C_TARGET_FOUND)
+        add_definitions(-DPADDLE_WITH_F16C_DISPATCH)
+    endif()
 endif()
 
 if(NOT WITH_GOLANG)
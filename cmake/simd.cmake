@@ -82,4 +82,37 @@ int main()
 }" AVX2_FOUND)
 
 set(CMAKE_REQUIRED_FLAGS ${CMAKE_REQUIRED_FLAGS_RETAINED})
-mark_as_advanced(MMX_FOUND SSE2_FOUND SSE3_FOUND AVX_FOUND AVX2_FOUND)
+
+# The AVX-512 and F16C kernels are compiled with __attribute__((target(...)))
+# whatever the global SIMD flags, and dispatched at runtime. Old compilers,
+# e.g. gcc 4.8, cannot compile these intrinsics in a target function.
+CHECK_CXX_SOURCE_COMPILES("
+#include <immintrin.h>
+__attribute__((target(\"avx512f\"))) void add(float* a, const float* b) {
+    __mmask16 mask = 0xff;
+    __m512 x = _mm512_maskz_loadu_ps(mask, a);
+    x = _mm512_fmadd_ps(x, _mm512_loadu_ps(b), _mm512_set1_ps(1.0f));
+    x = _mm512_scalef_ps(_mm512_roundscale_ps(x, 1), x);
+    _mm512_mask_storeu_ps(a, mask, x);
+}
+int main()
+{
+    float a[16] = {0}, b[16] = {0};
+    add(a, b);
+    return 0;
+}" AVX512_TARGET_FOUND)
+
+CHECK_CXX_SOURCE_COMPILES("
+#include <immintrin.h>
+__attribute__((target(\"avx,f16c\"))) unsigned short convert(const float* a) {
+    __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(a), 0);
+    return _cvtss_sh(_cvtsh_ss(_mm_extract_epi16(h, 0)), 0);
+}
+int main()
+{
+    float a[8] = {0};
+    return convert(a);
+}" F16C_TARGET_FOUND)
+
+mark_as_advanced(MMX_FOUND SSE2_FOUND SSE3_FOUND AVX_FOUND AVX2_FOUND
+                 AVX512_TARGET_FOUND F16C_TARGET_FOUND)
@@ -0,0 +1,324 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "batcher.h"
+#include "capi_private.h"
+
+namespace paddle {
+namespace capi {
+
+/**
+ * Merges the requests of paddle_batcher_forward into batches, which are
+ * forwarded by the batcher thread. See batcher.h.
+ */
+class Batcher {
+public:
+  Batcher(GradientMachine* machine, size_t maxBatchSize, int64_t timeoutUs)
+      : machine_(machine),
+        maxBatchSize_(maxBatchSize),
+        timeoutUs_(timeoutUs),
+        queuedSamples_(0),
+        stopping_(false),
+        thread_([this] { run(); }) {}
+
+  ~Batcher() {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      stopping_ = true;
+    }
+    requestCond_.notify_one();
+    thread_.join();
+  }
+
+  paddle_error forward(const std::vector<Argument>& inArgs,
+                       std::vector<Argument>* outArgs) {
+    if (inArgs.empty()) return kPD_OUT_OF_RANGE;
+    Request request;
+    request.inArgs = &inArgs;
+    request.outArgs = outArgs;
+    request.numSamples = inArgs[0].getNumSequences();
+    request.error = kPD_NO_ERROR;
+    request.done = false;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopping_) return kPD_UNDEFINED_ERROR;
+    queue_.push_back(&request);
+    queuedSamples_ += request.numSamples;
+    requestCond_.notify_one();
+    doneCond_.wait(lock, [&request] { return request.done; });
+    return request.error;
+  }
+
+private:
+  struct Request {
+    const std::vector<Argument>* inArgs;
+    std::vector<Argument>* outArgs;
+    size_t numSamples;
+    paddle_error error;
+    bool done;
+  };
+
+  void run() {
+    if (FLAGS_use_gpu) {
+      hl_init(FLAGS_gpu_id);
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      requestCond_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+      if (queue_.empty()) break;
+
+      // Wait for more requests until the batch is full or the time is up.
+      auto deadline = std::chrono::steady_clock::now() +
+                      std::chrono::microseconds(timeoutUs_);
+      while (!stopping_ && queuedSamples_ < maxBatchSize_ &&
+             requestCond_.wait_until(lock, deadline) !=
+                 std::cv_status::timeout) {
+      }
+
+      // The requests whose input layout differs from the first one stay in
+      // the queue, in order, for the next batches.
+      std::vector<Request*> batch;
+      size_t numSamples = 0;
+      for (auto it = queue_.begin(); it != queue_.end();) {
+        Request* request = *it;
+        if (!batch.empty() &&
+            !sameLayout(*request->inArgs, *batch[0]->inArgs)) {
+          ++it;
+          continue;
+        }
+        if (!batch.empty() &&
+            numSamples + request->numSamples > maxBatchSize_) {
+          break;
+        }
+        batch.push_back(request);
+        numSamples += request->numSamples;
+        queuedSamples_ -= request->numSamples;
+        it = queue_.erase(it);
+      }
+
+      lock.unlock();
+      forwardBatch(batch);
+      lock.lock();
+      for (auto request : batch) {
+        request->done = true;
+      }
+      doneCond_.notify_all();
+    }
+  }
+
+  static bool sameLayout(const std::vector<Argument>& a,
+                         const std::vector<Argument>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+      if (!a[i].value != !b[i].value || !a[i].ids != !b[i].ids ||
+          a[i].hasSeq() != b[i].hasSeq() ||
+          a[i].hasSubseq() != b[i].hasSubseq()) {
+        return false;
+      }
+      if (a[i].value && a[i].value->getWidth() != b[i].value->getWidth()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Forwards the requests of a batch, which have the same input layout.
+   */
+  void forwardBatch(const std::vector<Request*>& requests) {
+    // The sample and row offsets of each request in the batch.
+    std::vector<size_t> sampleStarts(1, 0);
+    std::vector<size_t> rowStarts(1, 0);
+    for (auto request : requests) {
+      sampleStarts.push_back(sampleStarts.back() + request->numSamples);
+      rowStarts.push_back(rowStarts.back() +
+                          (*request->inArgs)[0].getBatchSize());
+    }
+
+    const std::vector<Argument>* inArgs = requests[0]->inArgs;
+    if (requests.size() > 1) {
+      inArgs_.resize(inArgs->size());
+      std::vector<Argument> parts(requests.size());
+      for (size_t i = 0; i < inArgs_.size(); ++i) {
+        for (size_t j = 0; j < requests.size(); ++j) {
+          parts[j] = (*requests[j]->inArgs)[i];
+        }
+        inArgs_[i].concat(parts, false /* useGpu */);
+        inArgs_[i].setFrameHeight(parts[0].getFrameHeight());
+        inArgs_[i].setFrameWidth(parts[0].getFrameWidth());
+        inArgs_[i].setFrameDepth(parts[0].getFrameDepth());
+      }
+      inArgs = &inArgs_;
+    }
+    machine_->forward(*inArgs, &outArgs_, PASS_TEST);
+
+    for (size_t j = 0; j < requests.size(); ++j) {
+      std::vector<Argument>& outArgs = *requests[j]->outArgs;
+      outArgs.resize(outArgs_.size());
+      for (size_t i = 0; i < outArgs_.size(); ++i) {
+        const Argument& out = outArgs_[i];
+        size_t rowStart, rowEnd;
+        if (out.hasSeq()) {
+          const int* starts = out.sequenceStartPositions->getData(false);
+          rowStart = starts[sampleStarts[j]];
+          rowEnd = starts[sampleStarts[j + 1]];
+        } else if (out.getBatchSize() ==
+                   static_cast<int64_t>(sampleStarts.back())) {
+          rowStart = sampleStarts[j];
+          rowEnd = sampleStarts[j + 1];
+        } else if (out.getBatchSize() ==
+                   static_cast<int64_t>(rowStarts.back())) {
+          rowStart = rowStarts[j];
+          rowEnd = rowStarts[j + 1];
+        } else {
+          requests[j]->error = kPD_UNDEFINED_ERROR;
+          break;
+        }
+        sliceRows(out,
+                  rowStart,
+                  rowEnd,
+                  sampleStarts[j],
+                  sampleStarts[j + 1],
+                  &outArgs[i]);
+      }
+    }
+  }
+
+  /**
+   * Copies the rows [rowStart, rowEnd) of the batch output, which are the
+   * sequences [seqStart, seqEnd) if it has sequences, to the output of a
+   * request.
+   */
+  static void sliceRows(const Argument& out,
+                        size_t rowStart,
+                        size_t rowEnd,
+                        size_t seqStart,
+                        size_t seqEnd,
+                        Argument* result) {
+    bool useGpu = out.value ? out.value->useGpu()
+                            : (out.ids ? out.ids->useGpu() : false);
+    Argument part;
+    part.subArgFrom(out,
+                    rowStart,
+                    rowEnd - rowStart,
+                    out.value ? out.value->getWidth() : 0,
+                    useGpu);
+    part.setFrameHeight(out.getFrameHeight());
+    part.setFrameWidth(out.getFrameWidth());
+    part.setFrameDepth(out.getFrameDepth());
+    result->resizeAndCopyFrom(part, false /* useGpu */);
+
+    result->sequenceStartPositions.reset();
+    result->subSequenceStartPositions.reset();
+    if (out.hasSeq()) {
+      const int* starts = out.sequenceStartPositions->getData(false);
+      ICpuGpuVector::resizeOrCreate(
+          result->sequenceStartPositions, seqEnd - seqStart + 1, false);
+      int* dest = result->sequenceStartPositions->getMutableData(false);
+      for (size_t i = seqStart; i <= seqEnd; ++i) {
+        dest[i - seqStart] = starts[i] - rowStart;
+      }
+    }
+    if (out.hasSubseq()) {
+      const int* starts = out.subSequenceStartPositions->getData(false);
+      std::vector<int> positions;
+      for (size_t i = 0; i < out.subSequenceStartPositions->getSize(); ++i) {
+        if (starts[i] >= static_cast<int>(rowStart) &&
+            starts[i] <= static_cast<int>(rowEnd)) {
+          positions.push_back(starts[i] - rowStart);
+        }
+      }
+      ICpuGpuVector::resizeOrCreate(
+          result->subSequenceStartPositions, positions.size(), false);
+      std::copy(positions.begin(),
+                positions.end(),
+                result->subSequenceStartPositions->getMutableData(false));
+    }
+  }
+
+  GradientMachine* machine_;
+  size_t maxBatchSize_;
+  int64_t timeoutUs_;
+
+  std::mutex mutex_;
+  // notifies the batcher thread of new requests
+  std::condition_variable requestCond_;
+  // notifies the callers of the finished batches
+  std::condition_variable doneCond_;
+  std::deque<Request*> queue_;
+  size_t queuedSamples_;
+  bool stopping_;
+
+  // the concatenated inputs and the outputs of a batch, reused by the
+  // following batches
+  std::vector<Argument> inArgs_;
+  std::vector<Argument> outArgs_;
+
+  std::thread thread_;
+};
+
+struct CBatcher {
+  STRUCT_HEADER
+  std::unique_ptr<Batcher> batcher;
+
+  CBatcher() : type(kBATCHER) {}
+};
+
+}  // namespace capi
+}  // namespace paddle
+
+using paddle::capi::cast;
+using paddle::capi::CArguments;
+using paddle::capi::CBatcher;
+using paddle::capi::CGradientMachine;
+
+extern "C" {
+paddle_error paddle_batcher_create(paddle_gradient_machine machine,
+                                   uint64_t maxBatchSize,
+                                   uint64_t timeoutUs,
+                                   paddle_batcher* batcher) {
+  auto m = cast<CGradientMachine>(machine);
+  if (m == nullptr || batcher == nullptr || m->machine == nullptr) {
+    return kPD_NULLPTR;
+  }
+  if (maxBatchSize == 0) return kPD_OUT_OF_RANGE;
+  auto ptr = new CBatcher();
+  ptr->batcher.reset(new paddle::capi::Batcher(
+      m->machine.get(), maxBatchSize, static_cast<int64_t>(timeoutUs)));
+  *batcher = ptr;
+  return kPD_NO_ERROR;
+}
+
+paddle_error paddle_batcher_forward(paddle_batcher batcher,
+                                    paddle_arguments inArgs,
+                                    paddle_arguments outArgs) {
+  auto b = cast<CBatcher>(batcher);
+  auto in = cast<CArguments>(inArgs);
+  auto out = cast<CArguments>(outArgs);
+  if (b == nullptr || in == nullptr || out == nullptr) return kPD_NULLPTR;
+  return b->batcher->forward(in->args, &out->args);
+}
+
+paddle_error paddle_batcher_destroy(paddle_batcher batcher) {
+  delete cast<CBatcher>(batcher);
+  return kPD_NO_ERROR;
+}
+}
@@ -0,0 +1,84 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#ifndef __PADDLE_CAPI_BATCHER_H__
+#define __PADDLE_CAPI_BATCHER_H__
+#include "arguments.h"
+#include "config.h"
+#include "error.h"
+#include "gradient_machine.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Batcher merges the inference requests of many threads into larger
+ *        batches, which are forwarded by one gradient machine.
+ *
+ * A thread calling paddle_batcher_forward waits until its request has been
+ * run. The batcher thread takes the first request in the queue, waits for
+ * more requests until the batch has maxBatchSize samples or timeoutUs
+ * microseconds have passed, concatenates the inputs of the requests, with
+ * their sequence start positions, forwards them once, and copies to each
+ * request the rows of the outputs that belong to its samples.
+ *
+ * A sample is a sequence for sequence inputs and a row otherwise. Only the
+ * requests with the same input layout, i.e. the same inputs, widths and
+ * sequence nesting, are batched together. The others wait for a later
+ * batch.
+ */
+typedef void* paddle_batcher;
+
+/**
+ * @brief Create a batcher.
+ * @param [in] machine gradient machine forwarding the batches. It must not
+ *             be used by other threads while the batcher exists, create one
+ *             by paddle_gradient_machine_create_shared_param.
+ * @param [in] maxBatchSize the maximum number of samples of a batch. A
+ *             larger request is run as a batch on its own.
+ * @param [in] timeoutUs how long a batch waits to be filled, in
+ *             microseconds.
+ * @param [out] batcher the created batcher.
+ * @return paddle_error
+ */
+PD_API paddle_error paddle_batcher_create(paddle_gradient_machine machine,
+                                          uint64_t maxBatchSize,
+                                          uint64_t timeoutUs,
+                                          paddle_batcher* batcher);
+
+/**
+ * @brief Run the inference of one request. It is thread safe.
+ * @param [in] batcher the batcher.
+ * @param [in] inArgs input arguments of the request.
+ * @param [out] outArgs output arguments of the request, which own their
+ *              data.
+ * @return paddle_error
+ */
+PD_API paddle_error paddle_batcher_forward(paddle_batcher batcher,
+                                           paddle_arguments inArgs,
+                                           paddle_arguments outArgs);
+
+/**
+ * @brief Destroy a batcher after running the requests in its queue. The
+ *        gradient machine is not destroyed.
+ * @param [in] batcher the batcher to destroy.
+ * @return paddle_error
+ */
+PD_API paddle_error paddle_batcher_destroy(paddle_batcher batcher);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
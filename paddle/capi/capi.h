@@ -22,6 +22,7 @@ limitations under the License. */
  * NOTE: This is an experimental API, it could be changed.
  */
 #include "arguments.h"
+#include "batcher.h"
 #include "config.h"
 #include "error.h"
 #include "gradient_machine.h"
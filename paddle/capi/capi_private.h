@@ -22,7 +22,13 @@ limitations under the License. */
 namespace paddle {
 namespace capi {
 
-enum CType { kIVECTOR = 0, kMATRIX, kARGUMENTS, kGRADIENT_MACHINE };
+enum CType {
+  kIVECTOR = 0,
+  kMATRIX,
+  kARGUMENTS,
+  kGRADIENT_MACHINE,
+  kBATCHER
+};
 
 #define STRUCT_HEADER CType type;
 
@@ -0,0 +1 @@
+../dense/convert_protobin.sh
\ No newline at end of file
@@ -0,0 +1,134 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <paddle/capi.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <time.h>
+#include "../common/common.h"
+
+#define CONFIG_BIN "./trainer_config.bin"
+#define NUM_THREAD 32
+#define NUM_ITER 200
+#define MAX_BATCH_SIZE 32
+#define TIMEOUT_US 1000
+
+/*
+ * @brief A load generator comparing two ways to serve many concurrent
+ *        requests of one sample:
+ *        - each thread forwards its requests with its own gradient machine,
+ *        - the threads submit their requests to a batcher, which forwards
+ *          them in batches of up to MAX_BATCH_SIZE samples.
+ */
+
+paddle_gradient_machine machine;
+void* config;
+long config_size;
+paddle_batcher batcher;
+
+double now_ms() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+void* thread_main(void* use_batcher) {
+  paddle_gradient_machine local_machine = NULL;
+  if (!use_batcher) {
+    CHECK(paddle_gradient_machine_create_shared_param(
+        machine, config, config_size, &local_machine));
+  }
+  paddle_arguments in_args = paddle_arguments_create_none();
+  CHECK(paddle_arguments_resize(in_args, 1));
+  paddle_matrix mat = paddle_matrix_create(/* sample_num */ 1,
+                                           /* size */ 784,
+                                           /* useGPU */ false);
+  paddle_arguments out_args = paddle_arguments_create_none();
+  paddle_matrix prob = paddle_matrix_create_none();
+  paddle_real* array;
+  for (int iter = 0; iter < NUM_ITER; ++iter) {
+    CHECK(paddle_matrix_get_row(mat, 0, &array));
+    for (int i = 0; i < 784; ++i) {
+      array[i] = rand() / ((float)RAND_MAX);
+    }
+    CHECK(paddle_arguments_set_value(in_args, 0, mat));
+
+    if (use_batcher) {
+      CHECK(paddle_batcher_forward(batcher, in_args, out_args));
+    } else {
+      CHECK(paddle_gradient_machine_forward(local_machine,
+                                            in_args,
+                                            out_args,
+                                            /* isTrain */ false));
+    }
+    CHECK(paddle_arguments_get_value(out_args, 0, prob));
+    CHECK(paddle_matrix_get_row(prob, 0, &array));
+  }
+
+  CHECK(paddle_matrix_destroy(prob));
+  CHECK(paddle_arguments_destroy(out_args));
+  CHECK(paddle_matrix_destroy(mat));
+  CHECK(paddle_arguments_destroy(in_args));
+  if (local_machine != NULL) {
+    CHECK(paddle_gradient_machine_destroy(local_machine));
+  }
+  return NULL;
+}
+
+void run(int use_batcher) {
+  pthread_t threads[NUM_THREAD];
+  double start = now_ms();
+  for (int i = 0; i < NUM_THREAD; ++i) {
+    pthread_create(&threads[i], NULL, thread_main, (void*)(long)use_batcher);
+  }
+  for (int i = 0; i < NUM_THREAD; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+  double elapsed = now_ms() - start;
+  printf("%s: %d requests in %.1f ms, %.1f requests/s\n",
+         use_batcher ? "batcher" : "one machine per thread",
+         NUM_THREAD * NUM_ITER,
+         elapsed,
+         NUM_THREAD * NUM_ITER * 1000.0 / elapsed);
+}
+
+int main() {
+  // Initalize Paddle
+  char* argv[] = {"--use_gpu=False"};
+  CHECK(paddle_init(1, (char**)argv));
+
+  // Reading config binary file. It is generated by `convert_protobin.sh`
+  config = read_config(CONFIG_BIN, &config_size);
+
+  CHECK(paddle_gradient_machine_create_for_inference(
+      &machine, config, (int)config_size));
+  CHECK(paddle_gradient_machine_randomize_param(machine));
+  srand(time(0));
+
+  run(/* use_batcher */ 0);
+
+  // The batcher forwards the batches with a machine of its own.
+  paddle_gradient_machine batcher_machine;
+  CHECK(paddle_gradient_machine_create_shared_param(
+      machine, config, config_size, &batcher_machine));
+  CHECK(paddle_batcher_create(
+      batcher_machine, MAX_BATCH_SIZE, TIMEOUT_US, &batcher));
+  run(/* use_batcher */ 1);
+
+  CHECK(paddle_batcher_destroy(batcher));
+  CHECK(paddle_gradient_machine_destroy(batcher_machine));
+  CHECK(paddle_gradient_machine_destroy(machine));
+  free(config);
+  return 0;
+}
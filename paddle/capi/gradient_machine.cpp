@@ -169,6 +169,35 @@ paddle_error paddle_gradient_machine_get_layer_output(
   return kPD_NO_ERROR;
 }
 
+paddle_error paddle_gradient_machine_reserve(
+    paddle_gradient_machine machine,
+    uint64_t maxBatchSize,
+    uint64_t maxSeqLength,
+    uint64_t maxSubSeqLength,
+    const paddle_input_type* inputTypes,
+    uint64_t numInputs) {
+  auto m = cast(machine);
+  if (m == nullptr || m->machine == nullptr) return kPD_NULLPTR;
+  if (inputTypes == nullptr && numInputs != 0) return kPD_NULLPTR;
+  if (maxBatchSize == 0) return kPD_OUT_OF_RANGE;
+  if (maxSubSeqLength != 0 && maxSeqLength == 0) return kPD_OUT_OF_RANGE;
+  auto nn = dynamic_cast<paddle::NeuralNetwork*>(m->machine.get());
+  if (nn == nullptr) return kPD_NOT_SUPPORTED;
+  std::vector<paddle::NeuralNetwork::InputType> types;
+  for (uint64_t i = 0; i < numInputs; ++i) {
+    if (inputTypes[i] < kPD_DENSE_INPUT || inputTypes[i] > kPD_IDS_INPUT) {
+      return kPD_OUT_OF_RANGE;
+    }
+    types.push_back(
+        static_cast<paddle::NeuralNetwork::InputType>(inputTypes[i]));
+  }
+  if (!types.empty() && types.size() != nn->getDataLayers().size()) {
+    return kPD_OUT_OF_RANGE;
+  }
+  nn->reserve(maxBatchSize, maxSeqLength, maxSubSeqLength, types);
+  return kPD_NO_ERROR;
+}
+
 paddle_error paddle_gradient_machine_release_layer_output(
     paddle_gradient_machine machine) {
   auto m = cast(machine);
@@ -113,6 +113,41 @@ paddle_gradient_machine_get_layer_output(paddle_gradient_machine machine,
                                          const char* layerName,
                                          paddle_arguments args);
 
+/**
+ * @brief The data an input of a gradient machine is fed with.
+ */
+typedef enum {
+  kPD_DENSE_INPUT = 0,
+  kPD_SPARSE_BINARY_INPUT = 1,
+  kPD_SPARSE_FLOAT_INPUT = 2,
+  kPD_IDS_INPUT = 3,
+} paddle_input_type;
+
+/**
+ * @brief Size the buffers of all the layers for inference on batches of up
+ *        to maxBatchSize samples, so that the forwards of smaller batches do
+ *        not allocate memory.
+ * @param [in] machine gradient machine used for inference
+ * @param [in] maxBatchSize the maximum number of samples of a batch
+ * @param [in] maxSeqLength the maximum length of the input sequences, 0 if
+ *             the inputs are not sequences
+ * @param [in] maxSubSeqLength the maximum length of the subsequences of
+ *             nested input sequences, 0 if the sequences are not nested
+ * @param [in] inputTypes the type of each input, in the order of the
+ *             arguments of paddle_gradient_machine_forward, or NULL to feed
+ *             the inputs read by a table projection with ids and the others
+ *             with dense values
+ * @param [in] numInputs the number of elements of inputTypes
+ * @return paddle_error
+ */
+PD_API paddle_error
+paddle_gradient_machine_reserve(paddle_gradient_machine machine,
+                                uint64_t maxBatchSize,
+                                uint64_t maxSeqLength,
+                                uint64_t maxSubSeqLength,
+                                const paddle_input_type* inputTypes,
+                                uint64_t numInputs);
+
 /**
  * @brief Release the middle layer's output memory of the gradient machine.
  * @param [in] gradient machine that have run a inference
@@ -14,9 +14,11 @@ limitations under the License. */
 
 #include <gtest/gtest.h>
 #include <paddle/gserver/gradientmachines/GradientMachine.h>
+#include <paddle/gserver/gradientmachines/NeuralNetwork.h>
 #include <paddle/trainer/TrainerConfigHelper.h>
 #include <stdlib.h>
 #include <string.h>
+#include <thread>
 #include <type_traits>
 #include "capi.h"
 #include "paddle/utils/ThreadLocal.h"
@@ -105,6 +107,294 @@ TEST(GradientMachine, testPredict) {
   ASSERT_EQ(kPD_NO_ERROR, paddle_gradient_machine_destroy(machine));
 }
 
+TEST(GradientMachine, testReserve) {
+  paddle::TrainerConfigHelper config("./test_predict_network.py");
+  std::unique_ptr<paddle::NeuralNetwork> nn(
+      paddle::NeuralNetwork::create(config.getModelConfig()));
+  nn->init(config.getModelConfig(), nullptr, {paddle::PARAMETER_VALUE}, false);
+  nn->randParameters();
+  nn->reserve(16);
+  const paddle::real* buffer =
+      nn->getLayerOutput("__fc_layer_0__").value->getData();
+
+  // The smaller batches are computed in the reserved buffers.
+  for (size_t rows : {1, 3, 16, 5}) {
+    auto data = randomBuffer(rows * 100);
+    std::vector<paddle::Argument> inArgs(1);
+    inArgs[0].value =
+        paddle::Matrix::create(data.data(), rows, 100, false, false);
+    std::vector<paddle::Argument> outArgs;
+    nn->forward(inArgs, &outArgs, paddle::PASS_TEST);
+    ASSERT_EQ(rows, outArgs[0].value->getHeight());
+    ASSERT_EQ(buffer, outArgs[0].value->getData());
+  }
+}
+
+TEST(GradientMachine, testReserveTypedInputs) {
+  paddle::TrainerConfigHelper config("./test_predict_network.py");
+  std::string buffer;
+  ASSERT_TRUE(config.getModelConfig().SerializeToString(&buffer));
+  paddle_gradient_machine machine;
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_gradient_machine_create_for_inference(
+                &machine, &buffer[0], (int)buffer.size()));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_gradient_machine_randomize_param(machine));
+
+  paddle_input_type sparse = kPD_SPARSE_BINARY_INPUT;
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_gradient_machine_reserve(machine, 8, 0, 0, &sparse, 1));
+  // Nested sequences reserve the subsequence start positions too.
+  paddle_input_type dense = kPD_DENSE_INPUT;
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_gradient_machine_reserve(machine, 4, 5, 2, &dense, 1));
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_gradient_machine_reserve(machine, 4, 5, 0, nullptr, 0));
+
+  paddle_input_type types[] = {kPD_DENSE_INPUT, kPD_IDS_INPUT};
+  ASSERT_EQ(kPD_OUT_OF_RANGE,
+            paddle_gradient_machine_reserve(machine, 4, 0, 0, types, 2));
+  ASSERT_EQ(kPD_OUT_OF_RANGE,
+            paddle_gradient_machine_reserve(machine, 4, 0, 2, &dense, 1));
+  ASSERT_EQ(kPD_NULLPTR,
+            paddle_gradient_machine_reserve(machine, 4, 0, 0, nullptr, 1));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_gradient_machine_destroy(machine));
+}
+
+// Forwards a random input of the given rows with the machine and with the
+// batcher, and checks that they output the same.
+static void checkBatcherForward(paddle_gradient_machine machine,
+                                paddle_batcher batcher,
+                                uint64_t rows) {
+  paddle_arguments inArgs = paddle_arguments_create_none();
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_resize(inArgs, 1));
+  paddle_matrix mat = paddle_matrix_create(rows, 100, false);
+  auto data = randomBuffer(rows * 100);
+  paddle_real* rowPtr;
+  ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_get_row(mat, 0, &rowPtr));
+  memcpy(rowPtr, data.data(), data.size() * sizeof(paddle_real));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_set_value(inArgs, 0, mat));
+
+  paddle_arguments outArgs = paddle_arguments_create_none();
+  paddle_arguments batchedOutArgs = paddle_arguments_create_none();
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_gradient_machine_forward(machine, inArgs, outArgs, false));
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_batcher_forward(batcher, inArgs, batchedOutArgs));
+
+  paddle_matrix out = paddle_matrix_create_none();
+  paddle_matrix batchedOut = paddle_matrix_create_none();
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_get_value(outArgs, 0, out));
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_arguments_get_value(batchedOutArgs, 0, batchedOut));
+  uint64_t height, width, batchedHeight, batchedWidth;
+  ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_get_shape(out, &height, &width));
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_matrix_get_shape(batchedOut, &batchedHeight, &batchedWidth));
+  ASSERT_EQ(rows, batchedHeight);
+  ASSERT_EQ(height, batchedHeight);
+  ASSERT_EQ(width, batchedWidth);
+  for (uint64_t i = 0; i < height; ++i) {
+    paddle_real* expected;
+    paddle_real* actual;
+    ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_get_row(out, i, &expected));
+    ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_get_row(batchedOut, i, &actual));
+    for (uint64_t j = 0; j < width; ++j) {
+      ASSERT_NEAR(expected[j], actual[j], 1e-5);
+    }
+  }
+
+  ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_destroy(batchedOut));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_destroy(out));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_destroy(mat));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_destroy(batchedOutArgs));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_destroy(outArgs));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_destroy(inArgs));
+}
+
+// Returns the start positions of the given nesting level of args.
+static std::vector<int> sequenceStartPositions(paddle_arguments args,
+                                               uint32_t nestedLevel) {
+  paddle_ivector positions = paddle_ivector_create_none();
+  EXPECT_EQ(kPD_NO_ERROR,
+            paddle_arguments_get_sequence_start_pos(
+                args, 0, nestedLevel, positions));
+  uint64_t size = 0;
+  int* data = nullptr;
+  EXPECT_EQ(kPD_NO_ERROR, paddle_ivector_get_size(positions, &size));
+  EXPECT_EQ(kPD_NO_ERROR, paddle_ivector_get(positions, &data));
+  std::vector<int> result(data, data + size);
+  EXPECT_EQ(kPD_NO_ERROR, paddle_ivector_destroy(positions));
+  return result;
+}
+
+// Forwards a random input of numSequences nested sequences, of 1 to 3
+// sub-sequences of 1 or 2 rows, with the machine and with the batcher, and
+// checks that they output the same rows and the same start positions.
+static void checkBatcherSequenceForward(paddle_gradient_machine machine,
+                                        paddle_batcher batcher,
+                                        int numSequences) {
+  auto& eng = paddle::ThreadLocalRandomEngine::get();
+  std::uniform_int_distribution<int> dist(1, 3);
+  std::vector<int> seqPos(1, 0);
+  std::vector<int> subSeqPos(1, 0);
+  for (int i = 0; i < numSequences; ++i) {
+    int numSubSequences = dist(eng);
+    for (int j = 0; j < numSubSequences; ++j) {
+      subSeqPos.push_back(subSeqPos.back() + 1 + dist(eng) % 2);
+    }
+    seqPos.push_back(subSeqPos.back());
+  }
+  uint64_t rows = seqPos.back();
+
+  paddle_arguments inArgs = paddle_arguments_create_none();
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_resize(inArgs, 1));
+  paddle_matrix mat = paddle_matrix_create(rows, 100, false);
+  auto data = randomBuffer(rows * 100);
+  paddle_real* rowPtr;
+  ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_get_row(mat, 0, &rowPtr));
+  memcpy(rowPtr, data.data(), data.size() * sizeof(paddle_real));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_set_value(inArgs, 0, mat));
+  paddle_ivector seqVec =
+      paddle_ivector_create(seqPos.data(), seqPos.size(), true, false);
+  paddle_ivector subSeqVec =
+      paddle_ivector_create(subSeqPos.data(), subSeqPos.size(), true, false);
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_arguments_set_sequence_start_pos(inArgs, 0, 0, seqVec));
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_arguments_set_sequence_start_pos(inArgs, 0, 1, subSeqVec));
+
+  paddle_arguments outArgs = paddle_arguments_create_none();
+  paddle_arguments batchedOutArgs = paddle_arguments_create_none();
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_gradient_machine_forward(machine, inArgs, outArgs, false));
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_batcher_forward(batcher, inArgs, batchedOutArgs));
+
+  // The positions of the request's sequences in the batch are rebased.
+  ASSERT_EQ(seqPos, sequenceStartPositions(outArgs, 0));
+  ASSERT_EQ(seqPos, sequenceStartPositions(batchedOutArgs, 0));
+  ASSERT_EQ(subSeqPos, sequenceStartPositions(outArgs, 1));
+  ASSERT_EQ(subSeqPos, sequenceStartPositions(batchedOutArgs, 1));
+
+  paddle_matrix out = paddle_matrix_create_none();
+  paddle_matrix batchedOut = paddle_matrix_create_none();
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_get_value(outArgs, 0, out));
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_arguments_get_value(batchedOutArgs, 0, batchedOut));
+  uint64_t height, width, batchedHeight, batchedWidth;
+  ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_get_shape(out, &height, &width));
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_matrix_get_shape(batchedOut, &batchedHeight, &batchedWidth));
+  ASSERT_EQ(rows, height);
+  ASSERT_EQ(rows, batchedHeight);
+  ASSERT_EQ(width, batchedWidth);
+  for (uint64_t i = 0; i < height; ++i) {
+    paddle_real* expected;
+    paddle_real* actual;
+    ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_get_row(out, i, &expected));
+    ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_get_row(batchedOut, i, &actual));
+    for (uint64_t j = 0; j < width; ++j) {
+      ASSERT_NEAR(expected[j], actual[j], 1e-5);
+    }
+  }
+
+  ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_destroy(batchedOut));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_destroy(out));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_ivector_destroy(subSeqVec));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_ivector_destroy(seqVec));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_destroy(mat));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_destroy(batchedOutArgs));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_destroy(outArgs));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_destroy(inArgs));
+}
+
+TEST(GradientMachine, testBatcher) {
+  paddle::TrainerConfigHelper config("./test_predict_network.py");
+  std::string buffer;
+  ASSERT_TRUE(config.getModelConfig().SerializeToString(&buffer));
+  paddle_gradient_machine machine;
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_gradient_machine_create_for_inference(
+                &machine, &buffer[0], (int)buffer.size()));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_gradient_machine_randomize_param(machine));
+
+  paddle_gradient_machine batcherMachine;
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_gradient_machine_create_shared_param(
+                machine, &buffer[0], (int)buffer.size(), &batcherMachine));
+  paddle_batcher batcher;
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_batcher_create(batcherMachine, 8, 1000, &batcher));
+
+  // Requests of 1 to 3 rows from several threads, so that the batches mix
+  // requests of different sizes.
+  const int numThreads = 4;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numThreads; ++t) {
+    threads.emplace_back([&, t] {
+      paddle_gradient_machine threadMachine;
+      ASSERT_EQ(kPD_NO_ERROR,
+                paddle_gradient_machine_create_shared_param(
+                    machine, &buffer[0], (int)buffer.size(), &threadMachine));
+      for (int iter = 0; iter < 20; ++iter) {
+        checkBatcherForward(threadMachine, batcher, 1 + (t + iter) % 3);
+      }
+      ASSERT_EQ(kPD_NO_ERROR, paddle_gradient_machine_destroy(threadMachine));
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // A request larger than the batch size runs on its own.
+  checkBatcherForward(machine, batcher, 10);
+
+  // Requests of 1 to 3 nested sequences, whose start positions are
+  // concatenated in the batches and rebased in the outputs.
+  threads.clear();
+  for (int t = 0; t < numThreads; ++t) {
+    threads.emplace_back([&, t] {
+      paddle_gradient_machine threadMachine;
+      ASSERT_EQ(kPD_NO_ERROR,
+                paddle_gradient_machine_create_shared_param(
+                    machine, &buffer[0], (int)buffer.size(), &threadMachine));
+      for (int iter = 0; iter < 20; ++iter) {
+        checkBatcherSequenceForward(threadMachine, batcher, 1 + (t + iter) % 3);
+      }
+      ASSERT_EQ(kPD_NO_ERROR, paddle_gradient_machine_destroy(threadMachine));
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Requests of rows and of nested sequences at the same time are put into
+  // different batches.
+  threads.clear();
+  for (int t = 0; t < numThreads; ++t) {
+    threads.emplace_back([&, t] {
+      paddle_gradient_machine threadMachine;
+      ASSERT_EQ(kPD_NO_ERROR,
+                paddle_gradient_machine_create_shared_param(
+                    machine, &buffer[0], (int)buffer.size(), &threadMachine));
+      for (int iter = 0; iter < 20; ++iter) {
+        if ((t + iter) % 2 == 0) {
+          checkBatcherForward(threadMachine, batcher, 1 + iter % 3);
+        } else {
+          checkBatcherSequenceForward(threadMachine, batcher, 1 + iter % 3);
+        }
+      }
+      ASSERT_EQ(kPD_NO_ERROR, paddle_gradient_machine_destroy(threadMachine));
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(kPD_NO_ERROR, paddle_batcher_destroy(batcher));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_gradient_machine_destroy(batcherMachine));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_gradient_machine_destroy(machine));
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   std::vector<char*> argvs;
@@ -16,6 +16,7 @@ limitations under the License. */
 #include <typeindex>
 #include "paddle/fluid/framework/framework.pb.h"
 #include "paddle/fluid/platform/enforce.h"
+#include "paddle/math/float16.h"
 
 namespace paddle {
 namespace framework {
@@ -32,6 +33,10 @@ inline proto::DataType ToDataType(std::type_index type) {
     return DataType::INT64;
   } else if (typeid(bool).hash_code() == type.hash_code()) {
     return DataType::BOOL;
+  } else if (typeid(int8_t).hash_code() == type.hash_code()) {
+    return DataType::INT8;
+  } else if (typeid(float16).hash_code() == type.hash_code()) {
+    return DataType::FP16;
   } else {
     PADDLE_THROW("Not supported");
   }
@@ -50,6 +55,10 @@ inline std::type_index ToTypeIndex(proto::DataType type) {
       return typeid(int64_t);
     case DataType::BOOL:
       return typeid(bool);
+    case DataType::INT8:
+      return typeid(int8_t);
+    case DataType::FP16:
+      return typeid(float16);
     default:
       PADDLE_THROW("Not support type %d", type);
   }
@@ -96,6 +105,8 @@ inline std::string DataTypeToString(const proto::DataType type) {
       return "int64";
     case DataType::BOOL:
       return "bool";
+    case DataType::INT8:
+      return "int8";
     default:
       PADDLE_THROW("Not support type %d", type);
   }
@@ -21,6 +21,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/lod_rank_table.h"
 #include "paddle/fluid/framework/lod_tensor_array.h"
+#include "paddle/fluid/framework/op_cost.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/reader.h"
 #include "paddle/fluid/platform/place.h"
@@ -36,6 +37,26 @@ namespace framework {
 
 Executor::Executor(const platform::Place& place) : place_(place) {}
 
+// Deletes the local scope of a run when it goes out of scope, so that the
+// scope is not leaked when an operator throws.
+class LocalScopeGuard {
+ public:
+  LocalScopeGuard(Scope* parent, Scope* local)
+      : parent_(parent), local_(local) {}
+  ~LocalScopeGuard() { Delete(); }
+
+  void Delete() {
+    if (local_ != nullptr) {
+      parent_->DeleteScope(local_);
+      local_ = nullptr;
+    }
+  }
+
+ private:
+  Scope* parent_;
+  Scope* local_;
+};
+
 static void CreateTensor(Variable* var, proto::VarDesc::VarType var_type) {
   if (var_type == proto::VarDesc::LOD_TENSOR) {
     var->GetMutable<LoDTensor>();
@@ -79,16 +100,34 @@ static void CheckTensorNANOrInf(const std::string& name,
 
 void Executor::Run(const ProgramDesc& pdesc, Scope* scope, int block_id,
                    bool create_local_scope, bool create_vars) {
+  auto ctx = Prepare(pdesc, block_id);
+  RunPreparedContext(ctx.get(), scope, create_local_scope, create_vars);
+}
+
+std::unique_ptr<ExecutorPrepareContext> Executor::Prepare(
+    const ProgramDesc& program, int block_id) {
+  PADDLE_ENFORCE_LT(static_cast<size_t>(block_id), program.Size());
+  std::unique_ptr<ExecutorPrepareContext> ctx(
+      new ExecutorPrepareContext(program, block_id));
+  for (auto& op_desc : program.Block(block_id).AllOps()) {
+    ctx->ops_.push_back(OpRegistry::CreateOp(*op_desc));
+  }
+  return ctx;
+}
+
+void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
+                                  bool create_local_scope, bool create_vars) {
   // TODO(tonyyang-svail):
   //    - only runs on the first device (i.e. no interdevice communication)
   //    - will change to use multiple blocks for RNN op and Cond Op
-  PADDLE_ENFORCE_LT(static_cast<size_t>(block_id), pdesc.Size());
-  auto& block = pdesc.Block(block_id);
+  auto& block = ctx->prog_.Block(ctx->block_id_);
 
-  Scope* local_scope = scope;
+  Scope* local_scope =
+      create_vars && create_local_scope ? &scope->NewScope() : scope;
+  LocalScopeGuard local_scope_guard(
+      scope, local_scope != scope ? local_scope : nullptr);
   if (create_vars) {
     if (create_local_scope) {
-      local_scope = &scope->NewScope();
       for (auto& var : block.AllVars()) {
         if (var->Name() == framework::kEmptyVarName) {
           continue;
@@ -116,14 +155,20 @@ void Executor::Run(const ProgramDesc& pdesc, Scope* scope, int block_id,
     }  // if (create_local_scope)
   }    // if (create_vars)
 
-  for (auto& op_desc : block.AllOps()) {
-    auto op = paddle::framework::OpRegistry::CreateOp(*op_desc);
+  for (auto& op : ctx->ops_) {
     VLOG(4) << op->DebugStringEx(local_scope);
 
-    platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
-    platform::RecordEvent record_event(op->Type(), pool.Get(place_));
-
-    op->Run(*local_scope, place_);
+    {
+      platform::DeviceContextPool& pool =
+          platform::DeviceContextPool::Instance();
+      platform::RecordEvent record_event(op->Type(), pool.Get(place_));
+      op->Run(*local_scope, place_);
+    }
+    if (platform::IsProfileEnabled()) {
+      // Computed once the event is closed, so that it is not timed.
+      platform::SetPopEventDetail(op->Type(), OpInputShapes(*op, *local_scope),
+                                  EstimateOpFlops(*op, *local_scope));
+    }
     VLOG(3) << op->DebugStringEx(local_scope);
     if (FLAGS_benchmark) {
       VLOG(2) << "Memory used after operator " + op->Type() + " running: "
@@ -139,9 +184,7 @@ void Executor::Run(const ProgramDesc& pdesc, Scope* scope, int block_id,
       }
     }
   }
-  if (create_vars && create_local_scope) {
-    scope->DeleteScope(local_scope);
-  }
+  local_scope_guard.Delete();
   if (FLAGS_benchmark) {
     VLOG(2) << "-------------------------------------------------------";
     VLOG(2) << "Memory used after deleting local scope: "
@@ -14,7 +14,11 @@ limitations under the License. */
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "paddle/fluid/framework/op_info.h"
+#include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/tensor.h"
@@ -23,6 +27,18 @@ limitations under the License. */
 namespace paddle {
 namespace framework {
 
+// The operators of one block, created once by Executor::Prepare so that a
+// block run many times, e.g. the step block of a while or recurrent
+// operator, does not create its operators again at every run.
+struct ExecutorPrepareContext {
+  ExecutorPrepareContext(const ProgramDesc& prog, size_t block_id)
+      : prog_(prog), block_id_(block_id) {}
+
+  const ProgramDesc& prog_;
+  size_t block_id_;
+  std::vector<std::unique_ptr<OperatorBase>> ops_;
+};
+
 class Executor {
  public:
   // TODO(dzhwinter) : Do not rely on this function, it will be removed
@@ -47,6 +63,16 @@ class Executor {
            const std::string& feed_holder_name = "feed",
            const std::string& fetch_holder_name = "fetch");
 
+  // The program must outlive the returned context.
+  static std::unique_ptr<ExecutorPrepareContext> Prepare(
+      const ProgramDesc& program, int block_id);
+
+  // Same as Run(ctx->prog_, scope, ctx->block_id_, ...), with the operators
+  // of the context.
+  void RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
+                          bool create_local_scope = true,
+                          bool create_vars = true);
+
  private:
   const platform::Place place_;
 };
@@ -0,0 +1,551 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/inference_pass.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/feed_fetch_type.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/float16_convert.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+template <typename T>
+T GetAttrOr(const OpDesc& op, const std::string& name, T default_value) {
+  if (!op.HasAttr(name)) {
+    return default_value;
+  }
+  return boost::get<T>(op.GetAttr(name));
+}
+
+// Returns the only argument of `param`, or an empty string if the parameter
+// is missing or duplicable.
+std::string SingleArgument(const VariableNameMap& args,
+                           const std::string& param) {
+  auto it = args.find(param);
+  if (it == args.end() || it->second.size() != 1) {
+    return "";
+  }
+  return it->second[0];
+}
+
+std::string SingleInput(const OpDesc& op, const std::string& param) {
+  return SingleArgument(op.Inputs(), param);
+}
+
+std::string SingleOutput(const OpDesc& op, const std::string& param) {
+  return SingleArgument(op.Outputs(), param);
+}
+
+// The number of operators reading each variable in the whole program. fetch
+// operators are counted too, so a fetch target is never taken for an
+// intermediate result that a fusion may elide.
+std::unordered_map<std::string, int> CountReaders(const ProgramDesc& program) {
+  std::unordered_map<std::string, int> readers;
+  for (size_t i = 0; i < program.Size(); ++i) {
+    for (auto* op : program.Block(i).AllOps()) {
+      for (auto& name : op->InputArgumentNames()) {
+        ++readers[name];
+      }
+    }
+  }
+  return readers;
+}
+
+// Returns the index of the first operator after `start` reading `name`, or
+// -1 if there is no such operator.
+int FindReader(BlockDesc* block, size_t start, const std::string& name) {
+  for (size_t i = start + 1; i < block->OpSize(); ++i) {
+    auto inputs = block->Op(i)->InputArgumentNames();
+    if (std::find(inputs.begin(), inputs.end(), name) != inputs.end()) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+bool IsFetched(const BlockDesc& block, const std::string& name) {
+  for (auto* op : block.AllOps()) {
+    if (op->Type() == kFetchOpType && SingleInput(*op, "X") == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The activations the fc and conv2d_fusion operators can apply.
+bool IsFusableActivation(const std::string& type) {
+  return type == "relu" || type == "sigmoid" || type == "tanh";
+}
+
+bool IsParameter(const BlockDesc& block, const std::string& name) {
+  auto* var = block.FindVar(name);
+  return var != nullptr && var->Persistable();
+}
+
+size_t ParameterRank(const BlockDesc& block, const std::string& name) {
+  return block.FindVar(name)->GetShape().size();
+}
+
+// Copies the float parameter `name` to `cpu_tensor`. Returns false if the
+// parameter has not been loaded into `scope` or is not a float tensor.
+bool ReadParameter(const Scope& scope, const std::string& name,
+                   LoDTensor* cpu_tensor) {
+  auto* var = scope.FindVar(name);
+  if (var == nullptr || !var->IsType<LoDTensor>()) {
+    return false;
+  }
+  auto& tensor = var->Get<LoDTensor>();
+  if (!tensor.IsInitialized() ||
+      tensor.type().hash_code() != typeid(float).hash_code()) {
+    return false;
+  }
+  Copy(tensor, platform::CPUPlace(), cpu_tensor);
+  return true;
+}
+
+void WriteParameter(Scope* scope, const std::string& name,
+                    const LoDTensor& cpu_tensor) {
+  auto* tensor = scope->FindVar(name)->GetMutable<LoDTensor>();
+  auto place = tensor->place();
+  Copy(cpu_tensor, place, tensor);
+  // cpu_tensor goes out of scope right after, do not let the copy outlive it.
+  platform::DeviceContextPool::Instance().Get(place)->Wait();
+}
+
+void RenameInputInProgram(ProgramDesc* program, const std::string& old_name,
+                          const std::string& new_name) {
+  for (size_t i = 0; i < program->Size(); ++i) {
+    for (auto* op : program->MutableBlock(i)->AllOps()) {
+      op->RenameInput(old_name, new_name);
+    }
+  }
+}
+
+// dropout with is_test is a scale by (1 - dropout_prob). It is rewritten
+// into a scale operator, which does not allocate the Mask output, and is
+// removed together with scale operators of factor 1 when it is an identity.
+class RemoveDropoutPass : public InferencePass {
+ public:
+  std::string Type() const override { return "remove_dropout"; }
+
+  int Apply(ProgramDesc* program, Scope* scope,
+            const platform::Place& place) const override {
+    auto* block = program->MutableBlock(0);
+    int count = 0;
+    for (size_t i = 0; i < block->OpSize();) {
+      auto* op = block->Op(i);
+      float scale;
+      if (op->Type() == "dropout" && GetAttrOr<bool>(*op, "is_test", false)) {
+        scale = 1.0f - GetAttrOr<float>(*op, "dropout_prob", 0.5f);
+      } else if (op->Type() == "scale") {
+        scale = GetAttrOr<float>(*op, "scale", 1.0f);
+      } else {
+        ++i;
+        continue;
+      }
+
+      std::string x = SingleInput(*op, "X");
+      std::string out = SingleOutput(*op, "Out");
+      if (x.empty() || out.empty()) {
+        ++i;
+        continue;
+      }
+
+      // The name of a fetch target is part of the interface of the model,
+      // so an identity producing it is kept.
+      if (scale == 1.0f && !IsFetched(*block, out)) {
+        RenameInputInProgram(program, out, x);
+        block->RemoveOp(i, i + 1);
+        ++count;
+        continue;
+      }
+
+      if (op->Type() == "dropout") {
+        op->SetType("scale");
+        op->SetInputMap({{"X", {x}}});
+        op->SetOutputMap({{"Out", {out}}});
+        op->SetAttrMap({{"scale", scale}});
+        ++count;
+      }
+      ++i;
+    }
+    return count;
+  }
+};
+
+// Folds an is_test batch_norm into the filter and bias of the preceding
+// conv2d:
+//   alpha = scale / sqrt(variance + epsilon)
+//   filter' = filter * alpha
+//   bias' = (bias - mean) * alpha + shift
+// where bias is the conv2d bias added by elementwise_add, or 0 if there is
+// none. batch_norm is then either removed or turned into the bias addition.
+class FoldConvBNPass : public InferencePass {
+ public:
+  std::string Type() const override { return "fold_conv_bn"; }
+
+  int Apply(ProgramDesc* program, Scope* scope,
+            const platform::Place& place) const override {
+    auto* block = program->MutableBlock(0);
+    auto readers = CountReaders(*program);
+    int count = 0;
+    for (size_t i = 0; i < block->OpSize(); ++i) {
+      auto* conv = block->Op(i);
+      if (conv->Type() != "conv2d" && conv->Type() != "depthwise_conv2d") {
+        continue;
+      }
+      std::string filter = SingleInput(*conv, "Filter");
+      std::string conv_out = SingleOutput(*conv, "Output");
+      // The filter is modified in place, so it must not be shared.
+      if (!IsParameter(*block, filter) || readers[filter] != 1 ||
+          readers[conv_out] != 1) {
+        continue;
+      }
+
+      int bn_idx = FindReader(block, i, conv_out);
+      if (bn_idx < 0) continue;
+
+      OpDesc* add = nullptr;
+      std::string conv_bias;
+      std::string bn_in = conv_out;
+      if (block->Op(bn_idx)->Type() == "elementwise_add") {
+        add = block->Op(bn_idx);
+        conv_bias = SingleInput(*add, "Y");
+        bn_in = SingleOutput(*add, "Out");
+        if (SingleInput(*add, "X") != conv_out ||
+            GetAttrOr<int>(*add, "axis", -1) != 1 ||
+            !IsParameter(*block, conv_bias) || readers[conv_bias] != 1 ||
+            bn_in.empty() || readers[bn_in] != 1) {
+          continue;
+        }
+        bn_idx = FindReader(block, bn_idx, bn_in);
+        if (bn_idx < 0) continue;
+      }
+
+      auto* bn = block->Op(bn_idx);
+      if (bn->Type() != "batch_norm" ||
+          !GetAttrOr<bool>(*bn, "is_test", false) ||
+          GetAttrOr<std::string>(*bn, "data_layout", "NCHW") != "NCHW" ||
+          SingleInput(*bn, "X") != bn_in) {
+        continue;
+      }
+      std::string bn_shift = SingleInput(*bn, "Bias");
+      std::string bn_out = SingleOutput(*bn, "Y");
+      // Without a conv2d bias, the batch_norm shift is reused as the bias.
+      if (add == nullptr && readers[bn_shift] != 1) continue;
+
+      LoDTensor weight, bias, scale, shift, mean, variance;
+      if (!ReadParameter(*scope, filter, &weight) ||
+          !ReadParameter(*scope, SingleInput(*bn, "Scale"), &scale) ||
+          !ReadParameter(*scope, bn_shift, &shift) ||
+          !ReadParameter(*scope, SingleInput(*bn, "Mean"), &mean) ||
+          !ReadParameter(*scope, SingleInput(*bn, "Variance"), &variance) ||
+          (add != nullptr && !ReadParameter(*scope, conv_bias, &bias))) {
+        continue;
+      }
+      const int64_t channels = weight.dims()[0];
+      if (scale.numel() != channels || shift.numel() != channels ||
+          mean.numel() != channels || variance.numel() != channels ||
+          (add != nullptr && bias.numel() != channels)) {
+        continue;
+      }
+
+      const float epsilon = GetAttrOr<float>(*bn, "epsilon", 1e-5f);
+      const int64_t weight_stride = weight.numel() / channels;
+      float* weight_data = weight.data<float>();
+      LoDTensor new_bias;
+      float* new_bias_data =
+          new_bias.mutable_data<float>(shift.dims(), platform::CPUPlace());
+      for (int64_t c = 0; c < channels; ++c) {
+        float alpha =
+            scale.data<float>()[c] / std::sqrt(variance.data<float>()[c] +
+                                               epsilon);
+        for (int64_t k = 0; k < weight_stride; ++k) {
+          weight_data[c * weight_stride + k] *= alpha;
+        }
+        float b = add != nullptr ? bias.data<float>()[c] : 0.0f;
+        new_bias_data[c] =
+            (b - mean.data<float>()[c]) * alpha + shift.data<float>()[c];
+      }
+      WriteParameter(scope, filter, weight);
+
+      if (add != nullptr) {
+        WriteParameter(scope, conv_bias, new_bias);
+        add->SetOutput("Out", {bn_out});
+        block->RemoveOp(bn_idx, bn_idx + 1);
+      } else {
+        WriteParameter(scope, bn_shift, new_bias);
+        bn->SetType("elementwise_add");
+        bn->SetInputMap({{"X", {conv_out}}, {"Y", {bn_shift}}});
+        bn->SetOutputMap({{"Out", {bn_out}}});
+        bn->SetAttrMap({{"axis", 1}});
+      }
+      ++count;
+    }
+    return count;
+  }
+};
+
+// The result of matching elementwise_add(bias) [-> activation] after the
+// operator producing `out`: the indices of the matched operators in `fused`
+// and the output of the last one in `out`. `fused` is empty if nothing
+// matched.
+struct BiasActMatch {
+  std::string bias;
+  std::string activation;
+  std::string out;
+  std::vector<int> fused;
+};
+
+BiasActMatch MatchBiasAct(BlockDesc* block,
+                          std::unordered_map<std::string, int>* readers,
+                          size_t start, const std::string& out,
+                          const std::vector<int>& bias_axes) {
+  BiasActMatch match;
+  match.out = out;
+  if ((*readers)[out] != 1) return match;
+
+  int next = FindReader(block, start, out);
+  if (next >= 0 && block->Op(next)->Type() == "elementwise_add") {
+    auto* add = block->Op(next);
+    std::string bias = SingleInput(*add, "Y");
+    int axis = GetAttrOr<int>(*add, "axis", -1);
+    if (SingleInput(*add, "X") == out && IsParameter(*block, bias) &&
+        ParameterRank(*block, bias) == 1 &&
+        std::find(bias_axes.begin(), bias_axes.end(), axis) !=
+            bias_axes.end() &&
+        !SingleOutput(*add, "Out").empty()) {
+      match.bias = bias;
+      match.out = SingleOutput(*add, "Out");
+      match.fused.push_back(next);
+      if ((*readers)[match.out] != 1) return match;
+      next = FindReader(block, next, match.out);
+    } else {
+      return match;
+    }
+  }
+
+  if (next >= 0 && IsFusableActivation(block->Op(next)->Type()) &&
+      SingleInput(*block->Op(next), "X") == match.out &&
+      !SingleOutput(*block->Op(next), "Out").empty()) {
+    match.activation = block->Op(next)->Type();
+    match.out = SingleOutput(*block->Op(next), "Out");
+    match.fused.push_back(next);
+  }
+  return match;
+}
+
+void RemoveFusedOps(BlockDesc* block, std::vector<int> fused) {
+  std::sort(fused.begin(), fused.end(), std::greater<int>());
+  for (int idx : fused) {
+    block->RemoveOp(idx, idx + 1);
+  }
+}
+
+// conv2d -> elementwise_add(bias, axis=1) [-> relu|sigmoid|tanh] are fused
+// into one conv2d_fusion operator.
+class FuseConvBiasActPass : public InferencePass {
+ public:
+  std::string Type() const override { return "fuse_conv_bias_act"; }
+
+  int Apply(ProgramDesc* program, Scope* scope,
+            const platform::Place& place) const override {
+    auto* block = program->MutableBlock(0);
+    auto readers = CountReaders(*program);
+    int count = 0;
+    for (size_t i = 0; i < block->OpSize(); ++i) {
+      auto* conv = block->Op(i);
+      if (conv->Type() != "conv2d") continue;
+      std::string conv_out = SingleOutput(*conv, "Output");
+      if (conv_out.empty()) continue;
+
+      auto match = MatchBiasAct(block, &readers, i, conv_out, {1});
+      if (match.fused.empty()) continue;
+
+      conv->SetType("conv2d_fusion");
+      if (!match.bias.empty()) {
+        conv->SetInput("Bias", {match.bias});
+      }
+      conv->SetOutput("Output", {match.out});
+      conv->SetAttr("activation", match.activation.empty()
+                                      ? std::string("identity")
+                                      : match.activation);
+      RemoveFusedOps(block, match.fused);
+      ++count;
+    }
+    return count;
+  }
+};
+
+// mul -> elementwise_add(bias) [-> relu|sigmoid|tanh], as built by
+// fluid.layers.fc, are fused into one fc operator.
+class FuseFCPass : public InferencePass {
+ public:
+  std::string Type() const override { return "fuse_fc"; }
+
+  int Apply(ProgramDesc* program, Scope* scope,
+            const platform::Place& place) const override {
+    auto* block = program->MutableBlock(0);
+    auto readers = CountReaders(*program);
+    int count = 0;
+    for (size_t i = 0; i < block->OpSize(); ++i) {
+      auto* mul = block->Op(i);
+      if (mul->Type() != "mul") continue;
+      std::string x = SingleInput(*mul, "X");
+      std::string w = SingleInput(*mul, "Y");
+      std::string mul_out = SingleOutput(*mul, "Out");
+      if (x.empty() || mul_out.empty() || !IsParameter(*block, w) ||
+          ParameterRank(*block, w) != 2 ||
+          GetAttrOr<int>(*mul, "y_num_col_dims", 1) != 1) {
+        continue;
+      }
+      int x_num_col_dims = GetAttrOr<int>(*mul, "x_num_col_dims", 1);
+
+      auto match =
+          MatchBiasAct(block, &readers, i, mul_out, {-1, x_num_col_dims});
+      if (match.fused.empty()) continue;
+
+      VariableNameMap inputs{{"Input", {x}}, {"W", {w}}};
+      if (!match.bias.empty()) {
+        inputs["Bias"] = {match.bias};
+      }
+      mul->SetType("fc");
+      mul->SetInputMap(inputs);
+      mul->SetOutputMap({{"Out", {match.out}}});
+      mul->SetAttrMap({{"in_num_col_dims", x_num_col_dims},
+                       {"activation_type", match.activation.empty()
+                                               ? std::string("identity")
+                                               : match.activation}});
+      RemoveFusedOps(block, match.fused);
+      ++count;
+    }
+    return count;
+  }
+};
+
+// Embedding tables read only by lookup_table operators are converted to
+// float16 in scope. The lookup_table float16 kernel converts the rows it
+// gathers back to float, so only the storage of the table is halved.
+//
+// The other operators, e.g. elementwise, activations, sum and sgd, have no
+// float16 CPU kernels, so a table that any of them reads or any operator
+// writes is left in float: no float16 tensor ever reaches them.
+class FP16EmbeddingPass : public InferencePass {
+ public:
+  std::string Type() const override { return "fp16_embedding"; }
+
+  int Apply(ProgramDesc* program, Scope* scope,
+            const platform::Place& place) const override {
+    if (!platform::is_cpu_place(place)) return 0;
+    auto* block = program->MutableBlock(0);
+    auto readers = CountReaders(*program);
+    std::unordered_map<std::string, int> table_readers;
+    for (auto* op : block->AllOps()) {
+      if (op->Type() != "lookup_table") continue;
+      std::string w = SingleInput(*op, "W");
+      if (IsParameter(*block, w)) {
+        ++table_readers[w];
+      }
+    }
+    std::unordered_set<std::string> written;
+    for (size_t i = 0; i < program->Size(); ++i) {
+      for (auto* op : program->Block(i).AllOps()) {
+        for (auto& name : op->OutputArgumentNames()) {
+          written.insert(name);
+        }
+      }
+    }
+
+    int count = 0;
+    for (auto& kv : table_readers) {
+      auto& name = kv.first;
+      auto* var = block->FindVar(name);
+      if (kv.second != readers[name] || written.count(name) ||
+          var->GetDataType() != proto::DataType::FP32) {
+        continue;
+      }
+      LoDTensor table;
+      if (!ReadParameter(*scope, name, &table)) continue;
+      auto* tensor = scope->FindVar(name)->GetMutable<LoDTensor>();
+      platform::FloatToFloat16(
+          table.data<float>(),
+          tensor->mutable_data<float16>(table.dims(), platform::CPUPlace()),
+          table.numel());
+      var->SetDataType(proto::DataType::FP16);
+      ++count;
+    }
+    return count;
+  }
+};
+
+}  // namespace
+
+const InferencePass& GetInferencePass(const std::string& type) {
+  static std::unordered_map<std::string, std::unique_ptr<InferencePass>>
+      passes = [] {
+        std::unordered_map<std::string, std::unique_ptr<InferencePass>> m;
+        for (InferencePass* pass :
+             std::vector<InferencePass*>{
+                 new RemoveDropoutPass, new FoldConvBNPass,
+                 new FuseConvBiasActPass, new FuseFCPass,
+                 new FP16EmbeddingPass}) {
+          m[pass->Type()].reset(pass);
+        }
+        return m;
+      }();
+  auto it = passes.find(type);
+  PADDLE_ENFORCE(it != passes.end(), "No inference pass named %s", type);
+  return *it->second;
+}
+
+std::vector<std::string> DefaultInferencePasses(const platform::Place& place) {
+  // batch_norm must be folded before its conv2d is fused with the bias.
+  std::vector<std::string> passes{"remove_dropout", "fold_conv_bn"};
+  if (platform::is_cpu_place(place)) {
+    passes.push_back("fuse_conv_bias_act");
+    passes.push_back("fuse_fc");
+  }
+  return passes;
+}
+
+void ApplyInferencePasses(ProgramDesc* program, Scope* scope,
+                          const platform::Place& place,
+                          const std::vector<std::string>& passes) {
+  for (auto& type : passes) {
+    int count = GetInferencePass(type).Apply(program, scope, place);
+    VLOG(3) << "Inference pass " << type << " applied " << count
+            << " rewrites";
+  }
+}
+
+void ApplyInferencePasses(ProgramDesc* program, Scope* scope,
+                          const platform::Place& place) {
+  ApplyInferencePasses(program, scope, place, DefaultInferencePasses(place));
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,67 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * An InferencePass rewrites the global block of an inference ProgramDesc in
+ * place. Unlike `InferenceOptimize` in prune.h, which works on the protobuf
+ * message only, a pass may also fold parameters (e.g. batch_norm into the
+ * conv2d filter), so passes must run after the persistables of the program
+ * have been loaded into `scope`.
+ */
+class InferencePass {
+ public:
+  virtual ~InferencePass() {}
+
+  virtual std::string Type() const = 0;
+
+  // Returns the number of rewrites applied to the program.
+  virtual int Apply(ProgramDesc* program, Scope* scope,
+                    const platform::Place& place) const = 0;
+};
+
+// Returns the pass named `type`, throws if there is no such pass. The
+// available passes are:
+//   remove_dropout:     drops is_test dropout and identity scale operators.
+//   fold_conv_bn:       folds is_test batch_norm into the preceding conv2d.
+//   fuse_conv_bias_act: conv2d + elementwise_add [+ act] -> conv2d_fusion.
+//   fuse_fc:            mul + elementwise_add [+ act] -> fc.
+//   fp16_embedding:     stores lookup_table parameters as float16, CPU only.
+//                       Not a default pass since it loses precision.
+const InferencePass& GetInferencePass(const std::string& type);
+
+// The passes to apply for `place`, in the order they should run. The fusion
+// passes create CPU-only operators, so they are only enabled for CPUPlace.
+std::vector<std::string> DefaultInferencePasses(const platform::Place& place);
+
+void ApplyInferencePasses(ProgramDesc* program, Scope* scope,
+                          const platform::Place& place,
+                          const std::vector<std::string>& passes);
+
+void ApplyInferencePasses(ProgramDesc* program, Scope* scope,
+                          const platform::Place& place);
+
+}  // namespace framework
+}  // namespace paddle
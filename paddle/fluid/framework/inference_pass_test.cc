@@ -0,0 +1,219 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/inference_pass.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_desc.h"
+
+namespace f = paddle::framework;
+namespace p = paddle::platform;
+
+void AddOp(const std::string &type, const f::VariableNameMap &inputs,
+           const f::VariableNameMap &outputs, f::AttributeMap attrs,
+           f::BlockDesc *block) {
+  for (auto kv : outputs) {
+    for (auto v : kv.second) {
+      block->Var(v)->SetDataType(f::proto::DataType::FP32);
+    }
+  }
+  auto op = block->AppendOp();
+  op->SetType(type);
+  for (auto &kv : inputs) {
+    op->SetInput(kv.first, kv.second);
+  }
+  for (auto &kv : outputs) {
+    op->SetOutput(kv.first, kv.second);
+  }
+  op->SetAttrMap(attrs);
+}
+
+void AddParameter(const std::string &name, const std::vector<int64_t> &shape,
+                  const std::vector<float> &value, f::BlockDesc *block,
+                  f::Scope *scope) {
+  auto *var = block->Var(name);
+  var->SetShape(shape);
+  var->SetDataType(f::proto::DataType::FP32);
+  var->SetPersistable(true);
+  auto *tensor = scope->Var(name)->GetMutable<f::LoDTensor>();
+  float *data = tensor->mutable_data<float>(f::make_ddim(shape), p::CPUPlace());
+  std::copy(value.begin(), value.end(), data);
+}
+
+std::vector<std::string> OpTypes(const f::BlockDesc &block) {
+  std::vector<std::string> types;
+  for (auto *op : block.AllOps()) {
+    types.push_back(op->Type());
+  }
+  return types;
+}
+
+TEST(InferencePass, remove_dropout) {
+  f::ProgramDesc program;
+  f::BlockDesc *block = program.MutableBlock(0);
+  f::Scope scope;
+
+  AddOp("dropout", {{"X", {"a"}}}, {{"Out", {"b"}}, {"Mask", {"m"}}},
+        {{"is_test", true}, {"dropout_prob", 0.0f}}, block);
+  AddOp("dropout", {{"X", {"b"}}}, {{"Out", {"c"}}, {"Mask", {"m2"}}},
+        {{"is_test", true}, {"dropout_prob", 0.2f}}, block);
+  AddOp("fetch", {{"X", {"c"}}}, {{"Out", {"fetch"}}}, {{"col", 0}}, block);
+
+  f::GetInferencePass("remove_dropout").Apply(&program, &scope, p::CPUPlace());
+
+  ASSERT_EQ(OpTypes(*block), std::vector<std::string>({"scale", "fetch"}));
+  auto *scale = block->Op(0);
+  EXPECT_EQ(scale->Input("X"), std::vector<std::string>({"a"}));
+  EXPECT_EQ(scale->Output("Out"), std::vector<std::string>({"c"}));
+  EXPECT_EQ(scale->Outputs().count("Mask"), 0UL);
+  EXPECT_FLOAT_EQ(boost::get<float>(scale->GetAttr("scale")), 0.8f);
+}
+
+TEST(InferencePass, fuse_fc) {
+  f::ProgramDesc program;
+  f::BlockDesc *block = program.MutableBlock(0);
+  f::Scope scope;
+
+  AddParameter("w", {4, 3}, std::vector<float>(12, 1.0f), block, &scope);
+  AddParameter("b", {3}, std::vector<float>(3, 1.0f), block, &scope);
+  AddOp("mul", {{"X", {"x"}}, {"Y", {"w"}}}, {{"Out", {"mul_out"}}},
+        {{"x_num_col_dims", 1}, {"y_num_col_dims", 1}}, block);
+  AddOp("elementwise_add", {{"X", {"mul_out"}}, {"Y", {"b"}}},
+        {{"Out", {"add_out"}}}, {{"axis", 1}}, block);
+  AddOp("relu", {{"X", {"add_out"}}}, {{"Out", {"relu_out"}}},
+        f::AttributeMap{}, block);
+  // The output of the second mul is fetched, so its bias cannot be fused.
+  AddOp("mul", {{"X", {"relu_out"}}, {"Y", {"w"}}}, {{"Out", {"mul_out2"}}},
+        {{"x_num_col_dims", 1}, {"y_num_col_dims", 1}}, block);
+  AddOp("elementwise_add", {{"X", {"mul_out2"}}, {"Y", {"b"}}},
+        {{"Out", {"add_out2"}}}, {{"axis", 1}}, block);
+  AddOp("fetch", {{"X", {"mul_out2"}}}, {{"Out", {"fetch"}}}, {{"col", 0}},
+        block);
+  AddOp("fetch", {{"X", {"add_out2"}}}, {{"Out", {"fetch"}}}, {{"col", 1}},
+        block);
+
+  int count =
+      f::GetInferencePass("fuse_fc").Apply(&program, &scope, p::CPUPlace());
+
+  EXPECT_EQ(count, 1);
+  ASSERT_EQ(OpTypes(*block),
+            std::vector<std::string>(
+                {"fc", "mul", "elementwise_add", "fetch", "fetch"}));
+  auto *fc = block->Op(0);
+  EXPECT_EQ(fc->Input("Input"), std::vector<std::string>({"x"}));
+  EXPECT_EQ(fc->Input("W"), std::vector<std::string>({"w"}));
+  EXPECT_EQ(fc->Input("Bias"), std::vector<std::string>({"b"}));
+  EXPECT_EQ(fc->Output("Out"), std::vector<std::string>({"relu_out"}));
+  EXPECT_EQ(boost::get<std::string>(fc->GetAttr("activation_type")), "relu");
+}
+
+TEST(InferencePass, fold_conv_bn_and_fuse) {
+  f::ProgramDesc program;
+  f::BlockDesc *block = program.MutableBlock(0);
+  f::Scope scope;
+
+  // 2 output channels, 1 input channel, 1x1 filter.
+  AddParameter("filter", {2, 1, 1, 1}, {1.0f, 2.0f}, block, &scope);
+  AddParameter("scale", {2}, {4.0f, 3.0f}, block, &scope);
+  AddParameter("shift", {2}, {0.5f, -0.5f}, block, &scope);
+  AddParameter("mean", {2}, {1.0f, 2.0f}, block, &scope);
+  AddParameter("variance", {2}, {4.0f, 9.0f}, block, &scope);
+  AddOp("conv2d", {{"Input", {"x"}}, {"Filter", {"filter"}}},
+        {{"Output", {"conv_out"}}}, f::AttributeMap{}, block);
+  AddOp("batch_norm",
+        {{"X", {"conv_out"}},
+         {"Scale", {"scale"}},
+         {"Bias", {"shift"}},
+         {"Mean", {"mean"}},
+         {"Variance", {"variance"}}},
+        {{"Y", {"bn_out"}}},
+        {{"is_test", true},
+         {"epsilon", 0.0f},
+         {"data_layout", std::string("NCHW")}},
+        block);
+  AddOp("relu", {{"X", {"bn_out"}}}, {{"Out", {"relu_out"}}},
+        f::AttributeMap{}, block);
+  AddOp("fetch", {{"X", {"relu_out"}}}, {{"Out", {"fetch"}}}, {{"col", 0}},
+        block);
+
+  f::ApplyInferencePasses(&program, &scope, p::CPUPlace());
+
+  ASSERT_EQ(OpTypes(*block),
+            std::vector<std::string>({"conv2d_fusion", "fetch"}));
+  auto *conv = block->Op(0);
+  EXPECT_EQ(conv->Input("Bias"), std::vector<std::string>({"shift"}));
+  EXPECT_EQ(conv->Output("Output"), std::vector<std::string>({"relu_out"}));
+  EXPECT_EQ(boost::get<std::string>(conv->GetAttr("activation")), "relu");
+
+  // alpha = scale / sqrt(variance) = {2, 1}
+  const float *filter =
+      scope.FindVar("filter")->Get<f::LoDTensor>().data<float>();
+  EXPECT_FLOAT_EQ(filter[0], 2.0f);
+  EXPECT_FLOAT_EQ(filter[1], 2.0f);
+  // bias = -mean * alpha + shift
+  const float *bias =
+      scope.FindVar("shift")->Get<f::LoDTensor>().data<float>();
+  EXPECT_FLOAT_EQ(bias[0], -1.5f);
+  EXPECT_FLOAT_EQ(bias[1], -2.5f);
+}
+
+TEST(InferencePass, fp16_embedding) {
+  f::ProgramDesc program;
+  f::BlockDesc *block = program.MutableBlock(0);
+  f::Scope scope;
+
+  AddParameter("emb", {2, 2}, {1.0f, -2.5f, 0.5f, 65504.0f}, block, &scope);
+  AddParameter("shared", {2, 2}, {1.0f, 2.0f, 3.0f, 4.0f}, block, &scope);
+  AddOp("lookup_table", {{"W", {"emb"}}, {"Ids", {"ids"}}},
+        {{"Out", {"emb_out"}}}, f::AttributeMap{}, block);
+  // A table also read by another operator must stay in float.
+  AddOp("lookup_table", {{"W", {"shared"}}, {"Ids", {"ids"}}},
+        {{"Out", {"shared_out"}}}, f::AttributeMap{}, block);
+  AddOp("mul", {{"X", {"emb_out"}}, {"Y", {"shared"}}}, {{"Out", {"out"}}},
+        f::AttributeMap{}, block);
+  // Neither may the tables read by the operators without float16 kernels,
+  // nor the tables updated in the program.
+  AddParameter("added", {2, 2}, {1.0f, 2.0f, 3.0f, 4.0f}, block, &scope);
+  AddOp("lookup_table", {{"W", {"added"}}, {"Ids", {"ids"}}},
+        {{"Out", {"added_out"}}}, f::AttributeMap{}, block);
+  AddOp("elementwise_add", {{"X", {"added"}}, {"Y", {"added"}}},
+        {{"Out", {"sum"}}}, f::AttributeMap{}, block);
+  AddParameter("updated", {2, 2}, {1.0f, 2.0f, 3.0f, 4.0f}, block, &scope);
+  AddOp("lookup_table", {{"W", {"updated"}}, {"Ids", {"ids"}}},
+        {{"Out", {"updated_out"}}}, f::AttributeMap{}, block);
+  AddOp("fill_constant", {}, {{"Out", {"updated"}}}, f::AttributeMap{},
+        block);
+
+  auto &pass = f::GetInferencePass("fp16_embedding");
+  EXPECT_EQ(pass.Apply(&program, &scope, p::CPUPlace()), 1);
+
+  EXPECT_EQ(block->FindVar("emb")->GetDataType(), f::proto::DataType::FP16);
+  for (auto name : {"shared", "added", "updated"}) {
+    EXPECT_EQ(block->FindVar(name)->GetDataType(), f::proto::DataType::FP32)
+        << name;
+  }
+  auto &emb = scope.FindVar("emb")->Get<f::LoDTensor>();
+  EXPECT_EQ(emb.dims(), f::make_ddim({2, 2}));
+  const paddle::float16 *data = emb.data<paddle::float16>();
+  EXPECT_EQ(data[0].x, 0x3c00);
+  EXPECT_EQ(data[1].x, 0xc100);
+  EXPECT_EQ(data[2].x, 0x3800);
+  EXPECT_EQ(data[3].x, 0x7bff);
+  EXPECT_EQ(scope.FindVar("shared")->Get<f::LoDTensor>().type().hash_code(),
+            typeid(float).hash_code());
+}
@@ -0,0 +1,262 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/int8_quantization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+#include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/feed_fetch_type.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+const char kInt8Suffix[] = "@INT8";
+
+template <typename T>
+T GetAttrOr(const OpDesc& op, const std::string& name, T default_value) {
+  if (!op.HasAttr(name)) {
+    return default_value;
+  }
+  return boost::get<T>(op.GetAttr(name));
+}
+
+std::string SingleInput(const OpDesc& op, const std::string& param) {
+  auto& inputs = op.Inputs();
+  auto it = inputs.find(param);
+  if (it == inputs.end() || it->second.size() != 1) {
+    return "";
+  }
+  return it->second[0];
+}
+
+// The float activation and the weight of an operator the pass can rewrite.
+struct QuantizableOp {
+  std::string input;
+  std::string weight;
+  bool is_conv;
+};
+
+bool MatchQuantizable(const BlockDesc& block, const OpDesc& op,
+                      QuantizableOp* match) {
+  const std::string& type = op.Type();
+  if (type == "mul") {
+    if (GetAttrOr<int>(op, "y_num_col_dims", 1) != 1) return false;
+    *match = {SingleInput(op, "X"), SingleInput(op, "Y"), false};
+  } else if (type == "fc") {
+    *match = {SingleInput(op, "Input"), SingleInput(op, "W"), false};
+  } else if (type == "conv2d" || type == "conv2d_fusion") {
+    auto dilations = GetAttrOr<std::vector<int>>(op, "dilations", {1, 1});
+    if (GetAttrOr<int>(op, "groups", 1) != 1 ||
+        std::any_of(dilations.begin(), dilations.end(),
+                    [](int d) { return d != 1; })) {
+      return false;
+    }
+    *match = {SingleInput(op, "Input"), SingleInput(op, "Filter"), true};
+  } else {
+    return false;
+  }
+  if (match->input.empty() || match->weight.empty()) return false;
+  auto* weight = block.FindVar(match->weight);
+  return weight != nullptr && weight->Persistable() &&
+         weight->GetShape().size() == (match->is_conv ? 4UL : 2UL);
+}
+
+// Quantizes the float weight `name` per output channel into the int8
+// variable `name` + kInt8Suffix, and returns the scales. fc weights [K, N]
+// are transposed to [N, K], conv2d filters keep their [M, C, H, W] layout.
+// Returns an empty vector if the weight has not been loaded as float.
+std::vector<float> QuantizeWeight(const std::string& name, bool is_conv,
+                                  BlockDesc* block, Scope* scope) {
+  auto* var = scope->FindVar(name);
+  if (var == nullptr || !var->IsType<LoDTensor>()) return {};
+  auto& weight = var->Get<LoDTensor>();
+  if (!weight.IsInitialized() ||
+      weight.type().hash_code() != typeid(float).hash_code()) {
+    return {};
+  }
+
+  const float* data = weight.data<float>();
+  int64_t channels = is_conv ? weight.dims()[0] : weight.dims()[1];
+  int64_t depth = weight.numel() / channels;
+  // Element k of output channel c.
+  auto at = [&](int64_t c, int64_t k) {
+    return is_conv ? data[c * depth + k] : data[k * channels + c];
+  };
+
+  std::string int8_name = name + kInt8Suffix;
+  DDim int8_dims = is_conv ? weight.dims() : make_ddim({channels, depth});
+  auto* int8_var = block->Var(int8_name);
+  int8_var->SetDataType(proto::DataType::INT8);
+  int8_var->SetShape(vectorize(int8_dims));
+  int8_var->SetPersistable(true);
+  int8_t* int8_data =
+      scope->Var(int8_name)->GetMutable<LoDTensor>()->mutable_data<int8_t>(
+          int8_dims, platform::CPUPlace());
+
+  std::vector<float> scales(channels);
+  for (int64_t c = 0; c < channels; ++c) {
+    float max_abs = 0.0f;
+    for (int64_t k = 0; k < depth; ++k) {
+      max_abs = std::max(max_abs, std::fabs(at(c, k)));
+    }
+    scales[c] = max_abs > 0.0f ? 127.0f / max_abs : 1.0f;
+    for (int64_t k = 0; k < depth; ++k) {
+      float q = std::round(at(c, k) * scales[c]);
+      int8_data[c * depth + k] =
+          static_cast<int8_t>(std::min(std::max(q, -127.0f), 127.0f));
+    }
+  }
+  return scales;
+}
+
+}  // namespace
+
+std::vector<std::string> QuantizableInputs(const ProgramDesc& program) {
+  auto& block = program.Block(0);
+  std::vector<std::string> inputs;
+  std::unordered_set<std::string> seen;
+  for (auto* op : block.AllOps()) {
+    QuantizableOp match;
+    if (MatchQuantizable(block, *op, &match) &&
+        seen.insert(match.input).second) {
+      inputs.push_back(match.input);
+    }
+  }
+  return inputs;
+}
+
+Int8Calibrator::Int8Calibrator(const ProgramDesc& program)
+    : program_(program), fetch_holder_name_("fetch") {
+  auto* block = program_.MutableBlock(0);
+  std::unordered_set<std::string> fetched;
+  int col = 0;
+  for (auto* op : block->AllOps()) {
+    if (op->Type() == kFetchOpType) {
+      fetched.insert(op->Input("X")[0]);
+      fetch_holder_name_ = op->Output("Out")[0];
+      ++col;
+    }
+  }
+
+  auto* fetch_holder = block->Var(fetch_holder_name_);
+  fetch_holder->SetType(proto::VarDesc::FETCH_LIST);
+  fetch_holder->SetPersistable(true);
+  for (auto& name : QuantizableInputs(program)) {
+    ranges_[name] = 0.0f;
+    if (fetched.count(name)) continue;
+    auto* op = block->AppendOp();
+    op->SetType(kFetchOpType);
+    op->SetInput("X", {name});
+    op->SetOutput("Out", {fetch_holder_name_});
+    op->SetAttr("col", col++);
+  }
+}
+
+void Int8Calibrator::Sample(
+    Executor* executor, Scope* scope,
+    const std::map<std::string, const LoDTensor*>& feed_targets) {
+  // The executor requires a target for every fetch operator of the program.
+  std::map<std::string, LoDTensor> results;
+  std::map<std::string, LoDTensor*> fetch_targets;
+  for (auto* op : program_.Block(0).AllOps()) {
+    if (op->Type() == kFetchOpType) {
+      auto& name = op->Input("X")[0];
+      fetch_targets[name] = &results[name];
+    }
+  }
+  auto feeds = feed_targets;
+  executor->Run(program_, scope, feeds, fetch_targets, "feed",
+                fetch_holder_name_);
+
+  for (auto& range : ranges_) {
+    auto& tensor = results[range.first];
+    if (!tensor.IsInitialized() ||
+        tensor.type().hash_code() != typeid(float).hash_code()) {
+      continue;
+    }
+    const float* data = tensor.data<float>();
+    for (int64_t i = 0; i < tensor.numel(); ++i) {
+      range.second = std::max(range.second, std::fabs(data[i]));
+    }
+  }
+}
+
+int Int8QuantizePass::Apply(ProgramDesc* program, Scope* scope,
+                            const platform::Place& place) const {
+  if (!platform::is_cpu_place(place)) return 0;
+  auto* block = program->MutableBlock(0);
+  // Each activation and weight is quantized once for all its readers.
+  std::unordered_map<std::string, std::string> quantized_inputs;
+  std::unordered_map<std::string, std::vector<float>> weight_scales;
+  int count = 0;
+  for (size_t i = 0; i < block->OpSize(); ++i) {
+    auto* op = block->Op(i);
+    QuantizableOp match;
+    if (!MatchQuantizable(*block, *op, &match)) continue;
+    auto range = ranges_.find(match.input);
+    if (range == ranges_.end() || range->second <= 0.0f) continue;
+    float input_scale = 127.0f / range->second;
+
+    auto scales = weight_scales.find(match.weight);
+    if (scales == weight_scales.end()) {
+      auto quantized =
+          QuantizeWeight(match.weight, match.is_conv, block, scope);
+      if (quantized.empty()) continue;
+      scales = weight_scales.emplace(match.weight, quantized).first;
+    }
+
+    auto quantized_input = quantized_inputs.find(match.input);
+    if (quantized_input == quantized_inputs.end()) {
+      std::string int8_name = match.input + kInt8Suffix;
+      auto* int8_var = block->Var(int8_name);
+      int8_var->SetDataType(proto::DataType::INT8);
+      auto* input_var = block->FindVarRecursive(match.input);
+      if (input_var != nullptr) {
+        int8_var->SetShape(input_var->GetShape());
+      }
+      auto* quantize = block->InsertOp(i++);
+      quantize->SetType("quantize");
+      quantize->SetInput("X", {match.input});
+      quantize->SetOutput("Out", {int8_name});
+      quantize->SetAttr("scale", input_scale);
+      quantized_input =
+          quantized_inputs.emplace(match.input, int8_name).first;
+      op = block->Op(i);
+    }
+
+    if (op->Type() == "mul") {
+      op->SetInputMap({{"Input", {match.input}}, {"W", {match.weight}}});
+      op->SetAttrMap(
+          {{"in_num_col_dims", GetAttrOr<int>(*op, "x_num_col_dims", 1)},
+           {"activation_type", std::string("identity")}});
+    } else if (op->Type() == "conv2d") {
+      op->SetAttr("activation", std::string("identity"));
+    }
+    op->SetType(match.is_conv ? "quantized_conv2d" : "quantized_fc");
+    op->RenameInput(match.input, quantized_input->second);
+    op->RenameInput(match.weight, match.weight + kInt8Suffix);
+    op->SetAttr("input_scale", input_scale);
+    op->SetAttr("weight_scale", scales->second);
+    ++count;
+  }
+  return count;
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,84 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/inference_pass.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * Post-training int8 quantization of an inference program for CPU:
+ *
+ *   1. An Int8Calibrator runs the float program, usually after
+ *      ApplyInferencePasses, on sample inputs and records the largest
+ *      absolute value of every activation read by a quantizable operator.
+ *   2. An Int8QuantizePass built from those ranges quantizes the weights
+ *      per output channel, rewrites mul and fc into quantized_fc and conv2d
+ *      and conv2d_fusion into quantized_conv2d, and inserts a quantize
+ *      operator in front of each of their inputs. The int8 operators
+ *      dequantize their own outputs, so the rest of the program is
+ *      unchanged.
+ */
+
+// The activations of the global block that Int8QuantizePass may quantize.
+std::vector<std::string> QuantizableInputs(const ProgramDesc& program);
+
+class Int8Calibrator {
+ public:
+  explicit Int8Calibrator(const ProgramDesc& program);
+
+  // Runs the program once on `feed_targets` and updates the ranges.
+  void Sample(Executor* executor, Scope* scope,
+              const std::map<std::string, const LoDTensor*>& feed_targets);
+
+  // The largest absolute value seen so far for each quantizable input.
+  const std::unordered_map<std::string, float>& Ranges() const {
+    return ranges_;
+  }
+
+ private:
+  // A copy of the program which also fetches the quantizable inputs.
+  ProgramDesc program_;
+  std::string fetch_holder_name_;
+  std::unordered_map<std::string, float> ranges_;
+};
+
+// Not registered in GetInferencePass since it needs the calibrated ranges.
+// Inputs without a range are left in float, and so is everything on a place
+// other than CPUPlace.
+class Int8QuantizePass : public InferencePass {
+ public:
+  explicit Int8QuantizePass(std::unordered_map<std::string, float> ranges)
+      : ranges_(std::move(ranges)) {}
+
+  std::string Type() const override { return "int8_quantize"; }
+
+  int Apply(ProgramDesc* program, Scope* scope,
+            const platform::Place& place) const override;
+
+ private:
+  std::unordered_map<std::string, float> ranges_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,121 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/int8_quantization.h"
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/op_desc.h"
+
+namespace f = paddle::framework;
+namespace p = paddle::platform;
+
+void AddOp(const std::string &type, const f::VariableNameMap &inputs,
+           const f::VariableNameMap &outputs, f::AttributeMap attrs,
+           f::BlockDesc *block) {
+  for (auto kv : outputs) {
+    for (auto v : kv.second) {
+      block->Var(v)->SetDataType(f::proto::DataType::FP32);
+    }
+  }
+  auto op = block->AppendOp();
+  op->SetType(type);
+  for (auto &kv : inputs) {
+    op->SetInput(kv.first, kv.second);
+  }
+  for (auto &kv : outputs) {
+    op->SetOutput(kv.first, kv.second);
+  }
+  op->SetAttrMap(attrs);
+}
+
+void AddParameter(const std::string &name, const std::vector<int64_t> &shape,
+                  const std::vector<float> &value, f::BlockDesc *block,
+                  f::Scope *scope) {
+  auto *var = block->Var(name);
+  var->SetShape(shape);
+  var->SetDataType(f::proto::DataType::FP32);
+  var->SetPersistable(true);
+  auto *tensor = scope->Var(name)->GetMutable<f::LoDTensor>();
+  float *data = tensor->mutable_data<float>(f::make_ddim(shape), p::CPUPlace());
+  std::copy(value.begin(), value.end(), data);
+}
+
+TEST(Int8Quantization, quantize_pass) {
+  f::ProgramDesc program;
+  f::BlockDesc *block = program.MutableBlock(0);
+  f::Scope scope;
+
+  AddParameter("filter", {2, 1, 1, 1}, {1.0f, -0.5f}, block, &scope);
+  AddParameter("w", {2, 3}, {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f}, block,
+               &scope);
+  AddOp("conv2d", {{"Input", {"x"}}, {"Filter", {"filter"}}},
+        {{"Output", {"conv_out"}}}, {{"groups", 1}}, block);
+  AddOp("fc", {{"Input", {"conv_out"}}, {"W", {"w"}}}, {{"Out", {"fc_out"}}},
+        {{"in_num_col_dims", 1}, {"activation_type", std::string("relu")}},
+        block);
+  // The same activation and weight are quantized only once.
+  AddOp("mul", {{"X", {"conv_out"}}, {"Y", {"w"}}}, {{"Out", {"mul_out"}}},
+        {{"x_num_col_dims", 1}, {"y_num_col_dims", 1}}, block);
+  // mul_out has no range, so this mul stays in float.
+  AddOp("mul", {{"X", {"mul_out"}}, {"Y", {"w"}}}, {{"Out", {"out"}}},
+        {{"x_num_col_dims", 1}, {"y_num_col_dims", 1}}, block);
+
+  ASSERT_EQ(f::QuantizableInputs(program),
+            std::vector<std::string>({"x", "conv_out", "mul_out"}));
+
+  f::Int8QuantizePass pass({{"x", 2.0f}, {"conv_out", 4.0f}});
+  EXPECT_EQ(pass.Apply(&program, &scope, p::CPUPlace()), 3);
+
+  std::vector<std::string> types;
+  for (auto *op : block->AllOps()) {
+    types.push_back(op->Type());
+  }
+  ASSERT_EQ(types, std::vector<std::string>(
+                       {"quantize", "quantized_conv2d", "quantize",
+                        "quantized_fc", "quantized_fc", "mul"}));
+
+  auto *quantize = block->Op(0);
+  EXPECT_EQ(quantize->Input("X"), std::vector<std::string>({"x"}));
+  EXPECT_EQ(quantize->Output("Out"), std::vector<std::string>({"x@INT8"}));
+  EXPECT_FLOAT_EQ(boost::get<float>(quantize->GetAttr("scale")), 63.5f);
+
+  auto *conv = block->Op(1);
+  EXPECT_EQ(conv->Input("Input"), std::vector<std::string>({"x@INT8"}));
+  EXPECT_EQ(conv->Input("Filter"),
+            std::vector<std::string>({"filter@INT8"}));
+  EXPECT_EQ(boost::get<std::vector<float>>(conv->GetAttr("weight_scale")),
+            std::vector<float>({127.0f, 254.0f}));
+
+  auto *mul = block->Op(4);
+  EXPECT_EQ(mul->Input("Input"),
+            std::vector<std::string>({"conv_out@INT8"}));
+  EXPECT_EQ(mul->Input("W"), std::vector<std::string>({"w@INT8"}));
+  EXPECT_EQ(mul->Output("Out"), std::vector<std::string>({"mul_out"}));
+  EXPECT_FLOAT_EQ(boost::get<float>(mul->GetAttr("input_scale")), 31.75f);
+  EXPECT_EQ(block->Op(5)->Input("Y"), std::vector<std::string>({"w"}));
+
+  // The fc weight is transposed to [N, K], each row with its own scale.
+  auto &w = scope.FindVar("w@INT8")->Get<f::LoDTensor>();
+  EXPECT_EQ(w.dims(), f::make_ddim({3, 2}));
+  const int8_t *w_data = w.data<int8_t>();
+  EXPECT_EQ(w_data[0], 32);  // 1 * 127 / 4
+  EXPECT_EQ(w_data[1], 127);
+  EXPECT_EQ(w_data[2], 51);  // 2 * 127 / 5
+  EXPECT_EQ(w_data[3], 127);
+  auto scales = boost::get<std::vector<float>>(mul->GetAttr("weight_scale"));
+  ASSERT_EQ(scales.size(), 3UL);
+  EXPECT_FLOAT_EQ(scales[0], 127.0f / 4);
+  EXPECT_FLOAT_EQ(scales[2], 127.0f / 6);
+}
@@ -25,6 +25,7 @@ enum class LibraryType {
   kPlain = 0,
   kMKLDNN = 1,
   kCUDNN = 2,
+  kWinograd = 3,
 };
 
 inline std::string LibraryTypeToString(const LibraryType& library_type) {
@@ -35,6 +36,8 @@ inline std::string LibraryTypeToString(const LibraryType& library_type) {
       return "MKLDNN";
     case LibraryType::kCUDNN:
       return "CUDNN";
+    case LibraryType::kWinograd:
+      return "WINOGRAD";
     default:
       PADDLE_THROW("unknown LibraryType %d", static_cast<int>(library_type));
   }
@@ -51,6 +54,8 @@ inline LibraryType StringToLibraryType(const char* ctype) {
     return LibraryType::kMKLDNN;
   } else if (s == std::string("CUDNN")) {
     return LibraryType::kCUDNN;
+  } else if (s == std::string("WINOGRAD")) {
+    return LibraryType::kWinograd;
     // To be compatible with register macro.
     // CPU, CUDA, PLAIN are same library type.
   } else if (s == std::string("CPU")) {
@@ -0,0 +1,132 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/op_cost.h"
+
+#include <sstream>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+const LoDTensor* FindTensor(const Scope& scope, const std::string& name) {
+  auto* var = scope.FindVar(name);
+  if (var == nullptr || !var->IsType<LoDTensor>()) {
+    return nullptr;
+  }
+  return &var->Get<LoDTensor>();
+}
+
+// The tensor of the only argument of `param`, or nullptr.
+const LoDTensor* SingleTensor(const VariableNameMap& args,
+                              const std::string& param, const Scope& scope) {
+  auto it = args.find(param);
+  if (it == args.end() || it->second.size() != 1) {
+    return nullptr;
+  }
+  return FindTensor(scope, it->second[0]);
+}
+
+template <typename T>
+T GetAttrOr(const OperatorBase& op, const std::string& name,
+            T default_value) {
+  auto it = op.Attrs().find(name);
+  if (it == op.Attrs().end()) {
+    return default_value;
+  }
+  return boost::get<T>(it->second);
+}
+
+int64_t Product(const DDim& dims, int begin, int end) {
+  return product(slice_ddim(dims, begin, end));
+}
+
+// A convolution computes a dot product of the size of one filter, i.e.
+// C / groups * KH * KW, per element of its output, or for transposed
+// convolutions per element of its input.
+double ConvFlops(const LoDTensor* per_element, const LoDTensor* filter) {
+  if (per_element == nullptr || filter == nullptr ||
+      filter->dims().size() == 0 || filter->dims()[0] == 0) {
+    return 0.0;
+  }
+  return 2.0 * per_element->numel() * (filter->numel() / filter->dims()[0]);
+}
+
+}  // namespace
+
+std::string OpInputShapes(const OperatorBase& op, const Scope& scope) {
+  std::ostringstream os;
+  const char* separator = "";
+  for (auto& kv : op.Inputs()) {
+    std::vector<const LoDTensor*> tensors;
+    for (auto& name : kv.second) {
+      auto* tensor = FindTensor(scope, name);
+      if (tensor != nullptr) {
+        tensors.push_back(tensor);
+      }
+    }
+    if (tensors.empty()) continue;
+    os << separator << kv.first << "=";
+    for (size_t i = 0; i < tensors.size(); ++i) {
+      os << (i == 0 ? "[" : ", [") << tensors[i]->dims() << "]";
+    }
+    separator = " ";
+  }
+  return os.str();
+}
+
+double EstimateOpFlops(const OperatorBase& op, const Scope& scope) {
+  auto& type = op.Type();
+  auto& inputs = op.Inputs();
+  auto& outputs = op.Outputs();
+  if (type == "mul") {
+    auto* y = SingleTensor(inputs, "Y", scope);
+    auto* out = SingleTensor(outputs, "Out", scope);
+    if (y == nullptr || out == nullptr) return 0.0;
+    int k_dims = GetAttrOr<int>(op, "y_num_col_dims", 1);
+    return 2.0 * out->numel() * Product(y->dims(), 0, k_dims);
+  } else if (type == "fc" || type == "quantized_fc") {
+    auto* input = SingleTensor(inputs, "Input", scope);
+    auto* out = SingleTensor(outputs, "Out", scope);
+    if (input == nullptr || out == nullptr) return 0.0;
+    int m_dims = GetAttrOr<int>(op, "in_num_col_dims", 1);
+    return 2.0 * out->numel() *
+           Product(input->dims(), m_dims, input->dims().size());
+  } else if (type == "matmul") {
+    auto* x = SingleTensor(inputs, "X", scope);
+    auto* out = SingleTensor(outputs, "Out", scope);
+    if (x == nullptr || out == nullptr || x->dims().size() == 0) return 0.0;
+    int rank = x->dims().size();
+    int64_t k = x->dims()[rank - 1];
+    if (rank > 1 && GetAttrOr<bool>(op, "transpose_X", false)) {
+      k = x->dims()[rank - 2];
+    }
+    return 2.0 * out->numel() * k;
+  } else if (type == "conv2d" || type == "conv3d" ||
+             type == "depthwise_conv2d" || type == "conv2d_fusion" ||
+             type == "quantized_conv2d") {
+    return ConvFlops(SingleTensor(outputs, "Output", scope),
+                     SingleTensor(inputs, "Filter", scope));
+  } else if (type == "conv2d_transpose" || type == "conv3d_transpose") {
+    return ConvFlops(SingleTensor(inputs, "Input", scope),
+                     SingleTensor(inputs, "Filter", scope));
+  }
+  return 0.0;
+}
+
+}  // namespace framework
+}  // namespace paddle
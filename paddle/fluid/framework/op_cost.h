@@ -0,0 +1,35 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace framework {
+
+// The shapes of the LoDTensor inputs of `op` in `scope`, recorded by the
+// profiler as the detail of an operator event, e.g. "X=[32, 784] Y=[784, 10]".
+std::string OpInputShapes(const OperatorBase& op, const Scope& scope);
+
+// The floating point operations of one run of `op`, counting a multiply-add
+// as 2. It must be called after the run since the output shapes are used.
+// Only the gemm and convolution operators are estimated, others return 0.
+double EstimateOpFlops(const OperatorBase& op, const Scope& scope);
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,72 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/op_cost.h"
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace f = paddle::framework;
+
+class CostTestOp : public f::OperatorBase {
+ public:
+  DEFINE_OP_CLONE_METHOD(CostTestOp);
+  CostTestOp(const std::string &type, const f::VariableNameMap &inputs,
+             const f::VariableNameMap &outputs, const f::AttributeMap &attrs)
+      : OperatorBase(type, inputs, outputs, attrs) {}
+
+ private:
+  void RunImpl(const f::Scope &scope,
+               const paddle::platform::Place &place) const override {}
+};
+
+void SetDims(f::Scope *scope, const std::string &name,
+             const std::vector<int64_t> &dims) {
+  scope->Var(name)->GetMutable<f::LoDTensor>()->Resize(f::make_ddim(dims));
+}
+
+TEST(OpCost, gemm) {
+  f::Scope scope;
+  SetDims(&scope, "x", {8, 2, 3});
+  SetDims(&scope, "y", {6, 4});
+  SetDims(&scope, "out", {8, 4});
+
+  CostTestOp mul("mul", {{"X", {"x"}}, {"Y", {"y"}}}, {{"Out", {"out"}}},
+                 {{"x_num_col_dims", 1}, {"y_num_col_dims", 1}});
+  EXPECT_EQ(f::OpInputShapes(mul, scope), "X=[8, 2, 3] Y=[6, 4]");
+  EXPECT_DOUBLE_EQ(f::EstimateOpFlops(mul, scope), 2.0 * 8 * 4 * 6);
+
+  CostTestOp fc("fc", {{"Input", {"x"}}, {"W", {"y"}}}, {{"Out", {"out"}}},
+                {{"in_num_col_dims", 1}});
+  EXPECT_DOUBLE_EQ(f::EstimateOpFlops(fc, scope), 2.0 * 8 * 4 * 6);
+}
+
+TEST(OpCost, conv) {
+  f::Scope scope;
+  SetDims(&scope, "input", {2, 3, 8, 8});
+  SetDims(&scope, "filter", {16, 3, 3, 3});
+  SetDims(&scope, "output", {2, 16, 6, 6});
+
+  CostTestOp conv("conv2d", {{"Input", {"input"}}, {"Filter", {"filter"}}},
+                  {{"Output", {"output"}}}, f::AttributeMap{});
+  EXPECT_DOUBLE_EQ(f::EstimateOpFlops(conv, scope),
+                   2.0 * (2 * 16 * 6 * 6) * (3 * 3 * 3));
+
+  // Operators other than gemm and convolution are not estimated, and
+  // variables which are not in the scope are left out of the shapes.
+  CostTestOp sum("sum", {{"X", {"input", "missing", "input"}}},
+                 {{"Out", {"output"}}}, f::AttributeMap{});
+  EXPECT_EQ(f::OpInputShapes(sum, scope), "X=[2, 3, 8, 8], [2, 3, 8, 8]");
+  EXPECT_EQ(f::EstimateOpFlops(sum, scope), 0.0);
+}
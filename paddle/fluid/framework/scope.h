@@ -57,10 +57,15 @@ class Scope {
 
   const Scope& parent() const { return *parent_; }
 
+  /// Set the parent of a scope created by the default constructor, e.g. the
+  /// step scope an operator keeps across runs whose parent scope changes at
+  /// every run. The scope is no kid of its parent, which never deletes it.
+  void SetParent(const Scope* parent) { parent_ = parent; }
+
   /// Find the scope or an ancestor scope that contains the given variable.
   const Scope* FindScope(const Variable* var) const;
 
-  void DeleteScope(Scope* scope);
+  void DeleteScope(Scope* scope) const;
 
   /// Drop all kids scopes belonged to this scope.
   void DropKids();
@@ -98,6 +98,19 @@ class Tensor {
   /*! The internal of two tensors share the same memory block. */
   inline Tensor& ShareDataWith(const Tensor& src);
 
+  /**
+   * @brief   Refer to an external CPU memory block without copying it, e.g.
+   *          a parameter in a memory-mapped model file.
+   *
+   * @param[in] ptr     The beginning of the memory block.
+   * @param[in] size    The size of the memory block in bytes.
+   * @param[in] type    The type of the elements in the memory block.
+   * @param[in] owner   Keeps the memory block alive as long as a tensor
+   *                    refers to it, the tensor never frees `ptr` itself.
+   */
+  inline void ShareExternalData(void* ptr, size_t size, std::type_index type,
+                                std::shared_ptr<void> owner);
+
   /**
    * @brief  Return a sub-tensor of the given tensor.
    *
@@ -178,6 +191,35 @@ class Tensor {
     std::type_index type_;
   };
 
+  struct ExternalPlaceholder : public Placeholder {
+    ExternalPlaceholder(void* ptr, size_t size, std::type_index type,
+                        std::shared_ptr<void> owner)
+        : ptr_(ptr),
+          owner_(std::move(owner)),
+          place_(platform::CPUPlace()),
+          size_(size),
+          type_(type) {}
+
+    virtual size_t size() const { return size_; }
+    virtual platform::Place place() const { return place_; }
+    virtual void* ptr() const { return ptr_; }
+    virtual std::type_index type() const { return type_; }
+    virtual void set_type(std::type_index type) { type_ = type; }
+    virtual void set_place(platform::Place place) { place_ = place; }
+
+    /*! the pointer of the external memory block, not owned. */
+    void* ptr_;
+
+    /*! keeps the external memory block alive. */
+    std::shared_ptr<void> owner_;
+
+    platform::Place place_;
+
+    size_t size_;
+
+    std::type_index type_;
+  };
+
   /*! holds the memory block if allocated. */
   std::shared_ptr<Placeholder> holder_;
 
@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 #include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/platform/enforce.h"
+#include "paddle/math/float16.h"
 
 namespace paddle {
 namespace framework {
@@ -52,7 +53,9 @@ struct SizeOfTypeFunctor<HEAD, TAIL...> {
 };
 
 static inline size_t SizeOfType(std::type_index type) {
-  SizeOfTypeFunctor<int, float, double, int16_t, int64_t, bool, size_t> functor;
+  SizeOfTypeFunctor<int, float, double, int16_t, int64_t, bool, size_t,
+                    int8_t, float16>
+      functor;
   size_t size = functor(type);
   PADDLE_ENFORCE(size != 0UL, "Cannot get size of type %s", type.name());
   return size;
@@ -99,14 +102,18 @@ inline T* Tensor::data() {
 
 template <typename T>
 inline T* Tensor::mutable_data(DDim dims, platform::Place place) {
-  static_assert(std::is_pod<T>::value, "T must be POD");
+  static_assert(std::is_pod<T>::value || std::is_same<T, float16>::value,
+                "T must be POD");
   Resize(dims);
   return mutable_data<T>(place);
 }
 
 template <typename T>
 inline T* Tensor::mutable_data(platform::Place place) {
-  static_assert(std::is_pod<T>::value, "T must be POD");
+  // float16 is not POD because of its user-provided constructors, but it
+  // is a plain 16-bit value and can live in uninitialized memory.
+  static_assert(std::is_pod<T>::value || std::is_same<T, float16>::value,
+                "T must be POD");
   return reinterpret_cast<T*>(mutable_data(place, typeid(T)));
 }
 
@@ -152,6 +159,14 @@ inline Tensor& Tensor::ShareDataWith(const Tensor& src) {
   return *this;
 }
 
+inline void Tensor::ShareExternalData(void* ptr, size_t size,
+                                      std::type_index type,
+                                      std::shared_ptr<void> owner) {
+  PADDLE_ENFORCE_NOT_NULL(ptr, "Cannot share a null memory block.");
+  holder_.reset(new ExternalPlaceholder(ptr, size, type, std::move(owner)));
+  offset_ = 0;
+}
+
 inline Tensor Tensor::Slice(int begin_idx, int end_idx) const {
   check_memory_size();
   PADDLE_ENFORCE_GE(begin_idx, 0,
@@ -142,6 +142,28 @@ TEST(Tensor, ShareDataWith) {
 #endif
 }
 
+TEST(Tensor, ShareExternalData) {
+  std::shared_ptr<float> buf(new float[6], std::default_delete<float[]>());
+  std::weak_ptr<float> weak_buf = buf;
+  {
+    framework::Tensor tensor;
+    tensor.Resize(framework::make_ddim({2, 3}));
+    tensor.ShareExternalData(buf.get(), 6 * sizeof(float), typeid(float), buf);
+    buf.reset();
+    ASSERT_FALSE(weak_buf.expired());
+    EXPECT_TRUE(platform::is_cpu_place(tensor.place()));
+
+    // mutable_data reuses the external memory while it is large enough.
+    float* p1 = tensor.data<float>();
+    float* p2 = tensor.mutable_data<float>(platform::CPUPlace());
+    EXPECT_EQ(p1, p2);
+    framework::Tensor slice = tensor.Slice(1, 2);
+    EXPECT_EQ(slice.data<float>(), p1 + 3);
+  }
+  // The owner is released with the last tensor referring to the memory.
+  EXPECT_TRUE(weak_buf.expired());
+}
+
 TEST(Tensor, Slice) {
   {
     framework::Tensor src_tensor;
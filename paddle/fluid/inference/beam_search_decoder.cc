@@ -0,0 +1,311 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/beam_search_decoder.h"
+
+#include <algorithm>
+#include <memory>
+#include "paddle/fluid/framework/feed_fetch_type.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/operators/beam_search_op.h"
+
+namespace paddle {
+namespace inference {
+
+namespace {
+
+double ElapsedMs(std::chrono::steady_clock::time_point from,
+                 std::chrono::steady_clock::time_point to) {
+  return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+// Makes the variable `name` of `scope` share the data of `value`.
+void SetInput(framework::Scope* scope, const std::string& name,
+              const framework::LoDTensor& value) {
+  auto* tensor = scope->Var(name)->GetMutable<framework::LoDTensor>();
+  tensor->ShareDataWith(value);
+  tensor->set_lod(value.lod());
+}
+
+// The step program without its feed and fetch operators, and its prepared
+// operators.
+struct PreparedStepProgram {
+  explicit PreparedStepProgram(const framework::ProgramDesc& desc)
+      : program(desc) {
+    auto* block = program.MutableBlock(0);
+    for (size_t i = block->OpSize(); i > 0; --i) {
+      auto& type = block->Op(i - 1)->Type();
+      if (type == framework::kFeedOpType || type == framework::kFetchOpType) {
+        block->RemoveOp(i - 1, i);
+      }
+    }
+    ctx = framework::Executor::Prepare(program, 0);
+  }
+
+  framework::ProgramDesc program;
+  std::unique_ptr<framework::ExecutorPrepareContext> ctx;
+};
+
+// Copies the variable `name` of `scope`, which the next step overwrites.
+void GetOutput(const framework::Scope& scope, const std::string& name,
+               framework::LoDTensor* value) {
+  auto* var = scope.FindVar(name);
+  PADDLE_ENFORCE_NOT_NULL(var, "The step program has no variable %s", name);
+  auto& tensor = var->Get<framework::LoDTensor>();
+  framework::Copy(tensor, platform::CPUPlace(), value);
+  value->set_lod(tensor.lod());
+}
+
+}  // namespace
+
+BeamSearchStep ProgramBeamSearchStep(framework::Executor* executor,
+                                     framework::Scope* scope,
+                                     const framework::ProgramDesc* program,
+                                     const BeamSearchStepNames& names) {
+  // The step block is prepared once. The inputs and outputs are read and
+  // written in the scope directly, so every step only runs the operators.
+  auto prepared = std::make_shared<PreparedStepProgram>(*program);
+
+  return [=](const framework::LoDTensor& pre_ids,
+             const framework::LoDTensor& pre_scores,
+             std::vector<framework::LoDTensor>* states,
+             framework::LoDTensor* ids, framework::LoDTensor* scores) {
+    PADDLE_ENFORCE_EQ(states->size(), names.states.size(),
+                      "The step program has %d states",
+                      names.states.size());
+    SetInput(scope, names.pre_ids, pre_ids);
+    SetInput(scope, names.pre_scores, pre_scores);
+    for (size_t i = 0; i < names.states.size(); ++i) {
+      SetInput(scope, names.states[i].first, (*states)[i]);
+    }
+    // The variables stay in `scope`, so that their buffers are reused by
+    // the next steps.
+    executor->RunPreparedContext(prepared->ctx.get(), scope, false, true);
+    GetOutput(*scope, names.ids, ids);
+    GetOutput(*scope, names.scores, scores);
+    for (size_t i = 0; i < names.states.size(); ++i) {
+      // A state the step only reads keeps its value.
+      if (names.states[i].first != names.states[i].second) {
+        GetOutput(*scope, names.states[i].second, &(*states)[i]);
+      }
+    }
+  };
+}
+
+ContinuousBeamSearchDecoder::ContinuousBeamSearchDecoder(
+    const Options& options, BeamSearchStep step)
+    : options_(options), step_(std::move(step)) {
+  PADDLE_ENFORCE_GT(options_.beam_size, 0UL);
+  PADDLE_ENFORCE_GT(options_.max_batch_size, 0UL);
+  PADDLE_ENFORCE_GT(options_.max_length, 0UL);
+  // BeamSearch drops the candidates of prefixes ending with end_id.
+  PADDLE_ENFORCE_NE(options_.start_id, options_.end_id,
+                    "start_id and end_id must differ");
+}
+
+int64_t ContinuousBeamSearchDecoder::Submit(
+    std::vector<std::vector<float>> init_states) {
+  Request request;
+  request.submit_time = Clock::now();
+  request.live.emplace_back();
+  request.live_scores.push_back(0.0f);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (state_widths_.empty() && next_id_ == 0) {
+    for (auto& state : init_states) {
+      state_widths_.push_back(static_cast<int64_t>(state.size()));
+    }
+  }
+  PADDLE_ENFORCE_EQ(init_states.size(), state_widths_.size(),
+                    "Every request must have %d states",
+                    state_widths_.size());
+  for (size_t i = 0; i < init_states.size(); ++i) {
+    PADDLE_ENFORCE_EQ(static_cast<int64_t>(init_states[i].size()),
+                      state_widths_[i], "State %d must have %d values", i,
+                      state_widths_[i]);
+  }
+  request.states = std::move(init_states);
+  request.id = next_id_++;
+  waiting_.push_back(std::move(request));
+  return waiting_.back().id;
+}
+
+size_t ContinuousBeamSearchDecoder::Step() {
+  size_t num_states;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (active_.size() < options_.max_batch_size && !waiting_.empty()) {
+      active_.push_back(std::move(waiting_.front()));
+      waiting_.pop_front();
+      active_.back().admit_time = Clock::now();
+    }
+    num_states = state_widths_.size();
+    if (active_.empty()) return 0;
+  }
+
+  // Batch the live prefixes of all the requests. The first LoD level of the
+  // candidates tells the prefixes of each request, the second the row of
+  // each prefix, as BeamSearch expects them.
+  size_t num_prefixes = 0;
+  framework::LoD lod(2);
+  lod[0].push_back(0);
+  for (auto& request : active_) {
+    num_prefixes += request.live.size();
+    lod[0].push_back(num_prefixes);
+  }
+  for (size_t i = 0; i <= num_prefixes; ++i) {
+    lod[1].push_back(i);
+  }
+
+  auto prefix_dims = framework::make_ddim(
+      {static_cast<int64_t>(num_prefixes), static_cast<int64_t>(1)});
+  framework::LoDTensor pre_ids, pre_scores;
+  auto* pre_ids_data =
+      pre_ids.mutable_data<int64_t>(prefix_dims, platform::CPUPlace());
+  auto* pre_scores_data =
+      pre_scores.mutable_data<float>(prefix_dims, platform::CPUPlace());
+  std::vector<framework::LoDTensor> states(num_states);
+  std::vector<int64_t> widths(num_states);
+  for (size_t s = 0; s < num_states; ++s) {
+    auto& first = active_.front();
+    widths[s] = first.states[s].size() / first.live.size();
+    float* data = states[s].mutable_data<float>(
+        framework::make_ddim({static_cast<int64_t>(num_prefixes), widths[s]}),
+        platform::CPUPlace());
+    for (auto& request : active_) {
+      data = std::copy(request.states[s].begin(), request.states[s].end(),
+                       data);
+    }
+  }
+  size_t row = 0;
+  for (auto& request : active_) {
+    for (size_t p = 0; p < request.live.size(); ++p, ++row) {
+      pre_ids_data[row] = request.live[p].empty() ? options_.start_id
+                                                  : request.live[p].back();
+      pre_scores_data[row] = request.live_scores[p];
+    }
+  }
+  pre_ids.set_lod(lod);
+  pre_scores.set_lod(lod);
+
+  framework::LoDTensor ids, scores;
+  step_(pre_ids, pre_scores, &states, &ids, &scores);
+  PADDLE_ENFORCE_EQ(ids.dims().size(), 2, "ids must be [prefixes, K]");
+  PADDLE_ENFORCE_EQ(ids.dims()[0], static_cast<int64_t>(num_prefixes),
+                    "The step must return one row of ids per prefix");
+  PADDLE_ENFORCE_GE(ids.dims()[1], static_cast<int64_t>(options_.beam_size),
+                    "The step must return at least beam_size candidates");
+  PADDLE_ENFORCE_EQ(scores.dims(), ids.dims());
+  for (size_t s = 0; s < num_states; ++s) {
+    PADDLE_ENFORCE_EQ(states[s].dims()[0], static_cast<int64_t>(num_prefixes),
+                      "The step must return one row of state %d per prefix",
+                      s);
+    widths[s] = states[s].numel() / num_prefixes;
+  }
+  ids.set_lod(lod);
+  scores.set_lod(lod);
+
+  framework::LoDTensor selected_ids, selected_scores;
+  operators::BeamSearch beam_search(ids, scores, 0, options_.beam_size,
+                                    static_cast<int>(options_.end_id));
+  beam_search(pre_ids, &selected_ids, &selected_scores);
+  // The candidates selected for prefix p are the rows
+  // [children[p], children[p + 1]).
+  auto& children = selected_ids.lod()[1];
+  const int64_t* selected_ids_data = selected_ids.data<int64_t>();
+  const float* selected_scores_data = selected_scores.data<float>();
+
+  std::vector<Result> results;
+  size_t prefix = 0;
+  size_t kept = 0;
+  for (size_t r = 0; r < active_.size(); ++r) {
+    auto& request = active_[r];
+    std::vector<std::vector<int64_t>> live;
+    std::vector<float> live_scores;
+    std::vector<std::vector<float>> request_states(num_states);
+    for (size_t p = 0; p < request.live.size(); ++p, ++prefix) {
+      for (size_t c = children[prefix]; c < children[prefix + 1]; ++c) {
+        auto hypothesis = request.live[p];
+        hypothesis.push_back(selected_ids_data[c]);
+        if (selected_ids_data[c] == options_.end_id) {
+          request.ended.push_back(std::move(hypothesis));
+          request.ended_scores.push_back(selected_scores_data[c]);
+          continue;
+        }
+        live.push_back(std::move(hypothesis));
+        live_scores.push_back(selected_scores_data[c]);
+        for (size_t s = 0; s < num_states; ++s) {
+          const float* state = states[s].data<float>() + prefix * widths[s];
+          request_states[s].insert(request_states[s].end(), state,
+                                   state + widths[s]);
+        }
+      }
+    }
+    request.live = std::move(live);
+    request.live_scores = std::move(live_scores);
+    request.states = std::move(request_states);
+    ++request.steps;
+
+    Result result;
+    if (Finish(request, &result)) {
+      results.push_back(std::move(result));
+    } else if (kept++ != r) {
+      active_[kept - 1] = std::move(request);
+    }
+  }
+  active_.resize(kept);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  finished_.insert(finished_.end(), std::make_move_iterator(results.begin()),
+                   std::make_move_iterator(results.end()));
+  return active_.size() + waiting_.size();
+}
+
+bool ContinuousBeamSearchDecoder::Finish(const Request& request,
+                                         Result* result) const {
+  auto best_live =
+      std::max_element(request.live_scores.begin(), request.live_scores.end());
+  auto best_ended = std::max_element(request.ended_scores.begin(),
+                                     request.ended_scores.end());
+  bool has_live = best_live != request.live_scores.end();
+  bool has_ended = best_ended != request.ended_scores.end();
+  if (has_live && request.steps < options_.max_length &&
+      (!has_ended || *best_ended < *best_live)) {
+    return false;
+  }
+
+  result->request_id = request.id;
+  if (has_ended && (!has_live || *best_ended >= *best_live)) {
+    result->ids = request.ended[best_ended - request.ended_scores.begin()];
+    result->score = *best_ended;
+  } else {
+    result->ids = request.live[best_live - request.live_scores.begin()];
+    result->score = *best_live;
+  }
+  auto now = Clock::now();
+  result->queue_ms = ElapsedMs(request.submit_time, request.admit_time);
+  result->latency_ms = ElapsedMs(request.submit_time, now);
+  return true;
+}
+
+std::vector<ContinuousBeamSearchDecoder::Result>
+ContinuousBeamSearchDecoder::TakeFinished() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<Result> results;
+  results.swap(finished_);
+  return results;
+}
+
+}  // namespace inference
+}  // namespace paddle
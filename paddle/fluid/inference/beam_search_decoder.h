@@ -0,0 +1,152 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace inference {
+
+// Computes the candidates of one decoding step for a batch of prefixes. All
+// the tensors have one row per live prefix: `pre_ids` [P, 1] int64 holds the
+// last token of each prefix, `pre_scores` [P, 1] float its accumulated score
+// and `states` one [P, D] float tensor per decoder state. The step writes
+// the K best next tokens of each prefix into `ids` [P, K] int64, their
+// accumulated scores into `scores` [P, K] float, and replaces every state by
+// its next value, still one row per prefix.
+using BeamSearchStep = std::function<void(
+    const framework::LoDTensor& pre_ids, const framework::LoDTensor& pre_scores,
+    std::vector<framework::LoDTensor>* states, framework::LoDTensor* ids,
+    framework::LoDTensor* scores)>;
+
+// The variables of a step program.
+struct BeamSearchStepNames {
+  std::string pre_ids = "pre_ids";
+  std::string pre_scores = "pre_scores";
+  std::string ids = "ids";
+  std::string scores = "scores";
+  // For each state, the variable fed with its value and the variable
+  // fetched as its next value. Both can be the same variable for a state
+  // the step only reads, e.g. an encoder context vector.
+  std::vector<std::pair<std::string, std::string>> states;
+};
+
+// A BeamSearchStep running one step of a decoder `program`, usually the step
+// block of a while loop saved as an inference program, whose parameters are
+// in `scope`. The global block of the program is prepared once, without its
+// feed and fetch operators; each step sets the inputs and reads the outputs
+// in `scope` directly, where the other variables are kept across steps. The
+// executor and scope must outlive the step.
+BeamSearchStep ProgramBeamSearchStep(framework::Executor* executor,
+                                     framework::Scope* scope,
+                                     const framework::ProgramDesc* program,
+                                     const BeamSearchStepNames& names);
+
+/*
+ * A beam search decoding engine with continuous batching. Instead of
+ * decoding a fixed batch until its longest sequence ends, every Step()
+ * first admits waiting requests into the slots freed by finished ones, then
+ * runs the step on the live prefixes of all the admitted requests at once
+ * and selects the next beams with the BeamSearch of beam_search_op. The
+ * finished hypotheses and the finished requests are removed right away, so
+ * the batch of the next step only holds live beams.
+ *
+ * Scores are accumulated log probabilities, which can only decrease: a
+ * request finishes when its best ended hypothesis scores at least as well as
+ * its best live prefix, when it has no live prefix left, or after
+ * `max_length` steps.
+ *
+ * Submit and TakeFinished may be called from any thread, Step from one
+ * decoding thread only.
+ */
+class ContinuousBeamSearchDecoder {
+ public:
+  struct Options {
+    size_t beam_size = 4;
+    // The largest number of requests decoded together.
+    size_t max_batch_size = 32;
+    size_t max_length = 100;
+    int64_t start_id = 0;
+    int64_t end_id = 1;
+  };
+
+  struct Result {
+    int64_t request_id;
+    // The best hypothesis without the start token, ending with end_id
+    // unless it reached max_length.
+    std::vector<int64_t> ids;
+    float score;
+    // The time waiting for a free slot and the time from Submit to the
+    // end of decoding, in milliseconds.
+    double queue_ms;
+    double latency_ms;
+  };
+
+  ContinuousBeamSearchDecoder(const Options& options, BeamSearchStep step);
+
+  // Queues a request whose decoder states start at `init_states`, one
+  // vector per state, and returns its id.
+  int64_t Submit(std::vector<std::vector<float>> init_states);
+
+  // Runs one decoding step, returns the number of requests being decoded
+  // or waiting after it.
+  size_t Step();
+
+  // Returns the requests finished since the last call.
+  std::vector<Result> TakeFinished();
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Request {
+    int64_t id;
+    Clock::time_point submit_time;
+    Clock::time_point admit_time;
+    // The states of each live prefix, prefix-major: states[s] holds
+    // live.size() rows of the width of state s.
+    std::vector<std::vector<float>> states;
+    std::vector<std::vector<int64_t>> live;
+    std::vector<float> live_scores;
+    std::vector<std::vector<int64_t>> ended;
+    std::vector<float> ended_scores;
+    size_t steps = 0;
+  };
+
+  // Whether `request` is done after a step, and if so its result.
+  bool Finish(const Request& request, Result* result) const;
+
+  Options options_;
+  BeamSearchStep step_;
+  std::vector<int64_t> state_widths_;
+  std::vector<Request> active_;
+
+  std::mutex mutex_;
+  int64_t next_id_ = 0;
+  std::deque<Request> waiting_;
+  std::vector<Result> finished_;
+};
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,180 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/beam_search_decoder.h"
+
+#include <map>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/op_desc.h"
+
+namespace f = paddle::framework;
+namespace p = paddle::platform;
+using paddle::inference::ContinuousBeamSearchDecoder;
+
+const int64_t kEndId = 100;
+
+// A decoder whose state is the number of tokens left before the end. While
+// some are left, it proposes the next integer with a cost of 0.1 and the
+// end with a cost of 1, then the end with a cost of 0.1. The best sequence
+// of a request starting at n is 1, 2, ..., n, end.
+void CountDownStep(const f::LoDTensor &pre_ids, const f::LoDTensor &pre_scores,
+                   std::vector<f::LoDTensor> *states, f::LoDTensor *ids,
+                   f::LoDTensor *scores, std::vector<int64_t> *batch_sizes) {
+  int64_t rows = pre_ids.dims()[0];
+  batch_sizes->push_back(rows);
+  auto dims = f::make_ddim({rows, 2});
+  int64_t *ids_data = ids->mutable_data<int64_t>(dims, p::CPUPlace());
+  float *scores_data = scores->mutable_data<float>(dims, p::CPUPlace());
+  float *left = (*states)[0].data<float>();
+  for (int64_t i = 0; i < rows; ++i) {
+    int64_t next = pre_ids.data<int64_t>()[i] + 1;
+    float score = pre_scores.data<float>()[i];
+    bool done = left[i] <= 0.0f;
+    ids_data[2 * i] = done ? kEndId : next;
+    ids_data[2 * i + 1] = done ? next : kEndId;
+    scores_data[2 * i] = score - 0.1f;
+    scores_data[2 * i + 1] = score - 1.0f;
+    left[i] -= 1.0f;
+  }
+}
+
+TEST(ContinuousBeamSearchDecoder, admits_into_free_slots) {
+  ContinuousBeamSearchDecoder::Options options;
+  options.beam_size = 2;
+  options.max_batch_size = 2;
+  options.start_id = 0;
+  options.end_id = kEndId;
+  std::vector<int64_t> batch_sizes;
+  ContinuousBeamSearchDecoder decoder(
+      options, [&](const f::LoDTensor &pre_ids, const f::LoDTensor &pre_scores,
+                   std::vector<f::LoDTensor> *states, f::LoDTensor *ids,
+                   f::LoDTensor *scores) {
+        CountDownStep(pre_ids, pre_scores, states, ids, scores, &batch_sizes);
+      });
+
+  int64_t a = decoder.Submit({{1.0f}});
+  int64_t b = decoder.Submit({{4.0f}});
+  int64_t c = decoder.Submit({{2.0f}});
+
+  std::map<int64_t, ContinuousBeamSearchDecoder::Result> results;
+  int steps = 0;
+  while (decoder.Step() > 0) {
+    ++steps;
+    for (auto &result : decoder.TakeFinished()) {
+      results[result.request_id] = result;
+    }
+  }
+  for (auto &result : decoder.TakeFinished()) {
+    results[result.request_id] = result;
+  }
+
+  ASSERT_EQ(results.size(), 3UL);
+  EXPECT_EQ(results[a].ids, std::vector<int64_t>({1, kEndId}));
+  EXPECT_EQ(results[b].ids, std::vector<int64_t>({1, 2, 3, 4, kEndId}));
+  EXPECT_EQ(results[c].ids, std::vector<int64_t>({1, 2, kEndId}));
+  EXPECT_NEAR(results[b].score, -0.5f, 1e-5);
+  EXPECT_GE(results[c].latency_ms, results[c].queue_ms);
+
+  // c takes the slot a frees after the second step, and ends together with
+  // b after 5 steps instead of 8 if it waited for b to end. The ended
+  // hypotheses leave the batch, so each request has one live prefix.
+  EXPECT_EQ(steps + 1, 5);
+  EXPECT_EQ(batch_sizes, std::vector<int64_t>(5, 2));
+}
+
+void AddOp(const std::string &type, const f::VariableNameMap &inputs,
+           const f::VariableNameMap &outputs, f::AttributeMap attrs,
+           f::BlockDesc *block) {
+  for (auto &kv : outputs) {
+    for (auto &v : kv.second) {
+      block->Var(v)->SetType(f::proto::VarDesc::LOD_TENSOR);
+    }
+  }
+  auto op = block->AppendOp();
+  op->SetType(type);
+  for (auto &kv : inputs) {
+    op->SetInput(kv.first, kv.second);
+  }
+  for (auto &kv : outputs) {
+    op->SetOutput(kv.first, kv.second);
+  }
+  op->SetAttrMap(attrs);
+}
+
+TEST(ProgramBeamSearchStep, runs_prepared_step) {
+  // A saved step program: the candidates are the top 2 of h * W, and the
+  // next state is h / 2. The feed and fetch operators must be skipped.
+  f::ProgramDesc program;
+  f::BlockDesc *block = program.MutableBlock(0);
+  for (auto &name : {"pre_ids", "pre_scores", "h"}) {
+    block->Var(name)->SetType(f::proto::VarDesc::LOD_TENSOR);
+  }
+  auto *w_desc = block->Var("w");
+  w_desc->SetType(f::proto::VarDesc::LOD_TENSOR);
+  w_desc->SetPersistable(true);
+  AddOp("feed", {{"X", {"feed"}}}, {{"Out", {"h"}}}, {{"col", 0}}, block);
+  AddOp("mul", {{"X", {"h"}}, {"Y", {"w"}}}, {{"Out", {"logits"}}},
+        {{"x_num_col_dims", 1}, {"y_num_col_dims", 1}}, block);
+  AddOp("top_k", {{"X", {"logits"}}},
+        {{"Out", {"scores"}}, {"Indices", {"ids"}}}, {{"k", 2}}, block);
+  AddOp("scale", {{"X", {"h"}}}, {{"Out", {"h_next"}}}, {{"scale", 0.5f}},
+        block);
+  AddOp("fetch", {{"X", {"ids"}}}, {{"Out", {"fetch"}}}, {{"col", 0}}, block);
+
+  f::Scope scope;
+  auto *w = scope.Var("w")->GetMutable<f::LoDTensor>();
+  float *w_data = w->mutable_data<float>(f::make_ddim({3, 3}), p::CPUPlace());
+  std::fill(w_data, w_data + 9, 0.0f);
+  w_data[0] = 1.0f;
+  w_data[4] = 2.0f;
+  w_data[8] = 3.0f;
+
+  f::Executor executor(p::CPUPlace());
+  paddle::inference::BeamSearchStepNames names;
+  names.states.emplace_back("h", "h_next");
+  auto step =
+      paddle::inference::ProgramBeamSearchStep(&executor, &scope, &program,
+                                               names);
+
+  f::LoDTensor pre_ids, pre_scores, ids, scores;
+  auto prefix_dims = f::make_ddim({2, 1});
+  std::fill_n(pre_ids.mutable_data<int64_t>(prefix_dims, p::CPUPlace()), 2, 0);
+  std::fill_n(pre_scores.mutable_data<float>(prefix_dims, p::CPUPlace()), 2,
+              0.0f);
+  std::vector<f::LoDTensor> states(1);
+  float *h = states[0].mutable_data<float>(f::make_ddim({2, 3}),
+                                           p::CPUPlace());
+  const float h0[] = {1.0f, 2.0f, 3.0f, 3.0f, 1.0f, 0.0f};
+  std::copy(h0, h0 + 6, h);
+
+  // h * W is {1, 4, 9} and {3, 2, 0}, halved at every step.
+  for (int i = 0; i < 3; ++i) {
+    step(pre_ids, pre_scores, &states, &ids, &scores);
+    float factor = 1.0f / (1 << i);
+    ASSERT_EQ(ids.dims(), f::make_ddim({2, 2}));
+    ASSERT_EQ(scores.dims(), f::make_ddim({2, 2}));
+    EXPECT_EQ(std::vector<int64_t>(ids.data<int64_t>(),
+                                   ids.data<int64_t>() + 4),
+              std::vector<int64_t>({2, 1, 0, 1}));
+    const float expected_scores[] = {9.0f, 4.0f, 3.0f, 2.0f};
+    for (int j = 0; j < 4; ++j) {
+      EXPECT_FLOAT_EQ(scores.data<float>()[j], expected_scores[j] * factor);
+    }
+    ASSERT_EQ(states[0].dims(), f::make_ddim({2, 3}));
+    for (int j = 0; j < 6; ++j) {
+      EXPECT_FLOAT_EQ(states[0].data<float>()[j], h0[j] * factor / 2);
+    }
+  }
+}
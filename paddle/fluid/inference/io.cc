@@ -14,9 +14,17 @@ limitations under the License. */
 
 #include "paddle/fluid/inference/io.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <fstream>
+#include <limits>
 #include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
+#include "paddle/fluid/framework/tensor_util.h"
 
 namespace paddle {
 namespace inference {
@@ -135,5 +143,220 @@ std::unique_ptr<framework::ProgramDesc> Load(
   return main_program;
 }
 
+// "PDMAPPED" in little endian
+constexpr uint64_t kMappedModelMagic = 0x44455050414d4450ULL;
+constexpr uint32_t kMappedModelVersion = 0;
+
+template <typename T>
+static void AppendPOD(std::string* buf, const T& value) {
+  buf->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static size_t AlignUp(size_t offset) {
+  return (offset + kMappedModelAlignment - 1) / kMappedModelAlignment *
+         kMappedModelAlignment;
+}
+
+// The layout of a mapped model file, all integers in host byte order:
+//   uint64_t magic, uint32_t version, uint32_t alignment
+//   uint64_t program_size, uint64_t param_num
+//   program_size bytes of serialized ProgramDesc
+//   param_num index entries:
+//     uint32_t name_size, name_size bytes of name
+//     int32_t data_type, uint32_t rank, int64_t dims[rank]
+//     uint64_t offset, uint64_t size
+//   the data of each parameter at its aligned offset
+void SaveMapped(const framework::ProgramDesc& main_program,
+                const framework::Scope& scope,
+                const std::string& filename) {
+  framework::ProgramDesc program(main_program);
+  std::string program_desc_str = program.Proto()->SerializeAsString();
+
+  std::vector<std::string> paramlist;
+  for (auto* var : program.Block(0).AllVars()) {
+    if (IsParameter(var, program)) {
+      paramlist.push_back(var->Name());
+    }
+  }
+  std::sort(paramlist.begin(), paramlist.end());
+
+  std::vector<framework::LoDTensor> tensors(paramlist.size());
+  size_t index_size = 0;
+  for (size_t i = 0; i < paramlist.size(); ++i) {
+    auto* var = scope.FindVar(paramlist[i]);
+    PADDLE_ENFORCE_NOT_NULL(var, "Parameter %s is not in the scope",
+                            paramlist[i]);
+    auto& tensor = var->Get<framework::LoDTensor>();
+    if (platform::is_cpu_place(tensor.place())) {
+      tensors[i].ShareDataWith(tensor);
+    } else {
+      framework::Copy(tensor, platform::CPUPlace(), &tensors[i]);
+      platform::DeviceContextPool::Instance().Get(tensor.place())->Wait();
+    }
+    // name_size, name, data_type, rank, dims, offset and size
+    index_size += sizeof(uint32_t) + paramlist[i].size() + sizeof(int32_t) +
+                  sizeof(uint32_t) +
+                  tensors[i].dims().size() * sizeof(int64_t) +
+                  2 * sizeof(uint64_t);
+  }
+
+  std::string header;
+  AppendPOD(&header, kMappedModelMagic);
+  AppendPOD(&header, kMappedModelVersion);
+  AppendPOD(&header, static_cast<uint32_t>(kMappedModelAlignment));
+  AppendPOD(&header, static_cast<uint64_t>(program_desc_str.size()));
+  AppendPOD(&header, static_cast<uint64_t>(paramlist.size()));
+  header.append(program_desc_str);
+
+  size_t offset = AlignUp(header.size() + index_size);
+  std::vector<size_t> offsets;
+  for (size_t i = 0; i < paramlist.size(); ++i) {
+    auto& tensor = tensors[i];
+    auto dims = framework::vectorize(tensor.dims());
+    AppendPOD(&header, static_cast<uint32_t>(paramlist[i].size()));
+    header.append(paramlist[i]);
+    AppendPOD(&header,
+              static_cast<int32_t>(framework::ToDataType(tensor.type())));
+    AppendPOD(&header, static_cast<uint32_t>(dims.size()));
+    for (int64_t d : dims) {
+      AppendPOD(&header, d);
+    }
+    AppendPOD(&header, static_cast<uint64_t>(offset));
+    AppendPOD(&header, static_cast<uint64_t>(tensor.memory_size()));
+    offsets.push_back(offset);
+    offset = AlignUp(offset + tensor.memory_size());
+  }
+
+  std::ofstream fout(filename, std::ios::out | std::ios::binary);
+  PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write",
+                 filename);
+  fout.write(header.data(), header.size());
+  const std::string padding(kMappedModelAlignment, '\0');
+  size_t written = header.size();
+  for (size_t i = 0; i < paramlist.size(); ++i) {
+    fout.write(padding.data(), offsets[i] - written);
+    fout.write(static_cast<const char*>(tensors[i].data<void>()),
+               tensors[i].memory_size());
+    written = offsets[i] + tensors[i].memory_size();
+  }
+  fout.close();
+  PADDLE_ENFORCE(!fout.fail(), "Failed to write %s", filename);
+}
+
+// Bounds-checked reads from the header of a mapped model file.
+class MappedModelReader {
+ public:
+  MappedModelReader(const char* data, size_t size, const std::string& name)
+      : data_(data), size_(size), pos_(0), name_(name) {}
+
+  template <typename T>
+  T Read() {
+    T value;
+    memcpy(&value, Consume(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string ReadString(size_t size) {
+    return std::string(Consume(size), size);
+  }
+
+ private:
+  const char* Consume(size_t n) {
+    // pos_ <= size_ always holds, so this cannot overflow for a corrupt n.
+    PADDLE_ENFORCE_LE(n, size_ - pos_, "%s is truncated", name_);
+    const char* p = data_ + pos_;
+    pos_ += n;
+    return p;
+  }
+
+  const char* data_;
+  size_t size_;
+  size_t pos_;
+  const std::string& name_;
+};
+
+std::unique_ptr<framework::ProgramDesc> LoadMapped(
+    framework::Scope& scope,
+    const std::string& filename,
+    const platform::Place& place) {
+  VLOG(3) << "mapping model from " << filename;
+  int fd = open(filename.c_str(), O_RDONLY);
+  PADDLE_ENFORCE_GE(fd, 0, "Cannot open %s", filename);
+  struct stat st;
+  PADDLE_ENFORCE_EQ(fstat(fd, &st), 0, "Cannot stat %s", filename);
+  size_t file_size = static_cast<size_t>(st.st_size);
+  // A private writable mapping: pages come from the page cache and are
+  // shared with other processes, a parameter modified in place (e.g. by an
+  // inference pass) gets a private copy of its pages and the file is never
+  // written.
+  void* addr = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                    fd, 0);
+  close(fd);
+  PADDLE_ENFORCE(addr != MAP_FAILED, "Cannot mmap %s", filename);
+  std::shared_ptr<void> mapping(
+      addr, [file_size](void* p) { munmap(p, file_size); });
+  const char* base = static_cast<const char*>(addr);
+
+  MappedModelReader reader(base, file_size, filename);
+  PADDLE_ENFORCE_EQ(reader.Read<uint64_t>(), kMappedModelMagic,
+                    "%s is not a mapped model file", filename);
+  PADDLE_ENFORCE_EQ(reader.Read<uint32_t>(), kMappedModelVersion,
+                    "Only version 0 of mapped model file is supported");
+  PADDLE_ENFORCE_EQ(reader.Read<uint32_t>(),
+                    static_cast<uint32_t>(kMappedModelAlignment),
+                    "The alignment of %s mismatches", filename);
+  uint64_t program_size = reader.Read<uint64_t>();
+  uint64_t param_num = reader.Read<uint64_t>();
+
+  std::unique_ptr<framework::ProgramDesc> main_program(
+      new framework::ProgramDesc(reader.ReadString(program_size)));
+
+  for (uint64_t i = 0; i < param_num; ++i) {
+    std::string name = reader.ReadString(reader.Read<uint32_t>());
+    auto type = framework::ToTypeIndex(
+        static_cast<framework::proto::DataType>(reader.Read<int32_t>()));
+    std::vector<int64_t> dims(reader.Read<uint32_t>());
+    for (auto& d : dims) {
+      d = reader.Read<int64_t>();
+    }
+    uint64_t offset = reader.Read<uint64_t>();
+    uint64_t size = reader.Read<uint64_t>();
+    // Checked without forming offset + size, which a corrupt offset wraps.
+    PADDLE_ENFORCE(size <= file_size && offset <= file_size - size,
+                   "%s is truncated", filename);
+    PADDLE_ENFORCE_EQ(offset % kMappedModelAlignment, 0UL,
+                      "The parameter %s of %s is misaligned", name, filename);
+    const uint64_t kMax = std::numeric_limits<uint64_t>::max();
+    uint64_t bytes = framework::SizeOfType(type);
+    bool overflow = false;
+    for (int64_t d : dims) {
+      PADDLE_ENFORCE_GE(d, 0, "The parameter %s of %s has negative dims", name,
+                        filename);
+      uint64_t dim = static_cast<uint64_t>(d);
+      overflow |= dim != 0 && bytes > kMax / dim;
+      bytes *= dim;
+    }
+    PADDLE_ENFORCE(!overflow && size == bytes,
+                   "The size of the parameter %s of %s mismatches its dims",
+                   name, filename);
+    VLOG(3) << "parameter's name: " << name;
+
+    auto* tensor = scope.Var(name)->GetMutable<framework::LoDTensor>();
+    void* data = const_cast<char*>(base + offset);
+    if (platform::is_cpu_place(place)) {
+      tensor->Resize(framework::make_ddim(dims));
+      tensor->ShareExternalData(data, size, type, mapping);
+    } else {
+      framework::Tensor cpu_tensor;
+      cpu_tensor.Resize(framework::make_ddim(dims));
+      cpu_tensor.ShareExternalData(data, size, type, mapping);
+      framework::Copy(cpu_tensor, place, tensor);
+    }
+  }
+  platform::DeviceContextPool::Instance().Get(place)->Wait();
+
+  return main_program;
+}
+
 }  // namespace inference
 }  // namespace paddle
@@ -39,5 +39,27 @@ std::unique_ptr<framework::ProgramDesc> Load(framework::Executor& executor,
                                              const std::string& prog_filename,
                                              const std::string& param_filename);
 
+// Parameters in a mapped model file start at multiples of this many bytes,
+// so the mapped tensors are suitably aligned for vectorized kernels.
+constexpr size_t kMappedModelAlignment = 64;
+
+// Saves `main_program` and its parameters held in `scope` into a single
+// file which can be memory-mapped by LoadMapped. The file starts with the
+// serialized program and an index of the parameters, followed by the data of
+// each parameter at an offset aligned to kMappedModelAlignment bytes.
+void SaveMapped(const framework::ProgramDesc& main_program,
+                const framework::Scope& scope,
+                const std::string& filename);
+
+// Loads a model saved by SaveMapped. The file is mmap()ed instead of being
+// read: on CPUPlace the parameters in `scope` refer to the mapped pages
+// directly, so nothing is copied at startup, pages are read on first access
+// and are shared by all the processes mapping the same file until written.
+// On other places the parameters are copied from the mapping.
+std::unique_ptr<framework::ProgramDesc> LoadMapped(
+    framework::Scope& scope,
+    const std::string& filename,
+    const platform::Place& place);
+
 }  // namespace inference
 }  // namespace paddle
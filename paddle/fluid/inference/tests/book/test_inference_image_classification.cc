@@ -49,6 +49,18 @@ TEST(inference, image_classification) {
   TestInference<paddle::platform::CPUPlace>(dirname, cpu_feeds, cpu_fetchs1);
   LOG(INFO) << output1.dims();
 
+  paddle::framework::LoDTensor output3;
+  std::vector<paddle::framework::LoDTensor*> cpu_fetchs3;
+  cpu_fetchs3.push_back(&output3);
+
+  // Run inference on CPU with the inference passes applied, the rewritten
+  // program should compute the same result
+  TestInference<paddle::platform::CPUPlace, false, true>(
+      dirname, cpu_feeds, cpu_fetchs3);
+  LOG(INFO) << output3.dims();
+
+  CheckError<float>(output1, output3);
+
 #ifdef PADDLE_WITH_CUDA
   paddle::framework::LoDTensor output2;
   std::vector<paddle::framework::LoDTensor*> cpu_fetchs2;
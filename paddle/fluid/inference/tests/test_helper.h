@@ -12,7 +12,11 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <time.h>
+#include <unistd.h>
+#include "paddle/fluid/framework/inference_pass.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/inference/io.h"
 
@@ -87,7 +91,38 @@ void CheckError(paddle::framework::LoDTensor& output1,
   EXPECT_EQ(count, 0U) << "There are " << count << " different elements.";
 }
 
-template <typename Place, bool IsCombined = false>
+void RunInferenceProgram(
+    paddle::framework::Executor& executor,
+    paddle::framework::Scope* scope,
+    paddle::framework::ProgramDesc* inference_program,
+    const std::vector<paddle::framework::LoDTensor*>& cpu_feeds,
+    std::vector<paddle::framework::LoDTensor*>& cpu_fetchs) {
+  // Get the feed_target_names and fetch_target_names
+  const std::vector<std::string>& feed_target_names =
+      inference_program->GetFeedTargetNames();
+  const std::vector<std::string>& fetch_target_names =
+      inference_program->GetFetchTargetNames();
+
+  // Prepare inputs: set up maps for feed targets
+  std::map<std::string, const paddle::framework::LoDTensor*> feed_targets;
+  for (size_t i = 0; i < feed_target_names.size(); ++i) {
+    // Please make sure that cpu_feeds[i] is right for feed_target_names[i]
+    feed_targets[feed_target_names[i]] = cpu_feeds[i];
+  }
+
+  // Define Tensor to get the outputs: set up maps for fetch targets
+  std::map<std::string, paddle::framework::LoDTensor*> fetch_targets;
+  for (size_t i = 0; i < fetch_target_names.size(); ++i) {
+    fetch_targets[fetch_target_names[i]] = cpu_fetchs[i];
+  }
+
+  // Run the inference program
+  executor.Run(*inference_program, scope, feed_targets, fetch_targets);
+}
+
+template <typename Place,
+          bool IsCombined = false,
+          bool UseInferencePasses = false>
 void TestInference(const std::string& dirname,
                    const std::vector<paddle::framework::LoDTensor*>& cpu_feeds,
                    std::vector<paddle::framework::LoDTensor*>& cpu_fetchs) {
@@ -114,27 +149,46 @@ void TestInference(const std::string& dirname,
     inference_program = paddle::inference::Load(executor, *scope, dirname);
   }
 
-  // 3. Get the feed_target_names and fetch_target_names
-  const std::vector<std::string>& feed_target_names =
-      inference_program->GetFeedTargetNames();
-  const std::vector<std::string>& fetch_target_names =
-      inference_program->GetFetchTargetNames();
-
-  // 4. Prepare inputs: set up maps for feed targets
-  std::map<std::string, const paddle::framework::LoDTensor*> feed_targets;
-  for (size_t i = 0; i < feed_target_names.size(); ++i) {
-    // Please make sure that cpu_feeds[i] is right for feed_target_names[i]
-    feed_targets[feed_target_names[i]] = cpu_feeds[i];
+  // Optionally rewrite the program and its loaded parameters, e.g. fold
+  // batch_norm into conv2d and fuse fc/conv2d with bias and activation.
+  if (UseInferencePasses) {
+    paddle::framework::ApplyInferencePasses(
+        inference_program.get(), scope, place);
   }
 
-  // 5. Define Tensor to get the outputs: set up maps for fetch targets
-  std::map<std::string, paddle::framework::LoDTensor*> fetch_targets;
-  for (size_t i = 0; i < fetch_target_names.size(); ++i) {
-    fetch_targets[fetch_target_names[i]] = cpu_fetchs[i];
+  // 3. Feed the inputs, run the inference program and fetch the outputs
+  RunInferenceProgram(
+      executor, scope, inference_program.get(), cpu_feeds, cpu_fetchs);
+
+  delete scope;
+}
+
+// Converts the model in `dirname` into a temporary mapped model file, and runs
+// the inference with the parameters mapped from that file.
+template <typename Place>
+void TestMappedInference(
+    const std::string& dirname,
+    const std::vector<paddle::framework::LoDTensor*>& cpu_feeds,
+    std::vector<paddle::framework::LoDTensor*>& cpu_fetchs) {
+  auto place = Place();
+  auto executor = paddle::framework::Executor(place);
+  char mapped_template[] = "/tmp/paddle_mapped_model.XXXXXX";
+  int fd = mkstemp(mapped_template);
+  PADDLE_ENFORCE_GE(fd, 0, "Cannot create a temporary mapped model file");
+  close(fd);
+  std::string mapped_filename = mapped_template;
+  {
+    paddle::framework::Scope scope;
+    auto program = paddle::inference::Load(executor, scope, dirname);
+    paddle::inference::SaveMapped(*program, scope, mapped_filename);
   }
 
-  // 6. Run the inference program
-  executor.Run(*inference_program, scope, feed_targets, fetch_targets);
+  auto* scope = new paddle::framework::Scope();
+  auto inference_program =
+      paddle::inference::LoadMapped(*scope, mapped_filename, place);
+  RunInferenceProgram(
+      executor, scope, inference_program.get(), cpu_feeds, cpu_fetchs);
 
   delete scope;
+  remove(mapped_filename.c_str());
 }
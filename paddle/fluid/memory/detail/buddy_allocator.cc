@@ -44,7 +44,7 @@ inline size_t align(size_t size, size_t alignment) {
   return remaining == 0 ? size : size + (alignment - remaining);
 }
 
-void* BuddyAllocator::Alloc(size_t unaligned_size) {
+void* BuddyAllocator::Alloc(size_t unaligned_size, size_t* allocated_size) {
   // adjust allocation alignment
   size_t size = align(unaligned_size + sizeof(Metadata), min_chunk_size_);
 
@@ -57,7 +57,9 @@ void* BuddyAllocator::Alloc(size_t unaligned_size) {
   // if the allocation is huge, send directly to the system allocator
   if (size > max_chunk_size_) {
     VLOG(10) << "Allocate from system allocator.";
-    return SystemAlloc(size);
+    void* p = SystemAlloc(size);
+    if (p != nullptr && allocated_size != nullptr) *allocated_size = size;
+    return p;
   }
 
   // query and allocate from the existing chunk
@@ -80,10 +82,12 @@ void* BuddyAllocator::Alloc(size_t unaligned_size) {
   total_free_ -= size;
 
   // split the allocation and return data for use
-  return reinterpret_cast<MemoryBlock*>(SplitToAlloc(it, size))->data();
+  auto block = reinterpret_cast<MemoryBlock*>(SplitToAlloc(it, size));
+  if (allocated_size != nullptr) *allocated_size = block->total_size(cache_);
+  return block->data();
 }
 
-void BuddyAllocator::Free(void* p) {
+void BuddyAllocator::Free(void* p, size_t* freed_size) {
   // Point back to metadata
   auto block = static_cast<MemoryBlock*>(p)->metadata();
 
@@ -92,6 +96,8 @@ void BuddyAllocator::Free(void* p) {
 
   VLOG(10) << "Free from address " << block;
 
+  if (freed_size != nullptr) *freed_size = block->total_size(cache_);
+
   if (block->type(cache_) == MemoryBlock::HUGE_CHUNK) {
     VLOG(10) << "Free directly from system allocator";
     system_allocator_->Free(block, block->total_size(cache_),
@@ -159,7 +165,11 @@ void BuddyAllocator::Free(void* p) {
   CleanIdleNormalAlloc();
 }
 
-size_t BuddyAllocator::Used() { return total_used_; }
+size_t BuddyAllocator::Used() {
+  // The profiler reads the usage while other threads allocate.
+  std::lock_guard<std::mutex> lock(mutex_);
+  return total_used_;
+}
 
 void* BuddyAllocator::SystemAlloc(size_t size) {
   size_t index = 0;
@@ -38,8 +38,10 @@ class BuddyAllocator {
   ~BuddyAllocator();
 
  public:
-  void* Alloc(size_t unaligned_size);
-  void Free(void* ptr);
+  // The total size of the block, with its metadata, is stored to
+  // allocated_size and freed_size when they are not null.
+  void* Alloc(size_t unaligned_size, size_t* allocated_size = nullptr);
+  void Free(void* ptr, size_t* freed_size = nullptr);
   size_t Used();
 
  public:
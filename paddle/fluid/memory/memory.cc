@@ -14,6 +14,8 @@ limitations under the License. */
 
 #include "paddle/fluid/memory/memory.h"
 
+#include <vector>
+
 #include "glog/logging.h"
 
 #include "paddle/fluid/memory/detail/buddy_allocator.h"
@@ -27,6 +29,17 @@ namespace memory {
 
 using BuddyAllocator = detail::BuddyAllocator;
 
+// The bytes allocated minus the bytes freed by the thread, on the CPU at
+// index 0 and on the GPU i at index i + 1.
+static thread_local std::vector<int64_t> g_thread_allocated;
+
+static int64_t& ThreadAllocated(size_t index) {
+  if (g_thread_allocated.size() <= index) {
+    g_thread_allocated.resize(index + 1, 0);
+  }
+  return g_thread_allocated[index];
+}
+
 BuddyAllocator* GetCPUBuddyAllocator() {
   static detail::BuddyAllocator* a = nullptr;
   if (a == nullptr) {
@@ -40,15 +53,19 @@ BuddyAllocator* GetCPUBuddyAllocator() {
 template <>
 void* Alloc<platform::CPUPlace>(platform::CPUPlace place, size_t size) {
   VLOG(10) << "Allocate " << size << " bytes on " << platform::Place(place);
-  void* p = GetCPUBuddyAllocator()->Alloc(size);
+  size_t allocated = 0;
+  void* p = GetCPUBuddyAllocator()->Alloc(size, &allocated);
   VLOG(10) << "  pointer=" << p;
+  ThreadAllocated(0) += allocated;
   return p;
 }
 
 template <>
 void Free<platform::CPUPlace>(platform::CPUPlace place, void* p) {
   VLOG(10) << "Free pointer=" << p << " on " << platform::Place(place);
-  GetCPUBuddyAllocator()->Free(p);
+  size_t freed = 0;
+  GetCPUBuddyAllocator()->Free(p, &freed);
+  ThreadAllocated(0) -= freed;
 }
 
 template <>
@@ -90,7 +107,9 @@ size_t Used<platform::CUDAPlace>(platform::CUDAPlace place) {
 template <>
 void* Alloc<platform::CUDAPlace>(platform::CUDAPlace place, size_t size) {
   auto* buddy_allocator = GetGPUBuddyAllocator(place.device);
-  auto* ptr = buddy_allocator->Alloc(size);
+  size_t allocated = 0;
+  auto* ptr = buddy_allocator->Alloc(size, &allocated);
+  ThreadAllocated(place.device + 1) += allocated;
   if (ptr == nullptr) {
     int cur_dev = platform::GetCurrentDeviceId();
     platform::SetDeviceId(place.device);
@@ -109,7 +128,9 @@ void* Alloc<platform::CUDAPlace>(platform::CUDAPlace place, size_t size) {
 
 template <>
 void Free<platform::CUDAPlace>(platform::CUDAPlace place, void* p) {
-  GetGPUBuddyAllocator(place.device)->Free(p);
+  size_t freed = 0;
+  GetGPUBuddyAllocator(place.device)->Free(p, &freed);
+  ThreadAllocated(place.device + 1) -= freed;
 }
 
 #endif
@@ -130,5 +151,12 @@ size_t memory_usage(const platform::Place& p) {
   return boost::apply_visitor(Usage(), p);
 }
 
+int64_t thread_allocated(const platform::Place& p) {
+  if (platform::is_gpu_place(p)) {
+    return ThreadAllocated(boost::get<platform::CUDAPlace>(p).device + 1);
+  }
+  return ThreadAllocated(0);
+}
+
 }  // namespace memory
 }  // namespace paddle
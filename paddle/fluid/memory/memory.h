@@ -61,6 +61,15 @@ struct Usage : public boost::static_visitor<size_t> {
 
 size_t memory_usage(const platform::Place& p);
 
+/**
+ * \brief   Bytes allocated minus bytes freed by the calling thread in one
+ *          place, counting the whole blocks taken from the allocator.
+ *
+ * \note    The difference of two readings is the memory the thread took
+ *          in between, whatever the other threads allocate.
+ */
+int64_t thread_allocated(const platform::Place& p);
+
 /**
  * \brief   Free memory block in one place.
  *
@@ -14,9 +14,11 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/beam_search_op.h"
 
+#include <algorithm>
 #include <map>
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/top_k.h"
 
 namespace paddle {
 namespace operators {
@@ -116,20 +118,26 @@ std::vector<std::vector<BeamSearch::Item>>
 BeamSearch::SelectTopBeamSizeItems() {
   std::vector<std::vector<Item>> result;
   std::vector<Item> items;
+  std::vector<score_t> scores;
+  std::vector<size_t> top;
   // for each source sentence, select the top beam_size items across all
   // candidate sets.
   while (NextItemSet(&items)) {
-    std::nth_element(std::begin(items), std::begin(items) + beam_size_,
-                     std::end(items), [](const Item &a, const Item &b) {
-                       // TODO(superjom) make score's comparation customizable.
-                       // partial sort in descending order
-                       return a.score > b.score;
-                     });
-    // prune the top beam_size items.
-    if (items.size() > beam_size_) {
-      items.resize(beam_size_);
+    // TODO(superjom) make score's comparation customizable.
+    scores.resize(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+      scores[i] = items[i].score;
     }
-    result.emplace_back(items);
+    top.resize(std::min(items.size(), beam_size_));
+    math::PartialTopK(scores.data(), static_cast<int64_t>(scores.size()),
+                      static_cast<int64_t>(top.size()),
+                      static_cast<score_t *>(nullptr), top.data());
+    std::vector<Item> selected;
+    selected.reserve(top.size());
+    for (size_t i : top) {
+      selected.push_back(items[i]);
+    }
+    result.emplace_back(std::move(selected));
   }
   VLOG(3) << "SelectTopBeamSizeItems result size " << result.size();
   for (auto &items : result) {
@@ -0,0 +1,110 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cmath>
+#include <string>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+
+// The activations that fused operators (fc, conv2d_fusion) can apply to
+// their output in the same sweep that adds the bias.
+enum class FusedActivation { kIdentity, kRelu, kSigmoid, kTanh };
+
+inline FusedActivation GetFusedActivation(const std::string& type) {
+  if (type.empty() || type == "identity") {
+    return FusedActivation::kIdentity;
+  } else if (type == "relu") {
+    return FusedActivation::kRelu;
+  } else if (type == "sigmoid") {
+    return FusedActivation::kSigmoid;
+  } else if (type == "tanh") {
+    return FusedActivation::kTanh;
+  }
+  PADDLE_THROW("Unsupported fused activation %s", type);
+}
+
+namespace detail {
+
+template <typename T>
+struct IdentityFunctor {
+  inline T operator()(T x) const { return x; }
+};
+
+template <typename T>
+struct ReluFunctor {
+  inline T operator()(T x) const { return x > static_cast<T>(0) ? x : 0; }
+};
+
+template <typename T>
+struct SigmoidFunctor {
+  inline T operator()(T x) const {
+    return static_cast<T>(1) / (static_cast<T>(1) + std::exp(-x));
+  }
+};
+
+template <typename T>
+struct TanhFunctor {
+  inline T operator()(T x) const { return std::tanh(x); }
+};
+
+template <typename T, typename Functor>
+void BiasActivationImpl(const T* bias, T* out, int64_t outer, int64_t channels,
+                        int64_t inner, Functor act) {
+  for (int64_t o = 0; o < outer; ++o) {
+    for (int64_t c = 0; c < channels; ++c) {
+      const T b = bias ? bias[c] : static_cast<T>(0);
+      T* out_c = out + (o * channels + c) * inner;
+      for (int64_t i = 0; i < inner; ++i) {
+        out_c[i] = act(out_c[i] + b);
+      }
+    }
+  }
+}
+
+}  // namespace detail
+
+// Computes out = act(out + bias) in place on a CPU buffer viewed as
+// [outer, channels, inner], where bias (optional, may be nullptr) has
+// `channels` elements. fc uses inner = 1, conv uses inner = H * W.
+template <typename T>
+void BiasActivation(const T* bias, T* out, int64_t outer, int64_t channels,
+                    int64_t inner, FusedActivation act) {
+  switch (act) {
+    case FusedActivation::kIdentity:
+      if (bias == nullptr) return;
+      detail::BiasActivationImpl(bias, out, outer, channels, inner,
+                                 detail::IdentityFunctor<T>());
+      break;
+    case FusedActivation::kRelu:
+      detail::BiasActivationImpl(bias, out, outer, channels, inner,
+                                 detail::ReluFunctor<T>());
+      break;
+    case FusedActivation::kSigmoid:
+      detail::BiasActivationImpl(bias, out, outer, channels, inner,
+                                 detail::SigmoidFunctor<T>());
+      break;
+    case FusedActivation::kTanh:
+      detail::BiasActivationImpl(bias, out, outer, channels, inner,
+                                 detail::TanhFunctor<T>());
+      break;
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
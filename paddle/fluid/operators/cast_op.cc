@@ -14,6 +14,8 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/cast_op.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/float16_convert.h"
 
 namespace paddle {
 namespace operators {
@@ -63,6 +65,28 @@ class CastOpGradMaker : public framework::SingleGradOpDescMaker {
   }
 };
 
+void CastFloat16(const framework::Tensor& in, framework::Tensor* out,
+                 framework::proto::DataType out_dtype,
+                 const platform::Place& place) {
+  PADDLE_ENFORCE(platform::is_cpu_place(place),
+                 "Casting from or to float16 is only supported on CPUPlace.");
+  auto in_dtype = framework::ToDataType(in.type());
+  if (in_dtype == out_dtype) {
+    framework::Copy(in, place, out);
+  } else if (in_dtype == framework::proto::DataType::FP32) {
+    PADDLE_ENFORCE(out_dtype == framework::proto::DataType::FP16,
+                   "float32 can only be cast to float16 here.");
+    platform::FloatToFloat16(in.data<float>(),
+                             out->mutable_data<float16>(place), in.numel());
+  } else {
+    PADDLE_ENFORCE(in_dtype == framework::proto::DataType::FP16 &&
+                       out_dtype == framework::proto::DataType::FP32,
+                   "float16 can only be cast from and to float32.");
+    platform::Float16ToFloat(in.data<float16>(),
+                             out->mutable_data<float>(place), in.numel());
+  }
+}
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -74,4 +98,5 @@ REGISTER_OP_CPU_KERNEL(cast, ops::CastOpKernel<CPU, float>,
                        ops::CastOpKernel<CPU, double>,
                        ops::CastOpKernel<CPU, int>,
                        ops::CastOpKernel<CPU, int64_t>,
-                       ops::CastOpKernel<CPU, bool>);
+                       ops::CastOpKernel<CPU, bool>,
+                       ops::CastOpKernel<CPU, paddle::float16>);
@@ -48,14 +48,27 @@ struct CastOpFunctor {
   }
 };
 
+// float16 is a storage type on CPU, it is only cast from and to float32,
+// using the vectorized conversions of platform/float16_convert.h.
+void CastFloat16(const framework::Tensor& in, framework::Tensor* out,
+                 framework::proto::DataType out_dtype,
+                 const platform::Place& place);
+
 template <typename DeviceContext, typename InT>
 class CastOpKernel : public framework::OpKernel<InT> {
  public:
   void Compute(const framework::ExecutionContext& context) const override {
     auto* in = context.Input<framework::Tensor>("X");
     auto* out = context.Output<framework::Tensor>("Out");
+    auto out_dtype =
+        static_cast<framework::proto::DataType>(context.Attr<int>("out_dtype"));
+    if (out_dtype == framework::proto::DataType::FP16 ||
+        in->type().hash_code() == typeid(float16).hash_code()) {
+      CastFloat16(*in, out, out_dtype, context.GetPlace());
+      return;
+    }
     framework::VisitDataType(
-        static_cast<framework::proto::DataType>(context.Attr<int>("out_dtype")),
+        out_dtype,
         CastOpFunctor<DeviceContext, InT>(
             in, out, context.template device_context<DeviceContext>()));
   }
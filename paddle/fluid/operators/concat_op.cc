@@ -100,7 +100,8 @@ class ConcatOpGrad : public framework::OperatorWithKernel {
 namespace ops = paddle::operators;
 REGISTER_OP_EX(concat, ops::ConcatOp, ops::ConcatOpMaker, concat_grad,
                ops::ConcatOpGrad, false)
-REGISTER_OP_CPU_KERNEL(concat,
-                       ops::ConcatKernel<paddle::platform::CPUPlace, float>)
+REGISTER_OP_CPU_KERNEL(
+    concat, ops::ConcatKernel<paddle::platform::CPUPlace, float>,
+    ops::ConcatKernel<paddle::platform::CPUPlace, paddle::float16>)
 REGISTER_OP_CPU_KERNEL(concat_grad,
                        ops::ConcatGradKernel<paddle::platform::CPUPlace, float>)
@@ -0,0 +1,97 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+#include "paddle/fluid/operators/bias_activation.h"
+#include "paddle/fluid/operators/conv_op.h"
+
+namespace paddle {
+namespace operators {
+
+class Conv2DFusionOpMaker : public Conv2DOpMaker {
+ public:
+  Conv2DFusionOpMaker(OpProto* proto, OpAttrChecker* op_checker)
+      : Conv2DOpMaker(proto, op_checker) {
+    AddInput("Bias",
+             "(Tensor, optional) The bias of convolution, a 1-D tensor with "
+             "one element per output channel.")
+        .AsDispensable();
+    AddAttr<std::string>("activation",
+                         "(string, default identity) The activation applied "
+                         "to the output, one of identity, relu, sigmoid and "
+                         "tanh.")
+        .SetDefault("identity");
+    AddComment(R"DOC(
+Conv2D Fusion Operator.
+
+Computes
+
+$$Output = act(conv2d(Input, Filter) + Bias)$$
+
+where the bias is broadcast along the channel dimension. The bias and the
+activation are applied while traversing the convolution output once, instead
+of running `elementwise_add` and an activation operator which both materialize
+a tensor of the output size. The operator is created by the
+`fuse_conv_bias_act` inference pass and has no gradient operator.
+)DOC");
+  }
+};
+
+class Conv2DFusionOp : public ConvOp {
+ public:
+  using ConvOp::ConvOp;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    ConvOp::InferShape(ctx);
+    if (ctx->HasInput("Bias")) {
+      auto bias_dims = ctx->GetInputDim("Bias");
+      auto filter_dims = ctx->GetInputDim("Filter");
+      PADDLE_ENFORCE_EQ(framework::product(bias_dims), filter_dims[0],
+                        "The size of Input(Bias) of Conv2DFusionOp should be "
+                        "equal to the number of output channels.");
+    }
+  }
+};
+
+template <typename DeviceContext, typename T>
+class Conv2DFusionKernel : public GemmConvKernel<DeviceContext, T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    PADDLE_ENFORCE(platform::is_cpu_place(context.GetPlace()),
+                   "conv2d_fusion only supports CPUPlace.");
+    GemmConvKernel<DeviceContext, T>::Compute(context);
+
+    const Tensor* bias = context.Input<Tensor>("Bias");
+    Tensor* output = context.Output<Tensor>("Output");
+    FusedActivation act =
+        GetFusedActivation(context.Attr<std::string>("activation"));
+
+    const int64_t batch_size = output->dims()[0];
+    const int64_t channels = output->dims()[1];
+    const int64_t spatial = output->numel() / (batch_size * channels);
+    BiasActivation<T>(bias ? bias->data<T>() : nullptr, output->data<T>(),
+                      batch_size, channels, spatial, act);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(conv2d_fusion, ops::Conv2DFusionOp,
+                             ops::Conv2DFusionOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    conv2d_fusion,
+    ops::Conv2DFusionKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::Conv2DFusionKernel<paddle::platform::CPUDeviceContext, double>);
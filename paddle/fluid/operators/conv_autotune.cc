@@ -0,0 +1,164 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/conv_autotune.h"
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include "paddle/fluid/framework/data_type.h"
+
+DEFINE_bool(conv_autotune, false,
+            "Time the kernels of conv2d on CPU on the first run of each shape "
+            "and use the fastest one.");
+DEFINE_string(conv_autotune_cache, "",
+              "The file keeping the kernels chosen by --conv_autotune across "
+              "processes. Default is empty, the choices are not kept.");
+
+namespace paddle {
+namespace operators {
+
+ConvAlgorithmCache& ConvAlgorithmCache::Instance() {
+  static ConvAlgorithmCache* cache =
+      new ConvAlgorithmCache(FLAGS_conv_autotune_cache);
+  return *cache;
+}
+
+ConvAlgorithmCache::ConvAlgorithmCache(const std::string& path)
+    : path_(path) {
+  Load();
+}
+
+void ConvAlgorithmCache::Load() {
+  if (path_.empty()) return;
+  std::ifstream fin(path_);
+  if (!fin) return;
+  std::string line;
+  while (std::getline(fin, line)) {
+    std::istringstream sin(line);
+    std::string key, library;
+    if (!(sin >> key >> library)) continue;
+    try {
+      libraries_[key] = framework::StringToLibraryType(library.c_str());
+    } catch (platform::EnforceNotMet& e) {
+      LOG(WARNING) << "Skip the line of " << path_ << ": " << line;
+    }
+  }
+  VLOG(3) << "Loaded " << libraries_.size() << " conv algorithms from "
+          << path_;
+}
+
+bool ConvAlgorithmCache::Find(const std::string& key,
+                              framework::LibraryType* library) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = libraries_.find(key);
+  if (it == libraries_.end()) return false;
+  *library = it->second;
+  return true;
+}
+
+void ConvAlgorithmCache::Insert(const std::string& key,
+                                framework::LibraryType library) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  libraries_[key] = library;
+  if (path_.empty()) return;
+  std::ofstream fout(path_, std::ios::app);
+  if (!fout) {
+    LOG(WARNING) << "Cannot write the conv algorithm cache " << path_;
+    return;
+  }
+  fout << key << " " << framework::LibraryTypeToString(library) << "\n";
+}
+
+static void AppendDims(const std::vector<int64_t>& dims, std::ostream* out) {
+  for (size_t i = 0; i < dims.size(); ++i) {
+    *out << (i == 0 ? "" : "x") << dims[i];
+  }
+}
+
+std::string ConvAlgorithmKey(const std::string& type,
+                             framework::proto::DataType data_type,
+                             const framework::DDim& input_dims,
+                             const framework::DDim& filter_dims,
+                             const std::vector<int>& strides,
+                             const std::vector<int>& paddings,
+                             const std::vector<int>& dilations, int groups) {
+  std::ostringstream key;
+  key << type << ":" << framework::DataTypeToString(data_type) << ":";
+  AppendDims(framework::vectorize(input_dims), &key);
+  key << ":";
+  AppendDims(framework::vectorize(filter_dims), &key);
+  key << ":s";
+  AppendDims(std::vector<int64_t>(strides.begin(), strides.end()), &key);
+  key << ":p";
+  AppendDims(std::vector<int64_t>(paddings.begin(), paddings.end()), &key);
+  key << ":d";
+  AppendDims(std::vector<int64_t>(dilations.begin(), dilations.end()), &key);
+  key << ":g" << groups;
+  return key.str();
+}
+
+framework::LibraryType FastestConvLibrary(
+    const std::vector<framework::LibraryType>& candidates, int repeat,
+    const std::function<bool(framework::LibraryType)>& run) {
+  PADDLE_ENFORCE(!candidates.empty(), "No conv kernel to autotune.");
+  PADDLE_ENFORCE_GT(repeat, 0);
+  framework::LibraryType library = candidates[0];
+  double best_time = std::numeric_limits<double>::max();
+  for (auto candidate : candidates) {
+    // The first run warms up the caches and the buffers of the kernel.
+    if (!run(candidate)) continue;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; ++i) {
+      run(candidate);
+    }
+    double time = std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - start)
+                      .count() /
+                  repeat;
+    VLOG(3) << candidate << ": " << time << " ms";
+    if (time < best_time) {
+      best_time = time;
+      library = candidate;
+    }
+  }
+  return library;
+}
+
+bool ConvAutotuneMemo::Find(const framework::DDim& input_dims,
+                            const framework::DDim& filter_dims,
+                            framework::LibraryType* library) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!valid_ || input_dims_ != input_dims || filter_dims_ != filter_dims) {
+    return false;
+  }
+  *library = library_;
+  return true;
+}
+
+void ConvAutotuneMemo::Set(const framework::DDim& input_dims,
+                           const framework::DDim& filter_dims,
+                           framework::LibraryType library) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  valid_ = true;
+  input_dims_ = input_dims;
+  filter_dims_ = filter_dims;
+  library_ = library;
+}
+
+}  // namespace operators
+}  // namespace paddle
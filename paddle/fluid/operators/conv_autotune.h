@@ -0,0 +1,109 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/ddim.h"
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/library_type.h"
+
+namespace paddle {
+namespace operators {
+
+/*
+ * \brief The conv2d kernels chosen by autotuning on CPU.
+ *
+ * With --conv_autotune, the first run of conv2d for a shape times each
+ * kernel that can compute it, and the fastest one, identified by its
+ * library type, is used from then on for that shape. The winners are
+ * appended to the file --conv_autotune_cache, if given, which is read back
+ * on the first use of the cache, so a host tunes each shape only once.
+ *
+ * Each line of the file is "<key> <library type>". A shape tuned again
+ * overrides the earlier lines.
+ */
+class ConvAlgorithmCache {
+ public:
+  // The cache of --conv_autotune_cache.
+  static ConvAlgorithmCache& Instance();
+
+  // Reads the cache file at path, if any, an empty path keeps the cache in
+  // memory.
+  explicit ConvAlgorithmCache(const std::string& path);
+
+  bool Find(const std::string& key, framework::LibraryType* library) const;
+
+  // Records the library of the key, and appends it to the cache file.
+  void Insert(const std::string& key, framework::LibraryType library);
+
+ private:
+  void Load();
+
+  std::string path_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, framework::LibraryType> libraries_;
+};
+
+// The key of a convolution in the cache, e.g.
+// conv2d:float32:4x64x56x56:64x64x3x3:s1x1:p1x1:d1x1:g1
+std::string ConvAlgorithmKey(const std::string& type,
+                             framework::proto::DataType data_type,
+                             const framework::DDim& input_dims,
+                             const framework::DDim& filter_dims,
+                             const std::vector<int>& strides,
+                             const std::vector<int>& paddings,
+                             const std::vector<int>& dilations, int groups);
+
+// Runs each candidate once to warm up, then `repeat` times, and returns the
+// candidate of the least average time. `run` returns false for a candidate
+// it cannot run, which is skipped. The first candidate is returned when none
+// can run.
+framework::LibraryType FastestConvLibrary(
+    const std::vector<framework::LibraryType>& candidates, int repeat,
+    const std::function<bool(framework::LibraryType)>& run);
+
+/*
+ * \brief The kernel a conv2d operator chose for the shape of its last run.
+ *
+ * The runs on the same shape use it without building the key or locking
+ * ConvAlgorithmCache. A cloned operator starts empty.
+ */
+class ConvAutotuneMemo {
+ public:
+  ConvAutotuneMemo() = default;
+  ConvAutotuneMemo(const ConvAutotuneMemo&) {}
+  ConvAutotuneMemo& operator=(const ConvAutotuneMemo&) { return *this; }
+
+  bool Find(const framework::DDim& input_dims,
+            const framework::DDim& filter_dims,
+            framework::LibraryType* library) const;
+
+  void Set(const framework::DDim& input_dims,
+           const framework::DDim& filter_dims, framework::LibraryType library);
+
+ private:
+  mutable std::mutex mutex_;
+  bool valid_ = false;
+  framework::DDim input_dims_;
+  framework::DDim filter_dims_;
+  framework::LibraryType library_ = framework::LibraryType::kPlain;
+};
+
+}  // namespace operators
+}  // namespace paddle
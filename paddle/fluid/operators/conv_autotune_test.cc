@@ -0,0 +1,179 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/conv_autotune.h"
+#include <gflags/gflags.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <thread>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+USE_OP(conv2d);
+USE_OP_DEVICE_KERNEL(conv2d, WINOGRAD);
+
+DECLARE_bool(conv_autotune);
+
+namespace paddle {
+namespace operators {
+
+TEST(ConvAutotune, Key) {
+  EXPECT_EQ("conv2d:float32:4x64x56x56:64x64x3x3:s1x1:p1x1:d1x1:g1",
+            ConvAlgorithmKey("conv2d", framework::proto::DataType::FP32,
+                             framework::make_ddim({4, 64, 56, 56}),
+                             framework::make_ddim({64, 64, 3, 3}), {1, 1},
+                             {1, 1}, {1, 1}, 1));
+  EXPECT_NE(ConvAlgorithmKey("conv2d", framework::proto::DataType::FP32,
+                             framework::make_ddim({4, 64, 56, 56}),
+                             framework::make_ddim({64, 64, 3, 3}), {1, 1},
+                             {1, 1}, {1, 1}, 1),
+            ConvAlgorithmKey("conv2d", framework::proto::DataType::FP64,
+                             framework::make_ddim({4, 64, 56, 56}),
+                             framework::make_ddim({64, 64, 3, 3}), {1, 1},
+                             {1, 1}, {1, 1}, 1));
+}
+
+TEST(ConvAutotune, Cache) {
+  char path[] = "/tmp/conv_autotune_test_XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_NE(-1, fd);
+  close(fd);
+
+  framework::LibraryType library;
+  {
+    ConvAlgorithmCache cache(path);
+    EXPECT_FALSE(cache.Find("a", &library));
+    cache.Insert("a", framework::LibraryType::kWinograd);
+    cache.Insert("b", framework::LibraryType::kPlain);
+    cache.Insert("a", framework::LibraryType::kPlain);
+    ASSERT_TRUE(cache.Find("a", &library));
+    EXPECT_EQ(framework::LibraryType::kPlain, library);
+  }
+  {
+    std::ofstream fout(path, std::ios::app);
+    fout << "malformed\n"
+         << "c UNKNOWN\n"
+         << "d WINOGRAD\n";
+  }
+
+  // The next process reads the choices back, a later line of a key
+  // overriding the earlier ones.
+  ConvAlgorithmCache cache(path);
+  ASSERT_TRUE(cache.Find("a", &library));
+  EXPECT_EQ(framework::LibraryType::kPlain, library);
+  ASSERT_TRUE(cache.Find("b", &library));
+  EXPECT_EQ(framework::LibraryType::kPlain, library);
+  EXPECT_FALSE(cache.Find("c", &library));
+  ASSERT_TRUE(cache.Find("d", &library));
+  EXPECT_EQ(framework::LibraryType::kWinograd, library);
+  remove(path);
+
+  ConvAlgorithmCache in_memory("");
+  in_memory.Insert("a", framework::LibraryType::kWinograd);
+  ASSERT_TRUE(in_memory.Find("a", &library));
+  EXPECT_EQ(framework::LibraryType::kWinograd, library);
+}
+
+TEST(ConvAutotune, FastestConvLibrary) {
+  std::map<framework::LibraryType, int> runs;
+  auto library = FastestConvLibrary(
+      {framework::LibraryType::kCUDNN, framework::LibraryType::kPlain,
+       framework::LibraryType::kWinograd},
+      3, [&](framework::LibraryType candidate) {
+        if (candidate == framework::LibraryType::kCUDNN) return false;
+        ++runs[candidate];
+        std::this_thread::sleep_for(std::chrono::milliseconds(
+            candidate == framework::LibraryType::kPlain ? 10 : 1));
+        return true;
+      });
+  EXPECT_EQ(framework::LibraryType::kWinograd, library);
+  // A warm-up run and the timed runs.
+  EXPECT_EQ(4, runs[framework::LibraryType::kPlain]);
+  EXPECT_EQ(4, runs[framework::LibraryType::kWinograd]);
+
+  EXPECT_EQ(framework::LibraryType::kPlain,
+            FastestConvLibrary({framework::LibraryType::kPlain}, 1,
+                               [](framework::LibraryType) { return false; }));
+}
+
+static void FillTensor(const framework::DDim& dims, float scale,
+                       framework::LoDTensor* tensor) {
+  float* data = tensor->mutable_data<float>(dims, platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = scale * static_cast<float>(i % 7 - 3);
+  }
+}
+
+static void RunConv2D(const std::string& output,
+                      const std::vector<int>& strides,
+                      framework::Scope* scope) {
+  framework::AttributeMap attrs;
+  attrs["strides"] = strides;
+  attrs["paddings"] = std::vector<int>({1, 1});
+  auto op = framework::OpRegistry::CreateOp(
+      "conv2d", {{"Input", {"input"}}, {"Filter", {"filter"}}},
+      {{"Output", {output}}}, attrs);
+  op->Run(*scope, platform::CPUPlace());
+  // The runs of a tuned shape find the kernel without timing.
+  op->Run(*scope, platform::CPUPlace());
+}
+
+TEST(ConvAutotune, Conv2D) {
+  framework::Scope scope;
+  FillTensor(framework::make_ddim({2, 4, 10, 10}), 0.1,
+             scope.Var("input")->GetMutable<framework::LoDTensor>());
+  FillTensor(framework::make_ddim({8, 4, 3, 3}), 0.01,
+             scope.Var("filter")->GetMutable<framework::LoDTensor>());
+
+  FLAGS_conv_autotune = false;
+  RunConv2D("expected", {1, 1}, &scope);
+  FLAGS_conv_autotune = true;
+  RunConv2D("output", {1, 1}, &scope);
+  RunConv2D("strided", {2, 2}, &scope);
+  FLAGS_conv_autotune = false;
+
+  auto& cache = ConvAlgorithmCache::Instance();
+  framework::LibraryType library;
+  ASSERT_TRUE(cache.Find(
+      ConvAlgorithmKey("conv2d", framework::proto::DataType::FP32,
+                       framework::make_ddim({2, 4, 10, 10}),
+                       framework::make_ddim({8, 4, 3, 3}), {1, 1}, {1, 1},
+                       {1, 1}, 1),
+      &library));
+  EXPECT_TRUE(library == framework::LibraryType::kPlain ||
+              library == framework::LibraryType::kWinograd);
+  // Only the plain kernel computes the strided convolution.
+  EXPECT_FALSE(cache.Find(
+      ConvAlgorithmKey("conv2d", framework::proto::DataType::FP32,
+                       framework::make_ddim({2, 4, 10, 10}),
+                       framework::make_ddim({8, 4, 3, 3}), {2, 2}, {1, 1},
+                       {1, 1}, 1),
+      &library));
+
+  // The chosen kernel writes the output of the operator, the candidates
+  // timed on the first run write a scratch one.
+  const auto& expected =
+      scope.FindVar("expected")->Get<framework::LoDTensor>();
+  const auto& output = scope.FindVar("output")->Get<framework::LoDTensor>();
+  ASSERT_EQ(expected.dims(), output.dims());
+  for (int64_t i = 0; i < expected.numel(); ++i) {
+    ASSERT_NEAR(expected.data<float>()[i], output.data<float>()[i], 1e-4);
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
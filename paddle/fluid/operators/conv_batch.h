@@ -0,0 +1,134 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/operators/strided_memcpy.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace operators {
+
+/*
+ * How the GEMM convolution kernels go through the images of a batch.
+ *
+ * Each image is unfolded (im2col or vol2col) into a column matrix of
+ * col_height x col_width values, col_width being the spatial size on the
+ * side of the column matrix, and multiplied with the filter. When that
+ * size is small, as in the last layers of a network, the GEMM of a single
+ * image is too narrow to run efficiently. On CPU, several consecutive
+ * images are then unfolded side by side into one column matrix of
+ * col_height x (images_per_gemm * col_width) values for one larger GEMM.
+ * From kConvBatchMinWidth columns on, the copies to and from the larger
+ * matrices cost more than they save, and the images are not batched.
+ *
+ * The steps, each of images_per_gemm images, are independent. On CPU with
+ * MKLML, whose OpenMP runtime also runs the GEMMs, they run on several
+ * threads, each with its own buffers. Otherwise, -fopenmp is not used and
+ * the steps run one after the other, each with a multi-threaded GEMM. The
+ * kernels on GPU keep the plain loop over the images.
+ */
+struct ConvBatchPlan {
+  int images_per_gemm;
+  // ceil(batch_size / images_per_gemm)
+  int num_steps;
+  bool parallel;
+};
+
+// Images are batched when col_width is below kConvBatchMinWidth, into a
+// column matrix of at most kConvBatchColumns columns and kConvBatchBytes
+// bytes.
+constexpr int64_t kConvBatchMinWidth = 128;
+constexpr int64_t kConvBatchColumns = 1024;
+constexpr int64_t kConvBatchBytes = 32 << 20;
+
+#ifdef PADDLE_WITH_MKLML
+constexpr bool kConvParallelSteps = true;
+#else
+constexpr bool kConvParallelSteps = false;
+#endif
+
+inline ConvBatchPlan PlanConvBatch(const platform::Place& place,
+                                   int batch_size, int64_t col_height,
+                                   int64_t col_width, size_t size_of_type) {
+  ConvBatchPlan plan{1, batch_size, false};
+  if (!platform::is_cpu_place(place) || batch_size <= 1) return plan;
+  plan.parallel = kConvParallelSteps;
+  if (col_width >= kConvBatchMinWidth) return plan;
+  const int64_t col_bytes =
+      std::max<int64_t>(col_height * col_width * size_of_type, 1);
+  int64_t images = std::min(kConvBatchColumns / std::max<int64_t>(col_width, 1),
+                            kConvBatchBytes / col_bytes);
+  images = std::max<int64_t>(1, std::min<int64_t>(images, batch_size));
+  plan.images_per_gemm = static_cast<int>(images);
+  plan.num_steps =
+      (batch_size + plan.images_per_gemm - 1) / plan.images_per_gemm;
+  plan.parallel = kConvParallelSteps && plan.num_steps > 1;
+  return plan;
+}
+
+// The buffers of the steps run by one thread.
+struct ConvWorkspace {
+  framework::Tensor col;
+  // the column matrix of the batched images
+  framework::Tensor col_batch;
+  // the other side of the GEMM of the batched images
+  framework::Tensor out_batch;
+};
+
+// Calls step(i, &workspace) for each step i of the plan.
+template <typename StepFunc>
+inline void ForEachConvStep(const ConvBatchPlan& plan, StepFunc step) {
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel if (plan.parallel)
+#endif
+  {
+    ConvWorkspace workspace;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp for
+#endif
+    for (int i = 0; i < plan.num_steps; ++i) {
+      step(i, &workspace);
+    }
+  }
+}
+
+// Copies the matrix src of [rows, cols] to the columns [offset, offset +
+// cols) of the matrix dst of [rows, *].
+template <typename T>
+inline void CopyToColumns(const platform::DeviceContext& ctx,
+                          const framework::Tensor& src, int64_t offset,
+                          framework::Tensor* dst) {
+  const int64_t cols = src.dims()[1];
+  StridedMemcpy<T>(ctx, src.data<T>(), framework::make_ddim({cols, 1}),
+                   src.dims(), framework::make_ddim({dst->dims()[1], 1}),
+                   dst->data<T>() + offset);
+}
+
+// Copies the columns [offset, offset + cols) of the matrix src of
+// [rows, *] to the matrix dst of [rows, cols].
+template <typename T>
+inline void CopyFromColumns(const platform::DeviceContext& ctx,
+                            const framework::Tensor& src, int64_t offset,
+                            framework::Tensor* dst) {
+  const int64_t cols = dst->dims()[1];
+  StridedMemcpy<T>(ctx, src.data<T>() + offset,
+                   framework::make_ddim({src.dims()[1], 1}), dst->dims(),
+                   framework::make_ddim({cols, 1}), dst->data<T>());
+}
+
+}  // namespace operators
+}  // namespace paddle
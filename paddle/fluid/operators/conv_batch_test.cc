@@ -0,0 +1,193 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/conv_batch.h"
+#include <glog/logging.h>
+#include <chrono>
+#include <random>
+#include "gtest/gtest.h"
+#include "paddle/fluid/operators/math/im2col.h"
+#include "paddle/fluid/operators/math/math_function.h"
+
+namespace paddle {
+namespace operators {
+
+TEST(ConvBatch, Plan) {
+  platform::CPUPlace cpu;
+  // 7x7 outputs: 20 images make at most 1024 columns.
+  ConvBatchPlan plan = PlanConvBatch(cpu, 64, 512 * 9, 49, sizeof(float));
+  EXPECT_EQ(20, plan.images_per_gemm);
+  EXPECT_EQ(4, plan.num_steps);
+  EXPECT_EQ(kConvParallelSteps, plan.parallel);
+
+  // Large outputs are not batched, the images run in parallel with MKLML.
+  plan = PlanConvBatch(cpu, 8, 64 * 9, 112 * 112, sizeof(float));
+  EXPECT_EQ(1, plan.images_per_gemm);
+  EXPECT_EQ(8, plan.num_steps);
+  EXPECT_EQ(kConvParallelSteps, plan.parallel);
+
+  plan = PlanConvBatch(cpu, 8, 256 * 9, 14 * 14, sizeof(float));
+  EXPECT_EQ(1, plan.images_per_gemm);
+
+  // The column matrix of the batch is bounded in bytes.
+  plan = PlanConvBatch(cpu, 64, 1 << 17, 16, sizeof(float));
+  EXPECT_EQ(4, plan.images_per_gemm);
+
+  // A small batch is one step.
+  plan = PlanConvBatch(cpu, 3, 27, 16, sizeof(double));
+  EXPECT_EQ(3, plan.images_per_gemm);
+  EXPECT_EQ(1, plan.num_steps);
+  EXPECT_FALSE(plan.parallel);
+
+  plan = PlanConvBatch(cpu, 1, 27, 16, sizeof(float));
+  EXPECT_EQ(1, plan.images_per_gemm);
+  EXPECT_EQ(1, plan.num_steps);
+}
+
+TEST(ConvBatch, Columns) {
+  platform::CPUPlace cpu;
+  platform::CPUDeviceContext ctx(cpu);
+  framework::Tensor src, batch, dst;
+  int* src_data = src.mutable_data<int>(framework::make_ddim({2, 3}), cpu);
+  for (int i = 0; i < 6; ++i) src_data[i] = i + 1;
+  int* batch_data = batch.mutable_data<int>(framework::make_ddim({2, 7}), cpu);
+  std::fill(batch_data, batch_data + 14, 0);
+
+  CopyToColumns<int>(ctx, src, 2, &batch);
+  // clang-format off
+  int expected[] = {
+      0, 0, 1, 2, 3, 0, 0,
+      0, 0, 4, 5, 6, 0, 0,
+  };
+  // clang-format on
+  for (int i = 0; i < 14; ++i) EXPECT_EQ(expected[i], batch_data[i]);
+
+  int* dst_data = dst.mutable_data<int>(framework::make_ddim({2, 3}), cpu);
+  CopyFromColumns<int>(ctx, batch, 2, &dst);
+  for (int i = 0; i < 6; ++i) EXPECT_EQ(src_data[i], dst_data[i]);
+}
+
+// The forward pass of GemmConvKernel for 3x3 filters with a padding of 1,
+// one gemm for each image or one for each step of the plan.
+static void Conv(const platform::CPUDeviceContext& ctx,
+                 const framework::Tensor& input,
+                 const framework::Tensor& filter, const ConvBatchPlan& plan,
+                 framework::Tensor* output) {
+  const int batch_size = input.dims()[0];
+  const int channels = input.dims()[1];
+  const int size = input.dims()[2];
+  const int64_t col_height = channels * 9;
+  const int64_t col_width = size * size;
+  const int out_channels = filter.dims()[0];
+  math::Im2ColFunctor<math::ColFormat::kCFO, platform::CPUDeviceContext, float>
+      im2col;
+  ForEachConvStep(plan, [&](int step, ConvWorkspace* workspace) {
+    const int begin = step * plan.images_per_gemm;
+    const int end = std::min(batch_size, begin + plan.images_per_gemm);
+    const int num_images = end - begin;
+    framework::Tensor& col = workspace->col;
+    col.mutable_data<float>(framework::make_ddim({channels, 3, 3, size, size}),
+                            ctx.GetPlace());
+    framework::Tensor col_matrix;
+    col_matrix.ShareDataWith(col);
+    col_matrix.Resize({col_height, col_width});
+    workspace->col_batch.mutable_data<float>(
+        {col_height, num_images * col_width}, ctx.GetPlace());
+    workspace->out_batch.mutable_data<float>(
+        {out_channels, num_images * col_width}, ctx.GetPlace());
+    for (int i = begin; i < end; ++i) {
+      framework::Tensor in_image =
+          input.Slice(i, i + 1).Resize({channels, size, size});
+      framework::Tensor out_matrix =
+          output->Slice(i, i + 1).Resize({out_channels, col_width});
+      im2col(ctx, in_image, {1, 1}, {1, 1}, {1, 1, 1, 1}, &col);
+      if (num_images == 1) {
+        math::matmul<platform::CPUDeviceContext, float>(
+            ctx, filter, false, col_matrix, false, 1.0f, &out_matrix, 0.0f);
+      } else {
+        CopyToColumns<float>(ctx, col_matrix, (i - begin) * col_width,
+                             &workspace->col_batch);
+      }
+    }
+    if (num_images == 1) return;
+    math::matmul<platform::CPUDeviceContext, float>(
+        ctx, filter, false, workspace->col_batch, false, 1.0f,
+        &workspace->out_batch, 0.0f);
+    for (int i = begin; i < end; ++i) {
+      framework::Tensor out_matrix =
+          output->Slice(i, i + 1).Resize({out_channels, col_width});
+      CopyFromColumns<float>(ctx, workspace->out_batch,
+                             (i - begin) * col_width, &out_matrix);
+    }
+  });
+}
+
+TEST(ConvBatch, BatchedGemm) {
+  // 3x3 convolutions of 512 channels on 7x7 as in the last stage of
+  // ResNet, and on 4x4.
+  platform::CPUPlace cpu;
+  platform::CPUDeviceContext ctx(cpu);
+  const int batch_size = 32;
+  const int repeat = 3;
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (int size : {7, 4}) {
+    const int channels = 512;
+    framework::Tensor input, filter, output, batched_output;
+    float* in = input.mutable_data<float>(
+        framework::make_ddim({batch_size, channels, size, size}), cpu);
+    float* f = filter.mutable_data<float>(
+        framework::make_ddim({channels, channels * 9}), cpu);
+    for (int64_t i = 0; i < input.numel(); ++i) in[i] = dist(rng);
+    for (int64_t i = 0; i < filter.numel(); ++i) f[i] = dist(rng);
+    output.mutable_data<float>(
+        framework::make_ddim({batch_size, channels, size, size}), cpu);
+    batched_output.mutable_data<float>(output.dims(), cpu);
+
+    ConvBatchPlan per_image{1, batch_size, false};
+    ConvBatchPlan plan = PlanConvBatch(cpu, batch_size, channels * 9,
+                                       size * size, sizeof(float));
+    EXPECT_GT(plan.images_per_gemm, 1);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; ++r) {
+      Conv(ctx, input, filter, per_image, &output);
+    }
+    auto per_image_end = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; ++r) {
+      Conv(ctx, input, filter, plan, &batched_output);
+    }
+    auto batched_end = std::chrono::steady_clock::now();
+
+    for (int64_t i = 0; i < output.numel(); ++i) {
+      ASSERT_NEAR(output.data<float>()[i], batched_output.data<float>()[i],
+                  1e-3);
+    }
+    LOG(INFO) << "size " << size << " channels " << channels << ": "
+              << plan.images_per_gemm << " images per gemm "
+              << std::chrono::duration<double, std::milli>(batched_end -
+                                                           per_image_end)
+                         .count() /
+                     repeat
+              << " ms, one gemm per image "
+              << std::chrono::duration<double, std::milli>(per_image_end -
+                                                           start)
+                         .count() /
+                     repeat
+              << " ms";
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
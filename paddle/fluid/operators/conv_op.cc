@@ -14,6 +14,11 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/conv_op.h"
 
+#include <gflags/gflags.h>
+#include <algorithm>
+
+DECLARE_bool(conv_autotune);
+
 namespace paddle {
 namespace operators {
 
@@ -77,18 +82,100 @@ framework::OpKernelType ConvOp::GetExpectedKernelType(
     use_cudnn &= dev_ctx.cudnn_handle() != nullptr;
   }
 #endif
-  framework::LibraryType library_;
+  std::string data_format = ctx.Attr<std::string>("data_format");
+  framework::DataLayout layout_ = framework::StringToDataLayout(data_format);
+  auto data_type = framework::ToDataType(ctx.Input<Tensor>("Input")->type());
+
+  framework::LibraryType library_ = framework::LibraryType::kPlain;
   if (use_cudnn) {
     library_ = framework::LibraryType::kCUDNN;
-  } else {
-    library_ = framework::LibraryType::kPlain;
+  } else if (FLAGS_conv_autotune && platform::is_cpu_place(ctx.GetPlace())) {
+    // Only the shapes that more than one kernel can compute are tuned.
+    auto candidates = AutotuneCandidates(ctx, data_type, layout_);
+    if (candidates.size() > 1) {
+      library_ = Autotune(ctx, data_type, layout_, candidates);
+    }
+  } else if (CanUseWinograd(ctx) && ctx.Attr<bool>("use_winograd")) {
+    library_ = framework::LibraryType::kWinograd;
   }
 
-  std::string data_format = ctx.Attr<std::string>("data_format");
-  framework::DataLayout layout_ = framework::StringToDataLayout(data_format);
-  return framework::OpKernelType(
-      framework::ToDataType(ctx.Input<Tensor>("Input")->type()), ctx.GetPlace(),
-      layout_, library_);
+  return framework::OpKernelType(data_type, ctx.GetPlace(), layout_, library_);
+}
+
+bool ConvOp::CanUseWinograd(const framework::ExecutionContext& ctx) const {
+  if (Type() != "conv2d" || !platform::is_cpu_place(ctx.GetPlace())) {
+    return false;
+  }
+  return math::IsWinogradConv(ctx.Input<Tensor>("Filter")->dims(),
+                              ctx.Attr<std::vector<int>>("strides"),
+                              ctx.Attr<std::vector<int>>("dilations"),
+                              ctx.Attr<int>("groups"));
+}
+
+std::vector<framework::LibraryType> ConvOp::AutotuneCandidates(
+    const framework::ExecutionContext& ctx,
+    framework::proto::DataType data_type,
+    framework::DataLayout layout) const {
+  std::vector<framework::LibraryType> candidates;
+  auto kernels = AllOpKernels().find(Type());
+  if (kernels == AllOpKernels().end()) return candidates;
+  auto add = [&](framework::LibraryType library) {
+    if (kernels->second.count(framework::OpKernelType(
+            data_type, ctx.GetPlace(), layout, library))) {
+      candidates.push_back(library);
+    }
+  };
+  add(framework::LibraryType::kPlain);
+  if (CanUseWinograd(ctx)) {
+    add(framework::LibraryType::kWinograd);
+  }
+  return candidates;
+}
+
+framework::LibraryType ConvOp::Autotune(
+    const framework::ExecutionContext& ctx,
+    framework::proto::DataType data_type, framework::DataLayout layout,
+    const std::vector<framework::LibraryType>& candidates) const {
+  const auto& input_dims = ctx.Input<Tensor>("Input")->dims();
+  const auto& filter_dims = ctx.Input<Tensor>("Filter")->dims();
+  framework::LibraryType library = candidates[0];
+  if (autotune_memo_.Find(input_dims, filter_dims, &library)) {
+    return library;
+  }
+
+  std::string key = ConvAlgorithmKey(
+      Type(), data_type, input_dims, filter_dims,
+      ctx.Attr<std::vector<int>>("strides"),
+      ctx.Attr<std::vector<int>>("paddings"),
+      ctx.Attr<std::vector<int>>("dilations"), ctx.Attr<int>("groups"));
+  auto& cache = ConvAlgorithmCache::Instance();
+  // A cache file written by another build may name a kernel missing here.
+  if (!cache.Find(key, &library) ||
+      std::find(candidates.begin(), candidates.end(), library) ==
+          candidates.end()) {
+    // The output in the child scope hides the output of the operator.
+    auto& scratch = ctx.scope().NewScope();
+    scratch.Var(Output("Output"))
+        ->GetMutable<framework::LoDTensor>()
+        ->Resize(ctx.Output<Tensor>("Output")->dims());
+    framework::ExecutionContext scratch_ctx(*this, scratch,
+                                            ctx.device_context());
+    auto& kernels = AllOpKernels().at(Type());
+    library = FastestConvLibrary(
+        candidates, kConvAutotuneRepeat,
+        [&](framework::LibraryType candidate) {
+          auto kernel = kernels.find(framework::OpKernelType(
+              data_type, ctx.GetPlace(), layout, candidate));
+          if (kernel == kernels.end()) return false;
+          kernel->second->Compute(scratch_ctx);
+          return true;
+        });
+    ctx.scope().DeleteScope(&scratch);
+    VLOG(3) << key << ": " << library;
+    cache.Insert(key, library);
+  }
+  autotune_memo_.Set(input_dims, filter_dims, library);
+  return library;
 }
 
 Conv2DOpMaker::Conv2DOpMaker(OpProto* proto, OpAttrChecker* op_checker)
@@ -136,6 +223,12 @@ Conv2DOpMaker::Conv2DOpMaker(OpProto* proto, OpAttrChecker* op_checker)
       "use_cudnn",
       "(bool, default false) Only used in cudnn kernel, need install cudnn")
       .SetDefault(false);
+  AddAttr<bool>(
+      "use_winograd",
+      "(bool, default false) Only used on CPU. Compute the 3x3 convolutions "
+      "of stride 1 of conv2d by the Winograd algorithm, whose transformed "
+      "filters are cached across runs.")
+      .SetDefault(false);
   AddAttr<std::string>(
       "data_format",
       "(string, default NCHW) Only used in "
@@ -329,17 +422,21 @@ REGISTER_OP(conv3d, ops::ConvOp, ops::Conv3DOpMaker, conv3d_grad,
 // TODO(xingzhaolong): neon kernel for mobile
 REGISTER_OP_CPU_KERNEL(
     depthwise_conv2d,
-    ops::GemmConvKernel<paddle::platform::CPUDeviceContext, float>,
-    ops::GemmConvKernel<paddle::platform::CPUDeviceContext, double>);
+    ops::DepthwiseConvKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::DepthwiseConvKernel<paddle::platform::CPUDeviceContext, double>);
 
 REGISTER_OP_CPU_KERNEL(
     depthwise_conv2d_grad,
-    ops::GemmConvGradKernel<paddle::platform::CPUDeviceContext, float>,
-    ops::GemmConvGradKernel<paddle::platform::CPUDeviceContext, double>);
+    ops::DepthwiseConvGradKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::DepthwiseConvGradKernel<paddle::platform::CPUDeviceContext, double>);
 
 REGISTER_OP_CPU_KERNEL(
     conv2d, ops::GemmConvKernel<paddle::platform::CPUDeviceContext, float>,
     ops::GemmConvKernel<paddle::platform::CPUDeviceContext, double>);
+REGISTER_OP_KERNEL(
+    conv2d, WINOGRAD, ::paddle::platform::CPUPlace,
+    ops::WinogradConvKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::WinogradConvKernel<paddle::platform::CPUDeviceContext, double>);
 REGISTER_OP_CPU_KERNEL(
     conv2d_grad,
     ops::GemmConvGradKernel<paddle::platform::CPUDeviceContext, float>,
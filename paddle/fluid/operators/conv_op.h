@@ -16,10 +16,13 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/conv_autotune.h"
+#include "paddle/fluid/operators/conv_batch.h"
 #include "paddle/fluid/operators/math/depthwise_conv.h"
 #include "paddle/fluid/operators/math/im2col.h"
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/operators/math/vol2col.h"
+#include "paddle/fluid/operators/math/winograd.h"
 
 namespace paddle {
 namespace operators {
@@ -46,6 +49,12 @@ inline bool IsExpand(std::vector<int64_t>& filter_dim,
   }
   return !(filter_1 && strides_1 && padding_0 && dilation_1);
 }
+inline bool IsDilated(const std::vector<int>& dilations) {
+  for (auto dilation : dilations) {
+    if (dilation != 1) return true;
+  }
+  return false;
+}
 
 // Define Op classes in .h file so that other conv
 // operator implementations can reuse the code.
@@ -67,6 +76,32 @@ class ConvOp : public framework::OperatorWithKernel {
  protected:
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override;
+
+ private:
+  // Whether the WINOGRAD kernel can compute the conv2d.
+  bool CanUseWinograd(const framework::ExecutionContext& ctx) const;
+
+  // The CPU kernels registered for the data type and layout that can compute
+  // the convolution of ctx.
+  std::vector<framework::LibraryType> AutotuneCandidates(
+      const framework::ExecutionContext& ctx,
+      framework::proto::DataType data_type,
+      framework::DataLayout layout) const;
+
+  // The fastest of the candidate kernels on the inputs of ctx. This is the
+  // one-time selection step of --conv_autotune: the kernels are timed by
+  // FastestConvLibrary on the first run of a shape, unless ConvAlgorithmCache
+  // knows it, writing a scratch output so that the outputs of the operator
+  // are only written by the chosen kernel. The later runs of the shape find
+  // the choice in autotune_memo_.
+  framework::LibraryType Autotune(
+      const framework::ExecutionContext& ctx,
+      framework::proto::DataType data_type, framework::DataLayout layout,
+      const std::vector<framework::LibraryType>& candidates) const;
+
+  static constexpr int kConvAutotuneRepeat = 3;
+
+  mutable ConvAutotuneMemo autotune_memo_;
 };
 
 class ConvOpGrad : public framework::OperatorWithKernel {
@@ -122,16 +157,6 @@ class GemmConvKernel : public framework::OpKernel<T> {
         framework::flatten_to_2d(col_shape, data_dim + 1);
 
     bool is_expand = IsExpand(filter_shape_vec, strides, paddings, dilations);
-    Tensor col;
-    // col_matrix shares the same piece of data with col,
-    // but will be reshaped into a two-dimensional matrix shape
-    // to call the matrix multiplication interface.
-    Tensor col_matrix;
-    if (is_expand) {
-      col.mutable_data<T>(col_shape, context.GetPlace());
-      col_matrix.ShareDataWith(col);
-      col_matrix.Resize(col_matrix_shape);
-    }
 
     framework::DDim input_shape = framework::slice_ddim(
         input->dims(), 1, static_cast<int>(input->dims().size()));
@@ -152,35 +177,81 @@ class GemmConvKernel : public framework::OpKernel<T> {
     math::Im2ColFunctor<math::ColFormat::kCFO, DeviceContext, T> im2col;
 
     auto& dev_ctx = context.template device_context<DeviceContext>();
-    for (int i = 0; i < batch_size; i++) {
-      Tensor in_batch = input->Slice(i, i + 1).Resize(input_shape);
-      Tensor out_batch = output->Slice(i, i + 1).Resize(output_matrix_shape);
+    const int64_t col_width = col_matrix_shape[1];
+    ConvBatchPlan plan = PlanConvBatch(context.GetPlace(), batch_size,
+                                       col_matrix_shape[0], col_width,
+                                       sizeof(T));
+    ForEachConvStep(plan, [&](int step, ConvWorkspace* workspace) {
+      const int begin = step * plan.images_per_gemm;
+      const int end = std::min(batch_size, begin + plan.images_per_gemm);
+      const int num_images = end - begin;
+      Tensor& col = workspace->col;
+      // col_matrix shares the same piece of data with col,
+      // but will be reshaped into a two-dimensional matrix shape
+      // to call the matrix multiplication interface.
+      Tensor col_matrix;
+      if (is_expand) {
+        col.mutable_data<T>(col_shape, context.GetPlace());
+      }
+      if (num_images > 1) {
+        workspace->col_batch.mutable_data<T>(
+            {col_matrix_shape[0], num_images * col_width}, context.GetPlace());
+        workspace->out_batch.mutable_data<T>(
+            {out_step, num_images * col_width}, context.GetPlace());
+      }
 
       for (int g = 0; g < groups; g++) {
-        Tensor in_slice = in_batch.Slice(g * in_step, (g + 1) * in_step);
+        Tensor filter_slice = filter.Slice(g * out_step, (g + 1) * out_step);
+        for (int i = begin; i < end; i++) {
+          Tensor in_batch = input->Slice(i, i + 1).Resize(input_shape);
+          Tensor out_batch =
+              output->Slice(i, i + 1).Resize(output_matrix_shape);
+          Tensor in_slice = in_batch.Slice(g * in_step, (g + 1) * in_step);
 
-        if (!is_expand) {
-          col.ShareDataWith(in_slice);
-          col_matrix.ShareDataWith(col);
+          if (!is_expand) {
+            col_matrix.ShareDataWith(in_slice);
+          } else {
+            if (data_dim == 2U) {
+              // im2col
+              im2col(dev_ctx, in_slice, dilations, strides,
+                     std::vector<int>{paddings[0], paddings[1], paddings[0],
+                                      paddings[1]},
+                     &col);
+            } else if (data_dim == 3U) {
+              // vol2col
+              vol2col(dev_ctx, in_slice, dilations, strides, paddings, &col);
+            }
+            col_matrix.ShareDataWith(col);
+          }
           col_matrix.Resize(col_matrix_shape);
-        } else if (data_dim == 2U) {
-          // im2col
-          im2col(dev_ctx, in_slice, dilations, strides,
-                 std::vector<int>{paddings[0], paddings[1], paddings[0],
-                                  paddings[1]},
-                 &col);
-        } else if (data_dim == 3U) {
-          // vol2col
-          vol2col(dev_ctx, in_slice, dilations, strides, paddings, &col);
-        }
 
-        // gemm
-        Tensor out_slice = out_batch.Slice(g * out_step, (g + 1) * out_step);
-        Tensor filter_slice = filter.Slice(g * out_step, (g + 1) * out_step);
-        math::matmul<DeviceContext, T>(dev_ctx, filter_slice, false, col_matrix,
-                                       false, T(1.0), &out_slice, T(0.0));
+          if (num_images == 1) {
+            // gemm
+            Tensor out_slice =
+                out_batch.Slice(g * out_step, (g + 1) * out_step);
+            math::matmul<DeviceContext, T>(dev_ctx, filter_slice, false,
+                                           col_matrix, false, T(1.0),
+                                           &out_slice, T(0.0));
+          } else {
+            CopyToColumns<T>(dev_ctx, col_matrix, (i - begin) * col_width,
+                             &workspace->col_batch);
+          }
+        }
+        if (num_images == 1) continue;
+
+        // one gemm for the images of the step
+        math::matmul<DeviceContext, T>(dev_ctx, filter_slice, false,
+                                       workspace->col_batch, false, T(1.0),
+                                       &workspace->out_batch, T(0.0));
+        for (int i = begin; i < end; i++) {
+          Tensor out_batch =
+              output->Slice(i, i + 1).Resize(output_matrix_shape);
+          Tensor out_slice = out_batch.Slice(g * out_step, (g + 1) * out_step);
+          CopyFromColumns<T>(dev_ctx, workspace->out_batch,
+                             (i - begin) * col_width, &out_slice);
+        }
       }
-    }
+    });
   }
 };
 
@@ -252,16 +323,10 @@ class GemmConvGradKernel : public framework::OpKernel<T> {
     int out_step = static_cast<int>(output_grad->dims()[1]) / groups;
 
     bool is_expand = IsExpand(filter_shape_vec, strides, paddings, dilations);
-    Tensor col;
-    // col_matrix shares the same piece of data with col,
-    // but will be reshaped into a two-dimensional matrix shape
-    // to call the matrix multiplication interface.
-    Tensor col_matrix;
-    if (is_expand) {
-      col.mutable_data<T>(col_shape, context.GetPlace());
-      col_matrix.ShareDataWith(col);
-      col_matrix.Resize(col_matrix_shape);
-    }
+    const int64_t col_width = col_matrix_shape[1];
+    ConvBatchPlan plan = PlanConvBatch(context.GetPlace(), batch_size,
+                                       col_matrix_shape[0], col_width,
+                                       sizeof(T));
 
     math::SetConstant<DeviceContext, T> set_zero;
     auto& dev_ctx = context.template device_context<DeviceContext>();
@@ -277,37 +342,82 @@ class GemmConvGradKernel : public framework::OpKernel<T> {
       math::Col2VolFunctor<DeviceContext, T> col2vol;
       math::Col2ImFunctor<math::ColFormat::kCFO, DeviceContext, T> col2im;
 
-      for (int i = 0; i < batch_size; i++) {
-        Tensor out_grad_batch =
-            output_grad->Slice(i, i + 1).Resize(output_matrix_shape);
-        Tensor in_grad_batch = input_grad->Slice(i, i + 1).Resize(input_shape);
+      ForEachConvStep(plan, [&](int step, ConvWorkspace* workspace) {
+        const int begin = step * plan.images_per_gemm;
+        const int end = std::min(batch_size, begin + plan.images_per_gemm);
+        const int num_images = end - begin;
+        Tensor& col = workspace->col;
+        // col_matrix shares the same piece of data with col,
+        // but will be reshaped into a two-dimensional matrix shape
+        // to call the matrix multiplication interface.
+        Tensor col_matrix;
+        if (is_expand) {
+          col.mutable_data<T>(col_shape, context.GetPlace());
+        }
+        if (num_images > 1) {
+          workspace->col_batch.mutable_data<T>(
+              {col_matrix_shape[0], num_images * col_width},
+              context.GetPlace());
+          workspace->out_batch.mutable_data<T>(
+              {out_step, num_images * col_width}, context.GetPlace());
+        }
+
         for (int g = 0; g < groups; g++) {
-          // gemm
-          Tensor out_grad_slice =
-              out_grad_batch.Slice(g * out_step, (g + 1) * out_step);
           Tensor filter_slice = filter.Slice(g * out_step, (g + 1) * out_step);
+          if (num_images > 1) {
+            // one gemm for the images of the step
+            for (int i = begin; i < end; i++) {
+              Tensor out_grad_batch =
+                  output_grad->Slice(i, i + 1).Resize(output_matrix_shape);
+              Tensor out_grad_slice =
+                  out_grad_batch.Slice(g * out_step, (g + 1) * out_step);
+              CopyToColumns<T>(dev_ctx, out_grad_slice,
+                               (i - begin) * col_width,
+                               &workspace->out_batch);
+            }
+            math::matmul<DeviceContext, T>(dev_ctx, filter_slice, true,
+                                           workspace->out_batch, false, T(1.0),
+                                           &workspace->col_batch, T(0.0));
+          }
 
-          Tensor in_grad_slice =
-              in_grad_batch.Slice(g * in_step, (g + 1) * in_step);
-
-          if (!is_expand) {
-            col_matrix.ShareDataWith(in_grad_slice);
+          for (int i = begin; i < end; i++) {
+            Tensor out_grad_batch =
+                output_grad->Slice(i, i + 1).Resize(output_matrix_shape);
+            Tensor in_grad_batch =
+                input_grad->Slice(i, i + 1).Resize(input_shape);
+            Tensor in_grad_slice =
+                in_grad_batch.Slice(g * in_step, (g + 1) * in_step);
+
+            if (!is_expand) {
+              col_matrix.ShareDataWith(in_grad_slice);
+            } else {
+              col_matrix.ShareDataWith(col);
+            }
             col_matrix.Resize(col_matrix_shape);
-          }
-          math::matmul<DeviceContext, T>(dev_ctx, filter_slice, true,
-                                         out_grad_slice, false, T(1.0),
-                                         &col_matrix, T(0.0));
-
-          if (is_expand && data_dim == 2U) {
-            col2im(dev_ctx, col, dilations, strides,
-                   std::vector<int>{paddings[0], paddings[1], paddings[0],
-                                    paddings[1]},
-                   &in_grad_slice);
-          } else if (is_expand && data_dim == 3U) {
-            col2vol(dev_ctx, col, dilations, strides, paddings, &in_grad_slice);
+            if (num_images == 1) {
+              // gemm
+              Tensor out_grad_slice =
+                  out_grad_batch.Slice(g * out_step, (g + 1) * out_step);
+              math::matmul<DeviceContext, T>(dev_ctx, filter_slice, true,
+                                             out_grad_slice, false, T(1.0),
+                                             &col_matrix, T(0.0));
+            } else {
+              CopyFromColumns<T>(dev_ctx, workspace->col_batch,
+                                 (i - begin) * col_width, &col_matrix);
+            }
+
+            if (is_expand && data_dim == 2U) {
+              col2im(dev_ctx, col, dilations, strides,
+                     std::vector<int>{paddings[0], paddings[1], paddings[0],
+                                      paddings[1]},
+                     &in_grad_slice);
+            } else if (is_expand && data_dim == 3U) {
+              col2vol(dev_ctx, col, dilations, strides, paddings,
+                      &in_grad_slice);
+            }
           }
         }
-      }
+      });
     }
 
     if (filter_grad) {
@@ -317,37 +427,76 @@ class GemmConvGradKernel : public framework::OpKernel<T> {
       set_zero(dev_ctx, filter_grad, static_cast<T>(0));
       math::Im2ColFunctor<math::ColFormat::kCFO, DeviceContext, T> im2col;
       math::Vol2ColFunctor<DeviceContext, T> vol2col;
-      for (int i = 0; i < batch_size; i++) {
-        Tensor out_grad_batch =
-            output_grad->Slice(i, i + 1).Resize(output_matrix_shape);
-        Tensor in_batch = input->Slice(i, i + 1).Resize(input_shape);
-        for (int g = 0; g < groups; g++) {
-          // im2col
-          Tensor out_grad_slice =
-              out_grad_batch.Slice(g * out_step, (g + 1) * out_step);
-          Tensor in_slice = in_batch.Slice(g * in_step, (g + 1) * in_step);
 
-          if (!is_expand) {
-            col.ShareDataWith(in_slice);
-            col_matrix.ShareDataWith(col);
-            col_matrix.Resize(col_matrix_shape);
-          } else if (data_dim == 2U) {
-            im2col(dev_ctx, in_slice, dilations, strides,
-                   std::vector<int>{paddings[0], paddings[1], paddings[0],
-                                    paddings[1]},
-                   &col);
-          } else if (data_dim == 3U) {
-            vol2col(dev_ctx, in_slice, dilations, strides, paddings, &col);
-          }
+      // All the steps add to filter_grad, so they run one after another;
+      // the images are still batched into larger gemms.
+      ConvBatchPlan filter_plan = plan;
+      filter_plan.parallel = false;
+      ForEachConvStep(filter_plan, [&](int step, ConvWorkspace* workspace) {
+        const int begin = step * plan.images_per_gemm;
+        const int end = std::min(batch_size, begin + plan.images_per_gemm);
+        const int num_images = end - begin;
+        Tensor& col = workspace->col;
+        Tensor col_matrix;
+        if (is_expand) {
+          col.mutable_data<T>(col_shape, context.GetPlace());
+        }
+        if (num_images > 1) {
+          workspace->col_batch.mutable_data<T>(
+              {col_matrix_shape[0], num_images * col_width},
+              context.GetPlace());
+          workspace->out_batch.mutable_data<T>(
+              {out_step, num_images * col_width}, context.GetPlace());
+        }
 
-          // gemm
+        for (int g = 0; g < groups; g++) {
           Tensor filter_grad_slice =
               filter_grad_.Slice(g * out_step, (g + 1) * out_step);
-          math::matmul<DeviceContext, T>(dev_ctx, out_grad_slice, false,
-                                         col_matrix, true, T(1.0),
-                                         &filter_grad_slice, T(1.0));
+          for (int i = begin; i < end; i++) {
+            Tensor out_grad_batch =
+                output_grad->Slice(i, i + 1).Resize(output_matrix_shape);
+            Tensor in_batch = input->Slice(i, i + 1).Resize(input_shape);
+            // im2col
+            Tensor out_grad_slice =
+                out_grad_batch.Slice(g * out_step, (g + 1) * out_step);
+            Tensor in_slice = in_batch.Slice(g * in_step, (g + 1) * in_step);
+
+            if (!is_expand) {
+              col_matrix.ShareDataWith(in_slice);
+            } else {
+              if (data_dim == 2U) {
+                im2col(dev_ctx, in_slice, dilations, strides,
+                       std::vector<int>{paddings[0], paddings[1], paddings[0],
+                                        paddings[1]},
+                       &col);
+              } else if (data_dim == 3U) {
+                vol2col(dev_ctx, in_slice, dilations, strides, paddings, &col);
+              }
+              col_matrix.ShareDataWith(col);
+            }
+            col_matrix.Resize(col_matrix_shape);
+
+            if (num_images == 1) {
+              // gemm
+              math::matmul<DeviceContext, T>(dev_ctx, out_grad_slice, false,
+                                             col_matrix, true, T(1.0),
+                                             &filter_grad_slice, T(1.0));
+            } else {
+              CopyToColumns<T>(dev_ctx, col_matrix, (i - begin) * col_width,
+                               &workspace->col_batch);
+              CopyToColumns<T>(dev_ctx, out_grad_slice,
+                               (i - begin) * col_width,
+                               &workspace->out_batch);
+            }
+          }
+          if (num_images > 1) {
+            // one gemm for the images of the step
+            math::matmul<DeviceContext, T>(dev_ctx, workspace->out_batch,
+                                           false, workspace->col_batch, true,
+                                           T(1.0), &filter_grad_slice, T(1.0));
+          }
         }
-      }
+      });
     }
   }
 };
@@ -368,6 +517,12 @@ class DepthwiseConvKernel : public framework::OpKernel<T> {
     std::vector<int> paddings = context.Attr<std::vector<int>>("paddings");
     std::vector<int> dilations = context.Attr<std::vector<int>>("dilations");
 
+    // The direct CPU kernels do not dilate the filter.
+    if (platform::is_cpu_place(context.GetPlace()) && IsDilated(dilations)) {
+      GemmConvKernel<DeviceContext, T>().Compute(context);
+      return;
+    }
+
     math::DepthwiseConvFunctor<DeviceContext, T> depthwiseConv;
 
     auto& dev_ctx = context.template device_context<DeviceContext>();
@@ -394,6 +549,11 @@ class DepthwiseConvGradKernel : public framework::OpKernel<T> {
     std::vector<int> paddings = context.Attr<std::vector<int>>("paddings");
     std::vector<int> dilations = context.Attr<std::vector<int>>("dilations");
 
+    if (platform::is_cpu_place(context.GetPlace()) && IsDilated(dilations)) {
+      GemmConvGradKernel<DeviceContext, T>().Compute(context);
+      return;
+    }
+
     math::SetConstant<DeviceContext, T> set_zero;
     auto& dev_ctx = context.template device_context<DeviceContext>();
 
@@ -418,5 +578,29 @@ class DepthwiseConvGradKernel : public framework::OpKernel<T> {
   }
 };
 
+// The conv2d kernel of the WINOGRAD library, chosen on CPU by
+// ConvOp::GetExpectedKernelType for the 3x3 filters of stride 1 when
+// use_winograd is set. The gradients are computed by GemmConvGradKernel.
+template <typename DeviceContext, typename T>
+class WinogradConvKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    const Tensor* input = context.Input<Tensor>("Input");
+    const Tensor* filter = context.Input<Tensor>("Filter");
+    Tensor* output = context.Output<Tensor>("Output");
+    output->mutable_data<T>(context.GetPlace());
+
+    std::vector<int> paddings = context.Attr<std::vector<int>>("paddings");
+    const int tile_size =
+        math::WinogradTileSize(output->dims()[2], output->dims()[3]);
+
+    auto& dev_ctx = context.template device_context<DeviceContext>();
+    Tensor transformed_filter = math::WinogradFilterCache<T>::Instance().Get(
+        dev_ctx, *filter, tile_size);
+    math::WinogradConvFunctor<DeviceContext, T> winograd;
+    winograd(dev_ctx, *input, transformed_filter, tile_size, paddings, output);
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/conv_batch.h"
 #include "paddle/fluid/operators/math/im2col.h"
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/operators/math/vol2col.h"
@@ -95,15 +96,6 @@ class GemmConvTransposeKernel : public framework::OpKernel<T> {
     // size: (c * k_h * k_w, h * w) or (c * k_d * k_h * k_w, d * h * w)
     DDim col_matrix_shape = framework::flatten_to_2d(col_shape, data_dim + 1);
 
-    Tensor col;
-    col.mutable_data<T>(col_shape, context.GetPlace());
-    // col_matrix shares the same piece of data with col,
-    // but will be reshaped into a two-dimensional matrix shape
-    // to call the matrix multiplication interface.
-    Tensor col_matrix;
-    col_matrix.ShareDataWith(col);
-    col_matrix.Resize(col_matrix_shape);
-
     // output size: (c, o_h, o_w) or (c, o_d, o_h, o_w)
     DDim output_shape =
         framework::slice_ddim(output->dims(), 1, output->dims().size());
@@ -125,32 +117,76 @@ class GemmConvTransposeKernel : public framework::OpKernel<T> {
 
     // convolution transpose: gemm + col2im or col2vol (similar to conv-backward
     // on input)
-    for (int i = 0; i < batch_size; i++) {
-      // batch with size (m, h * w) or (m, d * h * w)
-      Tensor input_batch = input->Slice(i, i + 1).Resize(input_matrix_shape);
-
-      // output size: (c, o_h, o_w) or (c, o_d, o_h, o_w)
-      Tensor output_batch = output->Slice(i, i + 1).Resize(output_shape);
-
-      // col_matrix = filter * input_batch
-      // of shape (c * k_h * k_w, h * w) or (c * k_d * k_h * k_w, d * h * w)
-      math::matmul<DeviceContext, T>(dev_ctx, filter, true, input_batch, false,
-                                     static_cast<T>(1.0), &col_matrix,
-                                     static_cast<T>(0.0));
-
-      if (data_dim == 2U) {
-        // col2im: col_matrix -> dy
-        // from (c * k_h * k_w, h * w) to (c, o_h, o_w)
-        col2im(dev_ctx, col, dilations, strides,
-               std::vector<int>{paddings[0], paddings[1], paddings[0],
-                                paddings[1]},
-               &output_batch);
-      } else if (data_dim == 3U) {
-        // col2vol: col_matrix -> dy
-        // from (c * k_d * k_h * k_w, d * h * w) to (c, o_d, o_h, o_w)
-        col2vol(dev_ctx, col, dilations, strides, paddings, &output_batch);
+    const int64_t col_width = col_matrix_shape[1];
+    ConvBatchPlan plan = PlanConvBatch(context.GetPlace(), batch_size,
+                                       col_matrix_shape[0], col_width,
+                                       sizeof(T));
+    ForEachConvStep(plan, [&](int step, ConvWorkspace* workspace) {
+      const int begin = step * plan.images_per_gemm;
+      const int end = std::min(batch_size, begin + plan.images_per_gemm);
+      const int num_images = end - begin;
+      Tensor& col = workspace->col;
+      col.mutable_data<T>(col_shape, context.GetPlace());
+      // col_matrix shares the same piece of data with col,
+      // but will be reshaped into a two-dimensional matrix shape
+      // to call the matrix multiplication interface.
+      Tensor col_matrix;
+      col_matrix.ShareDataWith(col);
+      col_matrix.Resize(col_matrix_shape);
+
+      if (num_images > 1) {
+        // one gemm for the images of the step:
+        // (c * k_h * k_w, n * h * w) = filter^T * (m, n * h * w)
+        Tensor& input_batches = workspace->out_batch;
+        input_batches.mutable_data<T>(
+            {input_matrix_shape[0], num_images * col_width},
+            context.GetPlace());
+        for (int i = begin; i < end; i++) {
+          Tensor input_batch =
+              input->Slice(i, i + 1).Resize(input_matrix_shape);
+          CopyToColumns<T>(dev_ctx, input_batch, (i - begin) * col_width,
+                           &input_batches);
+        }
+        workspace->col_batch.mutable_data<T>(
+            {col_matrix_shape[0], num_images * col_width}, context.GetPlace());
+        math::matmul<DeviceContext, T>(dev_ctx, filter, true, input_batches,
+                                       false, static_cast<T>(1.0),
+                                       &workspace->col_batch,
+                                       static_cast<T>(0.0));
       }
-    }
+
+      for (int i = begin; i < end; i++) {
+        // output size: (c, o_h, o_w) or (c, o_d, o_h, o_w)
+        Tensor output_batch = output->Slice(i, i + 1).Resize(output_shape);
+
+        if (num_images == 1) {
+          // batch with size (m, h * w) or (m, d * h * w)
+          Tensor input_batch =
+              input->Slice(i, i + 1).Resize(input_matrix_shape);
+          // col_matrix = filter * input_batch
+          // of shape (c * k_h * k_w, h * w) or (c * k_d * k_h * k_w, d * h * w)
+          math::matmul<DeviceContext, T>(dev_ctx, filter, true, input_batch,
+                                         false, static_cast<T>(1.0),
+                                         &col_matrix, static_cast<T>(0.0));
+        } else {
+          CopyFromColumns<T>(dev_ctx, workspace->col_batch,
+                             (i - begin) * col_width, &col_matrix);
+        }
+
+        if (data_dim == 2U) {
+          // col2im: col_matrix -> dy
+          // from (c * k_h * k_w, h * w) to (c, o_h, o_w)
+          col2im(dev_ctx, col, dilations, strides,
+                 std::vector<int>{paddings[0], paddings[1], paddings[0],
+                                  paddings[1]},
+                 &output_batch);
+        } else if (data_dim == 3U) {
+          // col2vol: col_matrix -> dy
+          // from (c * k_d * k_h * k_w, d * h * w) to (c, o_d, o_h, o_w)
+          col2vol(dev_ctx, col, dilations, strides, paddings, &output_batch);
+        }
+      }
+    });
   }
 };
 
@@ -214,15 +250,6 @@ class GemmConvTransposeGradKernel : public framework::OpKernel<T> {
     // input need to compute gradient
     auto& dev_ctx = context.template device_context<DeviceContext>();
     if (input_grad || filter_grad) {
-      Tensor col;
-      col.mutable_data<T>(col_shape, context.GetPlace());
-      // col_matrix shares the same piece of data with col,
-      // but will be reshaped into a two-dimensional matrix shape
-      // to call the matrix multiplication interface.
-      Tensor col_matrix;
-      col_matrix.ShareDataWith(col);
-      col_matrix.Resize(col_matrix_shape);
-
       Tensor filter_grad_;
       math::SetConstant<DeviceContext, T> set_zero;
 
@@ -239,51 +266,112 @@ class GemmConvTransposeGradKernel : public framework::OpKernel<T> {
         filter_grad_.Resize(filter_matrix_shape);
       }
 
-      for (int i = 0; i < batch_size; i++) {
-        // batch with size (c, o_h * o_w)
-        Tensor output_grad_batch =
-            output_grad->Slice(i, i + 1).Resize(output_shape);
+      const int64_t col_width = col_matrix_shape[1];
+      ConvBatchPlan plan = PlanConvBatch(context.GetPlace(), batch_size,
+                                         col_matrix_shape[0], col_width,
+                                         sizeof(T));
+      // All the steps add to filter_grad, so they run one after another.
+      plan.parallel = plan.parallel && !filter_grad;
+      ForEachConvStep(plan, [&](int step, ConvWorkspace* workspace) {
+        const int begin = step * plan.images_per_gemm;
+        const int end = std::min(batch_size, begin + plan.images_per_gemm);
+        const int num_images = end - begin;
+        Tensor& col = workspace->col;
+        col.mutable_data<T>(col_shape, context.GetPlace());
+        // col_matrix shares the same piece of data with col,
+        // but will be reshaped into a two-dimensional matrix shape
+        // to call the matrix multiplication interface.
+        Tensor col_matrix;
+        col_matrix.ShareDataWith(col);
+        col_matrix.Resize(col_matrix_shape);
+        if (num_images > 1) {
+          workspace->col_batch.mutable_data<T>(
+              {col_matrix_shape[0], num_images * col_width},
+              context.GetPlace());
+          workspace->out_batch.mutable_data<T>(
+              {input_matrix_shape[0], num_images * col_width},
+              context.GetPlace());
+        }
 
-        if (data_dim == 2U) {
-          // im2col: dy -> col matrix
-          // from (c, o_h, o_w) to (c * k_h * k_w, h * w)
-          im2col(dev_ctx, output_grad_batch, dilations, strides,
-                 std::vector<int>{paddings[0], paddings[1], paddings[0],
-                                  paddings[1]},
-                 &col);
-        } else if (data_dim == 3U) {
-          // vol2col: dy -> col_matrix
-          // from (c, o_d, o_h, o_w) to (c * k_d * k_h * k_w, d * h * w)
-          vol2col(dev_ctx, output_grad_batch, dilations, strides, paddings,
-                  &col);
+        for (int i = begin; i < end; i++) {
+          // batch with size (c, o_h * o_w)
+          Tensor output_grad_batch =
+              output_grad->Slice(i, i + 1).Resize(output_shape);
+
+          if (data_dim == 2U) {
+            // im2col: dy -> col matrix
+            // from (c, o_h, o_w) to (c * k_h * k_w, h * w)
+            im2col(dev_ctx, output_grad_batch, dilations, strides,
+                   std::vector<int>{paddings[0], paddings[1], paddings[0],
+                                    paddings[1]},
+                   &col);
+          } else if (data_dim == 3U) {
+            // vol2col: dy -> col_matrix
+            // from (c, o_d, o_h, o_w) to (c * k_d * k_h * k_w, d * h * w)
+            vol2col(dev_ctx, output_grad_batch, dilations, strides, paddings,
+                    &col);
+          }
+          if (num_images > 1) {
+            CopyToColumns<T>(dev_ctx, col_matrix, (i - begin) * col_width,
+                             &workspace->col_batch);
+            continue;
+          }
+
+          if (input_grad) {
+            // batch with size (m, h, w)
+            Tensor input_grad_batch =
+                input_grad->Slice(i, i + 1).Resize(input_matrix_shape);
+            // gemm: dx = filter * dy
+            // (m, c * k_h * k_w) * (c * k_h * k_w, h * w) -> (m, h * w)
+            // or
+            // (m, c * k_d * k_h * k_w) * (c * k_d * k_h * k_w, d * h * w) ->
+            // (m, d, h, w)
+            math::matmul<DeviceContext, T>(
+                dev_ctx, filter, false, col_matrix, false, static_cast<T>(1.0),
+                &input_grad_batch, static_cast<T>(0.0));
+          }
+          if (filter_grad) {
+            // input batch
+            Tensor in_batch = input->Slice(i, i + 1).Resize(input_matrix_shape);
+            // gemm: d_filter = x * dy^T
+            // (m, c * h * w) * (k_h * k_w, c * h * w) -> (m, k_h * k_w)
+            // or
+            // (m, d * h * w) * (d * h * w, c * k_d * k_h * k_w) -> (m, c *
+            // k_d * k_h * k_w)
+            math::matmul<DeviceContext, T>(dev_ctx, in_batch, false,
+                                           col_matrix, true,
+                                           static_cast<T>(1.0), &filter_grad_,
+                                           static_cast<T>(1.0));
+          }
         }
+        if (num_images == 1) return;
 
+        // one gemm for the images of the step, on the columns of all of
+        // them: (m, n * h * w) or (m, n * d * h * w)
+        Tensor& batches = workspace->out_batch;
         if (input_grad) {
-          // batch with size (m, h, w)
-          Tensor input_grad_batch =
-              input_grad->Slice(i, i + 1).Resize(input_matrix_shape);
-          // gemm: dx = filter * dy
-          // (m, c * k_h * k_w) * (c * k_h * k_w, h * w) -> (m, h * w)
-          // or
-          // (m, c * k_d * k_h * k_w) * (c * k_d * k_h * k_w, d * h * w) -> (m,
-          // d, h, w)
           math::matmul<DeviceContext, T>(
-              dev_ctx, filter, false, col_matrix, false, static_cast<T>(1.0),
-              &input_grad_batch, static_cast<T>(0.0));
+              dev_ctx, filter, false, workspace->col_batch, false,
+              static_cast<T>(1.0), &batches, static_cast<T>(0.0));
+          for (int i = begin; i < end; i++) {
+            Tensor input_grad_batch =
+                input_grad->Slice(i, i + 1).Resize(input_matrix_shape);
+            CopyFromColumns<T>(dev_ctx, batches, (i - begin) * col_width,
+                               &input_grad_batch);
+          }
         }
         if (filter_grad) {
-          // input batch
-          Tensor in_batch = input->Slice(i, i + 1).Resize(input_matrix_shape);
-          // gemm: d_filter = x * dy^T
-          // (m, c * h * w) * (k_h * k_w, c * h * w) -> (m, k_h * k_w)
-          // or
-          // (m, d * h * w) * (d * h * w, c * k_d * k_h * k_w) -> (m, c * k_d *
-          // k_h * k_w)
-          math::matmul<DeviceContext, T>(dev_ctx, in_batch, false, col_matrix,
-                                         true, static_cast<T>(1.0),
-                                         &filter_grad_, static_cast<T>(1.0));
+          for (int i = begin; i < end; i++) {
+            Tensor in_batch = input->Slice(i, i + 1).Resize(input_matrix_shape);
+            CopyToColumns<T>(dev_ctx, in_batch, (i - begin) * col_width,
+                             &batches);
+          }
+          math::matmul<DeviceContext, T>(dev_ctx, batches, false,
+                                         workspace->col_batch, true,
+                                         static_cast<T>(1.0), &filter_grad_,
+                                         static_cast<T>(1.0));
         }
-      }
+      });
     }
   }
 };
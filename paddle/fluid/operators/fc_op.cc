@@ -0,0 +1,109 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fc_op.h"
+
+namespace paddle {
+namespace operators {
+
+class FCOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("Input"),
+                   "Input(Input) of FCOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("W"), "Input(W) of FCOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                   "Output(Out) of FCOp should not be null.");
+
+    auto in_dims = ctx->GetInputDim("Input");
+    auto w_dims = ctx->GetInputDim("W");
+    int in_num_col_dims = ctx->Attrs().Get<int>("in_num_col_dims");
+
+    PADDLE_ENFORCE_EQ(w_dims.size(), 2, "Input(W) of FCOp should be 2-D.");
+    PADDLE_ENFORCE_GT(
+        in_dims.size(), in_num_col_dims,
+        "The rank of Input(Input) of FCOp should be larger than "
+        "in_num_col_dims.");
+    auto in_mat_dims = framework::flatten_to_2d(in_dims, in_num_col_dims);
+    PADDLE_ENFORCE_EQ(
+        in_mat_dims[1], w_dims[0],
+        "The width of flattened Input(Input) must be equal to the height of "
+        "Input(W).");
+
+    if (ctx->HasInput("Bias")) {
+      auto bias_dims = ctx->GetInputDim("Bias");
+      PADDLE_ENFORCE_EQ(framework::product(bias_dims), w_dims[1],
+                        "The size of Input(Bias) of FCOp should be equal to "
+                        "the width of Input(W).");
+    }
+
+    std::vector<int64_t> out_dims;
+    out_dims.reserve(static_cast<size_t>(in_num_col_dims + 1));
+    for (int i = 0; i < in_num_col_dims; ++i) {
+      out_dims.push_back(in_dims[i]);
+    }
+    out_dims.push_back(w_dims[1]);
+
+    ctx->SetOutputDim("Out", framework::make_ddim(out_dims));
+    ctx->ShareLoD("Input", /*->*/ "Out");
+  }
+};
+
+class FCOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  FCOpMaker(OpProto* proto, OpAttrChecker* op_checker)
+      : OpProtoAndCheckerMaker(proto, op_checker) {
+    AddInput("Input", "(Tensor) The input tensor of fc operator.");
+    AddInput("W", "(Tensor) The 2-D weight matrix of fc operator.");
+    AddInput("Bias",
+             "(Tensor, optional) The bias of fc operator, its size equals the "
+             "width of W.")
+        .AsDispensable();
+    AddOutput("Out", "(Tensor) The output tensor of fc operator.");
+    AddAttr<int>("in_num_col_dims",
+                 "(int, default 1) Same as x_num_col_dims of mul operator, "
+                 "the first `in_num_col_dims` dimensions of Input are "
+                 "flattened to form the height of the input matrix.")
+        .SetDefault(1)
+        .EqualGreaterThan(1);
+    AddAttr<std::string>("activation_type",
+                         "(string, default identity) The activation applied "
+                         "to the output, one of identity, relu, sigmoid and "
+                         "tanh.")
+        .SetDefault("identity");
+    AddComment(R"DOC(
+FC Operator.
+
+Fully connected operator for inference, it computes
+
+$$Out = act(Input * W + Bias)$$
+
+in a single kernel. It is not created by the python API directly but by the
+`fuse_fc` inference pass, which rewrites `mul`, `elementwise_add` and an
+activation operator into one `fc` operator, so there is no gradient operator.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(fc, ops::FCOp, ops::FCOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    fc, ops::FCKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::FCKernel<paddle::platform::CPUDeviceContext, double>);
@@ -0,0 +1,64 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/bias_activation.h"
+#include "paddle/fluid/operators/math/math_function.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+template <typename DeviceContext, typename T>
+class FCKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    PADDLE_ENFORCE(platform::is_cpu_place(context.GetPlace()),
+                   "fc only supports CPUPlace.");
+    const Tensor* input = context.Input<Tensor>("Input");
+    const Tensor* w = context.Input<Tensor>("W");
+    const Tensor* bias = context.Input<Tensor>("Bias");
+    Tensor* out = context.Output<Tensor>("Out");
+
+    int in_num_col_dims = context.Attr<int>("in_num_col_dims");
+    FusedActivation act =
+        GetFusedActivation(context.Attr<std::string>("activation_type"));
+
+    const Tensor in_matrix =
+        input->dims().size() > 2
+            ? framework::ReshapeToMatrix(*input, in_num_col_dims)
+            : *input;
+
+    out->mutable_data<T>(context.GetPlace());
+    auto out_dims = out->dims();
+    const int64_t rows = in_matrix.dims()[0];
+    const int64_t cols = w->dims()[1];
+    out->Resize({rows, cols});
+    math::matmul<DeviceContext, T>(
+        context.template device_context<DeviceContext>(), in_matrix, false, *w,
+        false, 1, out, 0);
+    // Add the bias and apply the activation while the gemm output is still
+    // hot in cache, instead of materializing two more intermediates.
+    BiasActivation<T>(bias ? bias->data<T>() : nullptr, out->data<T>(), rows,
+                      cols, 1, act);
+    out->Resize(out_dims);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -98,6 +98,7 @@ class ListenAndServOp : public framework::OperatorBase {
     auto *block = Attr<framework::BlockDesc *>(kOptimizeBlock);
     auto *program = block->Program();
     framework::Executor executor(dev_place);
+    auto ctx = executor.Prepare(*program, block->ID());
 
     // TODO(typhoonzero): change this to a while_op for every cluster-batch.
     bool exit_flag = false;
@@ -157,8 +158,9 @@ class ListenAndServOp : public framework::OperatorBase {
       }
       VLOG(3) << "run optimize graph...";
       try {
-        executor.Run(*program, &recv_scope, block->ID(), /*global_block*/
-                     false /*create_local_scope*/, false /*create_vars*/);
+        executor.RunPreparedContext(ctx.get(), &recv_scope,
+                                    false /*create_local_scope*/,
+                                    false /*create_vars*/);
       } catch (std::exception &e) {
         LOG(ERROR) << "run sub program error " << e.what();
       }
@@ -61,7 +61,9 @@ class LookupTableOpMaker : public framework::OpProtoAndCheckerMaker {
              "contains the ids to be looked up in W. "
              "Ids must be a column vector with rank = 2. "
              "The 2nd dimension size must be 1.");
-    AddOutput("Out", "The lookup results, which have the same type as W.");
+    AddOutput("Out",
+              "The lookup results, which have the same type as W, except "
+              "that a float16 W is looked up into float32 results.");
     AddAttr<bool>("is_sparse",
                   "(boolean, default false) "
                   "Sparse update")
@@ -142,6 +144,7 @@ REGISTER_OPERATOR(lookup_table_grad, ops::LookupTableOpGrad,
                   ops::LookupTableOpGradVarTypeInference);
 
 REGISTER_OP_CPU_KERNEL(lookup_table, ops::LookupTableKernel<float>,
-                       ops::LookupTableKernel<double>);
+                       ops::LookupTableKernel<double>,
+                       ops::LookupTableFP16Kernel);
 REGISTER_OP_CPU_KERNEL(lookup_table_grad, ops::LookupTableGradKernel<float>,
                        ops::LookupTableGradKernel<double>);
@@ -18,6 +18,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/platform/float16_convert.h"
 
 namespace paddle {
 namespace operators {
@@ -60,6 +61,35 @@ class LookupTableKernel : public framework::OpKernel<T> {
   }
 };
 
+// A float16 table is a storage format only: the looked up rows are converted
+// to float, so the table takes half the memory and bandwidth while the rest
+// of the network still computes in float.
+class LookupTableFP16Kernel : public framework::OpKernel<float16> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto* table_t = context.Input<LoDTensor>("W");
+    auto* ids_t = context.Input<LoDTensor>("Ids");
+    auto* output_t = context.Output<LoDTensor>("Out");
+    int64_t padding_idx = context.Attr<int64_t>("padding_idx");
+
+    int N = table_t->dims()[0];
+    int D = table_t->dims()[1];
+    auto* ids = ids_t->data<int64_t>();
+    auto* table = table_t->data<float16>();
+    auto* output = output_t->mutable_data<float>(context.GetPlace());
+
+    for (int64_t i = 0; i < ids_t->numel(); ++i) {
+      if (padding_idx != -1 && ids[i] == padding_idx) {
+        memset(output + i * D, 0, D * sizeof(float));
+      } else {
+        PADDLE_ENFORCE_LT(ids[i], N);
+        PADDLE_ENFORCE_GE(ids[i], 0);
+        platform::Float16ToFloat(table + ids[i] * D, output + i * D, D);
+      }
+    }
+  }
+};
+
 template <typename T>
 class LookupTableGradKernel : public framework::OpKernel<T> {
  public:
@@ -0,0 +1,295 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/depthwise_conv.h"
+#include <algorithm>
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * The CPU kernels compute the convolution directly, one filter tap at a
+ * time: for the tap (kh, kw), a row of the output is a strided row of the
+ * input scaled by the weight, over the output positions whose input
+ * position is not in the padding. The innermost loops run along the output
+ * width with no branch, so that the compiler vectorizes them.
+ *
+ * The planes (image, channel) are independent and processed in parallel.
+ */
+
+// The output positions o in [0, output_size) whose input position
+// o * stride + offset is in [0, input_size) are [*begin, *end).
+static inline void ValidRange(int input_size, int output_size, int stride,
+                              int offset, int* begin, int* end) {
+  *begin = offset >= 0 ? 0 : (-offset + stride - 1) / stride;
+  *end = input_size - 1 - offset < 0
+             ? 0
+             : std::min(output_size, (input_size - 1 - offset) / stride + 1);
+  *begin = std::min(*begin, *end);
+}
+
+/*
+ * All tensors are in NCHW format.
+ * Ksize, strides, paddings are two elements. These two elements represent
+ * height and width, respectively.
+ */
+template <typename T>
+class DepthwiseConvFunctor<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings, framework::Tensor* output) {
+    const int batch_size = input.dims()[0];
+    const int input_channels = input.dims()[1];
+    const int input_height = input.dims()[2];
+    const int input_width = input.dims()[3];
+    const int output_channels = output->dims()[1];
+    const int output_height = output->dims()[2];
+    const int output_width = output->dims()[3];
+    const int ksize_height = filter.dims()[2];
+    const int ksize_width = filter.dims()[3];
+    const int stride_height = strides[0];
+    const int stride_width = strides[1];
+    const int padding_height = paddings[0];
+    const int padding_width = paddings[1];
+    const int filter_multiplier = output_channels / input_channels;
+
+    const T* input_data = input.data<T>();
+    const T* filter_data = filter.data<T>();
+    T* output_data = output->mutable_data<T>(context.GetPlace());
+
+    const int input_plane = input_height * input_width;
+    const int output_plane = output_height * output_width;
+    const int num_planes = batch_size * output_channels;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int plane = 0; plane < num_planes; ++plane) {
+      const int batch = plane / output_channels;
+      const int c_out = plane % output_channels;
+      const int c_in = c_out / filter_multiplier;
+      const T* in =
+          input_data + (batch * input_channels + c_in) * input_plane;
+      const T* weight = filter_data + c_out * ksize_height * ksize_width;
+      T* out = output_data + plane * output_plane;
+      std::fill(out, out + output_plane, static_cast<T>(0));
+
+      for (int h_out = 0; h_out < output_height; ++h_out) {
+        T* out_row = out + h_out * output_width;
+        for (int kh = 0; kh < ksize_height; ++kh) {
+          const int h_in = h_out * stride_height - padding_height + kh;
+          if (h_in < 0 || h_in >= input_height) continue;
+          const T* in_row = in + h_in * input_width;
+          for (int kw = 0; kw < ksize_width; ++kw) {
+            const int offset = kw - padding_width;
+            int begin, end;
+            ValidRange(input_width, output_width, stride_width, offset,
+                       &begin, &end);
+            if (begin == end) continue;
+            const T w = weight[kh * ksize_width + kw];
+            // Form the pointer from the first in-range column only; the
+            // row start plus a negative offset would point before in.
+            const T* src = in_row + (begin * stride_width + offset);
+            if (stride_width == 1) {
+              for (int w_out = begin; w_out < end; ++w_out) {
+                out_row[w_out] += w * src[w_out - begin];
+              }
+            } else {
+              for (int w_out = begin; w_out < end; ++w_out) {
+                out_row[w_out] += w * src[(w_out - begin) * stride_width];
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+};
+
+template <typename T>
+class DepthwiseConvInputGradFunctor<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const framework::Tensor& output_grad,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  framework::Tensor* input_grad) {
+    const int batch_size = input.dims()[0];
+    const int input_channels = input.dims()[1];
+    const int input_height = input.dims()[2];
+    const int input_width = input.dims()[3];
+    const int output_channels = output_grad.dims()[1];
+    const int output_height = output_grad.dims()[2];
+    const int output_width = output_grad.dims()[3];
+    const int ksize_height = filter.dims()[2];
+    const int ksize_width = filter.dims()[3];
+    const int stride_height = strides[0];
+    const int stride_width = strides[1];
+    const int padding_height = paddings[0];
+    const int padding_width = paddings[1];
+    const int filter_multiplier = output_channels / input_channels;
+
+    const T* filter_data = filter.data<T>();
+    const T* output_grad_data = output_grad.data<T>();
+    T* input_grad_data = input_grad->mutable_data<T>(context.GetPlace());
+
+    const int input_plane = input_height * input_width;
+    const int output_plane = output_height * output_width;
+    const int num_planes = batch_size * input_channels;
+    // Each input plane gathers the gradients of its filter_multiplier
+    // output planes, so that no two threads write to the same plane.
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int plane = 0; plane < num_planes; ++plane) {
+      const int batch = plane / input_channels;
+      const int c_in = plane % input_channels;
+      T* in_grad = input_grad_data + plane * input_plane;
+
+      for (int m = 0; m < filter_multiplier; ++m) {
+        const int c_out = c_in * filter_multiplier + m;
+        const T* out_grad = output_grad_data +
+                            (batch * output_channels + c_out) * output_plane;
+        const T* weight = filter_data + c_out * ksize_height * ksize_width;
+
+        for (int h_out = 0; h_out < output_height; ++h_out) {
+          const T* out_grad_row = out_grad + h_out * output_width;
+          for (int kh = 0; kh < ksize_height; ++kh) {
+            const int h_in = h_out * stride_height - padding_height + kh;
+            if (h_in < 0 || h_in >= input_height) continue;
+            T* in_grad_row = in_grad + h_in * input_width;
+            for (int kw = 0; kw < ksize_width; ++kw) {
+              const int offset = kw - padding_width;
+              int begin, end;
+              ValidRange(input_width, output_width, stride_width, offset,
+                         &begin, &end);
+              if (begin == end) continue;
+              const T w = weight[kh * ksize_width + kw];
+              T* dst = in_grad_row + (begin * stride_width + offset);
+              if (stride_width == 1) {
+                for (int w_out = begin; w_out < end; ++w_out) {
+                  dst[w_out - begin] += w * out_grad_row[w_out];
+                }
+              } else {
+                for (int w_out = begin; w_out < end; ++w_out) {
+                  dst[(w_out - begin) * stride_width] +=
+                      w * out_grad_row[w_out];
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+};
+
+template <typename T>
+class DepthwiseConvFilterGradFunctor<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& output_grad,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  framework::Tensor* filter_grad) {
+    const int batch_size = input.dims()[0];
+    const int input_channels = input.dims()[1];
+    const int input_height = input.dims()[2];
+    const int input_width = input.dims()[3];
+    const int output_channels = output_grad.dims()[1];
+    const int output_height = output_grad.dims()[2];
+    const int output_width = output_grad.dims()[3];
+    const int ksize_height = filter_grad->dims()[2];
+    const int ksize_width = filter_grad->dims()[3];
+    const int stride_height = strides[0];
+    const int stride_width = strides[1];
+    const int padding_height = paddings[0];
+    const int padding_width = paddings[1];
+    const int filter_multiplier = output_channels / input_channels;
+
+    const T* input_data = input.data<T>();
+    const T* output_grad_data = output_grad.data<T>();
+    T* filter_grad_data = filter_grad->mutable_data<T>(context.GetPlace());
+
+    const int input_plane = input_height * input_width;
+    const int output_plane = output_height * output_width;
+    // Each output channel sums over the batch into its own filter.
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int c_out = 0; c_out < output_channels; ++c_out) {
+      const int c_in = c_out / filter_multiplier;
+      T* weight_grad = filter_grad_data + c_out * ksize_height * ksize_width;
+
+      for (int batch = 0; batch < batch_size; ++batch) {
+        const T* in =
+            input_data + (batch * input_channels + c_in) * input_plane;
+        const T* out_grad = output_grad_data +
+                            (batch * output_channels + c_out) * output_plane;
+
+        for (int h_out = 0; h_out < output_height; ++h_out) {
+          const T* out_grad_row = out_grad + h_out * output_width;
+          for (int kh = 0; kh < ksize_height; ++kh) {
+            const int h_in = h_out * stride_height - padding_height + kh;
+            if (h_in < 0 || h_in >= input_height) continue;
+            const T* in_row = in + h_in * input_width;
+            for (int kw = 0; kw < ksize_width; ++kw) {
+              const int offset = kw - padding_width;
+              int begin, end;
+              ValidRange(input_width, output_width, stride_width, offset,
+                         &begin, &end);
+              if (begin == end) continue;
+              const T* src = in_row + (begin * stride_width + offset);
+              T sum = 0;
+              if (stride_width == 1) {
+                for (int w_out = begin; w_out < end; ++w_out) {
+                  sum += out_grad_row[w_out] * src[w_out - begin];
+                }
+              } else {
+                for (int w_out = begin; w_out < end; ++w_out) {
+                  sum += out_grad_row[w_out] *
+                         src[(w_out - begin) * stride_width];
+                }
+              }
+              weight_grad[kh * ksize_width + kw] += sum;
+            }
+          }
+        }
+      }
+    }
+  }
+};
+
+template class DepthwiseConvFunctor<platform::CPUDeviceContext, float>;
+template class DepthwiseConvFunctor<platform::CPUDeviceContext, double>;
+
+template class DepthwiseConvInputGradFunctor<platform::CPUDeviceContext,
+                                             float>;
+template class DepthwiseConvInputGradFunctor<platform::CPUDeviceContext,
+                                             double>;
+
+template class DepthwiseConvFilterGradFunctor<platform::CPUDeviceContext,
+                                              float>;
+template class DepthwiseConvFilterGradFunctor<platform::CPUDeviceContext,
+                                              double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
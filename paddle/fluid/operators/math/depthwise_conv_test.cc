@@ -0,0 +1,223 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/depthwise_conv.h"
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "paddle/fluid/operators/math/im2col.h"
+#include "paddle/fluid/operators/math/math_function.h"
+
+namespace {
+
+using paddle::framework::Tensor;
+using paddle::framework::make_ddim;
+using paddle::platform::CPUDeviceContext;
+using paddle::platform::CPUPlace;
+
+struct Shape {
+  int batch, channels, multiplier, height, width;
+  int ksize_h, ksize_w, stride, padding;
+
+  int OutputHeight() const {
+    return (height + 2 * padding - ksize_h) / stride + 1;
+  }
+  int OutputWidth() const {
+    return (width + 2 * padding - ksize_w) / stride + 1;
+  }
+};
+
+void RandomTensor(const std::vector<int64_t>& dims, std::mt19937* rng,
+                  Tensor* tensor) {
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  double* data = tensor->mutable_data<double>(make_ddim(dims), CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) data[i] = dist(*rng);
+}
+
+// The reference: the definition of the convolution, one output position
+// at a time. Computes the output, and the gradients of the input and the
+// filter for the given output gradient.
+void ReferenceDepthwiseConv(const Shape& s, const double* input,
+                            const double* filter, const double* output_grad,
+                            std::vector<double>* output,
+                            std::vector<double>* input_grad,
+                            std::vector<double>* filter_grad) {
+  const int oc = s.channels * s.multiplier;
+  const int oh = s.OutputHeight();
+  const int ow = s.OutputWidth();
+  output->assign(s.batch * oc * oh * ow, 0);
+  input_grad->assign(s.batch * s.channels * s.height * s.width, 0);
+  filter_grad->assign(oc * s.ksize_h * s.ksize_w, 0);
+  for (int n = 0; n < s.batch; ++n) {
+    for (int c = 0; c < oc; ++c) {
+      const int ic = c / s.multiplier;
+      for (int i = 0; i < oh; ++i) {
+        for (int j = 0; j < ow; ++j) {
+          const int out = ((n * oc + c) * oh + i) * ow + j;
+          for (int kh = 0; kh < s.ksize_h; ++kh) {
+            for (int kw = 0; kw < s.ksize_w; ++kw) {
+              const int h = i * s.stride - s.padding + kh;
+              const int w = j * s.stride - s.padding + kw;
+              if (h < 0 || h >= s.height || w < 0 || w >= s.width) continue;
+              const int in =
+                  ((n * s.channels + ic) * s.height + h) * s.width + w;
+              const int f = (c * s.ksize_h + kh) * s.ksize_w + kw;
+              (*output)[out] += input[in] * filter[f];
+              (*input_grad)[in] += output_grad[out] * filter[f];
+              (*filter_grad)[f] += output_grad[out] * input[in];
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+void ExpectNear(const std::vector<double>& expected, const Tensor& actual) {
+  ASSERT_EQ(static_cast<int64_t>(expected.size()), actual.numel());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_NEAR(expected[i], actual.data<double>()[i], 1e-9) << "i=" << i;
+  }
+}
+
+}  // namespace
+
+TEST(math, depthwise_conv_cpu) {
+  namespace math = paddle::operators::math;
+  CPUDeviceContext context(CPUPlace{});
+  math::DepthwiseConvFunctor<CPUDeviceContext, double> conv;
+  math::DepthwiseConvInputGradFunctor<CPUDeviceContext, double> input_grad_fn;
+  math::DepthwiseConvFilterGradFunctor<CPUDeviceContext, double>
+      filter_grad_fn;
+
+  std::mt19937 rng(0);
+  // batch, channels, multiplier, height, width, ksize_h, ksize_w, stride,
+  // padding
+  std::vector<Shape> shapes = {{2, 3, 1, 7, 9, 3, 3, 1, 1},
+                               {2, 3, 2, 7, 8, 3, 3, 2, 1},
+                               {1, 4, 1, 5, 5, 5, 3, 1, 2},
+                               {1, 2, 3, 9, 6, 3, 3, 2, 0},
+                               {3, 2, 1, 4, 11, 1, 1, 1, 0},
+                               {1, 1, 1, 3, 3, 3, 3, 1, 3}};
+  for (const auto& s : shapes) {
+    const int oc = s.channels * s.multiplier;
+    Tensor input, filter, output_grad;
+    RandomTensor({s.batch, s.channels, s.height, s.width}, &rng, &input);
+    RandomTensor({oc, 1, s.ksize_h, s.ksize_w}, &rng, &filter);
+    RandomTensor({s.batch, oc, s.OutputHeight(), s.OutputWidth()}, &rng,
+                 &output_grad);
+    std::vector<double> output_ref, input_grad_ref, filter_grad_ref;
+    ReferenceDepthwiseConv(s, input.data<double>(), filter.data<double>(),
+                           output_grad.data<double>(), &output_ref,
+                           &input_grad_ref, &filter_grad_ref);
+
+    std::vector<int> strides = {s.stride, s.stride};
+    std::vector<int> paddings = {s.padding, s.padding};
+    Tensor output, input_grad, filter_grad;
+    output.mutable_data<double>(output_grad.dims(), CPUPlace());
+    conv(context, input, filter, strides, paddings, &output);
+    ExpectNear(output_ref, output);
+
+    // The kernels add the gradients to the zeroed tensors.
+    math::SetConstant<CPUDeviceContext, double> set_zero;
+    input_grad.mutable_data<double>(input.dims(), CPUPlace());
+    set_zero(context, &input_grad, 0);
+    input_grad_fn(context, input, filter, output_grad, strides, paddings,
+                  &input_grad);
+    ExpectNear(input_grad_ref, input_grad);
+
+    filter_grad.mutable_data<double>(filter.dims(), CPUPlace());
+    set_zero(context, &filter_grad, 0);
+    filter_grad_fn(context, input, output_grad, strides, paddings,
+                   &filter_grad);
+    ExpectNear(filter_grad_ref, filter_grad);
+  }
+}
+
+TEST(math, depthwise_conv_cpu_benchmark) {
+  // Depthwise layers of MobileNet on one 224x224 image, compared with the
+  // im2col and 1-row GEMM per channel of GemmConvKernel.
+  namespace math = paddle::operators::math;
+  CPUDeviceContext context(CPUPlace{});
+  math::DepthwiseConvFunctor<CPUDeviceContext, float> conv;
+  math::Im2ColFunctor<math::ColFormat::kCFO, CPUDeviceContext, float> im2col;
+  const int repeat = 5;
+
+  // channels, size, stride
+  std::vector<std::vector<int>> layers = {
+      {32, 112, 1}, {64, 112, 2}, {128, 56, 1}, {256, 28, 1}, {512, 14, 1}};
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (const auto& layer : layers) {
+    const int c = layer[0], size = layer[1], stride = layer[2];
+    const int out_size = (size + 2 - 3) / stride + 1;
+    Tensor input, filter, output, gemm_output, col;
+    float* in = input.mutable_data<float>(make_ddim({1, c, size, size}),
+                                          CPUPlace());
+    float* f = filter.mutable_data<float>(make_ddim({c, 1, 3, 3}), CPUPlace());
+    for (int64_t i = 0; i < input.numel(); ++i) in[i] = dist(rng);
+    for (int64_t i = 0; i < filter.numel(); ++i) f[i] = dist(rng);
+    output.mutable_data<float>(make_ddim({1, c, out_size, out_size}),
+                               CPUPlace());
+    gemm_output.mutable_data<float>(make_ddim({c, out_size * out_size}),
+                                    CPUPlace());
+    col.mutable_data<float>(make_ddim({1, 3, 3, out_size, out_size}),
+                            CPUPlace());
+    Tensor col_matrix;
+    col_matrix.ShareDataWith(col);
+    col_matrix.Resize(make_ddim({9, out_size * out_size}));
+    Tensor filter_matrix;
+    filter_matrix.ShareDataWith(filter);
+    filter_matrix.Resize(make_ddim({c, 9}));
+    Tensor in_image;
+    in_image.ShareDataWith(input);
+    in_image.Resize(make_ddim({c, size, size}));
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; ++r) {
+      conv(context, input, filter, {stride, stride}, {1, 1}, &output);
+    }
+    auto direct_end = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; ++r) {
+      for (int g = 0; g < c; ++g) {
+        Tensor in_slice = in_image.Slice(g, g + 1);
+        im2col(context, in_slice, {1, 1}, {stride, stride}, {1, 1, 1, 1},
+               &col);
+        Tensor out_slice = gemm_output.Slice(g, g + 1);
+        Tensor filter_slice = filter_matrix.Slice(g, g + 1);
+        math::matmul<CPUDeviceContext, float>(context, filter_slice, false,
+                                              col_matrix, false, 1.0f,
+                                              &out_slice, 0.0f);
+      }
+    }
+    auto gemm_end = std::chrono::steady_clock::now();
+
+    for (int64_t i = 0; i < output.numel(); ++i) {
+      ASSERT_NEAR(gemm_output.data<float>()[i], output.data<float>()[i], 1e-4);
+    }
+    LOG(INFO) << "channels " << c << " size " << size << " stride " << stride
+              << ": direct "
+              << std::chrono::duration<double, std::milli>(direct_end - start)
+                         .count() /
+                     repeat
+              << " ms, im2col + gemm "
+              << std::chrono::duration<double, std::milli>(gemm_end -
+                                                           direct_end)
+                         .count() /
+                     repeat
+              << " ms";
+  }
+}
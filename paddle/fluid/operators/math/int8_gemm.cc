@@ -0,0 +1,167 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/int8_gemm.h"
+#include <algorithm>
+#include <cmath>
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+void QuantizeToInt8(const float* x, int64_t n, float scale, int8_t* out) {
+  for (int64_t i = 0; i < n; ++i) {
+    float q = std::round(x[i] * scale);
+    q = std::min(std::max(q, -127.0f), 127.0f);
+    out[i] = static_cast<int8_t>(q);
+  }
+}
+
+namespace {
+
+inline int32_t Dot(const int8_t* a, const int8_t* b, int64_t K) {
+  int32_t sum = 0;
+  for (int64_t k = 0; k < K; ++k) {
+    sum += static_cast<int32_t>(a[k]) * static_cast<int32_t>(b[k]);
+  }
+  return sum;
+}
+
+#ifdef __SSE4_1__
+// Sign extends 8 int8 values to int16.
+inline __m128i Load8(const int8_t* p) {
+  return _mm_cvtepi8_epi16(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+}
+
+inline int32_t HorizontalSum(__m128i v) {
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(v);
+}
+
+// Computes the 2x4 block of C at the rows a0 and a0 + K of A and the four
+// rows of B from b, each load of A or B being used twice. The accumulators
+// are spelled out, as -O2 does not unroll a loop over them into registers.
+inline void Int8GemmNT2x4(int64_t N, int64_t K, int64_t K8, const int8_t* a0,
+                          const int8_t* b, int32_t* c0) {
+  const int8_t* a1 = a0 + K;
+  const int8_t* b0 = b;
+  const int8_t* b1 = b0 + K;
+  const int8_t* b2 = b1 + K;
+  const int8_t* b3 = b2 + K;
+  __m128i s00 = _mm_setzero_si128(), s01 = s00, s02 = s00, s03 = s00;
+  __m128i s10 = s00, s11 = s00, s12 = s00, s13 = s00;
+  for (int64_t k = 0; k < K8; k += 8) {
+    const __m128i a0k = Load8(a0 + k);
+    const __m128i a1k = Load8(a1 + k);
+    __m128i bk = Load8(b0 + k);
+    s00 = _mm_add_epi32(s00, _mm_madd_epi16(a0k, bk));
+    s10 = _mm_add_epi32(s10, _mm_madd_epi16(a1k, bk));
+    bk = Load8(b1 + k);
+    s01 = _mm_add_epi32(s01, _mm_madd_epi16(a0k, bk));
+    s11 = _mm_add_epi32(s11, _mm_madd_epi16(a1k, bk));
+    bk = Load8(b2 + k);
+    s02 = _mm_add_epi32(s02, _mm_madd_epi16(a0k, bk));
+    s12 = _mm_add_epi32(s12, _mm_madd_epi16(a1k, bk));
+    bk = Load8(b3 + k);
+    s03 = _mm_add_epi32(s03, _mm_madd_epi16(a0k, bk));
+    s13 = _mm_add_epi32(s13, _mm_madd_epi16(a1k, bk));
+  }
+  int32_t* c1 = c0 + N;
+  c0[0] = HorizontalSum(s00) + Dot(a0 + K8, b0 + K8, K - K8);
+  c0[1] = HorizontalSum(s01) + Dot(a0 + K8, b1 + K8, K - K8);
+  c0[2] = HorizontalSum(s02) + Dot(a0 + K8, b2 + K8, K - K8);
+  c0[3] = HorizontalSum(s03) + Dot(a0 + K8, b3 + K8, K - K8);
+  c1[0] = HorizontalSum(s10) + Dot(a1 + K8, b0 + K8, K - K8);
+  c1[1] = HorizontalSum(s11) + Dot(a1 + K8, b1 + K8, K - K8);
+  c1[2] = HorizontalSum(s12) + Dot(a1 + K8, b2 + K8, K - K8);
+  c1[3] = HorizontalSum(s13) + Dot(a1 + K8, b3 + K8, K - K8);
+}
+#endif
+
+}  // namespace
+
+void Int8GemmNT(int64_t M, int64_t N, int64_t K, const int8_t* A,
+                const int8_t* B, int32_t* C) {
+  // Four rows of B are multiplied with the same row of A at a time, so each
+  // load of A is reused four times while the row is in L1. With SSE4.1, 8
+  // values along K are widened to int16 and multiply-added into int32 at a
+  // time, for two rows of A at a time; the compiler does not vectorize the
+  // scalar loop at -O2.
+  const int64_t N4 = N / 4 * 4;
+  int64_t m = 0;
+#ifdef __SSE4_1__
+  const int64_t K8 = K / 8 * 8;
+  for (; m + 1 < M; m += 2) {
+    const int8_t* a = A + m * K;
+    int32_t* c = C + m * N;
+    for (int64_t n = 0; n < N4; n += 4) {
+      Int8GemmNT2x4(N, K, K8, a, B + n * K, c + n);
+    }
+    for (int64_t n = N4; n < N; ++n) {
+      c[n] = Dot(a, B + n * K, K);
+      c[N + n] = Dot(a + K, B + n * K, K);
+    }
+  }
+#else
+  const int64_t K8 = 0;
+#endif
+  for (; m < M; ++m) {
+    const int8_t* a = A + m * K;
+    int32_t* c = C + m * N;
+    for (int64_t n = 0; n < N4; n += 4) {
+      const int8_t* b0 = B + n * K;
+      const int8_t* b1 = b0 + K;
+      const int8_t* b2 = b1 + K;
+      const int8_t* b3 = b2 + K;
+      int32_t sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+#ifdef __SSE4_1__
+      __m128i s0 = _mm_setzero_si128(), s1 = s0, s2 = s0, s3 = s0;
+      for (int64_t k = 0; k < K8; k += 8) {
+        const __m128i ak = Load8(a + k);
+        s0 = _mm_add_epi32(s0, _mm_madd_epi16(ak, Load8(b0 + k)));
+        s1 = _mm_add_epi32(s1, _mm_madd_epi16(ak, Load8(b1 + k)));
+        s2 = _mm_add_epi32(s2, _mm_madd_epi16(ak, Load8(b2 + k)));
+        s3 = _mm_add_epi32(s3, _mm_madd_epi16(ak, Load8(b3 + k)));
+      }
+      sum0 = HorizontalSum(s0);
+      sum1 = HorizontalSum(s1);
+      sum2 = HorizontalSum(s2);
+      sum3 = HorizontalSum(s3);
+#endif
+      for (int64_t k = K8; k < K; ++k) {
+        const int32_t ak = a[k];
+        sum0 += ak * b0[k];
+        sum1 += ak * b1[k];
+        sum2 += ak * b2[k];
+        sum3 += ak * b3[k];
+      }
+      c[n] = sum0;
+      c[n + 1] = sum1;
+      c[n + 2] = sum2;
+      c[n + 3] = sum3;
+    }
+    for (int64_t n = N4; n < N; ++n) {
+      c[n] = Dot(a, B + n * K, K);
+    }
+  }
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,41 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <cstdint>
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// Symmetric linear quantization used by the int8 inference operators: a real
+// value x is represented by the int8 value q = round(x * scale), saturated to
+// [-127, 127], so x ~= q / scale.
+void QuantizeToInt8(const float* x, int64_t n, float scale, int8_t* out);
+
+/*
+ * C = A * B^T with int8 inputs and int32 accumulation, all row-major:
+ *   A is [M, K], B is [N, K] and C is [M, N].
+ *
+ * Both operands are read along K, so every output element is a dot product
+ * of two contiguous int8 rows, computed with SSE4.1 16-bit multiply-adds when
+ * available. int8 fc weights are stored transposed for this reason, and int8
+ * conv2d uses the im2col layout whose rows are the receptive fields.
+ */
+void Int8GemmNT(int64_t M, int64_t N, int64_t K, const int8_t* A,
+                const int8_t* B, int32_t* C);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
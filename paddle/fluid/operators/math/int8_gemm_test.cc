@@ -0,0 +1,113 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/int8_gemm.h"
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "paddle/fluid/operators/math/math_function.h"
+
+TEST(math, quantize_to_int8) {
+  std::vector<float> x{0.0f, 0.5f, -0.26f, 1.0f, -3.0f, 2.0f};
+  std::vector<int8_t> q(x.size());
+  paddle::operators::math::QuantizeToInt8(x.data(), x.size(), 127.0f,
+                                          q.data());
+  EXPECT_EQ(q[0], 0);
+  EXPECT_EQ(q[1], 64);
+  EXPECT_EQ(q[2], -33);
+  EXPECT_EQ(q[3], 127);
+  // Out of range values saturate.
+  EXPECT_EQ(q[4], -127);
+  EXPECT_EQ(q[5], 127);
+}
+
+TEST(math, int8_gemm_nt) {
+  // N = 6 covers both the blocked columns and the remainder.
+  const int64_t M = 3, N = 6, K = 37;
+  std::vector<int8_t> A(M * K), B(N * K);
+  for (int64_t i = 0; i < M * K; ++i) {
+    A[i] = static_cast<int8_t>((i * 7) % 255 - 127);
+  }
+  for (int64_t i = 0; i < N * K; ++i) {
+    B[i] = static_cast<int8_t>((i * 13) % 255 - 127);
+  }
+  std::vector<int32_t> C(M * N);
+  paddle::operators::math::Int8GemmNT(M, N, K, A.data(), B.data(), C.data());
+
+  for (int64_t m = 0; m < M; ++m) {
+    for (int64_t n = 0; n < N; ++n) {
+      int32_t expected = 0;
+      for (int64_t k = 0; k < K; ++k) {
+        expected += A[m * K + k] * B[n * K + k];
+      }
+      EXPECT_EQ(C[m * N + n], expected);
+    }
+  }
+}
+
+TEST(math, int8_gemm_benchmark) {
+  // The GEMMs of a 1024x1024 fc layer on 1 and 16 samples and of two im2col
+  // 3x3 convolutions, compared with the float GEMM that they replace.
+  namespace math = paddle::operators::math;
+  paddle::platform::CPUDeviceContext context(paddle::platform::CPUPlace{});
+  const int repeat = 10;
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int> dist(-127, 127);
+  // M, N, K
+  std::vector<std::vector<int>> shapes = {
+      {1, 1024, 1024}, {16, 1024, 1024}, {64, 512, 2304}, {128, 256, 1152}};
+  for (const auto& shape : shapes) {
+    const int M = shape[0], N = shape[1], K = shape[2];
+    std::vector<int8_t> qa(M * K), qb(N * K);
+    std::vector<float> a(M * K), b(N * K), c(M * N);
+    std::vector<int32_t> qc(M * N);
+    for (int i = 0; i < M * K; ++i) {
+      qa[i] = static_cast<int8_t>(dist(rng));
+      a[i] = qa[i];
+    }
+    for (int i = 0; i < N * K; ++i) {
+      qb[i] = static_cast<int8_t>(dist(rng));
+      b[i] = qb[i];
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; ++r) {
+      math::gemm<paddle::platform::CPUDeviceContext, float>(
+          context, CblasNoTrans, CblasTrans, M, N, K, 1.0f, a.data(),
+          b.data(), 0.0f, c.data());
+    }
+    auto float_end = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; ++r) {
+      math::Int8GemmNT(M, N, K, qa.data(), qb.data(), qc.data());
+    }
+    auto int8_end = std::chrono::steady_clock::now();
+
+    // The random sums stay far below 2^24, so the float GEMM is exact too.
+    for (int i = 0; i < M * N; ++i) {
+      ASSERT_EQ(static_cast<float>(qc[i]), c[i]);
+    }
+    LOG(INFO) << "M " << M << " N " << N << " K " << K << ": int8 "
+              << std::chrono::duration<double, std::milli>(int8_end -
+                                                           float_end)
+                         .count() /
+                     repeat
+              << " ms, float "
+              << std::chrono::duration<double, std::milli>(float_end - start)
+                         .count() /
+                     repeat
+              << " ms";
+  }
+}
@@ -0,0 +1,132 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+namespace detail {
+
+// The number of values compared against the selection threshold at once.
+// 16 floats fill one cache line and a few SIMD registers.
+constexpr int64_t kTopKBlockSize = 16;
+
+template <typename T>
+struct TopKEntry {
+  T value;
+  int64_t index;
+};
+
+// Whether `a` ranks before `b`: larger values first, and among equal values
+// the one seen first.
+template <typename T>
+inline bool TopKBefore(const TopKEntry<T>& a, const TopKEntry<T>& b) {
+  return a.value > b.value || (a.value == b.value && a.index < b.index);
+}
+
+}  // namespace detail
+
+/*
+ * Selects the k largest of the n values of `row` and writes them in
+ * descending order to `values`, which may be null, and their positions to
+ * `indices`. Equal values are ranked by position, so the result is the same
+ * as a stable sort of the row followed by taking its k first entries. When k
+ * is larger than n, the last k - n entries get the index -1 and the lowest
+ * value of T.
+ *
+ * The k best entries so far are kept in a min-heap. Once it is full, the
+ * rest of the row is scanned by blocks: the comparisons of a whole block
+ * against the smallest kept value have no dependency and vectorize, and
+ * since the threshold only grows, for the large vocabularies of top_k and
+ * beam search most blocks are skipped without touching the heap.
+ */
+template <typename T, typename IndexT>
+void PartialTopK(const T* row, int64_t n, int64_t k, T* values,
+                 IndexT* indices) {
+  using Entry = detail::TopKEntry<T>;
+  for (int64_t i = std::max<int64_t>(n, 0); i < k; ++i) {
+    if (values != nullptr) values[i] = std::numeric_limits<T>::lowest();
+    indices[i] = static_cast<IndexT>(-1);
+  }
+  k = std::min(k, n);
+  if (k <= 0) return;
+
+  std::vector<Entry> heap(k);
+  for (int64_t i = 0; i < k; ++i) {
+    heap[i].value = row[i];
+    heap[i].index = i;
+  }
+  // With TopKBefore as the ordering, the front of the heap is the entry
+  // ranked last.
+  std::make_heap(heap.begin(), heap.end(), detail::TopKBefore<T>);
+
+  T threshold = heap.front().value;
+  for (int64_t start = k; start < n; start += detail::kTopKBlockSize) {
+    const int64_t end = std::min(start + detail::kTopKBlockSize, n);
+    // A later value equal to the threshold ranks after every kept entry.
+    int hits = 0;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp simd reduction(+ : hits)
+#endif
+    for (int64_t i = start; i < end; ++i) {
+      hits += row[i] > threshold;
+    }
+    if (hits == 0) continue;
+    for (int64_t i = start; i < end; ++i) {
+      if (row[i] > threshold) {
+        std::pop_heap(heap.begin(), heap.end(), detail::TopKBefore<T>);
+        heap.back().value = row[i];
+        heap.back().index = i;
+        std::push_heap(heap.begin(), heap.end(), detail::TopKBefore<T>);
+        threshold = heap.front().value;
+      }
+    }
+  }
+
+  std::sort_heap(heap.begin(), heap.end(), detail::TopKBefore<T>);
+  for (int64_t i = 0; i < k; ++i) {
+    if (values != nullptr) values[i] = heap[i].value;
+    indices[i] = static_cast<IndexT>(heap[i].index);
+  }
+}
+
+/*
+ * PartialTopK on each row of a row-major [rows, cols] matrix, the rows
+ * being processed in parallel. Row i writes to values + i * k and
+ * indices + i * k.
+ */
+template <typename T, typename IndexT>
+void PartialTopKRows(const T* data, int64_t rows, int64_t cols, int64_t k,
+                     T* values, IndexT* indices) {
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t i = 0; i < rows; ++i) {
+    PartialTopK(data + i * cols, cols, k,
+                values == nullptr ? nullptr : values + i * k,
+                indices + i * k);
+  }
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,138 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/top_k.h"
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+// The reference: a stable sort of the positions by descending value.
+void ReferenceTopK(const std::vector<float>& row, int64_t k,
+                   std::vector<float>* values, std::vector<int64_t>* indices) {
+  std::vector<int64_t> order(row.size());
+  for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(),
+                   [&](int64_t a, int64_t b) { return row[a] > row[b]; });
+  k = std::min<int64_t>(k, row.size());
+  indices->assign(order.begin(), order.begin() + k);
+  values->clear();
+  for (auto i : *indices) values->push_back(row[i]);
+}
+
+}  // namespace
+
+TEST(math, partial_top_k) {
+  std::mt19937 rng(0);
+  // Few distinct values, so that ties are frequent.
+  std::uniform_int_distribution<int> dist(-20, 20);
+  for (int64_t n : {1, 7, 16, 33, 1000}) {
+    for (int64_t k : {1, 3, 16, 40}) {
+      std::vector<float> row(n);
+      for (auto& v : row) v = dist(rng) * 0.5f;
+      std::vector<float> expected_values;
+      std::vector<int64_t> expected_indices;
+      ReferenceTopK(row, k, &expected_values, &expected_indices);
+
+      std::vector<float> values(k, -1.0f);
+      std::vector<int64_t> indices(k, -1);
+      paddle::operators::math::PartialTopK(row.data(), n, k, values.data(),
+                                           indices.data());
+      size_t m = expected_indices.size();
+      EXPECT_EQ(std::vector<int64_t>(indices.begin(), indices.begin() + m),
+                expected_indices);
+      EXPECT_EQ(std::vector<float>(values.begin(), values.begin() + m),
+                expected_values);
+      // The entries past n are filled.
+      for (size_t i = m; i < indices.size(); ++i) {
+        EXPECT_EQ(indices[i], -1);
+        EXPECT_EQ(values[i], std::numeric_limits<float>::lowest());
+      }
+    }
+  }
+}
+
+TEST(math, partial_top_k_rows) {
+  const int64_t rows = 3, cols = 5, k = 2;
+  std::vector<float> data({1, 5, 3, 5, 2,  // ties keep the first position
+                           0, 0, 0, 0, 0,  //
+                           -1, -2, -3, -4, 9});
+  std::vector<float> values(rows * k);
+  std::vector<int> indices(rows * k);
+  paddle::operators::math::PartialTopKRows(data.data(), rows, cols, k,
+                                           values.data(), indices.data());
+  EXPECT_EQ(indices, std::vector<int>({1, 3, 0, 1, 4, 0}));
+  EXPECT_EQ(values, std::vector<float>({5, 5, 0, 0, 9, -1}));
+
+  // Only the indices are needed by beam search.
+  paddle::operators::math::PartialTopKRows(data.data(), rows, cols, k,
+                                           static_cast<float*>(nullptr),
+                                           indices.data());
+  EXPECT_EQ(indices, std::vector<int>({1, 3, 0, 1, 4, 0}));
+}
+
+TEST(math, partial_top_k_benchmark) {
+  // Rows of softmax-like scores over vocabularies of usual sizes, compared
+  // with the std::partial_sort the kernels used before.
+  const int64_t rows = 32;
+  const int repeat = 5;
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+  for (int64_t vocab : {1000, 10000, 30000, 50000}) {
+    std::vector<float> data(rows * vocab);
+    for (auto& v : data) v = dist(rng);
+    for (int64_t k : {1, 4, 10, 100}) {
+      std::vector<float> values(rows * k);
+      std::vector<int64_t> indices(rows * k);
+      auto start = std::chrono::steady_clock::now();
+      for (int r = 0; r < repeat; ++r) {
+        for (int64_t i = 0; i < rows; ++i) {
+          paddle::operators::math::PartialTopK(
+              data.data() + i * vocab, vocab, k, values.data() + i * k,
+              indices.data() + i * k);
+        }
+      }
+      auto top_k_end = std::chrono::steady_clock::now();
+      std::vector<std::pair<float, int64_t>> pairs(vocab);
+      for (int r = 0; r < repeat; ++r) {
+        for (int64_t i = 0; i < rows; ++i) {
+          for (int64_t j = 0; j < vocab; ++j) {
+            pairs[j] = std::make_pair(data[i * vocab + j], j);
+          }
+          std::partial_sort(pairs.begin(), pairs.begin() + k, pairs.end(),
+                            [](const std::pair<float, int64_t>& a,
+                               const std::pair<float, int64_t>& b) {
+                              return a.first > b.first;
+                            });
+          EXPECT_EQ(pairs[0].second, indices[i * k]);
+        }
+      }
+      auto sort_end = std::chrono::steady_clock::now();
+      LOG(INFO) << "vocab " << vocab << " k " << k << ": PartialTopK "
+                << std::chrono::duration<double, std::micro>(top_k_end - start)
+                           .count() /
+                       (rows * repeat)
+                << " us/row, partial_sort "
+                << std::chrono::duration<double, std::micro>(sort_end -
+                                                             top_k_end)
+                           .count() /
+                       (rows * repeat)
+                << " us/row";
+    }
+  }
+}
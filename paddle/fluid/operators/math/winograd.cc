@@ -0,0 +1,447 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/winograd.h"
+#include <string.h>
+#include <algorithm>
+#include "paddle/fluid/operators/math/math_function.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+namespace {
+
+/*
+ * The one-dimensional transforms of F(m, 3), from "Fast Algorithms for
+ * Convolutional Neural Networks", Lavin and Gray, written out so that the
+ * zeros and ones of B^T, G and A^T cost nothing. The two-dimensional
+ * transforms apply them to the columns, then to the rows of the tiles.
+ *
+ * They transform n tiles at once: the element i of the tile k is at
+ * x[i * xs + k], and the element i of its transform at y[i * ys + k], so
+ * that the loops over the tiles are vectorized.
+ */
+template <typename T, int M>
+struct Winograd1D;
+
+template <typename T>
+struct Winograd1D<T, 2> {
+  // B^T d
+  static inline void Input(const T* x, int xs, T* y, int ys, int n) {
+    for (int k = 0; k < n; ++k) {
+      const T x0 = x[k], x1 = x[xs + k], x2 = x[2 * xs + k];
+      const T x3 = x[3 * xs + k];
+      y[k] = x0 - x2;
+      y[ys + k] = x1 + x2;
+      y[2 * ys + k] = x2 - x1;
+      y[3 * ys + k] = x1 - x3;
+    }
+  }
+  // G g
+  static inline void Filter(const T* x, int xs, T* y, int ys, int n) {
+    const T half = static_cast<T>(0.5);
+    for (int k = 0; k < n; ++k) {
+      const T x0 = x[k], x1 = x[xs + k], x2 = x[2 * xs + k];
+      y[k] = x0;
+      y[ys + k] = half * (x0 + x1 + x2);
+      y[2 * ys + k] = half * (x0 - x1 + x2);
+      y[3 * ys + k] = x2;
+    }
+  }
+  // A^T m
+  static inline void Output(const T* x, int xs, T* y, int ys, int n) {
+    for (int k = 0; k < n; ++k) {
+      const T x1 = x[xs + k], x2 = x[2 * xs + k];
+      y[k] = x[k] + x1 + x2;
+      y[ys + k] = x1 - x2 - x[3 * xs + k];
+    }
+  }
+};
+
+template <typename T>
+struct Winograd1D<T, 4> {
+  static inline void Input(const T* x, int xs, T* y, int ys, int n) {
+    for (int k = 0; k < n; ++k) {
+      const T x0 = x[k], x1 = x[xs + k], x2 = x[2 * xs + k];
+      const T x3 = x[3 * xs + k], x4 = x[4 * xs + k], x5 = x[5 * xs + k];
+      y[k] = 4 * x0 - 5 * x2 + x4;
+      y[ys + k] = x3 + x4 - 4 * (x1 + x2);
+      y[2 * ys + k] = x4 - x3 + 4 * (x1 - x2);
+      y[3 * ys + k] = x4 - x2 + 2 * (x3 - x1);
+      y[4 * ys + k] = x4 - x2 + 2 * (x1 - x3);
+      y[5 * ys + k] = 4 * x1 - 5 * x3 + x5;
+    }
+  }
+  static inline void Filter(const T* x, int xs, T* y, int ys, int n) {
+    for (int k = 0; k < n; ++k) {
+      const T x0 = x[k], x1 = x[xs + k], x2 = x[2 * xs + k];
+      y[k] = x0 / 4;
+      y[ys + k] = -(x0 + x1 + x2) / 6;
+      y[2 * ys + k] = -(x0 - x1 + x2) / 6;
+      y[3 * ys + k] = x0 / 24 + x1 / 12 + x2 / 6;
+      y[4 * ys + k] = x0 / 24 - x1 / 12 + x2 / 6;
+      y[5 * ys + k] = x2;
+    }
+  }
+  static inline void Output(const T* x, int xs, T* y, int ys, int n) {
+    for (int k = 0; k < n; ++k) {
+      const T x0 = x[k], x1 = x[xs + k], x2 = x[2 * xs + k];
+      const T x3 = x[3 * xs + k], x4 = x[4 * xs + k], x5 = x[5 * xs + k];
+      y[k] = x0 + x1 + x2 + x3 + x4;
+      y[ys + k] = x1 - x2 + 2 * (x3 - x4);
+      y[2 * ys + k] = x1 + x2 + 4 * (x3 + x4);
+      y[3 * ys + k] = x1 - x2 + 8 * (x3 - x4) + x5;
+    }
+  }
+};
+
+// The number of tiles transformed at once.
+constexpr int kWinogradLanes = 16;
+
+// The transformed inputs and the products of a group of images are at
+// most of kWinogradBytes bytes each.
+constexpr int64_t kWinogradBytes = 32 << 20;
+
+// FNV-1a over the 64-bit words of the data, in four interleaved streams
+// so that the multiplications do not wait for each other.
+uint64_t Fingerprint(const void* data, size_t size) {
+  const uint64_t kPrime = 1099511628211ULL;
+  const char* bytes = static_cast<const char*>(data);
+  uint64_t hash[4] = {14695981039346656037ULL, 1, 2, 3};
+  size_t i = 0;
+  for (; i + 4 * sizeof(uint64_t) <= size; i += 4 * sizeof(uint64_t)) {
+    uint64_t words[4];
+    memcpy(words, bytes + i, sizeof(words));
+    for (int k = 0; k < 4; ++k) hash[k] = (hash[k] ^ words[k]) * kPrime;
+  }
+  for (; i < size; ++i) {
+    hash[0] = (hash[0] ^ static_cast<unsigned char>(bytes[i])) * kPrime;
+  }
+  return ((hash[0] * kPrime ^ hash[1]) * kPrime ^ hash[2]) * kPrime ^ hash[3];
+}
+
+// U = G g G^T, for the filters of [num_filters, 3, 3], into
+// u of [alpha * alpha, num_filters].
+template <typename T, int M>
+void TransformFilters(const T* filter, int num_filters, T* u) {
+  constexpr int kAlpha = M + 2;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int f = 0; f < num_filters; ++f) {
+    T tmp[kAlpha * 3];
+    T out[kAlpha * kAlpha];
+    for (int j = 0; j < 3; ++j) {
+      Winograd1D<T, M>::Filter(filter + f * 9 + j, 3, tmp + j, 3, 1);
+    }
+    for (int i = 0; i < kAlpha; ++i) {
+      Winograd1D<T, M>::Filter(tmp + i * 3, 1, out + i * kAlpha, 1, 1);
+    }
+    for (int xi = 0; xi < kAlpha * kAlpha; ++xi) {
+      u[xi * num_filters + f] = out[xi];
+    }
+  }
+}
+
+template <typename T, int M>
+void WinogradConv(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& input, const T* u,
+                  const std::vector<int>& paddings,
+                  framework::Tensor* output) {
+  constexpr int kAlpha = M + 2;
+  constexpr int kAlpha2 = kAlpha * kAlpha;
+  const int batch_size = input.dims()[0];
+  const int input_channels = input.dims()[1];
+  const int input_height = input.dims()[2];
+  const int input_width = input.dims()[3];
+  const int output_channels = output->dims()[1];
+  const int output_height = output->dims()[2];
+  const int output_width = output->dims()[3];
+  const int padding_height = paddings[0];
+  const int padding_width = paddings[1];
+
+  const int tiles_height = (output_height + M - 1) / M;
+  const int tiles_width = (output_width + M - 1) / M;
+  const int tiles = tiles_height * tiles_width;
+  // The images are transformed and multiplied in groups, so that the
+  // GEMMs are over the tiles of several images.
+  const int64_t image_bytes = static_cast<int64_t>(kAlpha2) *
+                              std::max(input_channels, output_channels) *
+                              tiles * sizeof(T);
+  const int group_size = static_cast<int>(std::max<int64_t>(
+      1, std::min<int64_t>(batch_size, kWinogradBytes / image_bytes)));
+
+  const T* input_data = input.data<T>();
+  T* output_data = output->mutable_data<T>(context.GetPlace());
+  framework::Tensor v_tensor, m_tensor;
+  for (int begin = 0; begin < batch_size; begin += group_size) {
+    const int num_images = std::min(group_size, batch_size - begin);
+    const int cols = num_images * tiles;
+    // v: [alpha * alpha, input channels, cols]
+    T* v = v_tensor.mutable_data<T>(
+        framework::make_ddim({kAlpha2, input_channels, cols}),
+        context.GetPlace());
+    // products: [alpha * alpha, output channels, cols]
+    T* prod = m_tensor.mutable_data<T>(
+        framework::make_ddim({kAlpha2, output_channels, cols}),
+        context.GetPlace());
+
+    // V = B^T d B
+    const int num_planes = num_images * input_channels;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int plane = 0; plane < num_planes; ++plane) {
+      const int image = plane / input_channels;
+      const int c = plane % input_channels;
+      const T* in = input_data +
+                    ((begin + image) * input_channels + c) * input_height *
+                        input_width;
+      T* v_plane = v + c * cols + image * tiles;
+      // d[i][j][k], tmp and out are the elements (i, j) of the tiles
+      // t0 + k of a block of tiles.
+      T d[kAlpha2 * kWinogradLanes];
+      T tmp[kAlpha2 * kWinogradLanes];
+      T out[kAlpha2 * kWinogradLanes];
+      for (int t0 = 0; t0 < tiles; t0 += kWinogradLanes) {
+        const int n = std::min(kWinogradLanes, tiles - t0);
+        for (int k = 0; k < n; ++k) {
+          const int h0 = (t0 + k) / tiles_width * M - padding_height;
+          const int w0 = (t0 + k) % tiles_width * M - padding_width;
+          if (h0 >= 0 && h0 + kAlpha <= input_height && w0 >= 0 &&
+              w0 + kAlpha <= input_width) {
+            for (int i = 0; i < kAlpha; ++i) {
+              const T* in_row = in + (h0 + i) * input_width + w0;
+              for (int j = 0; j < kAlpha; ++j) {
+                d[(i * kAlpha + j) * kWinogradLanes + k] = in_row[j];
+              }
+            }
+          } else {
+            for (int i = 0; i < kAlpha; ++i) {
+              const int h = h0 + i;
+              for (int j = 0; j < kAlpha; ++j) {
+                const int x = w0 + j;
+                d[(i * kAlpha + j) * kWinogradLanes + k] =
+                    h >= 0 && h < input_height && x >= 0 && x < input_width
+                        ? in[h * input_width + x]
+                        : static_cast<T>(0);
+              }
+            }
+          }
+        }
+        for (int j = 0; j < kAlpha; ++j) {
+          Winograd1D<T, M>::Input(d + j * kWinogradLanes,
+                                  kAlpha * kWinogradLanes,
+                                  tmp + j * kWinogradLanes,
+                                  kAlpha * kWinogradLanes, n);
+        }
+        for (int i = 0; i < kAlpha; ++i) {
+          Winograd1D<T, M>::Input(tmp + i * kAlpha * kWinogradLanes,
+                                  kWinogradLanes,
+                                  out + i * kAlpha * kWinogradLanes,
+                                  kWinogradLanes, n);
+        }
+        for (int xi = 0; xi < kAlpha2; ++xi) {
+          T* dst = v_plane + xi * input_channels * cols + t0;
+          const T* src = out + xi * kWinogradLanes;
+          for (int k = 0; k < n; ++k) dst[k] = src[k];
+        }
+      }
+    }
+
+    // M = U .* V, summed over the input channels
+    for (int xi = 0; xi < kAlpha2; ++xi) {
+      gemm<platform::CPUDeviceContext, T>(
+          context, CblasNoTrans, CblasNoTrans, output_channels, cols,
+          input_channels, static_cast<T>(1),
+          u + xi * output_channels * input_channels,
+          v + xi * input_channels * cols, static_cast<T>(0),
+          prod + xi * output_channels * cols);
+    }
+
+    // Y = A^T M A
+    const int num_output_planes = num_images * output_channels;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int plane = 0; plane < num_output_planes; ++plane) {
+      const int image = plane / output_channels;
+      const int oc = plane % output_channels;
+      T* out = output_data +
+               ((begin + image) * output_channels + oc) * output_height *
+                   output_width;
+      const T* prod_plane = prod + oc * cols + image * tiles;
+      T mm[kAlpha2 * kWinogradLanes];
+      T tmp[M * kAlpha * kWinogradLanes];
+      T y[M * M * kWinogradLanes];
+      for (int t0 = 0; t0 < tiles; t0 += kWinogradLanes) {
+        const int n = std::min(kWinogradLanes, tiles - t0);
+        for (int xi = 0; xi < kAlpha2; ++xi) {
+          const T* src = prod_plane + xi * output_channels * cols + t0;
+          T* dst = mm + xi * kWinogradLanes;
+          for (int k = 0; k < n; ++k) dst[k] = src[k];
+        }
+        for (int j = 0; j < kAlpha; ++j) {
+          Winograd1D<T, M>::Output(mm + j * kWinogradLanes,
+                                   kAlpha * kWinogradLanes,
+                                   tmp + j * kWinogradLanes,
+                                   kAlpha * kWinogradLanes, n);
+        }
+        for (int i = 0; i < M; ++i) {
+          Winograd1D<T, M>::Output(tmp + i * kAlpha * kWinogradLanes,
+                                   kWinogradLanes, y + i * M * kWinogradLanes,
+                                   kWinogradLanes, n);
+        }
+        for (int k = 0; k < n; ++k) {
+          const int h0 = (t0 + k) / tiles_width * M;
+          const int w0 = (t0 + k) % tiles_width * M;
+          const int rows = std::min(M, output_height - h0);
+          const int row_width = std::min(M, output_width - w0);
+          for (int i = 0; i < rows; ++i) {
+            T* out_row = out + (h0 + i) * output_width + w0;
+            for (int j = 0; j < row_width; ++j) {
+              out_row[j] = y[(i * M + j) * kWinogradLanes + k];
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+template <typename T>
+class WinogradFilterTransform<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& filter, int tile_size,
+                  framework::Tensor* transformed_filter) {
+    PADDLE_ENFORCE(tile_size == 2 || tile_size == 4,
+                   "The Winograd tile size must be 2 or 4.");
+    const int alpha = tile_size + 2;
+    const int output_channels = filter.dims()[0];
+    const int input_channels = filter.dims()[1];
+    T* u = transformed_filter->mutable_data<T>(
+        framework::make_ddim({alpha * alpha, output_channels, input_channels}),
+        context.GetPlace());
+    if (tile_size == 2) {
+      TransformFilters<T, 2>(filter.data<T>(),
+                             output_channels * input_channels, u);
+    } else {
+      TransformFilters<T, 4>(filter.data<T>(),
+                             output_channels * input_channels, u);
+    }
+  }
+};
+
+template <typename T>
+class WinogradConvFunctor<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& transformed_filter, int tile_size,
+                  const std::vector<int>& paddings, framework::Tensor* output) {
+    PADDLE_ENFORCE(tile_size == 2 || tile_size == 4,
+                   "The Winograd tile size must be 2 or 4.");
+    const int alpha = tile_size + 2;
+    PADDLE_ENFORCE_EQ(transformed_filter.dims()[0], alpha * alpha);
+    PADDLE_ENFORCE_EQ(transformed_filter.dims()[1], output->dims()[1]);
+    PADDLE_ENFORCE_EQ(transformed_filter.dims()[2], input.dims()[1]);
+    if (tile_size == 2) {
+      WinogradConv<T, 2>(context, input, transformed_filter.data<T>(),
+                         paddings, output);
+    } else {
+      WinogradConv<T, 4>(context, input, transformed_filter.data<T>(),
+                         paddings, output);
+    }
+  }
+};
+
+template <typename T>
+WinogradFilterCache<T>& WinogradFilterCache<T>::Instance() {
+  // Never destroyed: the cached tensors must not outlive the allocators.
+  static WinogradFilterCache* cache = new WinogradFilterCache;
+  return *cache;
+}
+
+template <typename T>
+framework::Tensor WinogradFilterCache<T>::Get(
+    const platform::CPUDeviceContext& context, const framework::Tensor& filter,
+    int tile_size) {
+  const T* key = filter.data<T>();
+  const uint64_t fingerprint = Fingerprint(key, filter.numel() * sizeof(T));
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    Entry& entry = it->second;
+    lru_.splice(lru_.begin(), lru_, entry.lru);
+    if (entry.dims == filter.dims() && entry.tile_size == tile_size &&
+        entry.fingerprint == fingerprint) {
+      return entry.transformed_filter;
+    }
+  } else {
+    lru_.push_front(key);
+    it = entries_.emplace(key, Entry()).first;
+    it->second.lru = lru_.begin();
+  }
+  // A new tensor, the old transform may still be used by another run.
+  framework::Tensor transformed_filter;
+  WinogradFilterTransform<platform::CPUDeviceContext, T> transform;
+  transform(context, filter, tile_size, &transformed_filter);
+  Entry& entry = it->second;
+  if (entry.transformed_filter.IsInitialized()) {
+    bytes_ -= entry.transformed_filter.numel() * sizeof(T);
+  }
+  entry.dims = filter.dims();
+  entry.tile_size = tile_size;
+  entry.fingerprint = fingerprint;
+  entry.transformed_filter = transformed_filter;
+  bytes_ += transformed_filter.numel() * sizeof(T);
+
+  // Keeps at least the transform just made.
+  while (bytes_ > kMaxBytes && lru_.size() > 1) {
+    auto last = entries_.find(lru_.back());
+    bytes_ -= last->second.transformed_filter.numel() * sizeof(T);
+    entries_.erase(last);
+    lru_.pop_back();
+  }
+  return transformed_filter;
+}
+
+template <typename T>
+void WinogradFilterCache<T>::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  lru_.clear();
+  bytes_ = 0;
+}
+
+template <typename T>
+size_t WinogradFilterCache<T>::Bytes() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_;
+}
+
+template class WinogradFilterTransform<platform::CPUDeviceContext, float>;
+template class WinogradFilterTransform<platform::CPUDeviceContext, double>;
+template class WinogradConvFunctor<platform::CPUDeviceContext, float>;
+template class WinogradConvFunctor<platform::CPUDeviceContext, double>;
+template class WinogradFilterCache<float>;
+template class WinogradFilterCache<double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,132 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * \brief The 3x3 convolution of stride 1 by the Winograd minimal filtering
+ * algorithm F(m x m, 3 x 3), with m = 2 or 4.
+ *
+ * The output is computed in tiles of m x m, each from a tile of
+ * alpha x alpha inputs, alpha = m + 2:
+ *   Y = A^T [(G g G^T) .* (B^T d B)] A
+ * Summed over the input channels, the element-wise products become
+ * alpha * alpha GEMMs of [output channels, input channels] x
+ * [input channels, tiles], with 2.25 (m = 2) or 4 (m = 4) times fewer
+ * multiplications than im2col + GEMM. F(4 x 4, 3 x 3) is less accurate,
+ * it is used for outputs of at least 8 x 8.
+ *
+ * The input and output are in NCHW format, the filter in MCHW format.
+ * The transformed filter is of [alpha * alpha, output channels,
+ * input channels].
+ */
+
+// Whether the convolution can be computed by the Winograd functors.
+inline bool IsWinogradConv(const framework::DDim& filter_dims,
+                           const std::vector<int>& strides,
+                           const std::vector<int>& dilations, int groups) {
+  if (filter_dims.size() != 4 || filter_dims[2] != 3 || filter_dims[3] != 3) {
+    return false;
+  }
+  for (size_t i = 0; i < strides.size(); ++i) {
+    if (strides[i] != 1 || dilations[i] != 1) return false;
+  }
+  return groups == 1;
+}
+
+inline int WinogradTileSize(int output_height, int output_width) {
+  return output_height >= 8 && output_width >= 8 ? 4 : 2;
+}
+
+template <typename DeviceContext, typename T>
+class WinogradFilterTransform {
+ public:
+  void operator()(const DeviceContext& context,
+                  const framework::Tensor& filter, int tile_size,
+                  framework::Tensor* transformed_filter);
+};
+
+template <typename DeviceContext, typename T>
+class WinogradConvFunctor {
+ public:
+  void operator()(const DeviceContext& context, const framework::Tensor& input,
+                  const framework::Tensor& transformed_filter, int tile_size,
+                  const std::vector<int>& paddings, framework::Tensor* output);
+};
+
+/*
+ * \brief The transformed filters of the CPU kernel, kept across runs.
+ *
+ * The filters are looked up by their data, and the cached transform is
+ * used only when the fingerprint of the values still matches, so a filter
+ * updated in place by training, or a new filter allocated where a freed one
+ * was, is transformed again. In inference the filters never change and are
+ * transformed once. The fingerprint reads the whole filter at every run,
+ * i.e. 9 * C_in * C_out values against the 16 * C_in * C_out values of the
+ * transform read for every tile of every image.
+ *
+ * The cache holds at most kMaxBytes of transforms, the least recently used
+ * ones being dropped first, so that the transforms of the filters freed by
+ * unloaded programs do not stay for the life of the process.
+ */
+template <typename T>
+class WinogradFilterCache {
+ public:
+  static constexpr size_t kMaxBytes = 256 << 20;
+
+  static WinogradFilterCache& Instance();
+
+  // Returns the transform of the filter, which shares the cached data.
+  framework::Tensor Get(const platform::CPUDeviceContext& context,
+                        const framework::Tensor& filter, int tile_size);
+
+  // Drops all the transforms, e.g. once the programs using them are
+  // unloaded. The tensors returned by Get stay valid.
+  void Clear();
+
+  // The bytes of the cached transforms.
+  size_t Bytes();
+
+ private:
+  WinogradFilterCache() = default;
+
+  struct Entry {
+    framework::DDim dims;
+    int tile_size;
+    uint64_t fingerprint;
+    framework::Tensor transformed_filter;
+    // The position of the filter in lru_.
+    typename std::list<const T*>::iterator lru;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<const T*, Entry> entries_;
+  // The filters of entries_, the most recently used first.
+  std::list<const T*> lru_;
+  size_t bytes_ = 0;
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,214 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/winograd.h"
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "paddle/fluid/operators/math/im2col.h"
+#include "paddle/fluid/operators/math/math_function.h"
+
+namespace {
+
+using paddle::framework::Tensor;
+using paddle::framework::make_ddim;
+using paddle::platform::CPUDeviceContext;
+using paddle::platform::CPUPlace;
+namespace math = paddle::operators::math;
+
+template <typename T>
+void RandomTensor(const std::vector<int64_t>& dims, std::mt19937* rng,
+                  Tensor* tensor) {
+  std::uniform_real_distribution<T> dist(-1, 1);
+  T* data = tensor->mutable_data<T>(make_ddim(dims), CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) data[i] = dist(*rng);
+}
+
+// The im2col + GEMM of GemmConvKernel for a 3x3 filter of stride 1.
+template <typename T>
+void GemmConv(const CPUDeviceContext& context, const Tensor& input,
+              const Tensor& filter, int padding, Tensor* output) {
+  const int batch_size = input.dims()[0];
+  const int channels = input.dims()[1];
+  const int output_channels = output->dims()[1];
+  const int output_height = output->dims()[2];
+  const int output_width = output->dims()[3];
+  math::Im2ColFunctor<math::ColFormat::kCFO, CPUDeviceContext, T> im2col;
+  Tensor col;
+  col.mutable_data<T>(
+      make_ddim({channels, 3, 3, output_height, output_width}), CPUPlace());
+  Tensor col_matrix;
+  col_matrix.ShareDataWith(col);
+  col_matrix.Resize({channels * 9, output_height * output_width});
+  Tensor filter_matrix;
+  filter_matrix.ShareDataWith(filter);
+  filter_matrix.Resize({output_channels, channels * 9});
+  for (int i = 0; i < batch_size; ++i) {
+    Tensor in_image =
+        input.Slice(i, i + 1).Resize(make_ddim(
+            {channels, input.dims()[2], input.dims()[3]}));
+    Tensor out_matrix = output->Slice(i, i + 1).Resize(
+        {output_channels, output_height * output_width});
+    im2col(context, in_image, {1, 1}, {1, 1},
+           {padding, padding, padding, padding}, &col);
+    math::matmul<CPUDeviceContext, T>(context, filter_matrix, false,
+                                      col_matrix, false, T(1), &out_matrix,
+                                      T(0));
+  }
+}
+
+template <typename T>
+void TestWinograd(T max_error) {
+  CPUDeviceContext context(CPUPlace{});
+  std::mt19937 rng(0);
+  // batch, channels, output channels, height, width, padding
+  std::vector<std::vector<int>> shapes = {
+      {2, 3, 6, 5, 5, 0},  {2, 3, 6, 5, 5, 1},   {1, 4, 5, 9, 7, 1},
+      {3, 8, 4, 12, 10, 1}, {1, 2, 3, 16, 16, 1}, {2, 5, 7, 13, 17, 2},
+      {1, 1, 1, 3, 3, 0}};
+  for (const auto& s : shapes) {
+    const int batch_size = s[0], channels = s[1], output_channels = s[2];
+    const int height = s[3], width = s[4], padding = s[5];
+    const int output_height = height + 2 * padding - 2;
+    const int output_width = width + 2 * padding - 2;
+    Tensor input, filter, output, expected;
+    RandomTensor<T>({batch_size, channels, height, width}, &rng, &input);
+    RandomTensor<T>({output_channels, channels, 3, 3}, &rng, &filter);
+    auto output_dims = make_ddim(
+        {batch_size, output_channels, output_height, output_width});
+    output.mutable_data<T>(output_dims, CPUPlace());
+    expected.mutable_data<T>(output_dims, CPUPlace());
+    GemmConv<T>(context, input, filter, padding, &expected);
+
+    for (int tile_size : {2, 4}) {
+      Tensor transformed_filter;
+      math::WinogradFilterTransform<CPUDeviceContext, T> transform;
+      transform(context, filter, tile_size, &transformed_filter);
+      math::WinogradConvFunctor<CPUDeviceContext, T> winograd;
+      winograd(context, input, transformed_filter, tile_size,
+               {padding, padding}, &output);
+      for (int64_t i = 0; i < output.numel(); ++i) {
+        ASSERT_NEAR(expected.data<T>()[i], output.data<T>()[i], max_error)
+            << "tile_size=" << tile_size << " height=" << height
+            << " width=" << width << " i=" << i;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(math, winograd_conv) {
+  TestWinograd<double>(1e-10);
+  TestWinograd<float>(1e-4);
+}
+
+TEST(math, winograd_filter_cache) {
+  CPUDeviceContext context(CPUPlace{});
+  std::mt19937 rng(0);
+  Tensor filter;
+  RandomTensor<float>({4, 3, 3, 3}, &rng, &filter);
+  auto& cache = math::WinogradFilterCache<float>::Instance();
+
+  Tensor first = cache.Get(context, filter, 4);
+  EXPECT_EQ(make_ddim({36, 4, 3}), first.dims());
+  Tensor again = cache.Get(context, filter, 4);
+  EXPECT_EQ(first.data<float>(), again.data<float>());
+
+  // The filter updated in place is transformed again.
+  filter.data<float>()[5] += 1;
+  Tensor updated = cache.Get(context, filter, 4);
+  EXPECT_NE(first.data<float>(), updated.data<float>());
+  Tensor expected;
+  math::WinogradFilterTransform<CPUDeviceContext, float> transform;
+  transform(context, filter, 4, &expected);
+  for (int64_t i = 0; i < expected.numel(); ++i) {
+    ASSERT_EQ(expected.data<float>()[i], updated.data<float>()[i]);
+  }
+
+  Tensor small_tiles = cache.Get(context, filter, 2);
+  EXPECT_EQ(make_ddim({16, 4, 3}), small_tiles.dims());
+
+  // Only the latest transform of the filter is counted.
+  cache.Clear();
+  EXPECT_EQ(0UL, cache.Bytes());
+  Tensor cleared = cache.Get(context, filter, 2);
+  EXPECT_NE(small_tiles.data<float>(), cleared.data<float>());
+  EXPECT_EQ(16 * 4 * 3 * sizeof(float), cache.Bytes());
+  cache.Get(context, filter, 4);
+  EXPECT_EQ(36 * 4 * 3 * sizeof(float), cache.Bytes());
+  // The tensors returned before Clear stay valid.
+  EXPECT_EQ(expected.data<float>()[0], updated.data<float>()[0]);
+  cache.Clear();
+}
+
+TEST(math, winograd_conv_benchmark) {
+  // The 3x3 convolutions of the stages of ResNet-34 on 4 images, compared
+  // with the im2col + GEMM of GemmConvKernel.
+  CPUDeviceContext context(CPUPlace{});
+  const int batch_size = 4;
+  const int repeat = 3;
+  std::mt19937 rng(0);
+  // channels, size
+  std::vector<std::vector<int>> layers = {
+      {64, 56}, {128, 28}, {256, 14}, {512, 7}};
+  for (const auto& layer : layers) {
+    const int channels = layer[0], size = layer[1];
+    Tensor input, filter, output, expected;
+    RandomTensor<float>({batch_size, channels, size, size}, &rng, &input);
+    RandomTensor<float>({channels, channels, 3, 3}, &rng, &filter);
+    auto output_dims = make_ddim({batch_size, channels, size, size});
+    output.mutable_data<float>(output_dims, CPUPlace());
+    expected.mutable_data<float>(output_dims, CPUPlace());
+    const int tile_size = math::WinogradTileSize(size, size);
+    math::WinogradConvFunctor<CPUDeviceContext, float> winograd;
+    auto& cache = math::WinogradFilterCache<float>::Instance();
+
+    // As in inference, the filter is transformed before the first run.
+    cache.Get(context, filter, tile_size);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; ++r) {
+      GemmConv<float>(context, input, filter, 1, &expected);
+    }
+    auto gemm_end = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; ++r) {
+      Tensor transformed_filter = cache.Get(context, filter, tile_size);
+      winograd(context, input, transformed_filter, tile_size, {1, 1},
+               &output);
+    }
+    auto winograd_end = std::chrono::steady_clock::now();
+
+    float max_error = 0;
+    for (int64_t i = 0; i < output.numel(); ++i) {
+      max_error = std::max(max_error, std::abs(expected.data<float>()[i] -
+                                               output.data<float>()[i]));
+    }
+    // The sums are of 9 * channels products of values in [-1, 1].
+    EXPECT_LT(max_error, 1e-3);
+    LOG(INFO) << "channels " << channels << " size " << size << ": F("
+              << tile_size << "x" << tile_size << ", 3x3) "
+              << std::chrono::duration<double, std::milli>(winograd_end -
+                                                           gemm_end)
+                         .count() /
+                     repeat
+              << " ms, im2col + gemm "
+              << std::chrono::duration<double, std::milli>(gemm_end - start)
+                         .count() /
+                     repeat
+              << " ms, max error " << max_error;
+  }
+}
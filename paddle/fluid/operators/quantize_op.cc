@@ -0,0 +1,80 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/int8_gemm.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+class QuantizeOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("X"),
+                   "Input(X) of QuantizeOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                   "Output(Out) of QuantizeOp should not be null.");
+    ctx->SetOutputDim("Out", ctx->GetInputDim("X"));
+    ctx->ShareLoD("X", /*->*/ "Out");
+  }
+};
+
+class QuantizeOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  QuantizeOpMaker(OpProto* proto, OpAttrChecker* op_checker)
+      : OpProtoAndCheckerMaker(proto, op_checker) {
+    AddInput("X", "(Tensor) The float32 input tensor of quantize operator.");
+    AddOutput("Out", "(Tensor) The int8 output tensor of quantize operator.");
+    AddAttr<float>("scale",
+                   "(float) The quantization scale, 127 divided by the "
+                   "largest absolute value expected in X.")
+        .GreaterThan(0.0f);
+    AddComment(R"DOC(
+Quantize Operator.
+
+Quantizes a float32 tensor to int8 for the int8 inference operators:
+
+$$Out = min(max(round(X * scale), -127), 127)$$
+
+It is inserted by the `int8_quantize` inference pass in front of the inputs
+of `quantized_fc` and `quantized_conv2d`, which dequantize their results back
+to float32 themselves.
+
+)DOC");
+  }
+};
+
+template <typename DeviceContext, typename T>
+class QuantizeKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    const Tensor* x = context.Input<Tensor>("X");
+    Tensor* out = context.Output<Tensor>("Out");
+    float scale = context.Attr<float>("scale");
+    math::QuantizeToInt8(x->data<float>(), x->numel(), scale,
+                         out->mutable_data<int8_t>(context.GetPlace()));
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(quantize, ops::QuantizeOp, ops::QuantizeOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    quantize, ops::QuantizeKernel<paddle::platform::CPUDeviceContext, float>);
@@ -0,0 +1,157 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+#include <vector>
+#include "paddle/fluid/operators/bias_activation.h"
+#include "paddle/fluid/operators/conv_op.h"
+#include "paddle/fluid/operators/math/int8_gemm.h"
+
+namespace paddle {
+namespace operators {
+
+class QuantizedConv2DOpMaker : public Conv2DOpMaker {
+ public:
+  QuantizedConv2DOpMaker(OpProto* proto, OpAttrChecker* op_checker)
+      : Conv2DOpMaker(proto, op_checker) {
+    AddInput("Bias",
+             "(Tensor, optional) The float32 bias of convolution, a 1-D "
+             "tensor with one element per output channel.")
+        .AsDispensable();
+    AddAttr<std::string>("activation",
+                         "(string, default identity) The activation applied "
+                         "to the output, one of identity, relu, sigmoid and "
+                         "tanh.")
+        .SetDefault("identity");
+    AddAttr<float>("input_scale",
+                   "(float) The scale Input was quantized with.")
+        .GreaterThan(0.0f);
+    AddAttr<std::vector<float>>(
+        "weight_scale",
+        "(vector<float>) The scales Filter was quantized with, one per output "
+        "channel.");
+    AddComment(R"DOC(
+Quantized Conv2D Operator.
+
+The int8 counterpart of the conv2d_fusion operator. Input and Filter are int8,
+the convolution is accumulated in int32 and dequantized per output channel,
+
+$$Output = act(\frac{conv2d(Input_{int8}, Filter_{int8})}{input\_scale * weight\_scale} + Bias)$$
+
+so Output is float32. Only groups = 1 and dilations = 1 are supported. It is
+created by the `int8_quantize` inference pass and has no gradient operator.
+)DOC");
+  }
+};
+
+class QuantizedConv2DOp : public ConvOp {
+ public:
+  using ConvOp::ConvOp;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    ConvOp::InferShape(ctx);
+    auto filter_dims = ctx->GetInputDim("Filter");
+    auto weight_scale = ctx->Attrs().Get<std::vector<float>>("weight_scale");
+    PADDLE_ENFORCE_EQ(static_cast<int64_t>(weight_scale.size()),
+                      filter_dims[0],
+                      "Attr(weight_scale) should have one scale per output "
+                      "channel.");
+    if (ctx->HasInput("Bias")) {
+      auto bias_dims = ctx->GetInputDim("Bias");
+      PADDLE_ENFORCE_EQ(framework::product(bias_dims), filter_dims[0],
+                        "The size of Input(Bias) of QuantizedConv2DOp should "
+                        "be equal to the number of output channels.");
+    }
+  }
+};
+
+template <typename DeviceContext, typename T>
+class QuantizedConv2DKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    PADDLE_ENFORCE(platform::is_cpu_place(context.GetPlace()),
+                   "quantized_conv2d only supports CPUPlace.");
+    const Tensor* input = context.Input<Tensor>("Input");
+    const Tensor* filter = context.Input<Tensor>("Filter");
+    const Tensor* bias = context.Input<Tensor>("Bias");
+    Tensor* output = context.Output<Tensor>("Output");
+
+    int groups = context.Attr<int>("groups");
+    std::vector<int> strides = context.Attr<std::vector<int>>("strides");
+    std::vector<int> paddings = context.Attr<std::vector<int>>("paddings");
+    std::vector<int> dilations = context.Attr<std::vector<int>>("dilations");
+    float input_scale = context.Attr<float>("input_scale");
+    auto weight_scale = context.Attr<std::vector<float>>("weight_scale");
+    FusedActivation act =
+        GetFusedActivation(context.Attr<std::string>("activation"));
+    PADDLE_ENFORCE_EQ(groups, 1, "quantized_conv2d only supports groups = 1.");
+    PADDLE_ENFORCE(dilations[0] == 1 && dilations[1] == 1,
+                   "quantized_conv2d only supports dilations = 1.");
+
+    const int64_t batch_size = input->dims()[0];
+    const int64_t out_channels = filter->dims()[0];
+    const int64_t out_height = output->dims()[2];
+    const int64_t out_width = output->dims()[3];
+    const int64_t spatial = out_height * out_width;
+    const int64_t depth = filter->numel() / out_channels;
+    framework::DDim input_shape =
+        framework::slice_ddim(input->dims(), 1, input->dims().size());
+
+    // The kOCF layout puts every receptive field in a contiguous row of
+    // length C * kh * kw, the same layout as the rows of the filter.
+    Tensor col;
+    col.mutable_data<T>({out_height, out_width, filter->dims()[1],
+                         filter->dims()[2], filter->dims()[3]},
+                        platform::CPUPlace());
+    Tensor acc;
+    int32_t* acc_data = acc.mutable_data<int32_t>({out_channels, spatial},
+                                                  platform::CPUPlace());
+
+    std::vector<float> dequant(out_channels);
+    for (int64_t c = 0; c < out_channels; ++c) {
+      dequant[c] = 1.0f / (input_scale * weight_scale[c]);
+    }
+
+    math::Im2ColFunctor<math::ColFormat::kOCF, DeviceContext, T> im2col;
+    auto& dev_ctx = context.template device_context<DeviceContext>();
+    float* out_data = output->mutable_data<float>(context.GetPlace());
+    for (int64_t i = 0; i < batch_size; ++i) {
+      Tensor in_batch = input->Slice(i, i + 1).Resize(input_shape);
+      im2col(dev_ctx, in_batch, dilations, strides,
+             std::vector<int>{paddings[0], paddings[1], paddings[0],
+                              paddings[1]},
+             &col);
+      math::Int8GemmNT(out_channels, spatial, depth, filter->data<T>(),
+                       col.data<T>(), acc_data);
+      float* out_batch = out_data + i * out_channels * spatial;
+      for (int64_t c = 0; c < out_channels; ++c) {
+        for (int64_t j = 0; j < spatial; ++j) {
+          out_batch[c * spatial + j] = acc_data[c * spatial + j] * dequant[c];
+        }
+      }
+    }
+    BiasActivation<float>(bias ? bias->data<float>() : nullptr, out_data,
+                          batch_size, out_channels, spatial, act);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(quantized_conv2d, ops::QuantizedConv2DOp,
+                             ops::QuantizedConv2DOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    quantized_conv2d,
+    ops::QuantizedConv2DKernel<paddle::platform::CPUDeviceContext, int8_t>);
@@ -0,0 +1,182 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/bias_activation.h"
+#include "paddle/fluid/operators/math/int8_gemm.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+class QuantizedFCOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("Input"),
+                   "Input(Input) of QuantizedFCOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("W"),
+                   "Input(W) of QuantizedFCOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                   "Output(Out) of QuantizedFCOp should not be null.");
+
+    auto in_dims = ctx->GetInputDim("Input");
+    auto w_dims = ctx->GetInputDim("W");
+    int in_num_col_dims = ctx->Attrs().Get<int>("in_num_col_dims");
+    auto weight_scale = ctx->Attrs().Get<std::vector<float>>("weight_scale");
+
+    PADDLE_ENFORCE_EQ(w_dims.size(), 2,
+                      "Input(W) of QuantizedFCOp should be 2-D.");
+    PADDLE_ENFORCE_GT(
+        in_dims.size(), in_num_col_dims,
+        "The rank of Input(Input) of QuantizedFCOp should be larger than "
+        "in_num_col_dims.");
+    auto in_mat_dims = framework::flatten_to_2d(in_dims, in_num_col_dims);
+    PADDLE_ENFORCE_EQ(
+        in_mat_dims[1], w_dims[1],
+        "The width of flattened Input(Input) must be equal to the width of "
+        "the transposed Input(W).");
+    PADDLE_ENFORCE_EQ(static_cast<int64_t>(weight_scale.size()), w_dims[0],
+                      "Attr(weight_scale) should have one scale per output "
+                      "column.");
+
+    if (ctx->HasInput("Bias")) {
+      auto bias_dims = ctx->GetInputDim("Bias");
+      PADDLE_ENFORCE_EQ(framework::product(bias_dims), w_dims[0],
+                        "The size of Input(Bias) of QuantizedFCOp should be "
+                        "equal to the height of Input(W).");
+    }
+
+    std::vector<int64_t> out_dims;
+    out_dims.reserve(static_cast<size_t>(in_num_col_dims + 1));
+    for (int i = 0; i < in_num_col_dims; ++i) {
+      out_dims.push_back(in_dims[i]);
+    }
+    out_dims.push_back(w_dims[0]);
+
+    ctx->SetOutputDim("Out", framework::make_ddim(out_dims));
+    ctx->ShareLoD("Input", /*->*/ "Out");
+  }
+
+ protected:
+  // The int8 Input decides the kernel, the float Bias is read as is.
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(ctx.Input<Tensor>("Input")->type()),
+        ctx.GetPlace());
+  }
+};
+
+class QuantizedFCOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  QuantizedFCOpMaker(OpProto* proto, OpAttrChecker* op_checker)
+      : OpProtoAndCheckerMaker(proto, op_checker) {
+    AddInput("Input",
+             "(Tensor) The int8 input tensor, quantized with "
+             "Attr(input_scale).");
+    AddInput("W",
+             "(Tensor) The transposed int8 weight matrix of shape [N, K], "
+             "row n quantized with Attr(weight_scale)[n].");
+    AddInput("Bias", "(Tensor, optional) The float32 bias of size N.")
+        .AsDispensable();
+    AddOutput("Out", "(Tensor) The float32 output tensor.");
+    AddAttr<int>("in_num_col_dims",
+                 "(int, default 1) Same as in_num_col_dims of fc operator.")
+        .SetDefault(1)
+        .EqualGreaterThan(1);
+    AddAttr<std::string>("activation_type",
+                         "(string, default identity) The activation applied "
+                         "to the output, one of identity, relu, sigmoid and "
+                         "tanh.")
+        .SetDefault("identity");
+    AddAttr<float>("input_scale",
+                   "(float) The scale Input was quantized with.")
+        .GreaterThan(0.0f);
+    AddAttr<std::vector<float>>(
+        "weight_scale", "(vector<float>) The scales W was quantized with.");
+    AddComment(R"DOC(
+Quantized FC Operator.
+
+The int8 counterpart of the fc operator. The product of the int8 Input and W
+is accumulated in int32 and dequantized per output column,
+
+$$Out = act(\frac{Input_{int8} * W_{int8}^T}{input\_scale * weight\_scale} + Bias)$$
+
+so the result is float32 and feeds float operators directly. It is created by
+the `int8_quantize` inference pass and has no gradient operator.
+
+)DOC");
+  }
+};
+
+template <typename DeviceContext, typename T>
+class QuantizedFCKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    PADDLE_ENFORCE(platform::is_cpu_place(context.GetPlace()),
+                   "quantized_fc only supports CPUPlace.");
+    const Tensor* input = context.Input<Tensor>("Input");
+    const Tensor* w = context.Input<Tensor>("W");
+    const Tensor* bias = context.Input<Tensor>("Bias");
+    Tensor* out = context.Output<Tensor>("Out");
+
+    int in_num_col_dims = context.Attr<int>("in_num_col_dims");
+    float input_scale = context.Attr<float>("input_scale");
+    auto weight_scale = context.Attr<std::vector<float>>("weight_scale");
+    FusedActivation act =
+        GetFusedActivation(context.Attr<std::string>("activation_type"));
+
+    const Tensor in_matrix =
+        input->dims().size() > 2
+            ? framework::ReshapeToMatrix(*input, in_num_col_dims)
+            : *input;
+    const int64_t rows = in_matrix.dims()[0];
+    const int64_t depth = in_matrix.dims()[1];
+    const int64_t cols = w->dims()[0];
+
+    Tensor acc;
+    int32_t* acc_data =
+        acc.mutable_data<int32_t>({rows, cols}, platform::CPUPlace());
+    math::Int8GemmNT(rows, cols, depth, in_matrix.data<T>(), w->data<T>(),
+                     acc_data);
+
+    std::vector<float> dequant(cols);
+    for (int64_t j = 0; j < cols; ++j) {
+      dequant[j] = 1.0f / (input_scale * weight_scale[j]);
+    }
+    float* out_data = out->mutable_data<float>(context.GetPlace());
+    for (int64_t i = 0; i < rows; ++i) {
+      for (int64_t j = 0; j < cols; ++j) {
+        out_data[i * cols + j] = acc_data[i * cols + j] * dequant[j];
+      }
+    }
+    BiasActivation<float>(bias ? bias->data<float>() : nullptr, out_data, rows,
+                          cols, 1, act);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(quantized_fc, ops::QuantizedFCOp,
+                             ops::QuantizedFCOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    quantized_fc,
+    ops::QuantizedFCKernel<paddle::platform::CPUDeviceContext, int8_t>);
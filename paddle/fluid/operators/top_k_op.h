@@ -13,10 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
-#include <algorithm>
-#include <iostream>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/top_k.h"
 
 namespace paddle {
 namespace operators {
@@ -38,38 +37,19 @@ class TopkKernel : public framework::OpKernel<T> {
     auto* output = ctx.Output<LoDTensor>("Out");
     auto* indices = ctx.Output<LoDTensor>("Indices");
     // k is determined by Attr
-    const size_t k = static_cast<int>(ctx.Attr<int>("k"));
+    const int64_t k = ctx.Attr<int>("k");
 
     T* output_data = output->mutable_data<T>(ctx.GetPlace());
     int64_t* indices_data = indices->mutable_data<int64_t>(ctx.GetPlace());
 
-    auto eg_input = EigenMatrix<T>::From(*input);
-
-    // reshape input to a flattern matrix(like flat_inner_dims)
+    // view the input as a matrix (like flat_inner_dims)
     framework::DDim inputdims = input->dims();
-    const size_t row = framework::product(
+    const int64_t row = framework::product(
         framework::slice_ddim(inputdims, 0, inputdims.size() - 1));
-    const size_t col = inputdims[inputdims.size() - 1];
-    Eigen::DSizes<int, 2> flat2dims(row, col);
-    // NOTE: eigen shape doesn't affect paddle tensor.
-    eg_input.reshape(flat2dims);
-
-    for (size_t i = 0; i < row; i++) {
-      std::vector<std::pair<T, size_t>> vec;
-      for (size_t j = 0; j < col; j++) {
-        vec.push_back(std::pair<T, size_t>(eg_input(i, j), j));
-      }
+    const int64_t col = inputdims[inputdims.size() - 1];
 
-      std::partial_sort(
-          vec.begin(), vec.begin() + k, vec.end(),
-          [](const std::pair<T, size_t>& l, const std::pair<T, size_t>& r) {
-            return l.first > r.first;
-          });
-      for (size_t j = 0; j < k; j++) {
-        output_data[i * k + j] = vec[j].first;
-        indices_data[i * k + j] = int64_t(vec[j].second);
-      }
-    }
+    math::PartialTopKRows(input->data<T>(), row, col, k, output_data,
+                          indices_data);
   }
 };
 
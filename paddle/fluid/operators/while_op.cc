@@ -12,6 +12,8 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <memory>
+#include <mutex>
 #include <vector>
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/framework/lod_tensor_array.h"
@@ -31,6 +33,48 @@ static constexpr char kStepScopes[] = "StepScopes";
 static constexpr char kX[] = "X";
 static constexpr char kXGRAD[] = "X@GRAD";
 static constexpr char kOutputs[] = "Out";
+static constexpr char kIsTest[] = "is_test";
+
+// The state a while operator keeps across its runs: the step block prepared
+// for the executor and, with is_test, the scope of the steps, so that neither
+// the operators nor the variables of the step block are created at every
+// run. Runs of one operator share the state under the mutex. A cloned
+// operator starts without state.
+struct WhileOpCache {
+  WhileOpCache() {}
+  WhileOpCache(const WhileOpCache &) {}
+  WhileOpCache &operator=(const WhileOpCache &) { return *this; }
+
+  framework::ExecutorPrepareContext *Prepare(
+      const framework::BlockDesc *block) {
+    if (block_ != block) {
+      ctx_ = framework::Executor::Prepare(*block->Program(), block->ID());
+      block_ = block;
+    }
+    return ctx_.get();
+  }
+
+  std::mutex mutex_;
+  const framework::BlockDesc *block_{nullptr};
+  std::unique_ptr<framework::ExecutorPrepareContext> ctx_;
+  std::unique_ptr<framework::Scope> step_scope_;
+};
+
+// Hangs the cached step scope under the scope of a run, and detaches it when
+// the run ends, also by an exception, before that scope can be deleted.
+class StepScopeGuard {
+ public:
+  StepScopeGuard(framework::Scope *step_scope, const framework::Scope &parent)
+      : step_scope_(step_scope) {
+    step_scope_->SetParent(&parent);
+  }
+  ~StepScopeGuard() { step_scope_->SetParent(nullptr); }
+
+ private:
+  framework::Scope *step_scope_;
+
+  DISABLE_COPY_AND_ASSIGN(StepScopeGuard);
+};
 
 class WhileOp : public framework::OperatorBase {
  public:
@@ -49,21 +93,49 @@ class WhileOp : public framework::OperatorBase {
     framework::Executor executor(dev_place);
     auto *block = Attr<framework::BlockDesc *>(kStepBlock);
 
-    auto *program = block->Program();
+    std::lock_guard<std::mutex> lock(cache_.mutex_);
+    auto *ctx = cache_.Prepare(block);
 
     auto step_scopes =
         scope.FindVar(Output(kStepScopes))->GetMutable<StepScopeVar>();
 
     PADDLE_ENFORCE(platform::is_cpu_place(cond.place()),
                    "Condition of while op must in CPU memory.");
-    while (cond.data<bool>()[0]) {
-      auto &current_scope = scope.NewScope();
-      step_scopes->push_back(&current_scope);
+    if (!Attr<bool>(kIsTest)) {
+      while (cond.data<bool>()[0]) {
+        auto &current_scope = scope.NewScope();
+        step_scopes->push_back(&current_scope);
 
-      executor.Run(*program, &current_scope, block->ID(),
-                   false /*create_local_scope*/);
+        executor.RunPreparedContext(ctx, &current_scope,
+                                    false /*create_local_scope*/);
+      }
+      return;
+    }
+
+    // Without backward, the steps of all the runs share one scope, so that
+    // the variables of the step block and their memory are reused by every
+    // step. With backward, the step scopes are kids of the scope of the run,
+    // which the backward reads and drops.
+    if (cache_.step_scope_ == nullptr) {
+      cache_.step_scope_.reset(new framework::Scope());
+    }
+    auto &current_scope = *cache_.step_scope_;
+    StepScopeGuard guard(&current_scope, scope);
+    while (cond.data<bool>()[0]) {
+      for (auto &name : current_scope.LocalVarNames()) {
+        auto *var = current_scope.FindVar(name);
+        if (var->IsType<LoDTensor>()) {
+          var->GetMutable<LoDTensor>()->set_lod(framework::LoD());
+        } else if (var->IsType<framework::LoDTensorArray>()) {
+          var->GetMutable<framework::LoDTensorArray>()->clear();
+        }
+      }
+      executor.RunPreparedContext(ctx, &current_scope,
+                                  false /*create_local_scope*/);
     }
   }
+
+  mutable WhileOpCache cache_;
 };
 
 class WhileOpMaker : public framework::OpProtoAndCheckerMaker {
@@ -88,6 +160,11 @@ class WhileOpMaker : public framework::OpProtoAndCheckerMaker {
               "variables generated in the i'th step.");
     AddAttr<framework::BlockDesc *>(kStepBlock,
                                     "The step block inside WhileOp");
+    AddAttr<bool>(kIsTest,
+                  "(bool, default false) Set to true for inference only, the "
+                  "steps then reuse one scope and StepScopes stays empty, so "
+                  "the backward cannot run.")
+        .SetDefault(false);
     AddComment(R"DOC(
 )DOC");
   }
@@ -108,7 +185,8 @@ class WhileGradOp : public framework::OperatorBase {
     auto &dev_ctx = *pool.Get(dev_place);
     framework::Executor executor(dev_place);
     auto *block = Attr<framework::BlockDesc *>(kStepBlock);
-    auto *program = block->Program();
+    std::lock_guard<std::mutex> lock(cache_.mutex_);
+    auto *ctx = cache_.Prepare(block);
 
     auto *step_scopes =
         scope.FindVar(Input(kStepScopes))->GetMutable<StepScopeVar>();
@@ -163,7 +241,8 @@ class WhileGradOp : public framework::OperatorBase {
         }
       }
 
-      executor.Run(*program, *cur_scope_iter, block->ID(), false);
+      executor.RunPreparedContext(ctx, *cur_scope_iter,
+                                  false /*create_local_scope*/);
 
       auto &pg_names = Outputs(kXGRAD);
       auto &p_names = Inputs(kX);
@@ -216,6 +295,8 @@ class WhileGradOp : public framework::OperatorBase {
       const_cast<framework::Scope &>(scope).DeleteScope(&cur_scope);
     }
   }
+
+  mutable WhileOpCache cache_;
 };
 
 class WhileGradOpDescMaker : public framework::SingleGradOpDescMaker {
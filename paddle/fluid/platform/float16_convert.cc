@@ -0,0 +1,155 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/float16_convert.h"
+#include <string.h>
+
+// PADDLE_WITH_F16C_DISPATCH is defined by cmake/configure.cmake when the
+// compiler accepts F16C intrinsics in a target("avx,f16c") function.
+#ifdef PADDLE_WITH_F16C_DISPATCH
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace paddle {
+namespace platform {
+
+#ifdef PADDLE_WITH_F16C_DISPATCH
+
+namespace {
+
+// Compiled for F16C regardless of the global SIMD flags, only called after
+// HasF16C() returned true.
+__attribute__((target("avx,f16c"))) void FloatToFloat16F16C(const float* src,
+                                                            float16* dst,
+                                                            int64_t n) {
+  int64_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), 0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+  }
+  for (; i < n; ++i) {
+    dst[i].x = _cvtss_sh(src[i], 0);
+  }
+}
+
+__attribute__((target("avx,f16c"))) void Float16ToFloatF16C(const float16* src,
+                                                            float* dst,
+                                                            int64_t n) {
+  int64_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+  }
+  for (; i < n; ++i) {
+    dst[i] = _cvtsh_ss(src[i].x);
+  }
+}
+
+// XCR0, which tells the register states the OS saves.
+inline uint64_t XGetBV0() {
+  unsigned int eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+}
+
+}  // namespace
+
+bool HasF16C() {
+  static bool has_f16c = [] {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+      return false;
+    }
+    if ((ecx & bit_F16C) == 0 || (ecx & bit_AVX) == 0 ||
+        (ecx & bit_OSXSAVE) == 0) {
+      return false;
+    }
+    // The YMM registers can only be used if the OS saves the SSE and AVX
+    // states (XCR0 bits 1-2).
+    return (XGetBV0() & 0x6) == 0x6;
+  }();
+  return has_f16c;
+}
+
+#else
+
+bool HasF16C() { return false; }
+
+#endif
+
+namespace {
+
+// Rounds to the nearest half precision value, ties to even, like F16C does.
+// The float16 constructor truncates on CPUs without F16C, which would make
+// results depend on the machine.
+uint16_t FloatToHalfBits(float f) {
+  const uint32_t f32_infinity = 255U << 23;
+  const uint32_t f16_overflow = (127U + 16) << 23;
+  const uint32_t denorm_magic = ((127U - 15) + (23 - 10) + 1) << 23;
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(bits));
+  uint32_t sign = bits & 0x80000000U;
+  bits ^= sign;
+
+  uint16_t half;
+  if (bits >= f16_overflow) {
+    // Infinity, or NaN which stays a quiet NaN.
+    half = bits > f32_infinity ? 0x7e00 : 0x7c00;
+  } else if (bits < (113U << 23)) {
+    // The result is subnormal: adding 0.5 lets the FPU do the rounding.
+    float value, magic;
+    memcpy(&value, &bits, sizeof(bits));
+    memcpy(&magic, &denorm_magic, sizeof(denorm_magic));
+    value += magic;
+    memcpy(&bits, &value, sizeof(bits));
+    half = static_cast<uint16_t>(bits - denorm_magic);
+  } else {
+    uint32_t mantissa_odd = (bits >> 13) & 1;
+    // Rebias the exponent and round the mantissa to nearest even.
+    bits += ((15U - 127) << 23) + 0xfff;
+    bits += mantissa_odd;
+    half = static_cast<uint16_t>(bits >> 13);
+  }
+  return half | static_cast<uint16_t>(sign >> 16);
+}
+
+}  // namespace
+
+void FloatToFloat16(const float* src, float16* dst, int64_t n) {
+#ifdef PADDLE_WITH_F16C_DISPATCH
+  if (HasF16C()) {
+    FloatToFloat16F16C(src, dst, n);
+    return;
+  }
+#endif
+  for (int64_t i = 0; i < n; ++i) {
+    dst[i].x = FloatToHalfBits(src[i]);
+  }
+}
+
+void Float16ToFloat(const float16* src, float* dst, int64_t n) {
+#ifdef PADDLE_WITH_F16C_DISPATCH
+  if (HasF16C()) {
+    Float16ToFloatF16C(src, dst, n);
+    return;
+  }
+#endif
+  for (int64_t i = 0; i < n; ++i) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
+}  // namespace platform
+}  // namespace paddle
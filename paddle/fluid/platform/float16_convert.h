@@ -0,0 +1,34 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <stdint.h>
+#include "paddle/math/float16.h"
+
+namespace paddle {
+namespace platform {
+
+// Bulk conversions between float and float16 on CPU. On x86 CPUs with F16C
+// they convert 8 values per instruction, whatever the SIMD flags the library
+// was compiled with, since the instruction set is detected at runtime.
+// Otherwise they fall back to the element-wise conversions of float16.
+void FloatToFloat16(const float* src, float16* dst, int64_t n);
+void Float16ToFloat(const float16* src, float* dst, int64_t n);
+
+// Whether the CPU supports the F16C conversion instructions.
+bool HasF16C();
+
+}  // namespace platform
+}  // namespace paddle
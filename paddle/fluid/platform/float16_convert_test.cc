@@ -0,0 +1,46 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/float16_convert.h"
+#include <vector>
+#include "gtest/gtest.h"
+
+using paddle::float16;
+
+TEST(float16_convert, round_to_nearest_even) {
+  // 11 values exercise both the 8-wide loop and the remainder.
+  std::vector<float> src{0.0f,     1.0f,     -2.5f,  65504.0f,
+                         1024.75f, 1024.5f,  1e-7f,  65520.0f,
+                         -0.0625f, 100.25f,  2.0f};
+  std::vector<uint16_t> expected{0x0000, 0x3c00, 0xc100, 0x7bff,
+                                 0x6401, 0x6400, 0x0002, 0x7c00,
+                                 0xac00, 0x5644, 0x4000};
+  std::vector<float16> half(src.size());
+  paddle::platform::FloatToFloat16(src.data(), half.data(), src.size());
+  for (size_t i = 0; i < src.size(); ++i) {
+    EXPECT_EQ(half[i].x, expected[i]) << "at " << src[i];
+  }
+
+  std::vector<float> dst(src.size());
+  paddle::platform::Float16ToFloat(half.data(), dst.data(), half.size());
+  for (size_t i = 0; i < src.size(); ++i) {
+    EXPECT_EQ(dst[i], static_cast<float>(half[i]));
+  }
+  // Values representable in half precision survive the round trip.
+  EXPECT_EQ(dst[1], 1.0f);
+  EXPECT_EQ(dst[2], -2.5f);
+  EXPECT_EQ(dst[3], 65504.0f);
+  EXPECT_EQ(dst[9], 100.25f);
+  EXPECT_EQ(dst[4], 1025.0f);
+}
@@ -13,9 +13,17 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/platform/profiler.h"
+#include <fstream>
 #include <iomanip>
+#include <limits>
 #include <map>
+#include "gflags/gflags.h"
 #include "glog/logging.h"
+#include "paddle/fluid/memory/memory.h"
+
+DEFINE_bool(profile_memory, false,
+            "Record the memory allocated by the thread with each profiler "
+            "event, and report the memory each event takes.");
 
 namespace paddle {
 namespace platform {
@@ -47,8 +55,18 @@ inline uint64_t GetTimeInNsec() {
 }
 
 Event::Event(EventKind kind, std::string name, uint32_t thread_id,
-             const DeviceContext* dev_ctx)
-    : kind_(kind), name_(name), thread_id_(thread_id), has_cuda_(false) {
+             const DeviceContext* dev_ctx, std::string detail, double flops)
+    : kind_(kind),
+      name_(name),
+      thread_id_(thread_id),
+      has_cuda_(false),
+      detail_(std::move(detail)),
+      flops_(flops) {
+  thread_allocated_ =
+      FLAGS_profile_memory
+          ? memory::thread_allocated(dev_ctx ? dev_ctx->GetPlace()
+                                             : Place(CPUPlace()))
+          : 0;
 #ifdef PADDLE_WITH_CUDA
   has_cuda_ = dev_ctx ? platform::is_gpu_place(dev_ctx->GetPlace()) : false;
   if (has_cuda_) {
@@ -122,10 +140,14 @@ void PushEvent(const std::string& name, const DeviceContext* dev_ctx) {
   GetEventList().Record(EventKind::kPushRange, name, g_thread_id, dev_ctx);
 }
 
-void PopEvent(const std::string& name, const DeviceContext* dev_ctx) {
-  GetEventList().Record(EventKind::kPopRange, name, g_thread_id, dev_ctx);
+void PopEvent(const std::string& name, const DeviceContext* dev_ctx,
+              const std::string& detail, double flops) {
+  GetEventList().Record(EventKind::kPopRange, name, g_thread_id, dev_ctx,
+                        detail, flops);
 }
 
+bool IsProfileEnabled() { return g_state != ProfilerState::kDisabled; }
+
 RecordEvent::RecordEvent(const std::string& name,
                          const DeviceContext* dev_ctx) {
   if (g_state == ProfilerState::kDisabled) return;
@@ -139,6 +161,17 @@ RecordEvent::~RecordEvent() {
   PopEvent(name_, dev_ctx_);
 }
 
+void SetPopEventDetail(const std::string& name, std::string detail,
+                       double flops) {
+  if (g_state == ProfilerState::kDisabled) return;
+  auto& blocks = GetEventList().event_blocks;
+  if (blocks.empty() || blocks.front().empty()) return;
+  Event& last = blocks.front().back();
+  if (last.kind() == "pop" && last.name() == name) {
+    last.set_detail(std::move(detail), flops);
+  }
+}
+
 void EnableProfiler(ProfilerState state) {
   PADDLE_ENFORCE(state != ProfilerState::kDisabled,
                  "Can't enbale profling, since the input state is ",
@@ -183,7 +216,8 @@ std::vector<std::vector<Event>> GetAllEvents() {
   return result;
 }
 
-void DisableProfiler(EventSortingKey sorted_key) {
+void DisableProfiler(EventSortingKey sorted_key,
+                     const std::string& trace_path) {
   PADDLE_ENFORCE(g_state != ProfilerState::kDisabled,
                  "Can't disable profiling, since it's not starting.");
   // Mark the profiling stop.
@@ -192,9 +226,42 @@ void DisableProfiler(EventSortingKey sorted_key) {
 
   std::vector<std::vector<Event>> all_events = GetAllEvents();
   ParseEvents(all_events, sorted_key);
+  if (!trace_path.empty()) {
+    ExportChromeTrace(all_events, trace_path);
+  }
   ResetProfiler();
 }
 
+// Calls `on_pair` for each pop event of one thread with its push event, the
+// latest unmatched push event of the same name. Returns the push events
+// which have no pop event.
+static std::list<Event> MatchEvents(
+    const std::vector<Event>& events,
+    std::function<void(const Event&, const Event&)> on_pair) {
+  std::list<Event> pushed_events;
+  for (auto& event : events) {
+    if (event.kind() == "push") {
+      pushed_events.push_back(event);
+    } else if (event.kind() == "pop") {
+      std::list<Event>::reverse_iterator rit = pushed_events.rbegin();
+      while (rit != pushed_events.rend() && rit->name() != event.name()) {
+        ++rit;
+      }
+
+      if (rit != pushed_events.rend()) {
+        on_pair(*rit, event);
+        // remove the push marker from the list
+        pushed_events.erase((++rit).base());
+      } else {
+        LOG(WARNING) << "Cannot find the push marker of event \'"
+                     << event.name()
+                     << "\', which will be ignored in profiling report.";
+      }
+    }
+  }
+  return pushed_events;
+}
+
 void ParseEvents(std::vector<std::vector<Event>>& events,
                  EventSortingKey sorted_by) {
   if (g_profiler_place == "") return;
@@ -239,55 +306,41 @@ void ParseEvents(std::vector<std::vector<Event>>& events,
   std::vector<std::vector<EventItem>> events_table;
   size_t max_name_width = 0;
   for (size_t i = 0; i < events.size(); i++) {
-    std::list<Event> pushed_events;
     std::vector<EventItem> event_items;
     std::unordered_map<std::string, int> event_idx;
 
-    for (size_t j = 0; j < events[i].size(); j++) {
-      if (events[i][j].kind() == "push") {
-        pushed_events.push_back(events[i][j]);
-      } else if (events[i][j].kind() == "pop") {
-        std::list<Event>::reverse_iterator rit = pushed_events.rbegin();
-        while (rit != pushed_events.rend() &&
-               rit->name() != events[i][j].name()) {
-          ++rit;
-        }
-
-        if (rit != pushed_events.rend()) {
-          double event_time = (g_profiler_place == "CUDA")
-                                  ? rit->CudaElapsedMs(events[i][j])
-                                  : rit->CpuElapsedMs(events[i][j]);
-          std::string event_name =
-              "thread" + std::to_string(rit->thread_id()) + "::" + rit->name();
-          max_name_width = std::max(max_name_width, event_name.size());
-
-          if (event_idx.find(event_name) == event_idx.end()) {
-            event_idx[event_name] = event_items.size();
-            EventItem event_item = {event_name, 1,          event_time,
-                                    event_time, event_time, event_time};
-            event_items.push_back(event_item);
-          } else {
-            int index = event_idx[event_name];
-            event_items[index].calls += 1;
-            // total time
-            event_items[index].total_time += event_time;
-            // min time
-            event_items[index].min_time =
-                std::min(event_time, event_items[index].min_time);
-            // max time
-            event_items[index].max_time =
-                std::max(event_time, event_items[index].max_time);
-          }
-
-          // remove the push marker from the list
-          pushed_events.erase((++rit).base());
-        } else {
-          LOG(WARNING) << "Cannot find the push marker of event \'"
-                       << events[i][j].name()
-                       << "\', which will be ignored in profiling report.";
-        }
+    auto on_pair = [&](const Event& push, const Event& pop) {
+      double event_time = (g_profiler_place == "CUDA")
+                              ? push.CudaElapsedMs(pop)
+                              : push.CpuElapsedMs(pop);
+      double memory = pop.thread_allocated() - push.thread_allocated();
+      std::string event_name =
+          "thread" + std::to_string(push.thread_id()) + "::" + push.name();
+      max_name_width = std::max(max_name_width, event_name.size());
+
+      if (event_idx.find(event_name) == event_idx.end()) {
+        event_idx[event_name] = event_items.size();
+        EventItem event_item = {event_name, 1,          event_time,
+                                event_time, event_time, event_time,
+                                pop.flops(), memory};
+        event_items.push_back(event_item);
+      } else {
+        int index = event_idx[event_name];
+        event_items[index].calls += 1;
+        // total time
+        event_items[index].total_time += event_time;
+        // min time
+        event_items[index].min_time =
+            std::min(event_time, event_items[index].min_time);
+        // max time
+        event_items[index].max_time =
+            std::max(event_time, event_items[index].max_time);
+        event_items[index].total_flops += pop.flops();
+        event_items[index].total_memory += memory;
       }
-    }
+    };
+    std::list<Event> pushed_events = MatchEvents(events[i], on_pair);
+
     // average time
     for (auto& item : event_items) {
       item.ave_time = item.total_time / item.calls;
@@ -320,6 +373,10 @@ void PrintProfiler(std::vector<std::vector<EventItem>>& events_table,
             << "<-------------------------\n\n";
   std::cout << "Place: " << g_profiler_place << std::endl;
   std::cout << "Time unit: ms" << std::endl;
+  std::cout << "GFLOP/s: estimated FLOPs over the total time, for gemm and "
+            << "convolution operators" << std::endl;
+  std::cout << "Mem.(KB): average memory allocated minus freed by the thread "
+            << "during the event, with --profile_memory" << std::endl;
   std::cout << "Sorted by " << sorted_domain
             << " in descending order in the same thread\n\n";
   // Output events table
@@ -327,7 +384,9 @@ void PrintProfiler(std::vector<std::vector<EventItem>>& events_table,
   std::cout << std::setw(name_width) << "Event" << std::setw(data_width)
             << "Calls" << std::setw(data_width) << "Total"
             << std::setw(data_width) << "Min." << std::setw(data_width)
-            << "Max." << std::setw(data_width) << "Ave." << std::endl;
+            << "Max." << std::setw(data_width) << "Ave."
+            << std::setw(data_width) << "GFLOP/s" << std::setw(data_width)
+            << "Mem.(KB)" << std::endl;
   for (size_t i = 0; i < events_table.size(); ++i) {
     for (size_t j = 0; j < events_table[i].size(); ++j) {
       EventItem& event_item = events_table[i][j];
@@ -336,11 +395,73 @@ void PrintProfiler(std::vector<std::vector<EventItem>>& events_table,
                 << std::setw(data_width) << event_item.total_time
                 << std::setw(data_width) << event_item.min_time
                 << std::setw(data_width) << event_item.max_time
-                << std::setw(data_width) << event_item.ave_time << std::endl;
+                << std::setw(data_width) << event_item.ave_time
+                << std::setw(data_width)
+                << (event_item.total_time > 0
+                        ? event_item.total_flops / event_item.total_time / 1e6
+                        : 0.0)
+                << std::setw(data_width)
+                << event_item.total_memory / event_item.calls / 1024
+                << std::endl;
     }
   }
   std::cout << std::endl;
 }
 
+static std::string EscapeJson(const std::string& str) {
+  std::string escaped;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      escaped += ' ';
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+void ExportChromeTrace(const std::vector<std::vector<Event>>& events,
+                       const std::string& path) {
+  std::ofstream out(path);
+  PADDLE_ENFORCE(out.good(), "Cannot open %s to write the profiler trace",
+                 path);
+  // Timestamps are in microseconds from the first event.
+  int64_t start_ns = std::numeric_limits<int64_t>::max();
+  for (auto& thread_events : events) {
+    for (auto& event : thread_events) {
+      start_ns = std::min(start_ns, event.cpu_ns());
+    }
+  }
+  auto to_us = [](int64_t ns) { return ns / 1000.0; };
+
+  out << std::fixed << std::setprecision(3) << "{\"traceEvents\": [";
+  const char* separator = "\n";
+  for (auto& thread_events : events) {
+    MatchEvents(thread_events, [&](const Event& push, const Event& pop) {
+      out << separator << "{\"name\": \"" << EscapeJson(push.name())
+          << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << push.thread_id()
+          << ", \"ts\": " << to_us(push.cpu_ns() - start_ns)
+          << ", \"dur\": " << to_us(pop.cpu_ns() - push.cpu_ns())
+          << ", \"args\": {\"detail\": \"" << EscapeJson(pop.detail())
+          << "\", \"flops\": " << pop.flops() << ", \"memory_delta\": "
+          << pop.thread_allocated() - push.thread_allocated() << "}}";
+      separator = ",\n";
+    });
+    if (!FLAGS_profile_memory) continue;
+    for (auto& event : thread_events) {
+      out << separator
+          << "{\"name\": \"thread" << event.thread_id()
+          << " allocated\", \"ph\": \"C\", \"pid\": 0, "
+          << "\"ts\": " << to_us(event.cpu_ns() - start_ns)
+          << ", \"args\": {\"bytes\": " << event.thread_allocated() << "}}";
+      separator = ",\n";
+    }
+  }
+  out << "\n]}\n";
+}
+
 }  // namespace platform
 }  // namespace paddle
@@ -16,6 +16,7 @@ limitations under the License. */
 #include <forward_list>
 #include <list>
 #include <mutex>
+#include <string>
 #include <vector>
 #include "paddle/fluid/platform/device_context.h"
 
@@ -28,13 +29,29 @@ class Event {
  public:
   // The DeviceContext is used to get the cuda stream.
   // If CPU profiling mode, can pass nullptr.
+  // `detail` and `flops` describe the work done since the matching push
+  // event, e.g. the input shapes and the estimated FLOPs of an operator.
   Event(EventKind kind, std::string name, uint32_t thread_id,
-        const DeviceContext* dev_ctx);
+        const DeviceContext* dev_ctx, std::string detail = "",
+        double flops = 0.0);
 
   std::string kind() const;
   std::string name() const { return name_; }
   uint32_t thread_id() const { return thread_id_; }
   bool has_cuda() const { return has_cuda_; }
+  const std::string& detail() const { return detail_; }
+  double flops() const { return flops_; }
+  int64_t cpu_ns() const { return cpu_ns_; }
+  // The bytes allocated minus freed by the thread in the event's place, or
+  // in CPUPlace without device context, when the event was recorded. The
+  // difference between a push and its pop is the memory the event took.
+  // Only read with --profile_memory, 0 otherwise.
+  int64_t thread_allocated() const { return thread_allocated_; }
+
+  void set_detail(std::string detail, double flops) {
+    detail_ = std::move(detail);
+    flops_ = flops;
+  }
 
 #ifdef PADDLE_WITH_CUDA
   cudaEvent_t event() const { return event_; }
@@ -50,6 +67,9 @@ class Event {
   uint32_t thread_id_;
   int64_t cpu_ns_;
   bool has_cuda_;
+  std::string detail_;
+  double flops_;
+  int64_t thread_allocated_;
 #ifdef PADDLE_WITH_CUDA
   cudaEvent_t event_ = nullptr;
   int device_ = -1;
@@ -99,7 +119,11 @@ void Mark(const std::string& name, const DeviceContext* dev_ctx);
 
 void PushEvent(const std::string& name, const DeviceContext* dev_ctx);
 
-void PopEvent(const std::string& name, const DeviceContext* dev_ctx);
+void PopEvent(const std::string& name, const DeviceContext* dev_ctx,
+              const std::string& detail = "", double flops = 0.0);
+
+// Whether EnableProfiler has been called and the events are recorded.
+bool IsProfileEnabled();
 
 struct RecordEvent {
   explicit RecordEvent(const std::string& name, const DeviceContext* dev_ctx);
@@ -112,6 +136,13 @@ struct RecordEvent {
   std::string name_;
 };
 
+// Attaches `detail` and `flops` to the last event recorded by the calling
+// thread if it is the pop event of `name`, e.g. of a RecordEvent that has just
+// gone out of scope. This lets the detail be computed outside of the timed
+// range.
+void SetPopEventDetail(const std::string& name, std::string detail,
+                       double flops);
+
 // Return the event list of all threads. Asummed the returned value calls
 // event_lists, event_lists[i][j] represents the j-th Event of i-th thread.
 std::vector<std::vector<Event>> GetAllEvents();
@@ -124,6 +155,9 @@ struct EventItem {
   double min_time;
   double max_time;
   double ave_time;
+  // Sum of the estimated FLOPs and of the memory taken by the thread.
+  double total_flops;
+  double total_memory;
 };
 
 // Candidate keys to sort the profiling report
@@ -135,12 +169,23 @@ void EnableProfiler(ProfilerState state);
 // Clear the g_all_event_lists, which is total event lists of all threads.
 void ResetProfiler();
 
-void DisableProfiler(EventSortingKey sorted_key);
+// Print the profiling report, and also write the timeline of the events to
+// `trace_path` unless it is empty.
+void DisableProfiler(EventSortingKey sorted_key,
+                     const std::string& trace_path = "");
 
 // Parse the event list and output the profiling report
 void ParseEvents(std::vector<std::vector<Event>>&,
                  EventSortingKey sorted_by = EventSortingKey::kDefault);
 
+// Write the events in the Chrome trace event format to `path`, which
+// chrome://tracing displays as one timeline per thread. Each matched push
+// and pop becomes a complete event whose args hold the detail, the FLOPs
+// and the memory delta. With --profile_memory, the memory allocated by each
+// thread is also written as a counter.
+void ExportChromeTrace(const std::vector<std::vector<Event>>& events,
+                       const std::string& path);
+
 // Print results
 void PrintProfiler(std::vector<std::vector<EventItem>>& events_table,
                    std::string& sorted_domain, const size_t name_width,
@@ -13,7 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/platform/profiler.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include "gflags/gflags.h"
 #include "gtest/gtest.h"
+#include "paddle/fluid/memory/memory.h"
+
+DECLARE_bool(profile_memory);
 
 TEST(Event, CpuElapsedTime) {
   using paddle::platform::Event;
@@ -49,6 +57,31 @@ TEST(Event, CudaElapsedTime) {
 }
 #endif
 
+TEST(Event, ThreadAllocated) {
+  using paddle::platform::CPUPlace;
+  using paddle::platform::Event;
+  using paddle::platform::EventKind;
+
+  FLAGS_profile_memory = true;
+  Event start_event(EventKind::kPushRange, "alloc", 0, nullptr);
+  void* p = paddle::memory::Alloc(CPUPlace(), 1024);
+  // The memory allocated by other threads is not counted.
+  void* q = nullptr;
+  std::thread other([&q] { q = paddle::memory::Alloc(CPUPlace(), 1 << 20); });
+  other.join();
+  Event stop_event(EventKind::kPopRange, "alloc", 0, nullptr);
+  int64_t delta =
+      stop_event.thread_allocated() - start_event.thread_allocated();
+  EXPECT_GE(delta, 1024);
+  EXPECT_LT(delta, 1 << 20);
+
+  paddle::memory::Free(CPUPlace(), p);
+  Event free_event(EventKind::kPopRange, "free", 0, nullptr);
+  EXPECT_EQ(free_event.thread_allocated(), start_event.thread_allocated());
+  paddle::memory::Free(CPUPlace(), q);
+  FLAGS_profile_memory = false;
+}
+
 TEST(RecordEvent, RecordEvent) {
   using paddle::platform::DeviceContext;
   using paddle::platform::Event;
@@ -127,3 +160,57 @@ TEST(RecordEvent, RecordEvent) {
   // Will remove parsing-related code from test later
   DisableProfiler(EventSortingKey::kTotal);
 }
+
+TEST(RecordEvent, PopEventDetail) {
+  using paddle::platform::ProfilerState;
+  using paddle::platform::EventSortingKey;
+
+  paddle::platform::EnableProfiler(ProfilerState::kCPU);
+  { paddle::platform::RecordEvent record_event("mul", nullptr); }
+  // Ignored: the last event is not the pop event of "conv2d".
+  paddle::platform::SetPopEventDetail("conv2d", "Input=[1, 3]", 1.0);
+  paddle::platform::SetPopEventDetail("mul", "X=[2, 3] Y=[3, 4]", 48.0);
+  std::vector<std::vector<paddle::platform::Event>> events =
+      paddle::platform::GetAllEvents();
+  paddle::platform::DisableProfiler(EventSortingKey::kDefault);
+
+  int pop_count = 0;
+  for (auto& thread_events : events) {
+    for (auto& event : thread_events) {
+      if (event.kind() == "pop" && event.name() == "mul") {
+        EXPECT_EQ(event.detail(), "X=[2, 3] Y=[3, 4]");
+        EXPECT_EQ(event.flops(), 48.0);
+        EXPECT_EQ(event.thread_allocated(), 0);
+        ++pop_count;
+      }
+    }
+  }
+  EXPECT_EQ(pop_count, 1);
+}
+
+TEST(RecordEvent, ChromeTrace) {
+  using paddle::platform::Event;
+  using paddle::platform::EventKind;
+
+  FLAGS_profile_memory = true;
+  std::vector<std::vector<Event>> events(1);
+  events[0].emplace_back(EventKind::kPushRange, "mul", 0, nullptr);
+  events[0].emplace_back(EventKind::kPopRange, "mul", 0, nullptr,
+                         "X=[2, 3] Y=[3, 4]", 48.0);
+  EXPECT_EQ(events[0][1].detail(), "X=[2, 3] Y=[3, 4]");
+  EXPECT_EQ(events[0][1].flops(), 48.0);
+
+  std::string path = "profiler_test_trace.json";
+  paddle::platform::ExportChromeTrace(events, path);
+  std::ifstream in(path);
+  std::string trace((std::istreambuf_iterator<char>(in)),
+                    std::istreambuf_iterator<char>());
+  EXPECT_NE(trace.find("\"name\": \"mul\", \"ph\": \"X\""), std::string::npos);
+  EXPECT_NE(trace.find("\"detail\": \"X=[2, 3] Y=[3, 4]\""),
+            std::string::npos);
+  EXPECT_NE(trace.find("\"flops\": 48.000"), std::string::npos);
+  EXPECT_NE(trace.find("\"name\": \"thread0 allocated\", \"ph\": \"C\""),
+            std::string::npos);
+  std::remove(path.c_str());
+  FLAGS_profile_memory = false;
+}
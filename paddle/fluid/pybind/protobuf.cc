@@ -202,7 +202,8 @@ void BindVarDsec(py::module &m) {
       .value("INT64", proto::DataType::INT64)
       .value("FP16", proto::DataType::FP16)
       .value("FP32", proto::DataType::FP32)
-      .value("FP64", proto::DataType::FP64);
+      .value("FP64", proto::DataType::FP64)
+      .value("INT8", proto::DataType::INT8);
 
   py::class_<VarDesc> var_desc(m, "VarDesc", "");
   var_desc
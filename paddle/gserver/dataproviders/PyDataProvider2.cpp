@@ -16,8 +16,16 @@ limitations under the License. */
 
 #include <Python.h>
 #include <numpy/numpyconfig.h>
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
 #include <list>
 #include <unordered_set>
 #define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
@@ -184,6 +192,209 @@ public:
   static IPyDataProviderCache* create(CacheType ct);
 };
 
+/**
+ * A ring of records in memory shared with the worker processes, which are
+ * forked after it is created. The workers push the records, the provider pops
+ * them.
+ *
+ * The lock of the ring is robust: if a process dies holding it, the next one
+ * to take it marks the ring broken and closes it, since the ring may have
+ * been left half written.
+ */
+class SharedRecordRing {
+public:
+  enum PopStatus { kRecord, kEnd, kTimeout, kBroken };
+
+  SharedRecordRing(size_t capacity, size_t numWriters) {
+    size_t mapSize = sizeof(Header) + capacity;
+    void* ptr = mmap(nullptr,
+                     mapSize,
+                     PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS,
+                     -1,
+                     0);
+    CHECK(ptr != MAP_FAILED) << "Cannot map " << mapSize
+                             << " bytes of shared memory";
+    header_ = reinterpret_cast<Header*>(ptr);
+    data_ = reinterpret_cast<char*>(ptr) + sizeof(Header);
+
+    pthread_mutexattr_t mutexAttr;
+    pthread_mutexattr_init(&mutexAttr);
+    pthread_mutexattr_setpshared(&mutexAttr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&mutexAttr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&header_->mutex, &mutexAttr);
+    pthread_mutexattr_destroy(&mutexAttr);
+    pthread_condattr_t condAttr;
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setpshared(&condAttr, PTHREAD_PROCESS_SHARED);
+    pthread_cond_init(&header_->notEmpty, &condAttr);
+    pthread_cond_init(&header_->notFull, &condAttr);
+    pthread_condattr_destroy(&condAttr);
+
+    header_->capacity = capacity;
+    header_->head = 0;
+    header_->tail = 0;
+    header_->numWriters = numWriters;
+    header_->closed = false;
+    header_->broken = false;
+  }
+
+  ~SharedRecordRing() { munmap(header_, sizeof(Header) + header_->capacity); }
+
+  /**
+   * Push a record, waiting for the space. Called by the workers.
+   * @return false if the ring is closed, or if the record is larger than the
+   *         ring.
+   */
+  bool push(const std::string& record) {
+    uint32_t length = record.size();
+    size_t size = sizeof(length) + record.size();
+    if (size > header_->capacity) {
+      return false;
+    }
+    lock();
+    while (!header_->closed &&
+           header_->capacity - (header_->tail - header_->head) < size) {
+      recover(pthread_cond_wait(&header_->notFull, &header_->mutex));
+    }
+    bool pushed = !header_->closed;
+    if (pushed) {
+      copyIn(header_->tail, &length, sizeof(length));
+      copyIn(header_->tail + sizeof(length), record.data(), record.size());
+      header_->tail += size;
+      pthread_cond_signal(&header_->notEmpty);
+    }
+    pthread_mutex_unlock(&header_->mutex);
+    return pushed;
+  }
+
+  /**
+   * Tell the provider that a worker pushed all of its records.
+   */
+  void finishWriter() {
+    lock();
+    --header_->numWriters;
+    pthread_cond_signal(&header_->notEmpty);
+    pthread_mutex_unlock(&header_->mutex);
+  }
+
+  /**
+   * Pop a record. Called by the provider.
+   * @return kEnd if the ring is closed, or all the workers finished and the
+   *         records were popped. kTimeout if no record comes in timeoutMs.
+   *         kBroken if a process died holding the lock of the ring.
+   */
+  PopStatus pop(std::string* record, int timeoutMs) {
+    timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeoutMs / 1000;
+    deadline.tv_nsec += (timeoutMs % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec += 1;
+      deadline.tv_nsec -= 1000000000L;
+    }
+
+    lock();
+    int ret = 0;
+    while (!header_->closed && header_->head == header_->tail &&
+           header_->numWriters > 0 && ret != ETIMEDOUT) {
+      ret = recover(pthread_cond_timedwait(
+          &header_->notEmpty, &header_->mutex, &deadline));
+    }
+    PopStatus status;
+    if (header_->broken) {
+      status = kBroken;
+    } else if (header_->closed) {
+      status = kEnd;
+    } else if (header_->head != header_->tail) {
+      uint32_t length;
+      copyOut(header_->head, &length, sizeof(length));
+      record->resize(length);
+      copyOut(header_->head + sizeof(length), &(*record)[0], length);
+      header_->head += sizeof(length) + length;
+      pthread_cond_broadcast(&header_->notFull);
+      status = kRecord;
+    } else if (header_->numWriters == 0) {
+      status = kEnd;
+    } else {
+      status = kTimeout;
+    }
+    pthread_mutex_unlock(&header_->mutex);
+    return status;
+  }
+
+  /**
+   * Wake up and stop the workers and the provider waiting on the ring.
+   */
+  void close() {
+    lock();
+    header_->closed = true;
+    pthread_cond_broadcast(&header_->notEmpty);
+    pthread_cond_broadcast(&header_->notFull);
+    pthread_mutex_unlock(&header_->mutex);
+  }
+
+private:
+  struct Header {
+    pthread_mutex_t mutex;
+    pthread_cond_t notEmpty;
+    pthread_cond_t notFull;
+    size_t capacity;
+    // the positions of the first and the end bytes, never wrapped.
+    uint64_t head;
+    uint64_t tail;
+    size_t numWriters;
+    bool closed;
+    // A process died holding the mutex.
+    bool broken;
+  };
+
+  void lock() { recover(pthread_mutex_lock(&header_->mutex)); }
+
+  /**
+   * Check the result of taking the mutex. If its owner died, mark the ring
+   * broken and closed, wake up the others and make the mutex usable again.
+   * @return 0 in that case, ret otherwise.
+   */
+  int recover(int ret) {
+    if (ret != EOWNERDEAD) {
+      return ret;
+    }
+    header_->broken = true;
+    header_->closed = true;
+    pthread_mutex_consistent(&header_->mutex);
+    pthread_cond_broadcast(&header_->notEmpty);
+    pthread_cond_broadcast(&header_->notFull);
+    return 0;
+  }
+
+  void copyIn(uint64_t pos, const void* src, size_t size) {
+    size_t offset = pos % header_->capacity;
+    size_t first = std::min(size, header_->capacity - offset);
+    memcpy(data_ + offset, src, first);
+    memcpy(data_, reinterpret_cast<const char*>(src) + first, size - first);
+  }
+
+  void copyOut(uint64_t pos, void* dest, size_t size) {
+    size_t offset = pos % header_->capacity;
+    size_t first = std::min(size, header_->capacity - offset);
+    memcpy(dest, data_ + offset, first);
+    memcpy(reinterpret_cast<char*>(dest) + first, data_, size - first);
+  }
+
+  Header* header_;
+  char* data_;
+};
+
+static void encodeSample(const std::vector<SlotHeader>& headers,
+                         PyObject* sample,
+                         size_t batchSize,
+                         std::string* record);
+static size_t recordBatchSize(const std::string& record);
+static void decodeRecords(const std::vector<SlotHeader>& headers,
+                          const std::vector<std::string>& records,
+                          std::vector<Argument>* args);
+
 /**
  * PyDataProvider2.
  *
@@ -191,6 +402,12 @@ public:
  *
  * Here, we start a thread to read data. It is totally asynchronous for reading
  * data. And it support cache strategies.
+ *
+ * If num_workers of the provider is set, the generator runs in num_workers
+ * forked processes instead, each reading a part of the files. They pass the
+ * samples as records of bytes through a SharedRecordRing, and the thread puts
+ * the records into the data pool, which are copied into the arguments
+ * without calling python.
  */
 class PyDataProvider2 : public DataProvider {
 public:
@@ -200,7 +417,9 @@ public:
   PyDataProvider2(const DataConfig& config,
                   const ModelConfig& modelConfig,
                   bool useGpu)
-      : DataProvider(config, useGpu), callingContextCreated_(2) {
+      : DataProvider(config, useGpu),
+        callingContextCreated_(2),
+        workersDone_(true) {
     if (PyArray_API == NULL) import_array();
     auto& args = config.load_data_args();
     PyObjectPtr kwargs = PyObjectPtr(PyDict_New());
@@ -289,6 +508,11 @@ private:
 
     this->canOverBatchSize_ = self.getBoolAttr("can_over_batch_size");
 
+    this->numWorkers_ = self.getIntAttr<size_t>("num_workers", &ok);
+    if (!ok) {
+      this->numWorkers_ = 0;
+    }
+
     calcBatchSize_.reset(self.getAttr("calc_batch_size"));
     if (this->calcBatchSize_ && !py::isCallable(this->calcBatchSize_)) {
       this->calcBatchSize_.reset();
@@ -318,8 +542,13 @@ private:
     for (auto& header : headers_) {
       DBG << header;
     }
-    cache_.reset(IPyDataProviderCache::create(
-        (CacheType)self.getIntAttrWithError<int>("cache")));
+    CacheType cacheType = (CacheType)self.getIntAttrWithError<int>("cache");
+    cache_.reset(IPyDataProviderCache::create(cacheType));
+    if (numWorkers_ > 0 && cacheType != NO_CACHE) {
+      LOG(WARNING) << "num_workers does not work with cache, the data is "
+                   << "loaded in the trainer process";
+      numWorkers_ = 0;
+    }
   }
 
   PyObjectPtr loadPyFileLists(const std::string& fileListName) {
@@ -331,17 +560,38 @@ private:
     return PyObjectPtr(lst);
   }
 
+  PyObjectPtr createCallingContext(const std::string& filename) {
+    PyGuard g;
+    py::CallableHelper generator(this->generator_);
+    generator.setArgsSize(2);
+    generator.getArgs().set(0, instance_);
+    generator.getArgs().set(1, PyString_FromString(filename.c_str()), true);
+    PyObjectPtr context(generator());
+    CHECK_PY(context) << "Generator error.";
+    CHECK(PyIter_Check(context.get()));
+    return context;
+  }
+
+  size_t calcSampleBatchSize(PyObject* data) {
+    if (!calcBatchSize_) {
+      return 1;
+    }
+    PyGuard guard;
+    py::CallableHelper calcBatchSize(this->calcBatchSize_);
+    calcBatchSize.setArgsSize(1);
+    calcBatchSize.getArgs().set(0, data);
+    PyObjectPtr bs(calcBatchSize());
+    CHECK_PY(bs);
+    bool ok;
+    size_t batchSize = py::castInt<size_t>(bs.get(), &ok);
+    CHECK(ok) << "CalcBatchSize must return int or long";
+    return batchSize;
+  }
+
   void loadThread() {
     DBG << "Creating context";
     for (auto& filename : fileLists_) {
-      PyGuard g;
-      py::CallableHelper generator(this->generator_);
-      generator.setArgsSize(2);
-      generator.getArgs().set(0, instance_);
-      generator.getArgs().set(1, PyString_FromString(filename.c_str()), true);
-      callingContexts_.emplace_back(generator());
-      CHECK_PY(callingContexts_.back()) << "Generator error.";
-      CHECK(PyIter_Check(callingContexts_.back()));
+      callingContexts_.emplace_back(createCallingContext(filename));
     }
     DBG << "Create context done";
     callingContextCreated_.wait();
@@ -375,18 +625,7 @@ private:
         }
       }
 
-      size_t additionalBatchSize = 1;
-      if (calcBatchSize_) {
-        PyGuard guard;
-        py::CallableHelper calcBatchSize(this->calcBatchSize_);
-        calcBatchSize.setArgsSize(1);
-        calcBatchSize.getArgs().set(0, data);
-        PyObjectPtr bs(calcBatchSize());
-        CHECK_PY(bs);
-        bool ok;
-        additionalBatchSize = py::castInt<size_t>(bs.get(), &ok);
-        CHECK(ok) << "CalcBatchSize must return int or long";
-      }
+      size_t additionalBatchSize = calcSampleBatchSize(data);
 
       if (this->loadThread_) {  // wait poolActualSize < poolSize;
         std::unique_lock<std::mutex> l(mtx_);
@@ -405,13 +644,153 @@ private:
     DBG << "load thread end";
   }
 
+  /**
+   * Fork the worker processes of this pass. Each of them runs workerMain.
+   *
+   * The trainer threads are already running, and a forked process only has
+   * the thread that forked. A lock that another thread held at the fork,
+   * e.g. the lock of glog, stays locked forever in the workers. So the
+   * workers only run python, which is forked under its own lock, and the
+   * ring, whose lock is shared. They must not log, and they report errors by
+   * their exit status, which checkWorkers reads. The checks of the python
+   * data in createCallingContext and encodeSample are the exception: if one
+   * fails while glog was locked at the fork, the worker hangs instead of
+   * aborting.
+   */
+  void startWorkers() {
+    size_t numWorkers = std::min(numWorkers_, fileLists_.size());
+    ring_.reset(new SharedRecordRing(kWorkerRingSize, numWorkers));
+    workersDone_ = false;
+    // Fork with the python lock held, so that the python interpreter is in a
+    // consistent state in the workers.
+    PyGuard g;
+    for (size_t i = 0; i < numWorkers; ++i) {
+      pid_t pid = fork();
+      CHECK_NE(pid, -1) << "Cannot fork the data provider worker";
+      if (pid == 0) {
+        workerMain(i, numWorkers);
+      }
+      workers_.push_back(pid);
+    }
+    DBG << "Started " << numWorkers << " workers";
+  }
+
+  /**
+   * The main function of a worker process, which reads the files i, i +
+   * numWorkers, i + 2 * numWorkers, ... and pushes the samples into ring_.
+   */
+  void workerMain(size_t workerId, size_t numWorkers) {
+    PyOS_AfterFork();
+    std::deque<PyObjectPtr> contexts;
+    for (size_t i = workerId; i < fileLists_.size(); i += numWorkers) {
+      contexts.emplace_back(createCallingContext(fileLists_[i]));
+    }
+
+    PositionRandom p(skipShuffle_);
+    std::string record;
+    while (!contexts.empty()) {
+      size_t cid = p(contexts.size());
+      bool atEnd;
+      PyObjectPtr data(py::iterNext(contexts[cid], &atEnd));
+      if (atEnd || data == nullptr) {
+        contexts.erase(contexts.begin() + cid);
+        continue;
+      }
+      encodeSample(
+          headers_, data.get(), calcSampleBatchSize(data.get()), &record);
+      if (record.size() + sizeof(uint32_t) > kWorkerRingSize) {
+        // The sample cannot fit in the ring.
+        _exit(1);
+      }
+      if (!ring_->push(record)) {
+        break;
+      }
+    }
+    ring_->finishWriter();
+    _exit(0);
+  }
+
+  /**
+   * The loading thread with the worker processes. It moves the records from
+   * ring_ into the data pool.
+   */
+  void loadRecords() {
+    callingContextCreated_.wait();
+    std::string record;
+    while (!exit_) {
+      auto status = ring_->pop(&record, kWorkerPollMs);
+      CHECK(status != SharedRecordRing::kBroken)
+          << "A data provider worker died holding the lock of the records";
+      if (status == SharedRecordRing::kTimeout) {
+        checkWorkers();
+        continue;
+      } else if (status == SharedRecordRing::kEnd) {
+        break;
+      }
+
+      size_t additionalBatchSize = recordBatchSize(record);
+      {
+        std::unique_lock<std::mutex> l(mtx_);
+        pushCV_.wait(
+            l, [this] { return exit_ || this->poolActualSize_ < poolSize_; });
+        poolActualSize_ += additionalBatchSize;
+        recordPool_.emplace_back(std::move(record));
+      }
+      pullCV_.notify_all();
+    }
+    {
+      std::lock_guard<std::mutex> guard(mtx_);
+      workersDone_ = true;
+    }
+    pullCV_.notify_all();
+    DBG << "load records thread end";
+  }
+
+  /**
+   * Fail if a worker crashed, which would never finish its part of the pass.
+   */
+  void checkWorkers() {
+    for (auto& pid : workers_) {
+      int status;
+      if (pid > 0 && waitpid(pid, &status, WNOHANG) == pid) {
+        CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0)
+            << "The data provider worker " << pid << " exited abnormally";
+        pid = 0;
+      }
+    }
+  }
+
+  void stopWorkers() {
+    for (auto pid : workers_) {
+      if (pid > 0) {
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+      }
+    }
+    workers_.clear();
+    ring_.reset();
+  }
+
+  /**
+   * Whether the loading thread will put no more data into the data pool.
+   */
+  bool loadingFinished() {
+    return numWorkers_ > 0 ? workersDone_ : callingContexts_.empty();
+  }
+
   inline void resetImpl(bool startNewThread) {
     DBG << "Reseting " << startNewThread;
     exit_.store(true);
+    if (ring_) {
+      std::lock_guard<std::mutex> guard(mtx_);
+      ring_->close();
+      pushCV_.notify_all();
+    }
     if (loadThread_) {  // is loading.
       loadThread_->join();
       loadThread_.reset();
     }
+    stopWorkers();
     {
       PyGuard g;
       callingContexts_.clear();
@@ -423,13 +802,21 @@ private:
       PyGuard g;
       dataPool_.clear();
     }
+    recordPool_.clear();
     poolActualSize_ = 0;
 
     if (startNewThread && cache_->reset()) {
+      if (numWorkers_ > 0) {
+        startWorkers();
+      }
       DBG << "Start new thread.";
       loadThread_.reset(new std::thread([this] {
         exit_ = false;
-        loadThread();
+        if (numWorkers_ > 0) {
+          loadRecords();
+        } else {
+          loadThread();
+        }
       }));
       callingContextCreated_.wait();
     }
@@ -462,6 +849,15 @@ private:
   std::vector<SlotHeader> headers_;
   static PyObjectPtr zeroTuple_;
 
+  // The worker processes, see num_workers of the provider.
+  static const size_t kWorkerRingSize = 64 << 20;
+  static const int kWorkerPollMs = 1000;
+  size_t numWorkers_;
+  std::unique_ptr<SharedRecordRing> ring_;
+  std::vector<pid_t> workers_;
+  std::deque<std::string> recordPool_;
+  bool workersDone_;
+
   class PositionRandom {
   public:
     inline explicit PositionRandom(bool skipRand)
@@ -519,13 +915,45 @@ public:
       std::unique_lock<std::mutex> l(mtx_);
       pullCV_.wait(l, [this, &size] {
         return this->poolActualSize_ >= std::max(size, this->minPoolSize_) ||
-               callingContexts_.empty();
+               loadingFinished();
       });
 
       if (unittest::OnPoolFilled) {
         (*unittest::OnPoolFilled)(this->poolActualSize_);
       }
     }
+
+    DataBatch cpuBatch;
+    size_t bsize = numWorkers_ > 0 ? readRecords(size, &cpuBatch)
+                                   : readPyObjects(size, &cpuBatch);
+    if (bsize == 0) {  // end of pass.
+      return 0;
+    }
+
+    if (useGpu_) {
+      std::vector<Argument>& cpuArguments = cpuBatch.getStreams();
+      DataBatch& gpuBatch = *batch;
+      std::vector<Argument>& gpuArguments = gpuBatch.getStreams();
+      gpuArguments.resize(cpuArguments.size());
+      gpuBatch.setSize(bsize);
+      for (size_t i = 0; i < headers_.size(); ++i) {
+        gpuArguments[i].resizeAndCopyFrom(
+            cpuArguments[i], useGpu_, HPPL_STREAM_1);
+      }
+      hl_stream_synchronize(HPPL_STREAM_1);
+    } else {
+      *batch = cpuBatch;
+    }
+    return bsize;
+  }
+
+private:
+  /**
+   * Move the samples of a batch from the data pool of python objects, or the
+   * cache, into cpuBatch.
+   * @return the batch size, 0 at the end of pass.
+   */
+  size_t readPyObjects(size_t size, DataBatch* cpuBatch) {
     std::deque<PyObjectPtr> data;
     size_t bsize = 0;
     std::deque<PyObjectPtr>* poolPtr = nullptr;
@@ -599,9 +1027,8 @@ public:
       return 0;
     }
 
-    DataBatch cpuBatch;
-    cpuBatch.setSize(bsize);
-    auto& inArgs = cpuBatch.getStreams();
+    cpuBatch->setSize(bsize);
+    auto& inArgs = cpuBatch->getStreams();
     inArgs.resize(headers_.size());
     std::vector<std::unique_ptr<IFieldScanner>> scanners;
     scanners.reserve(headers_.size());
@@ -641,21 +1068,48 @@ public:
     }
 
     DBG << "Reading CPU Batch Done.";
+    return bsize;
+  }
 
-    if (useGpu_) {
-      std::vector<Argument>& cpuArguments = cpuBatch.getStreams();
-      DataBatch& gpuBatch = *batch;
-      std::vector<Argument>& gpuArguments = gpuBatch.getStreams();
-      gpuArguments.resize(cpuArguments.size());
-      gpuBatch.setSize(bsize);
-      for (size_t i = 0; i < headers_.size(); ++i) {
-        gpuArguments[i].resizeAndCopyFrom(
-            cpuArguments[i], useGpu_, HPPL_STREAM_1);
+  /**
+   * Move the records of a batch from the data pool of the worker processes
+   * into cpuBatch. The samples are picked as in readPyObjects.
+   * @return the batch size, 0 at the end of pass.
+   */
+  size_t readRecords(size_t size, DataBatch* cpuBatch) {
+    if (exit_) {
+      // PyDataProvider is destructing.
+      return 0;
+    }
+    std::vector<std::string> records;
+    size_t bsize = 0;
+    {
+      std::lock_guard<std::mutex> guard(mtx_);
+      while (bsize < size && !recordPool_.empty()) {
+        if (!skipShuffle_) {
+          size_t i = ThreadLocalRand::rand() % recordPool_.size();
+          if (i != 0) {
+            std::swap(recordPool_[i], recordPool_.front());
+          }
+        }
+        size_t sampleSize = recordBatchSize(recordPool_.front());
+        if (bsize + sampleSize > size && !canOverBatchSize_) {
+          break;
+        }
+        records.emplace_back(std::move(recordPool_.front()));
+        recordPool_.pop_front();
+        bsize += sampleSize;
       }
-      hl_stream_synchronize(HPPL_STREAM_1);
-    } else {
-      *batch = cpuBatch;
+      poolActualSize_ -= bsize;
+    }
+    this->pushCV_.notify_all();
+
+    if (bsize == 0) {
+      return 0;
     }
+    cpuBatch->setSize(bsize);
+    decodeRecords(headers_, records, &cpuBatch->getStreams());
+    DBG << "Reading CPU Batch Done.";
     return bsize;
   }
 };
@@ -966,6 +1420,293 @@ IFieldScanner* IFieldScanner::create(SlotHeader* header) {
   return retv;
 }
 
+/**
+ * The records passed from the worker processes to the provider.
+ *
+ * A record is the batch size of the sample, an int, followed by its slots. A
+ * slot is int numRows, int numSubseqs, int nnz, int subseqLens[numSubseqs],
+ * and
+ *   - dense: real values[numRows * dim]
+ *   - index: int ids[numRows]
+ *   - sparse: int rowNnzs[numRows], int cols[nnz], and real values[nnz] for
+ *             sparse values.
+ * The slot of no sequence has one row.
+ */
+struct RecordSlot {
+  int numRows;
+  int numSubseqs;
+  int nnz;
+  const char* subseqLens;
+  const char* rowNnzs;
+  const char* ints;
+  const char* values;
+};
+
+template <typename T>
+static void appendValues(const std::vector<T>& values, std::string* record) {
+  record->append(reinterpret_cast<const char*>(values.data()),
+                 values.size() * sizeof(T));
+}
+
+static void appendDense(size_t dim, PyObject* obj, std::vector<real>* values) {
+  if (PyArray_Check(obj)) {
+    auto dtype = PyArray_DTYPE((PyArrayObject*)obj);
+    CHECK(dtype->type == 'f' && dtype->elsize == sizeof(real))
+        << "You should yield float" << sizeof(real) * 8 << " array";
+    real* data = (real*)PyArray_DATA((PyArrayObject*)obj);
+    CHECK_EQ((size_t)PyArray_SIZE((PyArrayObject*)obj), dim);
+    values->insert(values->end(), data, data + dim);
+  } else {
+    py::SequenceHelper s(obj);
+    for (size_t i = 0; i < dim; ++i) {
+      values->push_back((real)s.getDouble(i));
+    }
+  }
+}
+
+static void encodeSlot(const SlotHeader& header,
+                       PyObject* obj,
+                       std::string* record) {
+  std::vector<PyObject*> rows;
+  std::vector<int> subseqLens;
+  if (header.seqType == SQT_NONE) {
+    rows.push_back(obj);
+  } else {
+    py::SequenceHelper seq(obj);
+    for (size_t i = 0; i < seq.size(); ++i) {
+      if (header.seqType == SQT_SUBSEQ) {
+        py::SequenceHelper subseq(seq[i]);
+        subseqLens.push_back(subseq.size());
+        for (size_t j = 0; j < subseq.size(); ++j) {
+          rows.push_back(subseq[j]);
+        }
+      } else {
+        rows.push_back(seq[i]);
+      }
+    }
+  }
+
+  std::vector<int> rowNnzs;
+  std::vector<int> ints;
+  std::vector<real> values;
+  bool ok;
+  for (auto row : rows) {
+    switch (header.slotType) {
+      case ST_DENSE:
+        appendDense(header.dim, row, &values);
+        break;
+      case ST_INDEX:
+        ints.push_back(py::castInt<int>(row, &ok));
+        CHECK(ok) << "Cannot cast int " << py::repr(row);
+        break;
+      case ST_NON_SPARSE_VALUE:
+      case ST_SPARSE_VALUE: {
+        py::SequenceHelper s(row);
+        rowNnzs.push_back(s.size());
+        for (size_t i = 0; i < s.size(); ++i) {
+          PyObject* col = s[i];
+          if (header.slotType == ST_SPARSE_VALUE) {
+            py::SequenceHelper pair(s[i]);
+            col = pair[0];
+            values.push_back((real)pair.getDouble(1));
+          }
+          ints.push_back(py::castInt<int>(col, &ok));
+          CHECK(ok);
+        }
+        break;
+      }
+      default:
+        LOG(FATAL) << "Not implemented " << header.slotType;
+    }
+  }
+
+  int sizes[3] = {(int)rows.size(),
+                  (int)subseqLens.size(),
+                  rowNnzs.empty() ? 0 : (int)ints.size()};
+  record->append(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+  appendValues(subseqLens, record);
+  appendValues(rowNnzs, record);
+  appendValues(ints, record);
+  appendValues(values, record);
+}
+
+static void encodeSample(const std::vector<SlotHeader>& headers,
+                         PyObject* sample,
+                         size_t batchSize,
+                         std::string* record) {
+  int size = batchSize;
+  record->assign(reinterpret_cast<const char*>(&size), sizeof(size));
+  py::SequenceHelper s(sample);
+  for (size_t i = 0; i < headers.size(); ++i) {
+    encodeSlot(headers[i], s[i], record);
+  }
+}
+
+static size_t recordBatchSize(const std::string& record) {
+  int size;
+  memcpy(&size, record.data(), sizeof(size));
+  return size;
+}
+
+static const char* parseSlot(const SlotHeader& header,
+                             const char* pos,
+                             RecordSlot* slot) {
+  int sizes[3];
+  memcpy(sizes, pos, sizeof(sizes));
+  pos += sizeof(sizes);
+  slot->numRows = sizes[0];
+  slot->numSubseqs = sizes[1];
+  slot->nnz = sizes[2];
+  size_t numRowNnzs = 0;
+  size_t numInts = 0;
+  size_t numValues = 0;
+  switch (header.slotType) {
+    case ST_DENSE:
+      numValues = slot->numRows * header.dim;
+      break;
+    case ST_INDEX:
+      numInts = slot->numRows;
+      break;
+    case ST_SPARSE_VALUE:
+      numValues = slot->nnz;
+    // fall through, not break;
+    case ST_NON_SPARSE_VALUE:
+      numRowNnzs = slot->numRows;
+      numInts = slot->nnz;
+      break;
+    default:
+      LOG(FATAL) << "Not implemented " << header.slotType;
+  }
+  slot->subseqLens = pos;
+  pos += slot->numSubseqs * sizeof(int);
+  slot->rowNnzs = pos;
+  pos += numRowNnzs * sizeof(int);
+  slot->ints = pos;
+  pos += numInts * sizeof(int);
+  slot->values = pos;
+  pos += numValues * sizeof(real);
+  return pos;
+}
+
+/**
+ * Copy the i-th slot of the records into argument.
+ */
+static void decodeSlot(const SlotHeader& header,
+                       const std::vector<std::vector<RecordSlot>>& records,
+                       size_t i,
+                       Argument* argument) {
+  size_t numRows = 0;
+  size_t numSubseqs = 0;
+  size_t nnz = 0;
+  for (auto& record : records) {
+    numRows += record[i].numRows;
+    numSubseqs += record[i].numSubseqs;
+    nnz += record[i].nnz;
+  }
+
+  size_t row = 0;
+  size_t offset = 0;
+  switch (header.slotType) {
+    case ST_DENSE:
+      Matrix::resizeOrCreate(
+          argument->value, numRows, header.dim, false, false);
+      for (auto& record : records) {
+        const RecordSlot& slot = record[i];
+        memcpy(argument->value->getData() + row * header.dim,
+               slot.values,
+               slot.numRows * header.dim * sizeof(real));
+        row += slot.numRows;
+      }
+      break;
+    case ST_INDEX:
+      IVector::resizeOrCreate(argument->ids, numRows, false);
+      for (auto& record : records) {
+        const RecordSlot& slot = record[i];
+        memcpy(argument->ids->getData() + row,
+               slot.ints,
+               slot.numRows * sizeof(int));
+        row += slot.numRows;
+      }
+      break;
+    case ST_NON_SPARSE_VALUE:
+    case ST_SPARSE_VALUE: {
+      bool hasValue = header.slotType == ST_SPARSE_VALUE;
+      Matrix::resizeOrCreateSparseMatrix(argument->value,
+                                         numRows,
+                                         header.dim,
+                                         nnz,
+                                         hasValue ? FLOAT_VALUE : NO_VALUE);
+      auto smat = (CpuSparseMatrix*)(argument->value.get());
+      int* rows = smat->getRows();
+      rows[0] = 0;
+      for (auto& record : records) {
+        const RecordSlot& slot = record[i];
+        for (int j = 0; j < slot.numRows; ++j) {
+          int rowNnz;
+          memcpy(&rowNnz, slot.rowNnzs + j * sizeof(int), sizeof(int));
+          rows[row + 1] = rows[row] + rowNnz;
+          ++row;
+        }
+        memcpy(smat->getCols() + offset, slot.ints, slot.nnz * sizeof(int));
+        if (hasValue) {
+          memcpy(smat->getData() + offset,
+                 slot.values,
+                 slot.nnz * sizeof(real));
+        }
+        offset += slot.nnz;
+      }
+      break;
+    }
+    default:
+      LOG(FATAL) << "Not implemented " << header.slotType;
+  }
+
+  if (header.seqType != SQT_NONE) {
+    ICpuGpuVector::resizeOrCreate(
+        argument->sequenceStartPositions, records.size() + 1, false);
+    int* starts = argument->sequenceStartPositions->getMutableData(false);
+    starts[0] = 0;
+    for (size_t j = 0; j < records.size(); ++j) {
+      starts[j + 1] = starts[j] + records[j][i].numRows;
+    }
+  }
+  if (header.seqType == SQT_SUBSEQ) {
+    ICpuGpuVector::resizeOrCreate(
+        argument->subSequenceStartPositions, numSubseqs + 1, false);
+    int* starts = argument->subSequenceStartPositions->getMutableData(false);
+    starts[0] = 0;
+    size_t k = 0;
+    for (auto& record : records) {
+      const RecordSlot& slot = record[i];
+      for (int j = 0; j < slot.numSubseqs; ++j) {
+        int len;
+        memcpy(&len, slot.subseqLens + j * sizeof(int), sizeof(int));
+        starts[k + 1] = starts[k] + len;
+        ++k;
+      }
+    }
+  }
+}
+
+static void decodeRecords(const std::vector<SlotHeader>& headers,
+                          const std::vector<std::string>& records,
+                          std::vector<Argument>* args) {
+  std::vector<std::vector<RecordSlot>> slots(
+      records.size(), std::vector<RecordSlot>(headers.size()));
+  for (size_t i = 0; i < records.size(); ++i) {
+    const char* pos = records[i].data() + sizeof(int);
+    for (size_t j = 0; j < headers.size(); ++j) {
+      pos = parseSlot(headers[j], pos, &slots[i][j]);
+    }
+    CHECK(pos == records[i].data() + records[i].size())
+        << "Broken record of the data provider workers";
+  }
+  args->resize(headers.size());
+  for (size_t j = 0; j < headers.size(); ++j) {
+    decodeSlot(headers[j], slots, j, &(*args)[j]);
+  }
+}
+
 /**
  * No Cache Strategy. Will destruct old data immediately and load data from
  * python every pass.
@@ -212,11 +212,6 @@ void MultiGradientMachine::allocGradBufs() {
 }
 
 void MultiGradientMachine::prefetch(const std::vector<Argument>& inArgs) {
-  // Each gradient machine in threads needs to do prefetch on its own
-  // part of inArgs. So we need to first divide inArgs to each thread
-  inArgs_ = inArgs;
-  startTask(TASK_COPY_IN_ARGS);
-
   for (auto& para : parameters_) {
     if (para->isSparseRemoteUpdate()) {
       auto mat = dynamic_cast<SparsePrefetchRowCpuMatrix*>(
@@ -225,14 +220,14 @@ void MultiGradientMachine::prefetch(const std::vector<Argument>& inArgs) {
     }
   }
 
+  // Each gradient machine in threads needs to do prefetch on its own
+  // part of inArgs. So each thread first copies its part of inArgs, then
+  // adds its rows to the SparsePrefetchRowCpuMatrix, which several threads
+  // can do at once.
+  inArgs_ = inArgs;
+  startTask(TASK_PREFETCH);
   waitForCopyInArgs();
 
-  // Because SparsePrefetchRowCpuMatrix can only be changed by ONE thread
-  // at one time, we need to do prefetch sequentially
-  for (auto& thread : threads_) {
-    thread->prefetch();
-  }
-
   for (auto& para : parameters_) {
     if (para->isSparseRemoteUpdate()) {
       auto mat = dynamic_cast<SparsePrefetchRowCpuMatrix*>(
@@ -307,7 +302,8 @@ void MultiGradientMachine::backwardImp(const UpdateCallback& callback) {
     waitAfterMerge();
     if (backwardCallback_) {
       for (auto& para : parameters_) {
-        if (!para->useGpu() && !para->isStatic()) {
+        if (!para->useGpu() && !para->isStatic() &&
+            !para->isHogwildSparseUpdate()) {
           backwardCallback_(para.get());
         }
       }
@@ -525,9 +521,10 @@ void TrainerThread::computeThread() {
       case MultiGradientMachine::TASK_BACKWARD:
         backward();
         break;
-      case MultiGradientMachine::TASK_COPY_IN_ARGS:
+      case MultiGradientMachine::TASK_PREFETCH:
         batchSize_ = copyInArgs();
         inArgsCopied_ = true;
+        prefetch();
         multiMachine_->waitForCopyInArgs();
         break;
     }
@@ -600,6 +597,15 @@ void TrainerThread::backward() {
 }
 
 void TrainerThread::backwardCallback(Parameter* para) {
+  if (para->isHogwildSparseUpdate()) {
+    // The updater applies the sparse rows of this thread to the shared
+    // value right away, there is nothing to merge.
+    CHECK(multiMachine_->getBackwardCallback())
+        << "--hogwild_sparse_update needs the parameters to be updated "
+        << "during backward";
+    multiMachine_->getBackwardCallback()(para);
+    return;
+  }
   // CPU parameters are merged in the end
   if (!para->useGpu() || para->isStatic()) return;
 
@@ -793,7 +799,7 @@ void TrainerThread::mergeCpuGradients() {
 
   CHECK(slaveParameters.size());
   for (auto& para : multiMachine_->getNonStaticParameters()) {
-    if (para->useGpu()) continue;
+    if (para->useGpu() || para->isHogwildSparseUpdate()) continue;
     if (para->isSparseRemoteUpdate()) {
       REGISTER_TIMER("mergeRemoteGradSparse");
       mergeGradSparseRemote(para.get(), slaveParameters);
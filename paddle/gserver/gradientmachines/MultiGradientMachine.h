@@ -171,7 +171,7 @@ public:
     TASK_FORWARD_BACKWARD = 0,
     TASK_FORWARD = 1,
     TASK_BACKWARD = 2,
-    TASK_COPY_IN_ARGS = 3,
+    TASK_PREFETCH = 3,
   };
 
   explicit MultiGradientMachine(const ModelConfig& config, bool useGpu);
@@ -250,7 +250,7 @@ protected:
   void waitAfterMerge() { allBarrier_.wait(); }
 
   /// called by MultiGradientMachine and TrainerThread to wait for copyInArgs()
-  /// finishing
+  /// and prefetch() finishing
   void waitForCopyInArgs() { allBarrier_.wait(); }
 
   TrainerThreadPtr& getThread(int threadId) { return threads_[threadId]; }
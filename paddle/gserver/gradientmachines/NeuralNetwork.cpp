@@ -14,6 +14,8 @@ limitations under the License. */
 
 #include "paddle/utils/Util.h"
 
+#include <algorithm>
+#include <set>
 #include "NeuralNetwork.h"
 #include "hl_gpu.h"
 #include "paddle/utils/CustomStackTrace.h"
@@ -359,6 +361,104 @@ void NeuralNetwork::releaseOutput() {
   }
 }
 
+void NeuralNetwork::reserve(size_t maxBatchSize,
+                            size_t maxSeqLength,
+                            size_t maxSubSeqLength,
+                            const std::vector<InputType>& inputTypes) {
+  CHECK_GT(maxBatchSize, 0UL);
+  CHECK(maxSubSeqLength == 0 || maxSeqLength > 0)
+      << "Nested sequences need maxSeqLength";
+  std::vector<InputType> types = inputTypes;
+  if (types.empty()) {
+    std::set<std::string> idsInputs;
+    for (auto& layer : config_.layers()) {
+      for (auto& input : layer.inputs()) {
+        if (input.has_proj_conf() && input.proj_conf().type() == "table") {
+          idsInputs.insert(input.input_layer_name());
+        }
+      }
+    }
+    for (auto& layer : dataLayers_) {
+      types.push_back(idsInputs.count(layer->getName()) ? kIdsInput
+                                                         : kDenseInput);
+    }
+  }
+  CHECK_EQ(types.size(), dataLayers_.size())
+      << "One input type is needed for each data layer";
+
+  size_t seqLength = std::max<size_t>(maxSeqLength, 1);
+  size_t numRows = maxBatchSize * seqLength;
+  size_t numSubSeqs = 0;
+  if (maxSubSeqLength > 0) {
+    numSubSeqs = (seqLength + maxSubSeqLength - 1) / maxSubSeqLength;
+  }
+  std::vector<Argument> inArgs(dataLayers_.size());
+  for (size_t i = 0; i < dataLayers_.size(); ++i) {
+    size_t size = dataLayers_[i]->getSize();
+    switch (types[i]) {
+      case kDenseInput:
+        inArgs[i].value = Matrix::create(numRows,
+                                         size,
+                                         /* trans= */ false,
+                                         /* useGpu= */ false);
+        inArgs[i].value->zeroMem();
+        break;
+      case kSparseBinaryInput:
+      case kSparseFloatInput: {
+        // One non-zero in the first column of each row.
+        auto valueType =
+            types[i] == kSparseBinaryInput ? NO_VALUE : FLOAT_VALUE;
+        inArgs[i].value = Matrix::createSparseMatrix(numRows,
+                                                     size,
+                                                     numRows,
+                                                     valueType,
+                                                     SPARSE_CSR,
+                                                     /* trans= */ false,
+                                                     /* useGpu= */ false);
+        int* rows = inArgs[i].value->getRows();
+        int* cols = inArgs[i].value->getCols();
+        for (size_t j = 0; j < numRows; ++j) {
+          rows[j] = j;
+          cols[j] = 0;
+        }
+        rows[numRows] = numRows;
+        if (valueType == FLOAT_VALUE) {
+          std::fill_n(inArgs[i].value->getData(), numRows, 0);
+        }
+        break;
+      }
+      case kIdsInput:
+        inArgs[i].ids = IVector::create(numRows, /* useGpu= */ false);
+        inArgs[i].ids->zeroMem();
+        break;
+      default:
+        LOG(FATAL) << "Unknown input type " << types[i];
+    }
+    if (maxSeqLength > 0) {
+      inArgs[i].sequenceStartPositions =
+          ICpuGpuVector::create(maxBatchSize + 1, /* useGpu= */ false);
+      int* starts = inArgs[i].sequenceStartPositions->getMutableData(false);
+      for (size_t j = 0; j <= maxBatchSize; ++j) {
+        starts[j] = j * seqLength;
+      }
+    }
+    if (maxSubSeqLength > 0) {
+      inArgs[i].subSequenceStartPositions = ICpuGpuVector::create(
+          maxBatchSize * numSubSeqs + 1, /* useGpu= */ false);
+      int* starts = inArgs[i].subSequenceStartPositions->getMutableData(false);
+      for (size_t j = 0; j < maxBatchSize; ++j) {
+        for (size_t k = 0; k < numSubSeqs; ++k) {
+          starts[j * numSubSeqs + k] = j * seqLength + k * maxSubSeqLength;
+        }
+      }
+      starts[maxBatchSize * numSubSeqs] = numRows;
+    }
+  }
+
+  std::vector<Argument> outArgs;
+  forward(inArgs, &outArgs, PASS_TEST);
+}
+
 #ifndef PADDLE_MOBILE_INFERENCE
 
 class CombinedEvaluator : public Evaluator {
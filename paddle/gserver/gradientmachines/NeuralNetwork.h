@@ -134,6 +134,11 @@ public:
 
   const std::string& getName() const { return subModelName_; }
 
+  /// The data layers, in the order of the arguments of forward().
+  const std::vector<DataLayerPtr>& getDataLayers() const {
+    return dataLayers_;
+  }
+
   /// some finish work, like convert the weight format of MKLDNNLayers
   void finish();
 
@@ -144,6 +149,36 @@ public:
    */
   void releaseOutput();
 
+  /// The data a data layer is fed with, for reserve().
+  enum InputType {
+    kDenseInput = 0,
+    kSparseBinaryInput = 1,
+    kSparseFloatInput = 2,
+    kIdsInput = 3,
+  };
+
+  /**
+   * @brief   Size the buffers of all the layers for inference on batches of
+   *          up to maxBatchSize samples, by forwarding such a batch of zeros.
+   *
+   * The layers resize their outputs in place, so smaller batches are then
+   * served from the same buffers, without allocating. Each input is a
+   * sequence of maxSeqLength frames, or a single row if maxSeqLength is 0.
+   * If maxSubSeqLength is not 0, the sequences are nested, and split into
+   * subsequences of maxSubSeqLength frames.
+   *
+   * inputTypes gives the type of each data layer, in the order of the
+   * arguments of forward(), so that sparse inputs, ids and labels are fed
+   * with their real type. If it is empty, the inputs read by a table
+   * projection are ids, and the others are dense values.
+   *
+   * @note    releaseOutput() frees the buffers of the middle layers.
+   */
+  void reserve(size_t maxBatchSize,
+               size_t maxSeqLength = 0,
+               size_t maxSubSeqLength = 0,
+               const std::vector<InputType>& inputTypes = {});
+
 protected:
   /**
    * The constructor of NeuralNetwork.
@@ -25,6 +25,11 @@ limitations under the License. */
 #include "paddle/utils/Util.h"
 
 DEFINE_string(diy_beam_search_prob_so, "", "the diy beam search cost so");
+DEFINE_bool(rnn_incremental_generation,
+            false,
+            "In generation, gather the memories of the surviving paths into "
+            "preallocated state buffers, and reuse the previous frame's "
+            "memories in place when the paths keep their rows");
 
 static const char* DIY_CALC_PROB_SYMBOL_NAME = "calc_prob";
 static const char* DIY_START_CALC_PROB_SYMBOL_NAME = "start_calc_prob";
@@ -993,6 +998,19 @@ void RecurrentGradientMachine::generateSequence() {
         memoryFrameLine.agents[0], memoryFrameLine.bootLayer, ids.size());
   }
 
+  if (FLAGS_rnn_incremental_generation) {
+    // A step has at most beam_size paths per sequence, the state buffers
+    // are allocated once for all of them.
+    size_t maxRows = numSequences * getBeamSize();
+    for (auto& memoryFrameLine : memoryFrameLines_) {
+      if (memoryFrameLine.layerName == outFrameLines_[0].layerName) continue;
+      for (auto& scatterAgent : memoryFrameLine.scatterAgents) {
+        dynamic_cast<ScatterAgentLayer*>(scatterAgent.get())
+            ->reserveIncrementalOutput(maxRows);
+      }
+    }
+  }
+
   // boot layer forward
   AsyncGpuBlock asyncGpuBlock;
 
@@ -1064,13 +1082,8 @@ void RecurrentGradientMachine::oneWaySearch(size_t batchSize) {
       }
 
       for (auto& memoryFrameLine : memoryFrameLines_) {
-        auto scatterAgent = dynamic_cast<ScatterAgentLayer*>(
-            memoryFrameLine.scatterAgents[machineCur].get());
-        scatterAgent->setRealLayer(memoryFrameLine.frames[machinePrev],
-                                   scatterIds);
-        scatterAgent->forward(PASS_TEST);
-        NeuralNetwork::connect(memoryFrameLine.agents[machineCur],
-                               memoryFrameLine.scatterAgents[machineCur]);
+        connectMemoryFrameLine(
+            memoryFrameLine, machineCur, machinePrev, scatterIds);
       }
     }
     const std::vector<Argument> inArgs;
@@ -1133,14 +1146,38 @@ void RecurrentGradientMachine::connectPrevFrame(int stepId,
 
   for (auto& memoryFrameLine : memoryFrameLines_) {
     bool isOutIds = (memoryFrameLine.layerName == outFrameLines_[0].layerName);
-    auto scatterAgent = dynamic_cast<ScatterAgentLayer*>(
-        memoryFrameLine.scatterAgents[machineCur].get());
-    scatterAgent->setRealLayer(memoryFrameLine.frames[machinePrev],
-                               isOutIds ? topIds_ : machineIds_);
-    scatterAgent->forward(PASS_TEST);
-    NeuralNetwork::connect(memoryFrameLine.agents[machineCur],
-                           memoryFrameLine.scatterAgents[machineCur]);
+    connectMemoryFrameLine(memoryFrameLine,
+                           machineCur,
+                           machinePrev,
+                           isOutIds ? topIds_ : machineIds_);
+  }
+}
+
+void RecurrentGradientMachine::connectMemoryFrameLine(
+    MemoryFrameLine& memoryFrameLine,
+    int machineCur,
+    int machinePrev,
+    const std::vector<int>& rowIds) {
+  if (FLAGS_rnn_incremental_generation && !rowIds.empty()) {
+    bool inPlace = true;
+    for (size_t i = 0; i < rowIds.size() && inPlace; ++i) {
+      inPlace = rowIds[i] == static_cast<int>(i);
+    }
+    if (inPlace) {
+      // The first rows of the previous frame are the memories wanted, the
+      // agent reads them directly instead of a copy.
+      NeuralNetwork::connect(memoryFrameLine.agents[machineCur],
+                             memoryFrameLine.frames[machinePrev],
+                             rowIds.size());
+      return;
+    }
   }
+  auto scatterAgent = dynamic_cast<ScatterAgentLayer*>(
+      memoryFrameLine.scatterAgents[machineCur].get());
+  scatterAgent->setRealLayer(memoryFrameLine.frames[machinePrev], rowIds);
+  scatterAgent->forward(PASS_TEST);
+  NeuralNetwork::connect(memoryFrameLine.agents[machineCur],
+                         memoryFrameLine.scatterAgents[machineCur]);
 }
 
 void RecurrentGradientMachine::forwardFrame(int machineCur) {
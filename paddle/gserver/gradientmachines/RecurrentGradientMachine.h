@@ -519,6 +519,20 @@ private:
    */
   void connectPrevFrame(int stepId, std::vector<Path>& paths);
 
+  /*
+   * @brief in generation, connect the memory of current frame to the rows
+   * of previous frame selected by rowIds.
+   *
+   * The rows are gathered by the scatter agent of the memory. With
+   * --rnn_incremental_generation, rows kept in place are not copied at all,
+   * and the others are gathered into a state buffer preallocated for the
+   * whole generation.
+   */
+  void connectMemoryFrameLine(MemoryFrameLine& memoryFrameLine,
+                              int machineCur,
+                              int machinePrev,
+                              const std::vector<int>& rowIds);
+
   /*
    * @brief used in beam search, forward current recurrent frame
    * @param machineCur : index to access the layer group frame in
@@ -165,6 +165,15 @@ bool ScatterAgentLayer::init(const LayerMap& layerMap,
   return true;
 }
 
+void ScatterAgentLayer::reserveIncrementalOutput(size_t maxRows) {
+  Matrix::resizeOrCreate(output_.value,
+                         maxRows,
+                         getSize(),
+                         /* trans */ false,
+                         useGpu_);
+  incremental_ = true;
+}
+
 void ScatterAgentLayer::forward(PassType passType) {
   Layer::forward(passType);
   CHECK_EQ(realLayer_->getDeviceId(), this->getDeviceId());
@@ -227,11 +236,15 @@ void ScatterAgentLayer::forwardWithSelection(PassType passType) {
     }
     if (realLayer_->getOutput().value) {
       int height = ids_->getSize();
-      resetOutput(height, width);
-
-      const MatrixPtr& outV = getOutputValue();
       const MatrixPtr& realV = realLayer_->getOutputValue();
-      outV->selectRows(*realV, *ids_);
+      if (incremental_) {
+        // every row is overwritten by the gather, no need to clear them.
+        resizeOutput(height, width);
+        getOutputValue()->copyByRowIndex(*realV, *ids_);
+      } else {
+        resetOutput(height, width);
+        getOutputValue()->selectRows(*realV, *ids_);
+      }
     }
   } else {
     // Putting the generation logic here is really an ugly hack!
@@ -113,8 +113,12 @@ protected:
   // true for setRealLayer, false for setRealLayerAndOutput
   bool selectionMode_;
 
+  // true after reserveIncrementalOutput
+  bool incremental_;
+
 public:
-  explicit ScatterAgentLayer(const LayerConfig& config) : Layer(config) {}
+  explicit ScatterAgentLayer(const LayerConfig& config)
+      : Layer(config), incremental_(false) {}
 
   virtual ~ScatterAgentLayer() {}
 
@@ -143,6 +147,15 @@ public:
     selectionMode_ = true;
   }
 
+  /**
+   * @brief preallocate the output for incremental generation
+   *
+   * The output value is allocated once for maxRows rows, and the rows
+   * selected by setRealLayer() are then gathered into it, without clearing
+   * it first.
+   */
+  void reserveIncrementalOutput(size_t maxRows);
+
   // set real layer and output, [idIndex, idIndex + idSize) of *ids*
   // are selected row for realOutArg in realLayer
   void setRealLayerAndOutput(LayerPtr layer,
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "Layer.h"
+#include "paddle/fluid/operators/math/top_k.h"
 
 namespace paddle {
 
@@ -53,20 +54,16 @@ void KmaxSeqScoreLayer::kmaxScorePerSeq(const real* scores,
                                         real* sortedIds,
                                         const ICpuGpuVectorPtr seqStartPos) {
   int* starts = seqStartPos->getMutableData(false);
-  std::vector<real> indices;
-  for (size_t i = 0; i < seqStartPos->getSize() - 1; ++i) {
-    int seqLen = starts[i + 1] - starts[i];
-    int k = std::min(static_cast<int>(beamSize_), seqLen);
-
-    indices.resize(seqLen, 0);
-    std::iota(begin(indices), end(indices), 0.);
-    std::vector<real> tmpScore(scores + starts[i], scores + starts[i + 1]);
-    std::partial_sort(
-        begin(indices),
-        begin(indices) + k,
-        end(indices),
-        [&](size_t a, size_t b) { return tmpScore[a] > tmpScore[b]; });
-    memcpy(sortedIds + (i * beamSize_), indices.data(), k * sizeof(real));
+  int numSeqs = static_cast<int>(seqStartPos->getSize()) - 1;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < numSeqs; ++i) {
+    operators::math::PartialTopK(scores + starts[i],
+                                 starts[i + 1] - starts[i],
+                                 static_cast<int64_t>(beamSize_),
+                                 static_cast<real*>(nullptr),
+                                 sortedIds + i * beamSize_);
   }
 }
 
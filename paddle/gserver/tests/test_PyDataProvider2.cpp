@@ -393,6 +393,58 @@ TEST(PyDataProvider2, minPoolSizeWithCache) {
   }
 }
 
+TEST(PyDataProvider2, multiProcess) {
+  std::string fileList = "multi_process.list";
+  std::ofstream fout(fileList);
+  fout << "stub file 1" << std::endl << "stub file 2" << std::endl;
+  fout.close();
+
+  paddle::DataConfig config;
+  config.set_type("py2");
+  config.set_files(fileList.c_str());
+  config.set_load_data_module("test_PyDataProvider2");
+  config.set_load_data_object("test_multi_process");
+  std::unique_ptr<paddle::DataProvider> provider(
+      paddle::DataProvider::create(config, false));
+
+  paddle::DataBatch batch;
+  for (size_t pass = 0; pass < 2; ++pass) {
+    provider->reset();
+    // Each of the two workers reads 200 samples from a file.
+    std::vector<int> counts(200, 0);
+    while (int64_t num = provider->getNextBatchInternal(64, &batch)) {
+      auto &dense = batch.getStreams()[0];
+      auto csm = std::dynamic_pointer_cast<paddle::CpuSparseMatrix>(
+          batch.getStreams()[1].value);
+      CHECK(csm != nullptr);
+      auto &subSeq = batch.getStreams()[2];
+      const int *seqStarts = subSeq.sequenceStartPositions->getData(false);
+      const int *subSeqStarts =
+          subSeq.subSequenceStartPositions->getData(false);
+      size_t k = 0;
+      for (int64_t r = 0; r < num; ++r) {
+        int i = (int)dense.value->getData()[r * 2];
+        ASSERT_EQ(-i, (int)dense.value->getData()[r * 2 + 1]);
+        ASSERT_EQ(csm->getColNum(r), (size_t)1);
+        ASSERT_EQ(csm->getRowCols(r)[0], i % 10);
+        ASSERT_EQ(csm->getRowValues(r)[0], real(i));
+        ASSERT_EQ(seqStarts[r], subSeqStarts[k]);
+        for (int j = 0; j < i % 3 + 1; ++j, ++k) {
+          ASSERT_EQ(subSeqStarts[k + 1] - subSeqStarts[k], j + 1);
+          for (int m = 0; m < j + 1; ++m) {
+            ASSERT_EQ(subSeq.ids->getData()[subSeqStarts[k] + m], m);
+          }
+        }
+        ASSERT_EQ(seqStarts[r + 1], subSeqStarts[k]);
+        ++counts[i];
+      }
+    }
+    for (int i = 0; i < 200; ++i) {
+      ASSERT_EQ(counts[i], 2);
+    }
+  }
+}
+
 int main(int argc, char **argv) {
   testing::InitGoogleTest(&argc, argv);
   paddle::initMain(argc, argv);
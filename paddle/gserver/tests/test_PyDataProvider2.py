@@ -123,3 +123,15 @@ def test_min_pool_size_with_cache(settings, filename):
     import random
     for _ in xrange(2**20):
         yield random.randint(0, 9)
+
+
+@provider(
+    input_types=[
+        dense_vector(2), sparse_float_vector(10), index_slot(
+            10, seq_type=SequenceType.SUB_SEQUENCE)
+    ],
+    num_workers=2)
+def test_multi_process(settings, filename):
+    for i in xrange(200):
+        sub_seq = [range(j + 1) for j in xrange(i % 3 + 1)]
+        yield [i, -i], [(i % 10, float(i))], sub_seq
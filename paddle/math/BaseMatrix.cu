@@ -672,6 +672,18 @@ template <>
 void BaseMatrixT<float>::relu(BaseMatrixT& b) {
   neon::relu(data_, b.data_, height_ * width_);
 }
+#elif defined(PADDLE_WITH_AVX512_DISPATCH)
+template <>
+void BaseMatrixT<float>::relu(BaseMatrixT& b) {
+  if (!useGpu_ && stride_ == width_ && b.stride_ == b.width_ &&
+      simd::avx512::isAvailable()) {
+    CHECK_EQ(height_, b.height_);
+    CHECK_EQ(width_, b.width_);
+    simd::avx512::relu(data_, b.data_, height_ * width_);
+  } else {
+    applyBinary(binary::Relu<float>(), b);
+  }
+}
 #endif
 
 DEFINE_MATRIX_BINARY_OP(ReluDerivative, a *= (b > 0.0f ? 1.0f : 0.0f));
@@ -734,6 +746,15 @@ DEFINE_MATRIX_BINARY_OP(Tanh, T tmp = -2.0 * a;
                         b = 2.0 / (1.0 + std::exp(tmp)) - 1.0);
 template <>
 void BaseMatrixT<real>::tanh(BaseMatrixT& b) {
+#if defined(PADDLE_WITH_AVX512_DISPATCH) && !defined(PADDLE_TYPE_DOUBLE)
+  if (!useGpu_ && stride_ == width_ && b.stride_ == b.width_ &&
+      simd::avx512::isAvailable()) {
+    CHECK_EQ(height_, b.height_);
+    CHECK_EQ(width_, b.width_);
+    simd::avx512::tanh(data_, b.data_, height_ * width_);
+    return;
+  }
+#endif
   applyBinary(binary::Tanh<real>(), b);
 }
 
@@ -799,6 +820,12 @@ void BaseMatrixT<real>::sigmoid(BaseMatrixT& b) {
     CHECK_EQ(b.width_, dim);
     const real* in = this->data_;
     real* out = b.data_;
+#if defined(PADDLE_WITH_AVX512_DISPATCH) && !defined(PADDLE_TYPE_DOUBLE)
+    if (simd::avx512::isAvailable()) {
+      simd::avx512::sigmoid(in, out, numSamples * dim);
+      return;
+    }
+#endif
 
     // out = - in
     const float THRESHOLD_MIN = -40.0;  // make sure sigmoid(x) > 0
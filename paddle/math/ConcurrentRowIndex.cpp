@@ -0,0 +1,212 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "ConcurrentRowIndex.h"
+
+#include <algorithm>
+
+#include "paddle/utils/Logging.h"
+
+namespace paddle {
+
+const unsigned int ConcurrentRowIndex::kNotFound;
+const size_t ConcurrentRowIndex::kFirstBlockSize;
+const size_t ConcurrentRowIndex::kMaxBlocks;
+
+namespace {
+
+/// The number of slots of a shard before its first growth.
+const size_t kInitialShardCapacity = 16;
+
+/// Finds the block holding the global id of *localId* and its offset there.
+void locateLocalId(size_t localId,
+                   size_t firstBlockSize,
+                   size_t* block,
+                   size_t* offset) {
+  size_t q = localId / firstBlockSize + 1;
+  *block = 63 - __builtin_clzll(q);
+  *offset = localId - firstBlockSize * ((1UL << *block) - 1);
+}
+
+}  // namespace
+
+struct ConcurrentRowIndex::Table {
+  explicit Table(size_t capacity)
+      : mask(capacity - 1),
+        keys(new std::atomic<unsigned int>[capacity]),
+        values(new std::atomic<unsigned int>[capacity]) {
+    reset();
+  }
+
+  void reset() {
+    for (size_t i = 0; i <= mask; ++i) {
+      keys[i].store(kNotFound, std::memory_order_relaxed);
+    }
+  }
+
+  /// The slot holding *id*, or else the empty slot ending its probe.
+  size_t probe(unsigned int id, size_t start) const {
+    size_t i = start & mask;
+    while (true) {
+      unsigned int key = keys[i].load(std::memory_order_acquire);
+      if (key == id || key == kNotFound) return i;
+      i = (i + 1) & mask;
+    }
+  }
+
+  size_t mask;
+  std::unique_ptr<std::atomic<unsigned int>[]> keys;
+  std::unique_ptr<std::atomic<unsigned int>[]> values;
+};
+
+struct ConcurrentRowIndex::Shard {
+  Shard() : count(0) {
+    tables.emplace_back(new Table(kInitialShardCapacity));
+    table.store(tables.back().get(), std::memory_order_release);
+  }
+
+  /// The table find() reads, always tables.back().
+  std::atomic<Table*> table;
+  /// Guards the fields below and the writes to the tables.
+  std::mutex mutex;
+  size_t count;
+  std::vector<std::unique_ptr<Table>> tables;
+};
+
+ConcurrentRowIndex::ConcurrentRowIndex(size_t numShards) : size_(0) {
+  shardBits_ = 0;
+  while ((1UL << shardBits_) < numShards) ++shardBits_;
+  shardMask_ = (1UL << shardBits_) - 1;
+  shards_.reset(new Shard[shardMask_ + 1]);
+  for (auto& block : blocks_) {
+    block.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+ConcurrentRowIndex::~ConcurrentRowIndex() {
+  for (auto& block : blocks_) {
+    delete[] block.load(std::memory_order_relaxed);
+  }
+}
+
+size_t ConcurrentRowIndex::hash(unsigned int id) const {
+  // The finalizer of MurmurHash3, so that the shard and the slot of
+  // consecutive ids are spread.
+  uint64_t h = id;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+unsigned int ConcurrentRowIndex::find(unsigned int id) const {
+  size_t h = hash(id);
+  const Table* table =
+      shards_[h & shardMask_].table.load(std::memory_order_acquire);
+  size_t i = table->probe(id, h >> shardBits_);
+  if (table->keys[i].load(std::memory_order_relaxed) != id) return kNotFound;
+  return table->values[i].load(std::memory_order_relaxed);
+}
+
+unsigned int ConcurrentRowIndex::insert(unsigned int id) {
+  CHECK_NE(id, kNotFound);
+  unsigned int localId = find(id);
+  if (localId != kNotFound) return localId;
+
+  size_t h = hash(id);
+  Shard& shard = shards_[h & shardMask_];
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  Table* table = shard.tables.back().get();
+  // Another thread may have inserted the id since find(), possibly into a
+  // table find() did not see.
+  size_t i = table->probe(id, h >> shardBits_);
+  if (table->keys[i].load(std::memory_order_relaxed) == id) {
+    return table->values[i].load(std::memory_order_relaxed);
+  }
+
+  if ((shard.count + 1) * 2 > table->mask + 1) {
+    // Keep the load under one half, so that probes stay short.
+    Table* grown = new Table((table->mask + 1) * 2);
+    for (size_t j = 0; j <= table->mask; ++j) {
+      unsigned int key = table->keys[j].load(std::memory_order_relaxed);
+      if (key == kNotFound) continue;
+      size_t k = grown->probe(key, hash(key) >> shardBits_);
+      grown->values[k].store(table->values[j].load(std::memory_order_relaxed),
+                             std::memory_order_relaxed);
+      grown->keys[k].store(key, std::memory_order_relaxed);
+    }
+    shard.tables.emplace_back(grown);
+    shard.table.store(grown, std::memory_order_release);
+    table = grown;
+    i = table->probe(id, h >> shardBits_);
+  }
+
+  localId = size_.fetch_add(1, std::memory_order_relaxed);
+  CHECK_NE(localId, kNotFound);
+  *globalIdSlot(localId) = id;
+  table->values[i].store(localId, std::memory_order_relaxed);
+  // Publishes the value and the global id to the readers of the key.
+  table->keys[i].store(id, std::memory_order_release);
+  ++shard.count;
+  return localId;
+}
+
+unsigned int ConcurrentRowIndex::globalId(unsigned int localId) const {
+  size_t block, offset;
+  locateLocalId(localId, kFirstBlockSize, &block, &offset);
+  return blocks_[block].load(std::memory_order_acquire)[offset];
+}
+
+unsigned int* ConcurrentRowIndex::globalIdSlot(unsigned int localId) {
+  size_t block, offset;
+  locateLocalId(localId, kFirstBlockSize, &block, &offset);
+  CHECK_LT(block, kMaxBlocks);
+  unsigned int* data = blocks_[block].load(std::memory_order_acquire);
+  if (data == nullptr) {
+    // The threads inserting the first ids of a block race to allocate it.
+    unsigned int* allocated = new unsigned int[kFirstBlockSize << block];
+    if (blocks_[block].compare_exchange_strong(data, allocated)) {
+      data = allocated;
+    } else {
+      delete[] allocated;
+    }
+  }
+  return data + offset;
+}
+
+void ConcurrentRowIndex::appendGlobalIds(std::vector<unsigned int>* ids) const {
+  size_t remaining = size();
+  ids->reserve(ids->size() + remaining);
+  for (size_t block = 0; remaining > 0; ++block) {
+    const unsigned int* data = blocks_[block].load(std::memory_order_acquire);
+    size_t n = std::min(remaining, kFirstBlockSize << block);
+    ids->insert(ids->end(), data, data + n);
+    remaining -= n;
+  }
+}
+
+void ConcurrentRowIndex::clear() {
+  for (size_t s = 0; s <= shardMask_; ++s) {
+    Shard& shard = shards_[s];
+    // Only the largest table is worth keeping for the next ids.
+    shard.tables.erase(shard.tables.begin(), shard.tables.end() - 1);
+    shard.tables.back()->reset();
+    shard.count = 0;
+  }
+  size_.store(0, std::memory_order_release);
+}
+
+}  // namespace paddle
@@ -0,0 +1,95 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "paddle/utils/Common.h"
+
+namespace paddle {
+
+/**
+ * @brief Maps the global ids of the rows of a sparse matrix to dense local
+ * ids, numbered in insertion order, and can be grown by several threads at
+ * once.
+ *
+ * The ids are spread over shards, each one an open addressing hash table.
+ * find() never locks: it reads the table a shard currently publishes.
+ * insert() locks the shard of the id only, so threads adding different ids
+ * rarely wait for each other, and a shard growing does not block the
+ * others. The tables a shard outgrows are kept until clear(), so that a
+ * concurrent reader never sees freed memory.
+ *
+ * The global id of each local id is kept in blocks which never move, and can
+ * be read while other ids are inserted.
+ */
+class ConcurrentRowIndex {
+public:
+  /// Returned by find() for an id which was not inserted.
+  static const unsigned int kNotFound = -1U;
+
+  /// numShards is rounded up to a power of two.
+  explicit ConcurrentRowIndex(size_t numShards = 64);
+  ~ConcurrentRowIndex();
+
+  /// The local id of the global id *id*, or kNotFound. Thread-safe.
+  unsigned int find(unsigned int id) const;
+
+  /**
+   * The local id of the global id *id*, which is given the next local id if
+   * it was not inserted before. Thread-safe.
+   */
+  unsigned int insert(unsigned int id);
+
+  /// The number of inserted ids.
+  size_t size() const { return size_.load(std::memory_order_acquire); }
+
+  /// The global id of the local id *localId*, which must be inserted.
+  unsigned int globalId(unsigned int localId) const;
+
+  /**
+   * Appends the global ids to *ids*, in the order of their local ids. Must
+   * not run concurrently with insert().
+   */
+  void appendGlobalIds(std::vector<unsigned int>* ids) const;
+
+  /// Removes all the ids, keeping the memory. Must not run concurrently with
+  /// any other method.
+  void clear();
+
+private:
+  struct Table;
+  struct Shard;
+
+  size_t hash(unsigned int id) const;
+  unsigned int* globalIdSlot(unsigned int localId);
+
+  std::unique_ptr<Shard[]> shards_;
+  size_t shardMask_;
+  size_t shardBits_;
+
+  // Block k holds the global ids of the local ids in
+  // [kFirstBlockSize * (2^k - 1), kFirstBlockSize * (2^(k+1) - 1)).
+  static const size_t kFirstBlockSize = 1024;
+  static const size_t kMaxBlocks = 32;
+  std::atomic<unsigned int*> blocks_[kMaxBlocks];
+  std::atomic<size_t> size_;
+
+  DISABLE_COPY(ConcurrentRowIndex);
+};
+
+}  // namespace paddle
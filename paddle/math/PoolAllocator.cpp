@@ -16,51 +16,180 @@ limitations under the License. */
 
 namespace paddle {
 
+/**
+ * @brief The index of the size class of size, or -1 if size is not the size
+ * of a class. See MemoryHandle for the sizes.
+ */
+static int sizeClass(size_t size) {
+  if (size == 256) return 0;
+  if (size == 512) return 1;
+  if (size > 0 && size <= (1 << 16) && size % 1024 == 0) {
+    return size / 1024 + 1;
+  }
+  return -1;
+}
+
+static size_t classSize(size_t index) {
+  return index == 0 ? 256 : (index == 1 ? 512 : (index - 1) * 1024);
+}
+
 PoolAllocator::PoolAllocator(Allocator* allocator,
                              size_t sizeLimit,
-                             const std::string& name)
+                             const std::string& name,
+                             size_t threadCacheLimit)
     : allocator_(allocator),
       sizeLimit_(sizeLimit),
       poolMemorySize_(0),
-      name_(name) {}
+      name_(name),
+      threadCacheLimit_(threadCacheLimit),
+      systemMemorySize_(0),
+      systemMemoryPeak_(0),
+      allocStat_(getStat(name + "_alloc_bytes")),
+      systemAllocStat_(getStat(name + "_system_alloc_bytes")),
+      systemMemoryPeakStat_(getStat(name + "_system_memory_peak_bytes")) {
+  allocStat_->setBytes(true);
+  systemAllocStat_->setBytes(true);
+  systemMemoryPeakStat_->setBytes(true);
+}
 
-PoolAllocator::~PoolAllocator() { freeAll(); }
+PoolAllocator::~PoolAllocator() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto cache : threadCaches_) {
+    moveToPool(cache);
+    cache->pool = nullptr;
+    delete cache;
+  }
+  threadCaches_.clear();
+  freeAll();
+}
 
 void* PoolAllocator::alloc(size_t size) {
+  allocStat_->addSample(size);
   if (sizeLimit_ > 0) {
+    int index = sizeClass(size);
+    if (threadCacheLimit_ > 0 && index >= 0) {
+      ThreadCache* cache = getThreadCache();
+      auto& blocks = cache->blocks[index];
+      if (!blocks.empty()) {
+        auto buf = blocks.back();
+        blocks.pop_back();
+        cache->size -= size;
+        return buf;
+      }
+    }
+    return allocShared(size);
+  } else {
+    return systemAlloc(size);
+  }
+}
+
+void PoolAllocator::free(void* ptr, size_t size) {
+  if (sizeLimit_ > 0) {
+    int index = sizeClass(size);
+    if (threadCacheLimit_ > 0 && index >= 0) {
+      ThreadCache* cache = getThreadCache();
+      auto& blocks = cache->blocks[index];
+      if (cache->size + size <= threadCacheLimit_) {
+        blocks.push_back(ptr);
+        cache->size += size;
+        return;
+      }
+      // The free lists of this thread are full, move the blocks of this size
+      // to the shared pool at once, so that the next frees do not lock.
+      std::lock_guard<std::mutex> guard(mutex_);
+      auto& it = pool_[size];
+      it.insert(it.end(), blocks.begin(), blocks.end());
+      it.push_back(ptr);
+      poolMemorySize_ += size * (blocks.size() + 1);
+      cache->size -= size * blocks.size();
+      blocks.clear();
+      return;
+    }
+    freeShared(ptr, size);
+  } else {
+    systemFree(ptr, size);
+  }
+}
+
+void* PoolAllocator::allocShared(size_t size) {
+  {
     std::lock_guard<std::mutex> guard(mutex_);
     auto it = pool_.find(size);
-    if (it == pool_.end() || it->second.size() == 0) {
-      if (poolMemorySize_ >= sizeLimit_) {
-        freeAll();
-      }
-      return allocator_->alloc(size);
-    } else {
+    if (it != pool_.end() && it->second.size() > 0) {
       auto buf = it->second.back();
       it->second.pop_back();
       poolMemorySize_ -= size;
       return buf;
     }
-  } else {
-    return allocator_->alloc(size);
+    if (poolMemorySize_ >= sizeLimit_) {
+      freeAll();
+    }
   }
+  return systemAlloc(size);
 }
 
-void PoolAllocator::free(void* ptr, size_t size) {
-  if (sizeLimit_ > 0) {
+void PoolAllocator::freeShared(void* ptr, size_t size) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto& it = pool_[size];
+  it.push_back(ptr);
+  poolMemorySize_ += size;
+}
+
+void* PoolAllocator::systemAlloc(size_t size) {
+  void* ptr = allocator_->alloc(size);
+  size_t memory = systemMemorySize_ += size;
+  systemAllocStat_->addSample(size);
+  // Count the growths of the high-water mark, so that their total is the
+  // high-water mark.
+  size_t peak = systemMemoryPeak_;
+  while (memory > peak) {
+    if (systemMemoryPeak_.compare_exchange_weak(peak, memory)) {
+      systemMemoryPeakStat_->addSample(memory - peak);
+      break;
+    }
+  }
+  return ptr;
+}
+
+void PoolAllocator::systemFree(void* ptr, size_t size) {
+  allocator_->free(ptr);
+  systemMemorySize_ -= size;
+}
+
+PoolAllocator::ThreadCache* PoolAllocator::getThreadCache() {
+  ThreadCache* cache = threadCache_.get(false);
+  if (!cache) {
+    cache = new ThreadCache();
+    cache->pool = this;
+    threadCache_.set(cache);
     std::lock_guard<std::mutex> guard(mutex_);
-    auto& it = pool_[size];
-    it.push_back(ptr);
-    poolMemorySize_ += size;
-  } else {
-    allocator_->free(ptr);
+    threadCaches_.push_back(cache);
+  }
+  return cache;
+}
+
+void PoolAllocator::releaseThreadCache(ThreadCache* cache) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  moveToPool(cache);
+  threadCaches_.remove(cache);
+}
+
+void PoolAllocator::moveToPool(ThreadCache* cache) {
+  for (size_t i = 0; i < cache->blocks.size(); ++i) {
+    auto& blocks = cache->blocks[i];
+    if (blocks.empty()) continue;
+    auto& it = pool_[classSize(i)];
+    it.insert(it.end(), blocks.begin(), blocks.end());
+    poolMemorySize_ += classSize(i) * blocks.size();
+    blocks.clear();
   }
+  cache->size = 0;
 }
 
 void PoolAllocator::freeAll() {
   for (auto it : pool_) {
     for (auto ptr : it.second) {
-      allocator_->free(ptr);
+      systemFree(ptr, it.first);
     }
   }
   poolMemorySize_ = 0;
@@ -14,17 +14,33 @@ limitations under the License. */
 
 #pragma once
 
+#include <atomic>
+#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
 #include <vector>
 #include "Allocator.h"
+#include "paddle/utils/Stat.h"
+#include "paddle/utils/ThreadLocal.h"
 
 namespace paddle {
 
 /**
  * @brief Memory pool allocator implementation.
+ *
+ * Each thread keeps the freed blocks of the size classes of MemoryHandle
+ * (256, 512 and the multiples of 1024 bytes up to 64K) in a free list of
+ * its own, which is used without locking. The free lists of a thread hold
+ * at most threadCacheLimit bytes, the blocks beyond it and the blocks of
+ * the other sizes are kept in a pool shared by all the threads.
+ *
+ * The bytes of the allocations are counted by the stat "<name>_alloc_bytes",
+ * those of the allocations from the system by "<name>_system_alloc_bytes",
+ * and the total of "<name>_system_memory_peak_bytes" is the high-water mark
+ * of the memory allocated from the system, or its growth since the stats
+ * were reset.
  */
 class PoolAllocator {
 public:
@@ -33,10 +49,14 @@ public:
    * @param allocator a Allocator object.
    * @param sizeLimit The maximum size memory can be managed,
    * if sizeLimit == 0, the pool allocator is a simple wrapper of allocator.
+   * @param threadCacheLimit The maximum size memory can be kept by the free
+   * lists of a thread, if threadCacheLimit == 0, all the threads use the
+   * shared pool.
    */
   PoolAllocator(Allocator* allocator,
                 size_t sizeLimit = 0,
-                const std::string& name = "pool");
+                const std::string& name = "pool",
+                size_t threadCacheLimit = 0);
 
   /**
    * @brief destructor.
@@ -48,14 +68,49 @@ public:
   std::string getName() { return name_; }
 
 private:
+  /**
+   * @brief The free lists of one thread, indexed by size class.
+   */
+  struct ThreadCache {
+    ThreadCache() : pool(nullptr), size(0), blocks(kNumSizeClasses) {}
+    ~ThreadCache() {
+      if (pool) pool->releaseThreadCache(this);
+    }
+
+    PoolAllocator* pool;
+    size_t size;
+    std::vector<std::vector<void*>> blocks;
+  };
+
+  static const size_t kNumSizeClasses = 66;
+
+  ThreadCache* getThreadCache();
+  void releaseThreadCache(ThreadCache* cache);
+  void moveToPool(ThreadCache* cache);
+  void* allocShared(size_t size);
+  void freeShared(void* ptr, size_t size);
+  void* systemAlloc(size_t size);
+  void systemFree(void* ptr, size_t size);
   void freeAll();
   void printAll();
+
   std::unique_ptr<Allocator> allocator_;
   std::mutex mutex_;
   std::unordered_map<size_t, std::vector<void*>> pool_;
   size_t sizeLimit_;
   size_t poolMemorySize_;
   std::string name_;
+
+  size_t threadCacheLimit_;
+  ThreadLocal<ThreadCache> threadCache_;
+  // the free lists of all the threads, guarded by mutex_
+  std::list<ThreadCache*> threadCaches_;
+
+  std::atomic<size_t> systemMemorySize_;
+  std::atomic<size_t> systemMemoryPeak_;
+  StatPtr allocStat_;
+  StatPtr systemAllocStat_;
+  StatPtr systemMemoryPeakStat_;
 };
 
 }  // namespace paddle
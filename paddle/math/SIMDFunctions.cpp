@@ -13,10 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "SIMDFunctions.h"
-#ifdef __SSE3__
+#if defined(__SSE3__) || defined(PADDLE_WITH_AVX512_DISPATCH)
 #include <immintrin.h>
 #endif
 #include <algorithm>
+#include "paddle/utils/CpuId.h"
 
 #ifdef __AVX__
 static void addto_avx(float* a, const float* b, size_t len) {
@@ -360,6 +361,208 @@ static void col_max_sse(float* result,
 
 #endif
 
+#ifdef PADDLE_WITH_AVX512_DISPATCH
+
+#if !defined(__clang__)
+// The AVX-512 intrinsics of GCC pass _mm512_undefined_ps() as the source of
+// their masked builtins, which GCC 12 warns about.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#define AVX512_TARGET __attribute__((target("avx512f")))
+
+// The lanes of the last, partial, vector of a loop over len floats.
+static inline __mmask16 tail_mask(size_t remaining) {
+  return remaining >= 16 ? 0xFFFF : (1U << remaining) - 1;
+}
+
+static AVX512_TARGET void addto_avx512(float* a, const float* b, size_t len) {
+  size_t i = 0;
+  for (; i + 64 <= len; i += 64) {
+    __m512 ma0 = _mm512_add_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+    __m512 ma1 = _mm512_add_ps(_mm512_loadu_ps(a + i + 16),
+                               _mm512_loadu_ps(b + i + 16));
+    __m512 ma2 = _mm512_add_ps(_mm512_loadu_ps(a + i + 32),
+                               _mm512_loadu_ps(b + i + 32));
+    __m512 ma3 = _mm512_add_ps(_mm512_loadu_ps(a + i + 48),
+                               _mm512_loadu_ps(b + i + 48));
+    _mm512_storeu_ps(a + i, ma0);
+    _mm512_storeu_ps(a + i + 16, ma1);
+    _mm512_storeu_ps(a + i + 32, ma2);
+    _mm512_storeu_ps(a + i + 48, ma3);
+  }
+  for (; i < len; i += 16) {
+    __mmask16 mask = tail_mask(len - i);
+    __m512 ma = _mm512_add_ps(_mm512_maskz_loadu_ps(mask, a + i),
+                              _mm512_maskz_loadu_ps(mask, b + i));
+    _mm512_mask_storeu_ps(a + i, mask, ma);
+  }
+}
+
+static AVX512_TARGET void batch_addto_avx512(float* a,
+                                             const float* b[],
+                                             int batch,
+                                             size_t len) {
+  size_t i = 0;
+  for (; i + 64 <= len; i += 64) {
+    __m512 ma0 = _mm512_loadu_ps(a + i);
+    __m512 ma1 = _mm512_loadu_ps(a + i + 16);
+    __m512 ma2 = _mm512_loadu_ps(a + i + 32);
+    __m512 ma3 = _mm512_loadu_ps(a + i + 48);
+    for (int k = 0; k < batch; k++) {
+      ma0 = _mm512_add_ps(ma0, _mm512_loadu_ps(b[k] + i));
+      ma1 = _mm512_add_ps(ma1, _mm512_loadu_ps(b[k] + i + 16));
+      ma2 = _mm512_add_ps(ma2, _mm512_loadu_ps(b[k] + i + 32));
+      ma3 = _mm512_add_ps(ma3, _mm512_loadu_ps(b[k] + i + 48));
+    }
+    _mm512_storeu_ps(a + i, ma0);
+    _mm512_storeu_ps(a + i + 16, ma1);
+    _mm512_storeu_ps(a + i + 32, ma2);
+    _mm512_storeu_ps(a + i + 48, ma3);
+  }
+  for (; i < len; i += 16) {
+    __mmask16 mask = tail_mask(len - i);
+    __m512 ma = _mm512_maskz_loadu_ps(mask, a + i);
+    for (int k = 0; k < batch; k++) {
+      ma = _mm512_add_ps(ma, _mm512_maskz_loadu_ps(mask, b[k] + i));
+    }
+    _mm512_mask_storeu_ps(a + i, mask, ma);
+  }
+}
+
+static AVX512_TARGET void col_max_avx512(float* result,
+                                         const float* data,
+                                         int dim,
+                                         int numSamples) {
+  int d = 0;
+  for (; d + 64 <= dim; d += 64) {
+    __m512 ma0 = _mm512_loadu_ps(data + d);
+    __m512 ma1 = _mm512_loadu_ps(data + d + 16);
+    __m512 ma2 = _mm512_loadu_ps(data + d + 32);
+    __m512 ma3 = _mm512_loadu_ps(data + d + 48);
+    for (int i = 1; i < numSamples; i++) {
+      const float* row = data + i * dim + d;
+      ma0 = _mm512_max_ps(ma0, _mm512_loadu_ps(row));
+      ma1 = _mm512_max_ps(ma1, _mm512_loadu_ps(row + 16));
+      ma2 = _mm512_max_ps(ma2, _mm512_loadu_ps(row + 32));
+      ma3 = _mm512_max_ps(ma3, _mm512_loadu_ps(row + 48));
+    }
+    _mm512_storeu_ps(result + d, ma0);
+    _mm512_storeu_ps(result + d + 16, ma1);
+    _mm512_storeu_ps(result + d + 32, ma2);
+    _mm512_storeu_ps(result + d + 48, ma3);
+  }
+  for (; d < dim; d += 16) {
+    __mmask16 mask = tail_mask(dim - d);
+    __m512 ma = _mm512_maskz_loadu_ps(mask, data + d);
+    for (int i = 1; i < numSamples; i++) {
+      ma = _mm512_max_ps(ma, _mm512_maskz_loadu_ps(mask, data + i * dim + d));
+    }
+    _mm512_mask_storeu_ps(result + d, mask, ma);
+  }
+}
+
+#ifdef __AVX__
+// max(src - lambda, 0) + min(src + lambda, 0), one of which is zero. The
+// AVX version ORs them, which AVX-512F has no instruction for.
+static AVX512_TARGET inline __m512 decay_l1_avx512(__m512 src,
+                                                   __m512 lambda) {
+  __m512 zero = _mm512_setzero_ps();
+  return _mm512_add_ps(_mm512_max_ps(_mm512_sub_ps(src, lambda), zero),
+                       _mm512_min_ps(_mm512_add_ps(src, lambda), zero));
+}
+
+static AVX512_TARGET void decayL1_avx512(float* dst,
+                                         float* src,
+                                         float lambda,
+                                         size_t len) {
+  __m512 mlambda = _mm512_set1_ps(lambda);
+  for (size_t i = 0; i < len; i += 16) {
+    __mmask16 mask = tail_mask(len - i);
+    __m512 msrc = _mm512_maskz_loadu_ps(mask, src + i);
+    _mm512_mask_storeu_ps(dst + i, mask, decay_l1_avx512(msrc, mlambda));
+  }
+}
+
+static AVX512_TARGET void decayL1_avx512(
+    float* dst, float* src, float* lr, float lambda, size_t len) {
+  __m512 mlambda = _mm512_set1_ps(lambda);
+  for (size_t i = 0; i < len; i += 16) {
+    __mmask16 mask = tail_mask(len - i);
+    __m512 msrc = _mm512_maskz_loadu_ps(mask, src + i);
+    __m512 mlr = _mm512_maskz_loadu_ps(mask, lr + i);
+    _mm512_mask_storeu_ps(
+        dst + i, mask, decay_l1_avx512(msrc, _mm512_mul_ps(mlr, mlambda)));
+  }
+}
+#endif
+
+// exp(x) with the polynomial of the Cephes library, as exp256_ps of
+// avx_mathfun.h, the power of two being applied with scalef.
+static AVX512_TARGET inline __m512 exp_avx512(__m512 x) {
+  x = _mm512_min_ps(x, _mm512_set1_ps(88.3762626647949f));
+  x = _mm512_max_ps(x, _mm512_set1_ps(-88.3762626647949f));
+  __m512 n = _mm512_roundscale_ps(
+      _mm512_mul_ps(x, _mm512_set1_ps(1.44269504088896341f)),
+      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  x = _mm512_fnmadd_ps(n, _mm512_set1_ps(0.693359375f), x);
+  x = _mm512_fnmadd_ps(n, _mm512_set1_ps(-2.12194440e-4f), x);
+
+  __m512 p = _mm512_set1_ps(1.9875691500E-4f);
+  p = _mm512_fmadd_ps(p, x, _mm512_set1_ps(1.3981999507E-3f));
+  p = _mm512_fmadd_ps(p, x, _mm512_set1_ps(8.3334519073E-3f));
+  p = _mm512_fmadd_ps(p, x, _mm512_set1_ps(4.1665795894E-2f));
+  p = _mm512_fmadd_ps(p, x, _mm512_set1_ps(1.6666665459E-1f));
+  p = _mm512_fmadd_ps(p, x, _mm512_set1_ps(5.0000001201E-1f));
+  p = _mm512_fmadd_ps(p, _mm512_mul_ps(x, x), x);
+  p = _mm512_add_ps(p, _mm512_set1_ps(1.0f));
+  return _mm512_scalef_ps(p, n);
+}
+
+static AVX512_TARGET void relu_avx512(const float* a, float* b, size_t len) {
+  __m512 zero = _mm512_setzero_ps();
+  for (size_t i = 0; i < len; i += 16) {
+    __mmask16 mask = tail_mask(len - i);
+    __m512 ma = _mm512_maskz_loadu_ps(mask, a + i);
+    _mm512_mask_storeu_ps(b + i, mask, _mm512_max_ps(ma, zero));
+  }
+}
+
+static AVX512_TARGET void sigmoid_avx512(const float* a, float* b, size_t len) {
+  __m512 one = _mm512_set1_ps(1.0f);
+  __m512 minInput = _mm512_set1_ps(-40.0f);
+  __m512 maxInput = _mm512_set1_ps(13.0f);
+  for (size_t i = 0; i < len; i += 16) {
+    __mmask16 mask = tail_mask(len - i);
+    __m512 ma = _mm512_maskz_loadu_ps(mask, a + i);
+    ma = _mm512_min_ps(_mm512_max_ps(ma, minInput), maxInput);
+    __m512 e = exp_avx512(_mm512_sub_ps(_mm512_setzero_ps(), ma));
+    _mm512_mask_storeu_ps(
+        b + i, mask, _mm512_div_ps(one, _mm512_add_ps(one, e)));
+  }
+}
+
+static AVX512_TARGET void tanh_avx512(const float* a, float* b, size_t len) {
+  __m512 one = _mm512_set1_ps(1.0f);
+  __m512 two = _mm512_set1_ps(2.0f);
+  __m512 maxInput = _mm512_set1_ps(40.0f);
+  for (size_t i = 0; i < len; i += 16) {
+    __mmask16 mask = tail_mask(len - i);
+    __m512 ma = _mm512_maskz_loadu_ps(mask, a + i);
+    __m512 e = exp_avx512(
+        _mm512_min_ps(_mm512_mul_ps(ma, _mm512_set1_ps(-2.0f)), maxInput));
+    __m512 mb = _mm512_sub_ps(_mm512_div_ps(two, _mm512_add_ps(one, e)), one);
+    _mm512_mask_storeu_ps(b + i, mask, mb);
+  }
+}
+
+#if !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
+
 #if defined(__AVX__)
 #define SIMD_INVOKE(func, ...) func##_avx(__VA_ARGS__)
 #elif defined(__SSE3__)
@@ -368,26 +571,55 @@ static void col_max_sse(float* result,
 
 namespace paddle {
 namespace simd {
+
+#ifdef PADDLE_WITH_AVX512_DISPATCH
+namespace avx512 {
+
+bool isAvailable() { return HAS_AVX512; }
+
+void relu(const float* a, float* b, size_t len) { relu_avx512(a, b, len); }
+
+void sigmoid(const float* a, float* b, size_t len) {
+  sigmoid_avx512(a, b, len);
+}
+
+void tanh(const float* a, float* b, size_t len) { tanh_avx512(a, b, len); }
+
+}  // namespace avx512
+
+#define AVX512_INVOKE(func, ...)        \
+  if (avx512::isAvailable()) {          \
+    return func##_avx512(__VA_ARGS__);  \
+  }
+#else
+#define AVX512_INVOKE(func, ...)
+#endif
+
 namespace internal {
 #ifdef __SSE3__
 void addToImpl(float* a, const float* b, size_t len) {
+  AVX512_INVOKE(addto, a, b, len);
   SIMD_INVOKE(addto, a, b, len);
 }
 void batchAddToImpl(float* a, const float* b[], int batch, size_t len) {
+  AVX512_INVOKE(batch_addto, a, b, batch, len);
   SIMD_INVOKE(batch_addto, a, b, batch, len);
 }
 
 void colMaxImpl(float* result, const float* data, int dim, int numSamples) {
+  AVX512_INVOKE(col_max, result, data, dim, numSamples);
   SIMD_INVOKE(col_max, result, data, dim, numSamples);
 }
 #endif
 
 #ifdef __AVX__
 void decayL1AvxImpl(float* dst, float* src, float lambda, size_t len) {
+  AVX512_INVOKE(decayL1, dst, src, lambda, len);
   decayL1_avx(dst, src, lambda, len);
 }
 void decayL1AvxImpl(
     float* dst, float* src, float* lr, float lambda, size_t len) {
+  AVX512_INVOKE(decayL1, dst, src, lr, lambda, len);
   decayL1_avx(dst, src, lr, lambda, len);
 }
 #endif
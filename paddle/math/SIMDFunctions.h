@@ -16,6 +16,11 @@ limitations under the License. */
 #include <stddef.h>
 #include <stdint.h>
 
+// PADDLE_WITH_AVX512_DISPATCH is defined by cmake/configure.cmake when the
+// compiler accepts AVX-512 intrinsics in a target("avx512f") function. The
+// AVX-512 kernels are then compiled whatever the global SIMD flags, and only
+// called when the CPU supports them.
+
 namespace paddle {
 
 namespace simd {
@@ -115,6 +120,29 @@ inline bool vec_check(size_t len) {
 #endif
 }
 
+#ifdef PADDLE_WITH_AVX512_DISPATCH
+/**
+ * AVX-512 kernels of the CPU activations. They must only be called when
+ * isAvailable() is true; addTo, batchAddTo, colMax and decayL1 above check
+ * it themselves.
+ */
+namespace avx512 {
+
+/// Whether both the CPU and the OS support AVX-512.
+bool isAvailable();
+
+/// b[i] = max(a[i], 0)
+void relu(const float* a, float* b, size_t len);
+
+/// b[i] = 1 / (1 + exp(-a[i])), a[i] being clipped to [-40, 13] first.
+void sigmoid(const float* a, float* b, size_t len);
+
+/// b[i] = 2 / (1 + exp(-2 * a[i])) - 1, the exponent being clipped to 40.
+void tanh(const float* a, float* b, size_t len);
+
+}  // namespace avx512
+#endif
+
 namespace internal {
 #ifdef __SSE3__
 void addToImpl(float* a, const float* b, size_t len);
@@ -228,14 +228,13 @@ void CacheRowCpuMatrix::mul(CpuSparseMatrix* a,
 }
 
 void SparsePrefetchRowCpuMatrix::addRows(const unsigned int* ids, size_t len) {
-  std::vector<unsigned int>& localIndices = indexDictHandle_->localIndices;
   for (size_t i = 0; i < len; i++) {
     CHECK_LT(*(ids + i), this->getHeight())
         << "id:" << *(ids + i) << "Height:" << this->getHeight()
         << "sparse id value exceeds the max input dimension, "
         << "it could be caused invalid input data samples";
+    addedRows_.insert(*(ids + i));
   }
-  localIndices.insert(localIndices.end(), ids, ids + len);
 }
 
 void SparsePrefetchRowCpuMatrix::addRows(MatrixPtr input) {
@@ -246,7 +245,6 @@ void SparsePrefetchRowCpuMatrix::addRows(MatrixPtr input) {
 }
 
 void SparsePrefetchRowCpuMatrix::addRows(IVectorPtr ids) {
-  std::vector<unsigned int>& localIndices = indexDictHandle_->localIndices;
   size_t numSamples = ids->getSize();
   int* index = ids->getData();
   for (size_t i = 0; i < numSamples; ++i) {
@@ -257,12 +255,16 @@ void SparsePrefetchRowCpuMatrix::addRows(IVectorPtr ids) {
         << "id:" << id << "Height:" << this->getHeight()
         << "sparse id value exceeds the max input dimension, "
         << "it could be caused invalid input data samples";
-    localIndices.push_back(id);
+    addedRows_.insert(id);
   }
 }
 
 void SparsePrefetchRowCpuMatrix::setupIndices() {
   auto& localIndices = indexDictHandle_->localIndices;
+  addedRows_.appendGlobalIds(&localIndices);
+  addedRows_.clear();
+  // The added ids are unique already, sorting them keeps the order of the
+  // rows, and of their requests to the parameter servers, deterministic.
   uniqueIds(localIndices);
   // for each sparse row
   for (size_t id = 0; id < localIndices.size(); ++id) {
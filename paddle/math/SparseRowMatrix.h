@@ -19,6 +19,7 @@ limitations under the License. */
 #include <gflags/gflags.h>
 #include <string.h>
 #include <algorithm>
+#include "ConcurrentRowIndex.h"
 #include "Matrix.h"
 #include "RowBuffer.h"
 #include "paddle/utils/Util.h"
@@ -219,7 +220,8 @@ public:
    *
    * *input* must be sparse matrix.
    *
-   * Can call many times before setup.
+   * Can call many times before setup, from several threads at once: the
+   * ids are deduplicated as they are added, in a ConcurrentRowIndex.
    */
   void addRows(MatrixPtr input);
   void addRows(IVectorPtr ids);
@@ -229,9 +231,16 @@ public:
    */
   void setupIndices();
 
+  void clearIndices() {
+    addedRows_.clear();
+    clearRows();
+  }
+
 protected:
   void addRows(const unsigned int* ids, size_t len);
   SyncThreadPool* pool_;
+  /// The rows added since the last setupIndices().
+  ConcurrentRowIndex addedRows_;
 };
 
 class SparseAutoGrowRowCpuMatrix : public SparseRowCpuMatrix {
@@ -21,8 +21,13 @@ limitations under the License. */
 DEFINE_int32(pool_limit_size,
              536870912,
              "maximum memory size managed by a memory pool, default is 512M");
+DEFINE_int32(pool_thread_cache_size,
+             16777216,
+             "maximum memory size kept by the free lists of a thread in a "
+             "memory pool, default is 16M");
 #else
 DEFINE_int32(pool_limit_size, 0, "default is 0");
+DEFINE_int32(pool_thread_cache_size, 0, "default is 0");
 #endif
 
 namespace paddle {
@@ -67,7 +72,10 @@ PoolAllocator* StorageEngine::getGpuAllocator(int deviceId) {
       std::string name =
           "gpu" + str::to_string(deviceId) + std::string("_pool");
       gpuAllocator_[deviceId] =
-          new PoolAllocator(new GpuAllocator(), FLAGS_pool_limit_size, name);
+          new PoolAllocator(new GpuAllocator(),
+                            FLAGS_pool_limit_size,
+                            name,
+                            FLAGS_pool_thread_cache_size);
     }
     return gpuAllocator_[deviceId];
   }
@@ -87,11 +95,15 @@ PoolAllocator* StorageEngine::getCpuAllocator() {
     std::lock_guard<RWLock> guard(lock_);
     if (cpuAllocator_ == nullptr) {
       if (FLAGS_use_gpu) {
-        cpuAllocator_ = new PoolAllocator(
-            new CudaHostAllocator(), FLAGS_pool_limit_size, "cuda_host_pool");
+        cpuAllocator_ = new PoolAllocator(new CudaHostAllocator(),
+                                          FLAGS_pool_limit_size,
+                                          "cuda_host_pool",
+                                          FLAGS_pool_thread_cache_size);
       } else {
-        cpuAllocator_ = new PoolAllocator(
-            new CpuAllocator(), FLAGS_pool_limit_size, "cpu_pool");
+        cpuAllocator_ = new PoolAllocator(new CpuAllocator(),
+                                          FLAGS_pool_limit_size,
+                                          "cpu_pool",
+                                          FLAGS_pool_thread_cache_size);
       }
     }
     return cpuAllocator_;
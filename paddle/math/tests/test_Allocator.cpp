@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <gtest/gtest.h>
+#include <thread>
 #include "paddle/utils/Logging.h"
 #include "paddle/utils/Util.h"
 #define private public
@@ -73,6 +74,43 @@ TEST(Allocator, Pool) {
 #endif
 }
 
+TEST(Allocator, PoolThreadCache) {
+  PoolAllocator* pool = new PoolAllocator(new CpuAllocator(),
+                                          /* sizeLimit */ 1 << 20,
+                                          "thread_cache_pool",
+                                          /* threadCacheLimit */ 2048);
+
+  /* the blocks of the size classes are kept by the thread */
+  void* ptr1 = pool->alloc(1024);
+  void* ptr2 = pool->alloc(1000);
+  pool->free(ptr1, 1024);
+  pool->free(ptr2, 1000);
+  EXPECT_EQ((size_t)0, pool->pool_[1024].size());
+  EXPECT_EQ((size_t)1, pool->pool_[1000].size());
+  EXPECT_EQ(ptr1, pool->alloc(1024));
+
+  /* the blocks beyond threadCacheLimit go to the shared pool */
+  void* ptr3 = pool->alloc(1024);
+  void* ptr4 = pool->alloc(1024);
+  pool->free(ptr1, 1024);
+  pool->free(ptr3, 1024);
+  pool->free(ptr4, 1024);
+  EXPECT_EQ((size_t)3, pool->pool_[1024].size());
+
+  /* the blocks of an exited thread go to the shared pool */
+  std::thread thread([pool] {
+    void* ptr = pool->alloc(512);
+    pool->free(ptr, 512);
+    EXPECT_EQ(ptr, pool->alloc(512));
+    pool->free(ptr, 512);
+  });
+  thread.join();
+  EXPECT_EQ((size_t)1, pool->pool_[512].size());
+  EXPECT_EQ((size_t)1, pool->threadCaches_.size());
+  EXPECT_EQ((size_t)(3 * 1024 + 1000 + 512), pool->systemMemorySize_);
+  delete pool;
+}
+
 TEST(MemoryHandle, Cpu) {
   for (auto size : {10, 30, 50, 100, 200, 512, 1000, 1023, 1024, 1025, 8193}) {
     CpuMemoryHandle handle(size);
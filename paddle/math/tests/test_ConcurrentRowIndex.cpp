@@ -0,0 +1,94 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "paddle/math/ConcurrentRowIndex.h"
+
+using paddle::ConcurrentRowIndex;
+
+TEST(ConcurrentRowIndex, insertAndFind) {
+  ConcurrentRowIndex index(4);
+  ASSERT_EQ(0UL, index.size());
+  ASSERT_EQ(ConcurrentRowIndex::kNotFound, index.find(7));
+
+  // Enough ids for the shards to grow and the global ids to span blocks.
+  const unsigned int kNumIds = 5000;
+  for (unsigned int i = 0; i < kNumIds; ++i) {
+    ASSERT_EQ(i, index.insert(i * 3));
+    ASSERT_EQ(i, index.insert(i * 3));
+  }
+  ASSERT_EQ(kNumIds, index.size());
+  for (unsigned int i = 0; i < kNumIds; ++i) {
+    ASSERT_EQ(i, index.find(i * 3));
+    ASSERT_EQ(i * 3, index.globalId(i));
+    ASSERT_EQ(ConcurrentRowIndex::kNotFound, index.find(i * 3 + 1));
+  }
+
+  std::vector<unsigned int> ids(1, 42);
+  index.appendGlobalIds(&ids);
+  ASSERT_EQ(kNumIds + 1, ids.size());
+  ASSERT_EQ(42U, ids[0]);
+  for (unsigned int i = 0; i < kNumIds; ++i) {
+    ASSERT_EQ(i * 3, ids[i + 1]);
+  }
+
+  index.clear();
+  ASSERT_EQ(0UL, index.size());
+  ASSERT_EQ(ConcurrentRowIndex::kNotFound, index.find(3));
+  ASSERT_EQ(0U, index.insert(3));
+}
+
+TEST(ConcurrentRowIndex, concurrentInsert) {
+  ConcurrentRowIndex index;
+  const int kNumThreads = 8;
+  const unsigned int kNumIds = 100000;
+  std::vector<std::vector<unsigned int>> localIds(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t] {
+      // Every thread inserts every id, in a different order, and checks the
+      // ids inserted by the others as it goes.
+      localIds[t].resize(kNumIds);
+      for (unsigned int i = 0; i < kNumIds; ++i) {
+        unsigned int id = (i * 7919U + t * 104729U) % kNumIds;
+        localIds[t][id] = index.insert(id);
+        unsigned int other = (i * 7919U + (t + 1) * 104729U) % kNumIds;
+        unsigned int localId = index.find(other);
+        if (localId != ConcurrentRowIndex::kNotFound) {
+          ASSERT_EQ(other, index.globalId(localId));
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(kNumIds, index.size());
+  for (int t = 1; t < kNumThreads; ++t) {
+    ASSERT_EQ(localIds[0], localIds[t]);
+  }
+  std::vector<unsigned int> ids;
+  index.appendGlobalIds(&ids);
+  for (unsigned int id = 0; id < kNumIds; ++id) {
+    ASSERT_EQ(id, ids[localIds[0][id]]);
+  }
+  std::sort(ids.begin(), ids.end());
+  for (unsigned int id = 0; id < kNumIds; ++id) {
+    ASSERT_EQ(id, ids[id]);
+  }
+}
@@ -0,0 +1,197 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+/**
+ * Micro-benchmarks of the SIMD primitives and of the CPU activations, each
+ * against its naive implementation. The timings are logged, so that the
+ * speedup of the AVX-512 kernels on a given machine can be tracked. Both
+ * implementations run the same number of times on the same inputs, and
+ * their results are checked against each other.
+ */
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "paddle/math/Matrix.h"
+#include "paddle/math/SIMDFunctions.h"
+#include "paddle/utils/CpuId.h"
+#include "paddle/utils/Util.h"
+
+using namespace paddle;  // NOLINT
+
+static constexpr size_t ALIGN = 64;
+static constexpr int REPEAT = 20;
+static constexpr float EPSILON = 1e-5;
+
+static std::unique_ptr<float[]> newRandomVector(size_t len) {
+  float* ptr;
+  CHECK_EQ(posix_memalign((void**)&ptr, ALIGN, len * sizeof(float)), 0);
+  std::mt19937 engine(len);
+  std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+  for (size_t i = 0; i < len; ++i) {
+    ptr[i] = dist(engine);
+  }
+  return std::unique_ptr<float[]>(ptr);
+}
+
+/// The average time of *func* in microseconds.
+static double timeIt(const std::function<void()>& func) {
+  func();  // warm up
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < REPEAT; ++i) {
+    func();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         REPEAT;
+}
+
+static void report(const std::string& name,
+                   size_t len,
+                   double naiveTime,
+                   double simdTime) {
+  LOG(INFO) << name << " len=" << len << ": naive " << naiveTime
+            << " us, simd " << simdTime << " us, speedup "
+            << naiveTime / simdTime;
+}
+
+static void expectNear(const float* expect, const float* actual, size_t len) {
+  for (size_t i = 0; i < len; ++i) {
+    float tolerance = EPSILON * std::max(1.0f, std::abs(expect[i]));
+    ASSERT_NEAR(expect[i], actual[i], tolerance);
+  }
+}
+
+class SIMDBenchmark : public ::testing::TestWithParam<size_t> {
+protected:
+  virtual void SetUp() {
+    LOG(INFO) << "AVX-512 " << (HAS_AVX512 ? "available" : "unavailable");
+  }
+};
+
+TEST_P(SIMDBenchmark, addTo) {
+  size_t len = GetParam();
+  auto naiveA = newRandomVector(len);
+  auto simdA = newRandomVector(len);
+  auto b = newRandomVector(len);
+  double naiveTime =
+      timeIt([&] { simd::naive::addTo(naiveA.get(), b.get(), len); });
+  double simdTime = timeIt([&] { simd::addTo(simdA.get(), b.get(), len); });
+  report("addTo", len, naiveTime, simdTime);
+  expectNear(naiveA.get(), simdA.get(), len);
+}
+
+TEST_P(SIMDBenchmark, batchAddTo) {
+  size_t len = GetParam();
+  const int batch = 8;
+  auto naiveA = newRandomVector(len);
+  auto simdA = newRandomVector(len);
+  std::vector<std::unique_ptr<float[]>> b;
+  std::vector<const float*> bRaw;
+  for (int i = 0; i < batch; ++i) {
+    b.emplace_back(newRandomVector(len));
+    bRaw.push_back(b.back().get());
+  }
+  double naiveTime = timeIt([&] {
+    std::vector<const float*> ptrs(bRaw);
+    simd::naive::batchAddTo(naiveA.get(), ptrs.data(), batch, len);
+  });
+  double simdTime = timeIt([&] {
+    // The SSE and AVX versions advance the pointers of *b*.
+    std::vector<const float*> ptrs(bRaw);
+    simd::batchAddTo(simdA.get(), ptrs.data(), batch, len);
+  });
+  report("batchAddTo", len, naiveTime, simdTime);
+  expectNear(naiveA.get(), simdA.get(), len);
+}
+
+TEST_P(SIMDBenchmark, colMax) {
+  size_t len = GetParam();
+  const int numSamples = 16;
+  auto data = newRandomVector(len * numSamples);
+  auto naiveResult = newRandomVector(len);
+  auto simdResult = newRandomVector(len);
+  double naiveTime = timeIt([&] {
+    simd::naive::colMax(naiveResult.get(), data.get(), len, numSamples);
+  });
+  double simdTime = timeIt(
+      [&] { simd::colMax(simdResult.get(), data.get(), len, numSamples); });
+  report("colMax", len, naiveTime, simdTime);
+  expectNear(naiveResult.get(), simdResult.get(), len);
+}
+
+TEST_P(SIMDBenchmark, decayL1) {
+  size_t len = GetParam();
+  auto src = newRandomVector(len);
+  auto lr = newRandomVector(len);
+  auto naiveDst = newRandomVector(len);
+  auto simdDst = newRandomVector(len);
+  double naiveTime = timeIt([&] {
+    simd::naive::decayL1(naiveDst.get(), src.get(), lr.get(), 0.1f, len);
+  });
+  double simdTime = timeIt(
+      [&] { simd::decayL1(simdDst.get(), src.get(), lr.get(), 0.1f, len); });
+  report("decayL1", len, naiveTime, simdTime);
+  expectNear(naiveDst.get(), simdDst.get(), len);
+}
+
+#ifndef PADDLE_TYPE_DOUBLE
+TEST_P(SIMDBenchmark, activations) {
+  size_t len = GetParam();
+  auto in = newRandomVector(len);
+  auto out = newRandomVector(len);
+  auto simdOut = newRandomVector(len);
+  CpuMatrix inMat(in.get(), 1, len);
+  CpuMatrix outMat(simdOut.get(), 1, len);
+
+  double naiveTime = timeIt([&] {
+    for (size_t i = 0; i < len; ++i) {
+      out[i] = in[i] > 0 ? in[i] : 0;
+    }
+  });
+  double simdTime = timeIt([&] { inMat.relu(outMat); });
+  report("relu", len, naiveTime, simdTime);
+  expectNear(out.get(), simdOut.get(), len);
+
+  naiveTime = timeIt([&] {
+    for (size_t i = 0; i < len; ++i) {
+      float x = std::min(std::max(in[i], -40.0f), 13.0f);
+      out[i] = 1.0f / (1.0f + std::exp(-x));
+    }
+  });
+  simdTime = timeIt([&] { inMat.sigmoid(outMat); });
+  report("sigmoid", len, naiveTime, simdTime);
+  expectNear(out.get(), simdOut.get(), len);
+
+  naiveTime = timeIt([&] {
+    for (size_t i = 0; i < len; ++i) {
+      out[i] = std::tanh(in[i]);
+    }
+  });
+  simdTime = timeIt([&] { inMat.tanh(outMat); });
+  report("tanh", len, naiveTime, simdTime);
+  expectNear(out.get(), simdOut.get(), len);
+}
+#endif
+
+INSTANTIATE_TEST_CASE_P(SIMDFunctions,
+                        SIMDBenchmark,
+                        ::testing::Values(1024, 65536, 1048576));
@@ -18,6 +18,7 @@ limitations under the License. */
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <cmath>
 #include <functional>
 #include <memory>
 #include <random>
@@ -169,3 +170,53 @@ TEST(SIMDFunction, decayL1_WithoutLR) {
     ASSERT_NEAR(dest[i], simd_dest[i], EPSILON);
   }
 }
+
+TEST(SIMDFunction, addTo_partialVector) {
+  // Lengths which are not a multiple of the vector width.
+  for (size_t len : {1UL, 7UL, 17UL, 100UL, VECTOR_LEN - 1}) {
+    auto A = NewRandomVector(len);
+    auto B = NewRandomVector(len);
+    auto ACopy = NewVector(len);
+    memcpy(ACopy.get(), A.get(), len * sizeof(float));
+
+    paddle::simd::naive::addTo(A.get(), B.get(), len);
+    paddle::simd::addTo(ACopy.get(), B.get(), len);
+
+    for (size_t i = 0; i < len; ++i) {
+      ASSERT_NEAR(A[i], ACopy[i], EPSILON);
+    }
+  }
+}
+
+#ifdef PADDLE_WITH_AVX512_DISPATCH
+TEST(SIMDFunction, avx512Activations) {
+  if (!paddle::simd::avx512::isAvailable()) {
+    LOG(INFO) << "AVX-512 is not supported, skip the test";
+    return;
+  }
+  // Covers the clipped ranges and a partial last vector.
+  const size_t len = VECTOR_LEN - 5;
+  std::uniform_real_distribution<float> dist(-50.0f, 50.0f);
+  auto A = NewVector(len);
+  for (size_t i = 0; i < len; ++i) {
+    A[i] = i % 2 ? dist(RandomEngine) : dist(RandomEngine) / 20;
+  }
+  auto B = NewVector(len);
+
+  paddle::simd::avx512::relu(A.get(), B.get(), len);
+  for (size_t i = 0; i < len; ++i) {
+    ASSERT_EQ(A[i] > 0 ? A[i] : 0.0f, B[i]);
+  }
+
+  paddle::simd::avx512::sigmoid(A.get(), B.get(), len);
+  for (size_t i = 0; i < len; ++i) {
+    float x = std::min(std::max(A[i], -40.0f), 13.0f);
+    ASSERT_NEAR(1.0f / (1.0f + std::exp(-x)), B[i], EPSILON);
+  }
+
+  paddle::simd::avx512::tanh(A.get(), B.get(), len);
+  for (size_t i = 0; i < len; ++i) {
+    ASSERT_NEAR(std::tanh(A[i]), B[i], EPSILON);
+  }
+}
+#endif
@@ -35,6 +35,12 @@ DEFINE_int32(
     grad_share_block_num,
     64,
     "block number of gradient parameter share for batch multi-cpu training");
+DEFINE_bool(hogwild_sparse_update,
+            false,
+            "In local multi-cpu training, let each computing thread apply its "
+            "sparse gradients to the shared parameter value as soon as they "
+            "are computed, without merging them or waiting for the other "
+            "threads (Hogwild)");
 
 namespace paddle {
 
@@ -163,6 +169,11 @@ bool Parameter::isGradSparseUpdate() const {
          (config_.sparse_update() || config_.sparse_remote_update());
 }
 
+bool Parameter::isHogwildSparseUpdate() const {
+  return FLAGS_hogwild_sparse_update && isGradSparseUpdate() &&
+         !config_.sparse_remote_update();
+}
+
 void Parameter::setMat(ParameterType pType, int matType) {
   CHECK(!mats_[pType]);
 
@@ -318,11 +329,95 @@ bool Parameter::save(std::ostream& s) const {
   return true;
 }
 
+size_t Parameter::getSavedSize() const {
+  size_t size = sizeof(Header) + getSize() * sizeof(real);
+  if (config_.is_sparse()) {
+    size += (intBufs_[PARAMETER_ROWS]->getSize() +
+             intBufs_[PARAMETER_COLS]->getSize()) *
+            sizeof(int);
+  }
+  return size;
+}
+
+namespace {
+
+/// A streambuf writing to a buffer of fixed size
+class BufferStreamBuf : public std::streambuf {
+public:
+  BufferStreamBuf(char* data, size_t size) { setp(data, data + size); }
+  bool full() const { return pptr() == epptr(); }
+};
+
+}  // namespace
+
+void Parameter::saveToBuffer(char* buf) const {
+  BufferStreamBuf streamBuf(buf, getSavedSize());
+  std::ostream s(&streamBuf);
+  save(s);
+  CHECK(streamBuf.full()) << "Fail to save parameter " << getName();
+}
+
+void Parameter::enableRowTracking() {
+  CHECK(!useGpu_ && !config_.is_sparse() && config_.dims_size() == 2)
+      << "Rows can not be tracked for parameter " << getName();
+  updatedRows_.assign(config_.dims(0), 0);
+}
+
+bool Parameter::saveDelta(std::ostream& s, const std::string& base) const {
+  CHECK(isRowTracked()) << "Rows are not tracked for " << getName();
+  std::vector<uint64_t> rows;
+  for (size_t i = 0; i < updatedRows_.size(); ++i) {
+    if (updatedRows_[i]) rows.push_back(i);
+  }
+
+  DeltaHeader header;
+  header.format = headerFormat_;
+  header.valueSize = sizeof(real);
+  header.height = updatedRows_.size();
+  header.numRows = rows.size();
+  header.baseSize = base.size();
+  CHECK(s.write(reinterpret_cast<char*>(&header), sizeof(header)))
+      << "Fail to write parameter " << getName();
+  CHECK(s.write(base.data(), base.size()))
+      << "Fail to write parameter " << getName();
+  CHECK(s.write(reinterpret_cast<char*>(rows.data()),
+                rows.size() * sizeof(uint64_t)))
+      << "Fail to write parameter " << getName();
+
+  const real* value = bufs_[PARAMETER_VALUE]->getData();
+  size_t width = getSize() / header.height;
+  for (auto row : rows) {
+    CHECK(s.write(reinterpret_cast<const char*>(value + row * width),
+                  width * sizeof(real)))
+        << "Fail to write parameter " << getName();
+  }
+  return true;
+}
+
+size_t Parameter::getSavedDeltaSize(const std::string& base) const {
+  size_t numRows =
+      updatedRows_.size() -
+      std::count(updatedRows_.begin(), updatedRows_.end(), 0);
+  size_t width = getSize() / updatedRows_.size();
+  return sizeof(DeltaHeader) + base.size() +
+         numRows * (sizeof(uint64_t) + width * sizeof(real));
+}
+
+void Parameter::saveDeltaToBuffer(char* buf, const std::string& base) const {
+  BufferStreamBuf streamBuf(buf, getSavedDeltaSize(base));
+  std::ostream s(&streamBuf);
+  saveDelta(s, base);
+  CHECK(streamBuf.full()) << "Fail to save parameter " << getName();
+}
+
 /**
  * Load parameter value from a file
  */
 bool Parameter::load(const std::string& filename) {
   std::ifstream fs(filename, std::ios_base::binary);
+  if (!fs && fileExist((filename + ".delta").c_str())) {
+    return loadDelta(filename);
+  }
   if (!fs) {
     LOG(INFO) << "missing parameters [" << filename << "] while loading model.";
     if (kMissParameterFail == FLAGS_load_missing_parameter_strategy) {
@@ -346,6 +441,54 @@ bool Parameter::load(const std::string& filename) {
   return load(fs);
 }
 
+bool Parameter::loadDelta(const std::string& filename) {
+  std::string deltaFile = filename + ".delta";
+  std::ifstream s(deltaFile, std::ios_base::binary);
+  CHECK(s) << "Fail to open " << deltaFile;
+  DeltaHeader header;
+  CHECK(s.read(reinterpret_cast<char*>(&header), sizeof(header)))
+      << "Fail to read parameter " << getName();
+  CHECK(isHeaderFormatSupported(header.format)) << "Incorrect format version: "
+                                                << header.format;
+  CHECK_EQ(header.valueSize, sizeof(real))
+      << "Unsupported valueSize " << header.valueSize << " at: " << getName();
+  CHECK(config_.dims_size() == 2 && header.height == (uint64_t)config_.dims(0))
+      << "The height (" << header.height << ") in the file does not match "
+      << "the parameter: " << getName();
+  std::string base(header.baseSize, '\0');
+  CHECK(s.read(&base[0], base.size()))
+      << "Fail to read parameter " << getName();
+  std::vector<uint64_t> rows(header.numRows);
+  CHECK(s.read(reinterpret_cast<char*>(rows.data()),
+               rows.size() * sizeof(uint64_t)))
+      << "Fail to read parameter " << getName();
+
+  // filename is dir/name, and the base is saved in dir/../base/name.
+  std::string dir = path::dirname(filename);
+  std::string baseFile =
+      path::join(path::dirname(dir), base, path::basename(filename));
+  CHECK(fileExist(baseFile.c_str()) ||
+        fileExist((baseFile + ".delta").c_str()))
+      << "Missing base " << baseFile << " of " << deltaFile;
+  load(baseFile);
+  VLOG(1) << "Merge " << rows.size() << " rows of " << deltaFile;
+
+  CpuVector vec(*bufs_[PARAMETER_VALUE].get());
+  size_t width = getSize() / header.height;
+  for (auto row : rows) {
+    CHECK_LT(row, header.height) << "Invalid row in " << deltaFile;
+    CHECK(s.read(reinterpret_cast<char*>(vec.getData() + row * width),
+                 width * sizeof(real)))
+        << "Fail to read parameter " << getName();
+  }
+
+  auto& tmp = *bufs_[PARAMETER_VALUE].get();
+  if (typeid(tmp) == typeid(GpuVector)) {
+    bufs_[PARAMETER_VALUE]->copyFrom(vec);
+  }
+  return true;
+}
+
 bool Parameter::load(std::istream& s) {
   CpuVector vec(*bufs_[PARAMETER_VALUE].get());
   Header header;
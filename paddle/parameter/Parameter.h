@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -182,6 +183,10 @@ public:
   // and MultiGradientMachine
   bool isGradSparseUpdate() const;
 
+  // for SgdThreadUpdater with --hogwild_sparse_update: the sparse gradient
+  // of each computing thread updates the value without being merged.
+  bool isHogwildSparseUpdate() const;
+
   bool isSparseRemoteUpdate() const {
     return config_.sparse_remote_update() && !useGpu();
   }
@@ -218,8 +223,59 @@ public:
    */
   bool save(std::ostream& s) const;
 
+  /**
+   * Size in bytes of the parameter written by save()
+   */
+  size_t getSavedSize() const;
+
+  /**
+   * Save parameter to buf, in the format of save(). buf must have
+   * getSavedSize() bytes.
+   */
+  void saveToBuffer(char* buf) const;
+
+  /**
+   * Record the rows of the value updated from now on, so that saveDelta()
+   * can save only them. The value must be a dense matrix in CPU.
+   */
+  void enableRowTracking();
+
+  bool isRowTracked() const { return !updatedRows_.empty(); }
+
+  /// Record that the row of the value is updated, if rows are tracked
+  void markRowUpdated(size_t row) {
+    if (!updatedRows_.empty()) updatedRows_[row] = 1;
+  }
+
+  /// Forget the updated rows, after the parameter is saved
+  void clearUpdatedRows() {
+    std::fill(updatedRows_.begin(), updatedRows_.end(), 0);
+  }
+
+  /**
+   * Save the rows updated since the last clearUpdatedRows() to ostream, as
+   * a delta over the parameter saved in the directory base, which is beside
+   * the directory of the delta.
+   */
+  bool saveDelta(std::ostream& s, const std::string& base) const;
+
+  /**
+   * Size in bytes of the delta written by saveDelta()
+   */
+  size_t getSavedDeltaSize(const std::string& base) const;
+
+  /**
+   * Save delta to buf, in the format of saveDelta(). buf must have
+   * getSavedDeltaSize() bytes.
+   */
+  void saveDeltaToBuffer(char* buf, const std::string& base) const;
+
   /**
    * Load parameter value from a file
+   *
+   * If the file is missing but filename + ".delta" exists, the parameter
+   * is loaded from the base of the delta, which may be a delta too, and the
+   * rows in the delta are copied over it.
    */
   bool load(const std::string& filename);
 
@@ -266,6 +322,16 @@ public:
     uint64_t size;       // = getSize()
   };
 
+  /// delta file header structure, followed by the name of the base
+  /// directory, the row ids (uint64_t) and the values of the rows
+  struct DeltaHeader {
+    int32_t format;      // = PARAM_FORMAT
+    uint32_t valueSize;  // = sizeof(real)
+    uint64_t height;     // = number of rows of the parameter
+    uint64_t numRows;    // = number of rows in the delta
+    uint64_t baseSize;   // = length of the name of the base
+  };
+
   /**
    * @brief Is the header format supported.
    */
@@ -363,6 +429,13 @@ protected:
 
   std::vector<std::shared_ptr<IParameterUpdaterHook>> updaterHooks_;
 
+  /// updatedRows_[i] is 1 if row i of the value is updated since the last
+  /// save. It is empty if rows are not tracked. A byte per row, so that
+  /// threads updating different rows do not race.
+  std::vector<char> updatedRows_;
+
+  bool loadDelta(const std::string& filename);
+
 public:
   void setSharedCount(int cnt) { sharedCount_ = cnt; }
   int getSharedCount() { return sharedCount_; }
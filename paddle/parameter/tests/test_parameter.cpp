@@ -0,0 +1,107 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <fstream>
+#include <sstream>
+#include "paddle/parameter/Parameter.h"
+#include "paddle/utils/Util.h"
+
+using namespace paddle;  // NOLINT
+
+static ParameterPtr createParameter(size_t height, size_t width) {
+  ParameterConfig config;
+  config.set_name("emb");
+  config.set_size(height * width);
+  config.add_dims(height);
+  config.add_dims(width);
+  return std::make_shared<Parameter>(config, /* useGpu= */ false);
+}
+
+static void updateRow(Parameter* para, size_t row, real value) {
+  size_t width = para->getConfig().dims(1);
+  real* data = para->getBuf(PARAMETER_VALUE)->getData();
+  for (size_t i = 0; i < width; ++i) {
+    data[row * width + i] = value;
+  }
+  para->markRowUpdated(row);
+}
+
+static void expectEqual(Parameter* a, Parameter* b) {
+  const real* x = a->getBuf(PARAMETER_VALUE)->getData();
+  const real* y = b->getBuf(PARAMETER_VALUE)->getData();
+  for (size_t i = 0; i < a->getSize(); ++i) {
+    EXPECT_EQ(x[i], y[i]);
+  }
+}
+
+TEST(Parameter, saveDelta) {
+  char dirTemplate[] = "/tmp/test_parameter_XXXXXX";
+  std::string dir = mkdtemp(dirTemplate);
+  for (auto name : {"pass-00000", "pass-00001", "pass-00002"}) {
+    mkDir(path::join(dir, name).c_str());
+  }
+
+  auto para = createParameter(100, 4);
+  real* value = para->getBuf(PARAMETER_VALUE)->getData();
+  for (size_t i = 0; i < para->getSize(); ++i) {
+    value[i] = 0.01 * i;
+  }
+  para->enableRowTracking();
+  para->save(path::join(dir, "pass-00000", "emb"));
+  para->clearUpdatedRows();
+
+  updateRow(para.get(), 2, 1.0);
+  updateRow(para.get(), 7, 2.0);
+  {
+    std::ofstream fs(path::join(dir, "pass-00001", "emb.delta"));
+    para->saveDelta(fs, "pass-00000");
+  }
+  auto expected = createParameter(100, 4);
+  expected->getBuf(PARAMETER_VALUE)->copyFrom(*para->getBuf(PARAMETER_VALUE));
+  para->clearUpdatedRows();
+
+  updateRow(para.get(), 7, 3.0);
+  updateRow(para.get(), 99, 4.0);
+  std::ostringstream os;
+  para->saveDelta(os, "pass-00001");
+  size_t size = para->getSavedDeltaSize("pass-00001");
+  EXPECT_EQ(os.str().size(), size);
+  EXPECT_EQ(sizeof(Parameter::DeltaHeader) + 10 +
+                2 * (sizeof(uint64_t) + 4 * sizeof(real)),
+            size);
+  std::unique_ptr<char[]> buf(new char[size]);
+  para->saveDeltaToBuffer(buf.get(), "pass-00001");
+  EXPECT_EQ(os.str(), std::string(buf.get(), size));
+  {
+    std::ofstream fs(path::join(dir, "pass-00002", "emb.delta"));
+    fs.write(buf.get(), size);
+  }
+
+  // The deltas are merged over their bases when loading.
+  auto loaded = createParameter(100, 4);
+  loaded->load(path::join(dir, "pass-00001", "emb"));
+  expectEqual(expected.get(), loaded.get());
+  loaded->load(path::join(dir, "pass-00002", "emb"));
+  expectEqual(para.get(), loaded.get());
+
+  rmDir(dir.c_str());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  initMain(argc, argv);
+  return RUN_ALL_TESTS();
+}
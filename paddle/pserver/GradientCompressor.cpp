@@ -0,0 +1,164 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "GradientCompressor.h"
+
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+
+#include "paddle/utils/Logging.h"
+
+namespace paddle {
+
+namespace {
+
+/// The number of reals holding n values of type T.
+template <typename T>
+size_t realsFor(size_t n) {
+  return (n * sizeof(T) + sizeof(real) - 1) / sizeof(real);
+}
+
+}  // namespace
+
+GradientCompressor::GradientCompressor(GradientCompression method,
+                                       double topKRatio)
+    : method_(method), topKRatio_(topKRatio) {
+  CHECK(method_ != GRADIENT_COMPRESSION_TOP_K ||
+        (topKRatio_ > 0 && topKRatio_ <= 1))
+      << "the ratio of top k should be in (0, 1], got " << topKRatio_;
+}
+
+GradientCompression GradientCompressor::parseMethod(const std::string& name) {
+  if (name == "none") {
+    return GRADIENT_COMPRESSION_NONE;
+  } else if (name == "top_k") {
+    return GRADIENT_COMPRESSION_TOP_K;
+  } else if (name == "int8") {
+    return GRADIENT_COMPRESSION_INT8;
+  }
+  LOG(FATAL) << "Unknown gradient compression: " << name;
+  return GRADIENT_COMPRESSION_NONE;
+}
+
+void GradientCompressor::encode(const real* grad,
+                                size_t size,
+                                real* residual,
+                                std::vector<real>* out) const {
+  for (size_t i = 0; i < size; ++i) {
+    residual[i] += grad[i];
+  }
+  switch (method_) {
+    case GRADIENT_COMPRESSION_TOP_K:
+      encodeTopK(residual, size, out);
+      break;
+    case GRADIENT_COMPRESSION_INT8:
+      encodeInt8(residual, size, out);
+      break;
+    default:
+      out->assign(residual, residual + size);
+      std::fill(residual, residual + size, 0);
+  }
+}
+
+void GradientCompressor::encodeTopK(real* acc,
+                                    size_t size,
+                                    std::vector<real>* out) const {
+  size_t k = std::min(
+      size, std::max<size_t>(1, std::ceil(topKRatio_ * (double)size)));
+  std::vector<uint32_t> positions(size);
+  for (size_t i = 0; i < size; ++i) {
+    positions[i] = i;
+  }
+  std::nth_element(positions.begin(),
+                   positions.begin() + k - 1,
+                   positions.end(),
+                   [acc](uint32_t a, uint32_t b) {
+                     return std::abs(acc[a]) > std::abs(acc[b]);
+                   });
+  // Ascending positions make the pserver's scattered adds sequential.
+  std::sort(positions.begin(), positions.begin() + k);
+
+  out->assign(1 + k + realsFor<uint32_t>(k), 0);
+  uint32_t count = k;
+  memcpy(out->data(), &count, sizeof(count));
+  real* values = out->data() + 1;
+  uint32_t* indices = reinterpret_cast<uint32_t*>(values + k);
+  for (size_t i = 0; i < k; ++i) {
+    values[i] = acc[positions[i]];
+    indices[i] = positions[i];
+    acc[positions[i]] = 0;
+  }
+}
+
+void GradientCompressor::encodeInt8(real* acc,
+                                    size_t size,
+                                    std::vector<real>* out) const {
+  real maxAbs = 0;
+  for (size_t i = 0; i < size; ++i) {
+    maxAbs = std::max(maxAbs, std::abs(acc[i]));
+  }
+  real scale = maxAbs / 127;
+
+  out->assign(1 + realsFor<int8_t>(size), 0);
+  (*out)[0] = scale;
+  if (scale == 0) {
+    return;
+  }
+  int8_t* quantized = reinterpret_cast<int8_t*>(out->data() + 1);
+  for (size_t i = 0; i < size; ++i) {
+    // |acc[i] / scale| <= 127, up to rounding.
+    int q = std::max(-127, std::min(127, (int)std::lround(acc[i] / scale)));
+    quantized[i] = q;
+    acc[i] -= q * scale;
+  }
+}
+
+void GradientCompressor::decodeAdd(GradientCompression method,
+                                   const real* data,
+                                   size_t len,
+                                   real* sum,
+                                   size_t size) {
+  switch (method) {
+    case GRADIENT_COMPRESSION_TOP_K: {
+      CHECK_GE(len, 1UL);
+      uint32_t k;
+      memcpy(&k, data, sizeof(k));
+      CHECK_EQ(len, 1 + k + realsFor<uint32_t>(k)) << "bad top k block";
+      const real* values = data + 1;
+      const uint32_t* indices = reinterpret_cast<const uint32_t*>(values + k);
+      for (size_t i = 0; i < k; ++i) {
+        CHECK_LT(indices[i], size);
+        sum[indices[i]] += values[i];
+      }
+      break;
+    }
+    case GRADIENT_COMPRESSION_INT8: {
+      CHECK_EQ(len, 1 + realsFor<int8_t>(size)) << "bad int8 block";
+      real scale = data[0];
+      const int8_t* quantized = reinterpret_cast<const int8_t*>(data + 1);
+      for (size_t i = 0; i < size; ++i) {
+        sum[i] += quantized[i] * scale;
+      }
+      break;
+    }
+    default:
+      CHECK_EQ(len, size);
+      for (size_t i = 0; i < size; ++i) {
+        sum[i] += data[i];
+      }
+  }
+}
+
+}  // namespace paddle
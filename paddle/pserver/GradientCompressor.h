@@ -0,0 +1,83 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "paddle/utils/Common.h"
+
+#include "ParameterService.pb.h"
+
+namespace paddle {
+
+/**
+ * @brief lossy encodings of the gradient blocks sent to the pservers, which
+ *        cut the bytes on the wire of large dense models.
+ *
+ * - GRADIENT_COMPRESSION_TOP_K keeps the values of the largest magnitude of
+ *   a block, a ratio of them, with their positions.
+ * - GRADIENT_COMPRESSION_INT8 quantizes the values of a block linearly to 8
+ *   bits, with the largest magnitude of the block as scale.
+ *
+ * The trainer keeps what an encoding leaves out in a residual, which is
+ * added to the next gradients before they are encoded (error feedback), so
+ * that every part of the gradients is applied eventually.
+ *
+ * An encoded block is a whole number of reals, as the pserver reads blocks:
+ * - top k: the number k stored in the first real, the k values, then the
+ *   k positions as uint32, padded.
+ * - int8: the scale, then the quantized values, padded.
+ */
+class GradientCompressor {
+public:
+  /**
+   * @param method     the encoding.
+   * @param topKRatio  the ratio of the values sent by
+   *                   GRADIENT_COMPRESSION_TOP_K, at least one per block.
+   */
+  explicit GradientCompressor(GradientCompression method,
+                              double topKRatio = 0.01);
+
+  /// Parses "none", "top_k" or "int8".
+  static GradientCompression parseMethod(const std::string& name);
+
+  GradientCompression getMethod() const { return method_; }
+
+  /**
+   * Encodes grad[0, size) plus residual[0, size) into out, and replaces
+   * residual with the part the encoding leaves out.
+   */
+  void encode(const real* grad,
+              size_t size,
+              real* residual,
+              std::vector<real>* out) const;
+
+  /// Adds the block of size values encoded in data[0, len) to sum.
+  static void decodeAdd(GradientCompression method,
+                        const real* data,
+                        size_t len,
+                        real* sum,
+                        size_t size);
+
+private:
+  void encodeTopK(real* acc, size_t size, std::vector<real>* out) const;
+  void encodeInt8(real* acc, size_t size, std::vector<real>* out) const;
+
+  GradientCompression method_;
+  double topKRatio_;
+};
+
+}  // namespace paddle
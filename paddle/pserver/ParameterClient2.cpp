@@ -22,6 +22,14 @@ limitations under the License. */
 
 DEFINE_string(pservers, "127.0.0.1", "Comma separated addresses of pservers");
 DEFINE_int32(parallel_thread_num, 1, "Thread number for parameter send");
+DEFINE_string(gradient_compression,
+              "none",
+              "Encoding of the dense gradients sent to the pservers in sync "
+              "SGD: none, top_k or int8. What an encoding leaves out is "
+              "added to the next gradients");
+DEFINE_double(gradient_top_k_ratio,
+              0.01,
+              "Ratio of the gradients sent with --gradient_compression=top_k");
 
 namespace paddle {
 
@@ -37,7 +45,11 @@ void copyToRepeatedField(google::protobuf::RepeatedField<T1>* dest,
 }
 
 ParameterClient2::ParameterClient2(bool separate, int port, int numPorts)
-    : BaseClient(separate, numPorts), port_(port) {
+    : BaseClient(separate, numPorts),
+      port_(port),
+      compressor_(new GradientCompressor(
+          GradientCompressor::parseMethod(FLAGS_gradient_compression),
+          FLAGS_gradient_top_k_ratio)) {
 #ifndef PADDLE_DISABLE_TIMER
   forwardbackwordTime_ = 0;
 #endif
@@ -140,6 +152,7 @@ void ParameterClient2::destroy() {
 
   parameterMap_.clear();
   allSegments_.clear();
+  compressionBuffers_.clear();
   clients_.clear();
 }
 
@@ -210,6 +223,11 @@ void ParameterClient2::prepareSendData(
   sendJob->parallelRequests.resize(serviceNum_);
   sendJob->parallelInputIovs.resize(serviceNum_);
 
+  /// only the dense gradients of sync-sgd are compressed
+  bool compress = compressor_->getMethod() != GRADIENT_COMPRESSION_NONE &&
+                  updateMode == PSERVER_UPDATE_MODE_ADD_GRADIENT &&
+                  parameterType == PARAMETER_GRADIENT;
+
   for (auto& request : sendJob->parallelRequests) {
 #ifndef PADDLE_DISABLE_TIMER
     if (updateMode == PSERVER_UPDATE_MODE_ADD_GRADIENT) {
@@ -223,6 +241,9 @@ void ParameterClient2::prepareSendData(
     request.set_num_samples(numSamples);
     request.set_cost(cost);
     request.set_batch_status(batchStatus);
+    if (compress) {
+      request.set_gradient_compression(compressor_->getMethod());
+    }
     CHECK_EQ(request.blocks_size(), 0);
     VLOG(10) << "request: trainer_id: " << request.trainer_id()
              << " update_mode" << request.update_mode()
@@ -302,6 +323,12 @@ void ParameterClient2::prepareSendData(
     } else {  /// parameter set for dense and sparse
       real* buf =
           sendingPara ? parameter->getBuf(parameterType)->getPoint(0) : nullptr;
+      CompressionBuffers* compressed = nullptr;
+      if (compress && buf) {
+        compressed = &compressionBuffers_[segments.id];
+        compressed->residual.resize(paraSize, 0);
+        compressed->blocks.resize(divup(paraSize, blockSize));
+      }
       uint64_t endDim = 0;
       for (uint64_t beginDim = 0; beginDim < paraSize; beginDim = endDim) {
         endDim = std::min<int64_t>(beginDim + blockSize, paraSize);
@@ -314,7 +341,15 @@ void ParameterClient2::prepareSendData(
         block->set_block_id(blockId);
         block->set_begin_pos(beginDim);
         block->set_block_size(endDim - beginDim);
-        if (buf) {
+        if (compressed) {
+          std::vector<real>& encoded = compressed->blocks[blockId];
+          compressor_->encode(buf + beginDim,
+                              endDim - beginDim,
+                              compressed->residual.data() + beginDim,
+                              &encoded);
+          sendJob->parallelInputIovs[serverId].push_back(
+              {encoded.data(), sizeof(real) * encoded.size()});
+        } else if (buf) {
           sendJob->parallelInputIovs[serverId].push_back(
               {buf + beginDim, sizeof(real) * ((size_t)(endDim - beginDim))});
         }
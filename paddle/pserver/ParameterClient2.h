@@ -31,6 +31,7 @@ limitations under the License. */
 
 #include "ParameterService.pb.h"
 
+#include "GradientCompressor.h"
 #include "ProtoServer.h"
 #include "SparseParameterDistribution.h"
 
@@ -597,6 +598,17 @@ protected:
   std::unique_ptr<SyncThreadPool> syncThreadPool_;
 
   bool passFinish_;
+
+  /// encoding of the gradients, see --gradient_compression
+  std::unique_ptr<GradientCompressor> compressor_;
+  struct CompressionBuffers {
+    /// the part of the gradients not sent yet
+    std::vector<real> residual;
+    /// the encoded blocks, which must live until they are sent
+    std::vector<std::vector<real>> blocks;
+  };
+  /// map parameter id to its compression buffers
+  std::unordered_map<size_t, CompressionBuffers> compressionBuffers_;
 };
 
 }  // namespace paddle
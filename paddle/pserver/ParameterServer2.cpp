@@ -17,6 +17,7 @@ limitations under the License. */
 #include <algorithm>
 #include <fstream>
 
+#include "GradientCompressor.h"
 #include "paddle/math/SIMDFunctions.h"
 #include "paddle/parameter/AverageOptimizer.h"
 #include "paddle/parameter/FirstOrderOptimizer.h"
@@ -32,6 +33,10 @@ limitations under the License. */
 #include "paddle/utils/StringUtil.h"
 
 DEFINE_int32(pserver_num_threads, 1, "number of threads for sync op exec");
+DEFINE_int32(pserver_num_optimizer_threads,
+             0,
+             "number of threads applying the async sgd updates, 0 to apply "
+             "them in the threads receiving the gradients");
 DEFINE_double(async_lagged_ratio_min,
               1.0,
               "control config_.async_lagged_grad_discard_ratio() min value");
@@ -124,6 +129,11 @@ bool ParameterServer2::init() {
   asyncTrainerCommitStat_.resize(FLAGS_num_gradient_servers);
   asyncTrainerCommitStat_.assign(asyncTrainerCommitStat_.size(), 0);
 
+  optimizerWorkers_.clear();
+  for (int i = 0; i < FLAGS_pserver_num_optimizer_threads; ++i) {
+    optimizerWorkers_.emplace_back(new ThreadWorker());
+  }
+
   return true;
 }
 
@@ -389,13 +399,28 @@ void ParameterServer2::addGradient(const SendParameterRequest& request,
 
       BlockInfo& info = blockInfos_[blockId];
       const ParameterConfig& config = getParameterConfig(blockId);
+      bool compressed = false;
       if (config.sparse_remote_update()) {
         CHECK_EQ(size, config.parameter_block_size());
       } else {  // dense
-        CHECK_LE(size, config.parameter_block_size());
+        compressed =
+            request.gradient_compression() != GRADIENT_COMPRESSION_NONE;
+        CHECK_LE(block.block_size(), config.parameter_block_size());
+        if (!compressed) {
+          // The gradient is added as is, so it must fill the block exactly.
+          CHECK_EQ(size, block.block_size());
+        }
       }
       std::lock_guard<std::mutex> guard(*info.lock);
-      simd::addTo(gradientSumBuffer, gradientBuffer, size);
+      if (compressed) {
+        GradientCompressor::decodeAdd(request.gradient_compression(),
+                                      gradientBuffer,
+                                      size,
+                                      gradientSumBuffer,
+                                      block.block_size());
+      } else {
+        simd::addTo(gradientSumBuffer, gradientBuffer, size);
+      }
     }
   }
   if (request.batch_status() == BATCH_FINISH ||
@@ -452,6 +477,29 @@ bool ParameterServer2::asyncGrdientCommitCheckAndStat(
   return commitGradient;
 }
 
+void ParameterServer2::asyncUpdateBlock(int64_t blockId,
+                                        int64_t offset,
+                                        const Buffer& grad) {
+  VectorPtr* vecs = parameter::getThreadLocalBuffer();
+  BlockInfo& info = blockInfos_[blockId];
+  const ParameterConfig& config = getParameterConfig(blockId);
+  size_t size = grad.size;
+
+  std::lock_guard<std::mutex> guard(*info.lock);
+  info.optimizer->startBatch(numSamplesProcessed_);
+
+  for (const auto type : info.optimizer->getParameterTypes()) {
+    vecs[type]->subVecFrom(*vectors_[type], offset, size);
+  }
+  vecs[PARAMETER_GRADIENT]->subVecFrom(grad.base, 0, size);
+  info.optimizer->update(vecs, config, isSparseServer_ ? 0 : -1);
+
+  if (auto callback = info.optimizer->needSpecialTraversal(config)) {
+    blockTraverse(info, config, offset, size, vecs, callback);
+  }
+  info.optimizer->finishBatch();
+}
+
 static ThreadLocal<std::vector<bool>> localBlockBitset_;
 
 void ParameterServer2::asyncSGD(const SendParameterRequest& request,
@@ -476,9 +524,11 @@ void ParameterServer2::asyncSGD(const SendParameterRequest& request,
 
   bool commitGradient = asyncGrdientCommitCheckAndStat(request);
 
-  VectorPtr* vecs = parameter::getThreadLocalBuffer();
-  size_t bufferIndex = 0;
-  for (const auto& block : request.blocks()) {
+  /// the blocks to update of each stripe, when there are optimizer workers
+  size_t numWorkers = optimizerWorkers_.size();
+  std::vector<std::vector<std::pair<int64_t, int>>> stripes(numWorkers);
+  for (int i = 0; i < request.blocks_size(); ++i) {
+    const auto& block = request.blocks(i);
     int64_t offset = getBlockOffset(block);
     CHECK_GE(offset, 0) << "Only existing parameter block is allowed: "
                         << " id=" << block.para_id()
@@ -487,44 +537,61 @@ void ParameterServer2::asyncSGD(const SendParameterRequest& request,
     CHECK_GE(blockId, 0) << "Only existing parameter block is allowed: "
                          << " id=" << block.para_id()
                          << " block id=" << block.block_id();
-    Buffer buffer = inputBuffers[bufferIndex];
-    ++bufferIndex;
 
-    size_t size = buffer.size;
-
-    BlockInfo& info = blockInfos_[blockId];
-    const ParameterConfig& config = getParameterConfig(blockId);
-
-    std::lock_guard<std::mutex> guard(*info.lock);
     /// gradients are too obsolete, will be discarded
-    if (commitGradient) {
-      info.optimizer->startBatch(numSamplesProcessed_);
-
-      for (const auto type : info.optimizer->getParameterTypes()) {
-        vecs[type]->subVecFrom(*vectors_[type], offset, size);
-      }
-      vecs[PARAMETER_GRADIENT]->subVecFrom(buffer.base, 0, size);
-      info.optimizer->update(vecs, config, isSparseServer_ ? 0 : -1);
+    if (!commitGradient) {
+      continue;
+    }
+    if (numWorkers == 0) {
+      asyncUpdateBlock(blockId, offset, inputBuffers[i]);
+    } else {
+      stripes[blockId % numWorkers].emplace_back(blockId, i);
+    }
+    if (isSparseServer_) {
+      localBlockBitset[blockId] = true;
+    }
+  }
 
-      if (auto callback = info.optimizer->needSpecialTraversal(config)) {
-        blockTraverse(info, config, offset, size, vecs, callback);
+  if (numWorkers > 0) {
+    Semaphore done;
+    int numJobs = 0;
+    for (size_t i = 0; i < numWorkers; ++i) {
+      if (stripes[i].empty()) {
+        continue;
       }
-      info.optimizer->finishBatch();
+      optimizerWorkers_[i]->addJob([&, i]() {
+        for (const auto& update : stripes[i]) {
+          int64_t blockId = update.first;
+          asyncUpdateBlock(blockId,
+                           blockInfos_[blockId].offset,
+                           inputBuffers[update.second]);
+        }
+        done.post();
+      });
+      ++numJobs;
     }
-
-    if (commitGradient && isSparseServer_) {
-      localBlockBitset[blockId] = true;
+    for (int i = 0; i < numJobs; ++i) {
+      done.wait();
     }
+  }
 
-    if (!isSparseServer_ && request.send_back_parameter()) {  // dense
-      int type = request.send_back_parameter_type();
+  /// the gradient buffers are reused for the values sent back, which are
+  /// copied under the block lock so that they are never half updated by
+  /// the requests of other trainers
+  if (!isSparseServer_ && request.send_back_parameter()) {  // dense
+    int type = request.send_back_parameter_type();
+    for (int i = 0; i < request.blocks_size(); ++i) {
+      const auto& block = request.blocks(i);
+      Buffer buffer = inputBuffers[i];
+      std::lock_guard<std::mutex> guard(*blockInfos_[getBlockId(block)].lock);
       sendBackParameter(block, type, response, &buffer, outputBuffers);
     }
-  }  /// foreach block
+  }
 
   asyncTrainerSteps_[request.trainer_id()] = asyncUpdateSteps_;
 
   if (commitGradient && isSparseServer_) {
+    VectorPtr* vecs = parameter::getThreadLocalBuffer();
     /// find blocks that trainer do not request update
     for (int64_t blockId = 0; blockId < numBlocks; ++blockId) {
       if (localBlockBitset[blockId]) {
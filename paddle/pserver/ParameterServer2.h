@@ -32,6 +32,7 @@ limitations under the License. */
 #include "paddle/utils/Common.h"
 #include "paddle/utils/Locks.h"
 #include "paddle/utils/Stat.h"
+#include "paddle/utils/Thread.h"
 #include "paddle/utils/ThreadLocal.h"
 
 #include "ParameterService.pb.h"
@@ -292,6 +293,17 @@ protected:
   /// only used by controller and other control cmd from trainer number 0
   std::unique_ptr<SyncThreadPool> syncThreadPool_;
 
+  /**
+   * optimizer workers of async sgd, empty if the updates are applied by
+   * the threads receiving the gradients.
+   * the blocks are striped over the workers by block id: the updates of a
+   * block are always applied by the worker of its stripe, in the order
+   * they arrive, so that the threads receiving the requests of different
+   * trainers never wait on each other for the same block, and the blocks
+   * of one request are updated by several workers in parallel.
+   */
+  std::vector<std::unique_ptr<ThreadWorker>> optimizerWorkers_;
+
   /// pserver for sparse remote update parameters
   bool isSparseServer_;
 
@@ -470,6 +482,9 @@ public:
                 SendParameterResponse* response,
                 std::vector<Buffer>* outputBuffers);
 
+  /// apply the gradient of one block for async-sgd, under the block lock
+  void asyncUpdateBlock(int64_t blockId, int64_t offset, const Buffer& grad);
+
   /**
    * @brief merge gradients from all trainer
    *
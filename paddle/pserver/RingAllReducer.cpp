@@ -0,0 +1,179 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "RingAllReducer.h"
+
+#include <algorithm>
+
+#include "paddle/utils/Queue.h"
+
+namespace paddle {
+
+namespace {
+
+/// The first block of each message, the second one holding the values.
+struct ChunkHeader {
+  int64_t seq;
+  int64_t offset;
+  int64_t length;
+};
+
+void parsePeer(const std::string& peer, std::string* host, int* port) {
+  size_t pos = peer.rfind(':');
+  CHECK(pos != std::string::npos) << "expect host:port, got " << peer;
+  *host = peer.substr(0, pos);
+  *port = std::stoi(peer.substr(pos + 1));
+}
+
+}  // namespace
+
+/**
+ * Queues the chunks sent by the left neighbour. It is the only peer
+ * connecting, so its chunks are queued in the order they were sent.
+ */
+class RingAllReducer::Receiver : public SocketServer {
+public:
+  /// move-only, so that the queue never copies the data of a chunk.
+  struct Chunk {
+    Chunk() = default;
+    Chunk(Chunk&&) = default;
+    Chunk& operator=(Chunk&&) = default;
+    Chunk(const Chunk&) = delete;
+    Chunk& operator=(const Chunk&) = delete;
+
+    ChunkHeader header;
+    std::vector<real> data;
+  };
+
+  Receiver(const std::string& addr, int port) : SocketServer(addr, port, -1) {}
+
+  Chunk pop() { return chunks_.dequeue(); }
+
+protected:
+  virtual void handleRequest(std::unique_ptr<MsgReader> msgReader,
+                             ResponseCallback callback) {
+    (void)callback;  // chunks are not acknowledged
+    Chunk chunk;
+    CHECK_EQ(msgReader->getNextBlockLength(), sizeof(ChunkHeader));
+    msgReader->readNextBlock(&chunk.header);
+    CHECK_EQ(msgReader->getNextBlockLength(),
+             chunk.header.length * sizeof(real));
+    chunk.data.resize(chunk.header.length);
+    msgReader->readNextBlock(chunk.data.data());
+    chunks_.enqueue(std::move(chunk));
+  }
+
+private:
+  Queue<Chunk> chunks_;
+};
+
+RingAllReducer::RingAllReducer(const std::vector<std::string>& peers,
+                               int rank,
+                               size_t chunkSize)
+    : rank_(rank),
+      numPeers_(peers.size()),
+      chunkSize_(chunkSize),
+      sendSeq_(0),
+      recvSeq_(0) {
+  CHECK_GE(rank_, 0);
+  CHECK_LT(rank_, numPeers_);
+  CHECK_GT(chunkSize_, 0UL);
+  if (numPeers_ == 1) {
+    return;
+  }
+
+  std::string host;
+  int port;
+  parsePeer(peers[rank_], &host, &port);
+  receiver_.reset(new Receiver(host, port));
+  receiver_->start();
+
+  // The right neighbour may not listen yet, SocketClient retries.
+  parsePeer(peers[(rank_ + 1) % numPeers_], &host, &port);
+  sender_.reset(new SocketClient(host, port, F_TCP));
+  LOG(INFO) << "ring all-reduce peer " << rank_ << " of " << numPeers_
+            << " connected to " << peers[(rank_ + 1) % numPeers_];
+}
+
+RingAllReducer::~RingAllReducer() {
+  // Closing the connection first stops the worker of the right neighbour.
+  sender_.reset();
+  receiver_.reset();
+}
+
+void RingAllReducer::sendChunk(const real* data, size_t offset, size_t length) {
+  ChunkHeader header = {sendSeq_++, (int64_t)offset, (int64_t)length};
+  std::vector<iovec> iovs = {
+      {&header, sizeof(header)},
+      {const_cast<real*>(data + offset), length * sizeof(real)}};
+  sender_->getChannel()->writeMessage(iovs);
+}
+
+void RingAllReducer::sendSegment(const real* data, size_t begin, size_t end) {
+  for (size_t offset = begin; offset < end; offset += chunkSize_) {
+    sendChunk(data, offset, std::min(chunkSize_, end - offset));
+  }
+}
+
+void RingAllReducer::recvSegment(
+    real* data, size_t begin, size_t end, bool add, bool forward) {
+  for (size_t offset = begin; offset < end; offset += chunkSize_) {
+    size_t length = std::min(chunkSize_, end - offset);
+    Receiver::Chunk chunk = receiver_->pop();
+    CHECK_EQ(chunk.header.seq, recvSeq_++)
+        << "the peers do not all-reduce the same buffers";
+    CHECK_EQ(chunk.header.offset, (int64_t)offset);
+    CHECK_EQ(chunk.header.length, (int64_t)length);
+
+    real* dst = data + offset;
+    if (add) {
+      for (size_t i = 0; i < length; ++i) {
+        dst[i] += chunk.data[i];
+      }
+    } else {
+      std::copy(chunk.data.begin(), chunk.data.end(), dst);
+    }
+    if (forward) {
+      sendChunk(data, offset, length);
+    }
+  }
+}
+
+void RingAllReducer::allReduce(real* data, size_t size) {
+  if (numPeers_ == 1) {
+    return;
+  }
+  size_t n = numPeers_;
+  // Segment i is [begin(i), begin(i + 1)).
+  auto begin = [size, n](size_t i) { return i * size / n; };
+
+  // Reduce-scatter: at step s the segment rank - s - 1 comes from the left,
+  // its partial sum over the peers rank - s - 1, ..., rank - 1.
+  sendSegment(data, begin(rank_), begin(rank_ + 1));
+  for (size_t s = 0; s + 1 < n; ++s) {
+    size_t seg = (rank_ + 2 * n - s - 1) % n;
+    // The last one is complete, and passing it on starts the all-gather.
+    recvSegment(data, begin(seg), begin(seg + 1), /* add= */ true, true);
+  }
+
+  // All-gather: at step s the complete segment rank - s comes from the
+  // left, where it was summed s steps before.
+  for (size_t s = 0; s + 1 < n; ++s) {
+    size_t seg = (rank_ + n - s) % n;
+    recvSegment(
+        data, begin(seg), begin(seg + 1), /* add= */ false, s + 2 < n);
+  }
+}
+
+}  // namespace paddle
@@ -0,0 +1,88 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LightNetwork.h"
+
+namespace paddle {
+
+/**
+ * @brief sums buffers over a group of peers connected in a ring, without
+ *        any parameter server.
+ *
+ * Each peer listens for its left neighbour and connects to its right one,
+ * so that every message travels one hop only. A buffer of n peers is cut
+ * into n segments: during n - 1 reduce-scatter steps each peer adds the
+ * segment received from the left into its own and passes it on, after
+ * which each peer holds the sum of one segment; during n - 1 all-gather
+ * steps the summed segments go around the ring once more. Each peer thus
+ * sends and receives 2 * (n - 1) / n of the buffer, whatever the number of
+ * peers, instead of a server receiving the whole buffer from each of them.
+ *
+ * The segments are sent as chunks of bounded size, and a chunk is passed
+ * on as soon as it is summed, so that the steps of the ring are pipelined
+ * rather than waiting for whole segments.
+ *
+ * All the peers must call allReduce() with buffers of the same size, in
+ * the same order.
+ */
+class RingAllReducer {
+public:
+  /**
+   * @param peers      the "host:port" of every peer, in ring order.
+   * @param rank       the index of this peer in peers.
+   * @param chunkSize  the largest number of values in one message.
+   */
+  RingAllReducer(const std::vector<std::string>& peers,
+                 int rank,
+                 size_t chunkSize);
+  ~RingAllReducer();
+
+  /// Replaces data with its sum over all the peers.
+  void allReduce(real* data, size_t size);
+
+  int getRank() const { return rank_; }
+  int getNumPeers() const { return numPeers_; }
+
+private:
+  class Receiver;
+
+  /// Sends data[begin, end) to the right neighbour.
+  void sendSegment(const real* data, size_t begin, size_t end);
+  void sendChunk(const real* data, size_t offset, size_t length);
+
+  /**
+   * Receives data[begin, end) from the left neighbour, adding it to data
+   * if add is true and overwriting it otherwise. Each chunk is sent on to
+   * the right neighbour once stored if forward is true.
+   */
+  void recvSegment(
+      real* data, size_t begin, size_t end, bool add, bool forward);
+
+  int rank_;
+  int numPeers_;
+  size_t chunkSize_;
+  std::unique_ptr<Receiver> receiver_;
+  std::unique_ptr<SocketClient> sender_;
+  /// sequence numbers of the chunks, checked against the sender's
+  int64_t sendSeq_;
+  int64_t recvSeq_;
+};
+
+}  // namespace paddle
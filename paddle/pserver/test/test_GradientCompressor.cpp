@@ -0,0 +1,215 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "paddle/pserver/GradientCompressor.h"
+#include "paddle/utils/Logging.h"
+
+using namespace paddle;  // NOLINT
+
+static const GradientCompression kMethods[] = {GRADIENT_COMPRESSION_NONE,
+                                               GRADIENT_COMPRESSION_TOP_K,
+                                               GRADIENT_COMPRESSION_INT8};
+
+static std::vector<real> randomVector(size_t size, int seed) {
+  std::mt19937 engine(seed);
+  std::normal_distribution<real> dist(0, 1);
+  std::vector<real> vec(size);
+  for (auto& v : vec) {
+    v = dist(engine);
+  }
+  return vec;
+}
+
+TEST(GradientCompressor, errorFeedback) {
+  // What is decoded plus the new residual is the gradient plus the old
+  // residual: nothing is lost.
+  for (auto method : kMethods) {
+    GradientCompressor compressor(method, 0.05);
+    for (size_t size : {1, 7, 1000, 4099}) {
+      std::vector<real> grad = randomVector(size, size);
+      std::vector<real> residual = randomVector(size, size + 1);
+      std::vector<real> expected(size);
+      for (size_t i = 0; i < size; ++i) {
+        expected[i] = grad[i] + residual[i];
+      }
+
+      std::vector<real> encoded;
+      compressor.encode(grad.data(), size, residual.data(), &encoded);
+      std::vector<real> decoded(size, 0);
+      GradientCompressor::decodeAdd(
+          method, encoded.data(), encoded.size(), decoded.data(), size);
+      for (size_t i = 0; i < size; ++i) {
+        EXPECT_NEAR(expected[i], decoded[i] + residual[i], 1e-5)
+            << "method=" << method << " size=" << size << " i=" << i;
+      }
+    }
+  }
+}
+
+TEST(GradientCompressor, topK) {
+  const size_t size = 1000;
+  GradientCompressor compressor(GRADIENT_COMPRESSION_TOP_K, 0.01);
+  std::vector<real> grad = randomVector(size, 0);
+  std::vector<real> residual(size, 0);
+  std::vector<real> encoded;
+  compressor.encode(grad.data(), size, residual.data(), &encoded);
+  std::vector<real> decoded(size, 0);
+  GradientCompressor::decodeAdd(GRADIENT_COMPRESSION_TOP_K,
+                                encoded.data(),
+                                encoded.size(),
+                                decoded.data(),
+                                size);
+
+  // The 10 values of the largest magnitude are sent, and only them.
+  std::vector<real> magnitudes(size);
+  for (size_t i = 0; i < size; ++i) {
+    magnitudes[i] = std::abs(grad[i]);
+  }
+  std::sort(magnitudes.begin(), magnitudes.end());
+  real threshold = magnitudes[size - 10];
+  for (size_t i = 0; i < size; ++i) {
+    if (std::abs(grad[i]) >= threshold) {
+      EXPECT_EQ(grad[i], decoded[i]);
+      EXPECT_EQ(0, residual[i]);
+    } else {
+      EXPECT_EQ(0, decoded[i]);
+      EXPECT_EQ(grad[i], residual[i]);
+    }
+  }
+}
+
+TEST(GradientCompressor, int8) {
+  const size_t size = 1001;
+  GradientCompressor compressor(GRADIENT_COMPRESSION_INT8);
+  std::vector<real> grad = randomVector(size, 0);
+  std::vector<real> residual(size, 0);
+  std::vector<real> encoded;
+  compressor.encode(grad.data(), size, residual.data(), &encoded);
+  real scale = encoded[0];
+  EXPECT_GT(scale, 0);
+  for (size_t i = 0; i < size; ++i) {
+    EXPECT_LE(std::abs(residual[i]), scale / 2 + 1e-6);
+  }
+
+  // A zero block is sent as a zero scale.
+  std::vector<real> zeros(size, 0);
+  compressor.encode(zeros.data(), size, zeros.data(), &encoded);
+  std::vector<real> decoded(size, 1);
+  GradientCompressor::decodeAdd(GRADIENT_COMPRESSION_INT8,
+                                encoded.data(),
+                                encoded.size(),
+                                decoded.data(),
+                                size);
+  EXPECT_EQ(std::vector<real>(size, 1), decoded);
+}
+
+TEST(GradientCompressor, bytesOnWire) {
+  // A usual dense block of the pservers.
+  const size_t size = 65536;
+  std::vector<real> grad = randomVector(size, 0);
+  for (auto method : kMethods) {
+    GradientCompressor compressor(method, 0.01);
+    std::vector<real> residual(size, 0);
+    std::vector<real> encoded;
+    compressor.encode(grad.data(), size, residual.data(), &encoded);
+    double ratio = (double)encoded.size() / size;
+    LOG(INFO) << "method=" << method << ": " << encoded.size() * sizeof(real)
+              << " bytes for " << size * sizeof(real) << ", ratio " << ratio;
+    if (method == GRADIENT_COMPRESSION_TOP_K) {
+      // a value and a position for each value sent
+      EXPECT_LT(ratio, 0.025);
+    } else if (method == GRADIENT_COMPRESSION_INT8) {
+      EXPECT_LT(ratio, 0.3);
+    }
+  }
+}
+
+/**
+ * The linear regression of the fit_a_line book model, 13 features and a
+ * bias, trained by SGD on synthetic data, its gradient going through the
+ * compression. Returns the mean squared error on the training data.
+ */
+static real fitALine(GradientCompression method, int numBatches) {
+  const size_t dim = 14;
+  const size_t numSamples = 1024;
+  const size_t batchSize = 32;
+  const real learningRate = 0.05;
+
+  std::vector<real> trueWeight = randomVector(dim, 1);
+  std::vector<real> x = randomVector(numSamples * dim, 2);
+  std::vector<real> noise = randomVector(numSamples, 3);
+  std::vector<real> y(numSamples);
+  for (size_t n = 0; n < numSamples; ++n) {
+    x[n * dim + dim - 1] = 1;  // bias
+    y[n] = 0.1 * noise[n];
+    for (size_t j = 0; j < dim; ++j) {
+      y[n] += trueWeight[j] * x[n * dim + j];
+    }
+  }
+
+  auto error = [&](const std::vector<real>& w, size_t n) {
+    real e = -y[n];
+    for (size_t j = 0; j < dim; ++j) {
+      e += w[j] * x[n * dim + j];
+    }
+    return e;
+  };
+
+  GradientCompressor compressor(method, 0.1);
+  std::vector<real> weight(dim, 0);
+  std::vector<real> residual(dim, 0);
+  std::vector<real> grad(dim);
+  std::vector<real> encoded;
+  for (int batch = 0; batch < numBatches; ++batch) {
+    std::fill(grad.begin(), grad.end(), 0);
+    for (size_t b = 0; b < batchSize; ++b) {
+      size_t n = (batch * batchSize + b) % numSamples;
+      real e = error(weight, n);
+      for (size_t j = 0; j < dim; ++j) {
+        grad[j] += e * x[n * dim + j] / batchSize;
+      }
+    }
+    compressor.encode(grad.data(), dim, residual.data(), &encoded);
+    std::vector<real> decoded(dim, 0);
+    GradientCompressor::decodeAdd(
+        method, encoded.data(), encoded.size(), decoded.data(), dim);
+    for (size_t j = 0; j < dim; ++j) {
+      weight[j] -= learningRate * decoded[j];
+    }
+  }
+
+  real mse = 0;
+  for (size_t n = 0; n < numSamples; ++n) {
+    real e = error(weight, n);
+    mse += e * e / numSamples;
+  }
+  return mse;
+}
+
+TEST(GradientCompressor, convergence) {
+  const int numBatches = 1000;
+  real baseline = fitALine(GRADIENT_COMPRESSION_NONE, numBatches);
+  LOG(INFO) << "fit_a_line mse without compression: " << baseline;
+  for (auto method : {GRADIENT_COMPRESSION_TOP_K, GRADIENT_COMPRESSION_INT8}) {
+    real mse = fitALine(method, numBatches);
+    LOG(INFO) << "fit_a_line mse with method=" << method << ": " << mse;
+    // The noise variance is 0.01.
+    EXPECT_LT(mse, std::max<real>(2 * baseline, 0.02));
+  }
+}
@@ -13,6 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <thread>
 #include <paddle/pserver/ParameterClient2.h>
 #include <paddle/pserver/ParameterServer2.h>
 #include <paddle/utils/Flags.h>
@@ -22,6 +26,7 @@ using namespace paddle;  // NOLINT
 using namespace std;     // NOLINT
 
 DECLARE_int32(num_gradient_servers);
+DECLARE_int32(pserver_num_optimizer_threads);
 DEFINE_string(server_addr, "127.0.0.1", "assign server address");
 DEFINE_int32(server_cpu, 0, "assign server cpu");
 
@@ -87,6 +92,10 @@ public:
   void checkSegments(const BlockSegments& expected, const BlockSegments& segs);
   void waitPassFinishTest();
   void synchronizeTest();
+  void asyncSGDTest(int numClients,
+                    int numBatches,
+                    vector<vector<real>>* values,
+                    int* numTornBlocks = nullptr);
 
 protected:
   ParameterClient2 client_;
@@ -536,6 +545,95 @@ void ParameterServer2Tester::synchronizeTest() {
   LOG(INFO) << "Pass 2 finished";
 }
 
+/**
+ * numClients trainers send numBatches identical gradients each, all at
+ * once, for async sgd. The updates of a block are all the same whatever
+ * their order, so the values of the parameters at the end depend neither
+ * on the interleaving of the requests nor on the optimizer threads.
+ *
+ * All the elements of a block are updated alike, so a block sent back
+ * whose elements differ was copied while another trainer's update was
+ * applied. Such blocks are counted in numTornBlocks.
+ */
+void ParameterServer2Tester::asyncSGDTest(int numClients,
+                                          int numBatches,
+                                          vector<vector<real>>* values,
+                                          int* numTornBlocks) {
+  setup();
+  for (auto& vec : vectors_) {
+    if (vec) {
+      vec->zeroMem();
+    }
+  }
+  asyncLaggedThreshold_ = std::numeric_limits<int64_t>::max();
+  for (auto& parameter : parameters_) {
+    parameter->getBuf(PARAMETER_VALUE)->reset(1.0);
+  }
+  client_.sendAndReceiveParameter(PSERVER_UPDATE_MODE_SET_PARAM,
+                                  PARAMETER_VALUE,
+                                  0,       // numSamples = 0
+                                  0,       // cost = 0
+                                  false);  // sendBackParameter = false
+
+  auto start = std::chrono::steady_clock::now();
+  std::atomic<int> tornBlocks(0);
+  std::vector<std::thread> threads;
+  for (int trainerId = 0; trainerId < numClients; ++trainerId) {
+    threads.emplace_back([this, trainerId, numBatches, &tornBlocks]() {
+      vector<ParameterPtr> parameters;
+      for (auto& config : clientConfigs_) {
+        parameters.emplace_back(new Parameter(config, /* useGpu= */ false));
+        parameters.back()->setID(parameters.size() - 1);
+        parameters.back()->enableType(PARAMETER_GRADIENT);
+        parameters.back()->getBuf(PARAMETER_GRADIENT)->reset(0.01);
+      }
+      ParameterClient2 client;
+      client.setTrainerId(trainerId);
+      CHECK(client.init(parameters));
+      for (int batch = 0; batch < numBatches; ++batch) {
+        client.sendAndReceiveParameter(PSERVER_UPDATE_MODE_ASYNC_SGD,
+                                       PARAMETER_GRADIENT,
+                                       0,      // numSamples = 0
+                                       0,      // cost = 0
+                                       true);  // sendBackParameter = true
+        for (auto& para : parameters) {
+          const real* data = para->getBuf(PARAMETER_VALUE)->getData();
+          size_t blockSize = para->getConfig().parameter_block_size();
+          for (size_t j = 0; j < para->getSize(); ++j) {
+            if (j % blockSize != 0 && data[j] != data[j - 1]) {
+              ++tornBlocks;
+              j = (j / blockSize + 1) * blockSize - 1;
+            }
+          }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  LOG(INFO) << "async sgd with " << FLAGS_pserver_num_optimizer_threads
+            << " optimizer threads: " << numClients * numBatches / seconds
+            << " requests/s";
+
+  client_.sendAndReceiveParameter(PSERVER_UPDATE_MODE_GET_PARAM,
+                                  PARAMETER_VALUE,
+                                  0,      // numSamples = 0
+                                  0,      // cost = 0
+                                  true);  // sendBackParameter = true
+  if (numTornBlocks) {
+    *numTornBlocks = tornBlocks;
+  }
+  values->clear();
+  for (auto& parameter : parameters_) {
+    real* data = parameter->getBuf(PARAMETER_VALUE)->getData();
+    values->emplace_back(data, data + parameter->getSize());
+  }
+}
+
 TEST(ParameterServer2, sendParameter) { g_server->sendParameterTest(); }
 
 TEST(ParameterServer2, setConfig) { g_server->setConfigTest(); }
@@ -550,6 +648,40 @@ TEST(ParameterServer2, waitPassFinish) { g_server->waitPassFinishTest(); }
 
 TEST(ParameterServer2, synchronize) { g_server->synchronizeTest(); }
 
+TEST(ParameterServer2, asyncSGD) {
+  const int numClients = FLAGS_num_gradient_servers;
+  const int numBatches = 20;
+  int oldNumOptimizerThreads = FLAGS_pserver_num_optimizer_threads;
+  FLAGS_pserver_num_optimizer_threads = 0;
+  vector<vector<real>> expected;
+  g_server->asyncSGDTest(numClients, numBatches, &expected);
+  for (auto& values : expected) {
+    EXPECT_NE(1.0, values[0]);
+  }
+
+  for (int numThreads : {1, 4}) {
+    FLAGS_pserver_num_optimizer_threads = numThreads;
+    vector<vector<real>> actual;
+    g_server->asyncSGDTest(numClients, numBatches, &actual);
+    EXPECT_EQ(expected, actual) << "optimizer threads: " << numThreads;
+  }
+  FLAGS_pserver_num_optimizer_threads = oldNumOptimizerThreads;
+}
+
+TEST(ParameterServer2, asyncSGDSendBack) {
+  // Two trainers updating the same blocks at the same time never get back
+  // values half updated by the other one.
+  int oldNumOptimizerThreads = FLAGS_pserver_num_optimizer_threads;
+  for (int numThreads : {0, 4}) {
+    FLAGS_pserver_num_optimizer_threads = numThreads;
+    vector<vector<real>> values;
+    int numTornBlocks = -1;
+    g_server->asyncSGDTest(2, 200, &values, &numTornBlocks);
+    EXPECT_EQ(0, numTornBlocks) << "optimizer threads: " << numThreads;
+  }
+  FLAGS_pserver_num_optimizer_threads = oldNumOptimizerThreads;
+}
+
 TEST(ParameterServer2, sendData) {
   // Set gserver and pserver all 3, so that the test is sufficient.
   int oldFlagsPortsNUm = FLAGS_ports_num;
@@ -0,0 +1,90 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "paddle/pserver/RingAllReducer.h"
+#include "paddle/utils/Flags.h"
+#include "paddle/utils/Util.h"
+
+using namespace paddle;  // NOLINT
+
+/// The ports FLAGS_port, ..., FLAGS_port + kMaxPeers - 1 are reserved.
+static const int kMaxPeers = 4;
+
+/// The value of element i of the buffer of peer rank.
+static real valueOf(int rank, size_t i) { return rank * 1000 + i % 997; }
+
+/**
+ * Runs numPeers peers over loopback, each in its thread, which all-reduce
+ * the buffers of the given sizes one after the other.
+ */
+static void testAllReduce(int numPeers,
+                          const std::vector<size_t>& sizes,
+                          size_t chunkSize) {
+  std::vector<std::string> peers;
+  for (int i = 0; i < numPeers; ++i) {
+    std::ostringstream peer;
+    peer << "127.0.0.1:" << FLAGS_port + i;
+    peers.push_back(peer.str());
+  }
+
+  std::vector<std::vector<std::vector<real>>> results(numPeers);
+  std::vector<std::thread> threads;
+  for (int rank = 0; rank < numPeers; ++rank) {
+    threads.emplace_back([&, rank]() {
+      RingAllReducer reducer(peers, rank, chunkSize);
+      for (size_t size : sizes) {
+        std::vector<real> data(size);
+        for (size_t i = 0; i < size; ++i) {
+          data[i] = valueOf(rank, i);
+        }
+        reducer.allReduce(data.data(), size);
+        results[rank].push_back(data);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int rank = 0; rank < numPeers; ++rank) {
+    ASSERT_EQ(results[rank].size(), sizes.size());
+    for (size_t k = 0; k < sizes.size(); ++k) {
+      for (size_t i = 0; i < sizes[k]; ++i) {
+        real expected = 0;
+        for (int peer = 0; peer < numPeers; ++peer) {
+          expected += valueOf(peer, i);
+        }
+        ASSERT_EQ(expected, results[rank][k][i])
+            << "peers=" << numPeers << " rank=" << rank
+            << " size=" << sizes[k] << " i=" << i;
+      }
+    }
+  }
+}
+
+TEST(RingAllReducer, allReduce) {
+  // Fewer values than peers leave some segments empty.
+  std::vector<size_t> sizes = {1, 3, 1000, 100003};
+  for (int numPeers = 1; numPeers <= kMaxPeers; ++numPeers) {
+    testAllReduce(numPeers, sizes, /* chunkSize= */ 4096);
+  }
+}
+
+TEST(RingAllReducer, oneChunkPerSegment) {
+  testAllReduce(kMaxPeers, {100003}, /* chunkSize= */ 1 << 20);
+}
@@ -14,8 +14,12 @@ limitations under the License. */
 
 #include "ParamUtil.h"
 
+#include <dirent.h>
+#include <fcntl.h>
 #include <fenv.h>
 #include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <iomanip>
 #include <iostream>
@@ -36,6 +40,55 @@ limitations under the License. */
 
 namespace paddle {
 
+namespace {
+
+/// The value of a parameter copied to memory, in the format of
+/// Parameter::save().
+struct ParameterSnapshot {
+  std::string name;
+  std::unique_ptr<char[]> data;
+  size_t size;
+};
+
+void writeFile(const std::string &filename, const char *data, size_t size) {
+  int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  CHECK_GE(fd, 0) << "Fail to open " << filename << ": " << strerror(errno);
+  while (size > 0) {
+    ssize_t n = write(fd, data, size);
+    if (n < 0 && errno == EINTR) continue;
+    CHECK_GE(n, 0) << "Fail to write " << filename << ": " << strerror(errno);
+    data += n;
+    size -= n;
+  }
+  close(fd);
+}
+
+void syncFile(const std::string &filename) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  CHECK_GE(fd, 0) << "Fail to open " << filename << ": " << strerror(errno);
+  CHECK_EQ(fsync(fd), 0) << "Fail to sync " << filename << ": "
+                         << strerror(errno);
+  close(fd);
+}
+
+/// Sync the files in dir and dir itself to disk.
+void syncDir(const std::string &dir) {
+  DIR *dp = opendir(dir.c_str());
+  CHECK(dp) << "Fail to open " << dir << ": " << strerror(errno);
+  struct dirent *ep;
+  while ((ep = readdir(dp)) != NULL) {
+    std::string filename = path::join(dir, ep->d_name);
+    struct stat st;
+    if (stat(filename.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+      syncFile(filename);
+    }
+  }
+  closedir(dp);
+  syncFile(dir);
+}
+
+}  // namespace
+
 ParameterUtil::ParameterUtil(
     const std::shared_ptr<TrainerConfigHelper> &config,
     std::unique_ptr<ParameterUtilConfig> &&intconfig,
@@ -45,6 +98,21 @@ ParameterUtil::ParameterUtil(
   intConfig_ = std::move(intconfig);
   gserver_ = gradientMachine;
   pUpdater_ = parameterUpdater;
+  numDeltaSaves_ = 0;
+  if (intConfig_->sparse_full_saving_period_ > 0 &&
+      intConfig_->save_only_one_) {
+    LOG(WARNING) << "sparse_full_saving_period is ignored with save_only_one, "
+                 << "which deletes the bases of the deltas";
+    intConfig_->sparse_full_saving_period_ = 0;
+  }
+  if (intConfig_->async_save_) {
+    if (intConfig_->load_save_param_pserver_) {
+      LOG(WARNING) << "async_save is ignored when parameters are saved in "
+                   << "pserver";
+    } else {
+      saveWorker_.reset(new ThreadWorker());
+    }
+  }
 }
 
 bool ParameterUtil::loadParameters(int passId, bool local, bool remote) {
@@ -78,6 +146,7 @@ void ParameterUtil::saveParametersOnePass(int passId, int passInnerId) {
 }
 
 void ParameterUtil::saveParameters(int passId, int passInnerId) {
+  Timer timer;
   constexpr int kBufLen = 100;
   char buf[kBufLen];
   if (passInnerId > 0) {
@@ -92,14 +161,41 @@ void ParameterUtil::saveParameters(int passId, int passInnerId) {
   }
   mkDirRecursively(basePath.c_str());
 
+  // The rows of the sparse parameters updated since the last save are
+  // saved as deltas over it, with a full save every
+  // sparse_full_saving_period saves.
+  std::string deltaBase;
+  if (intConfig_->sparse_full_saving_period_ > 0) {
+    if (!lastSaveName_.empty() && lastSaveName_ != buf &&
+        ++numDeltaSaves_ < intConfig_->sparse_full_saving_period_) {
+      deltaBase = lastSaveName_;
+    } else {
+      numDeltaSaves_ = 0;
+    }
+    lastSaveName_ = buf;
+  }
+
   std::string saveDir = path::join(basePath, buf);
-  mkDir(saveDir.c_str());
+  if (!saveWorker_) {
+    mkDir(saveDir.c_str());
+  }
   if (!intConfig_->load_save_param_pserver_) {
     pUpdater_->getParametersRemote(true /*full parameter*/,
                                    true /*after apply*/);
   }
 
-  gserver_->saveParameters(saveDir);
+  if (saveWorker_) {
+    saveParametersAsync(saveDir, deltaBase);
+    LOG(INFO) << "Training stalled " << timer.stop() / 1000
+              << " ms to save parameters to " << saveDir;
+    return;
+  }
+
+  if (intConfig_->sparse_full_saving_period_ > 0) {
+    saveParametersWithDelta(saveDir, deltaBase);
+  } else {
+    gserver_->saveParameters(saveDir);
+  }
   if (intConfig_->load_save_param_pserver_) {
     pUpdater_->saveParametersRemote(saveDir);
   }
@@ -110,6 +206,82 @@ void ParameterUtil::saveParameters(int passId, int passInnerId) {
   out.close();
   VLOG(1) << "save dir " << saveDir;
   saveConfigWithPath(saveDir);
+  LOG(INFO) << "Training stalled " << timer.stop() / 1000
+            << " ms to save parameters to " << saveDir;
+}
+
+void ParameterUtil::saveParametersWithDelta(const std::string &saveDir,
+                                            const std::string &deltaBase) {
+  LOG(INFO) << "Saving parameters to " << saveDir;
+  for (auto &para : gserver_->getParameters()) {
+    if (!para->isFullSize()) continue;
+    std::string filename = path::join(saveDir, para->getName());
+    std::string deltaFile = filename + ".delta";
+    if (para->isRowTracked() && !deltaBase.empty()) {
+      // A full file would be loaded instead of the delta.
+      remove(filename.c_str());
+      std::ofstream fs(deltaFile, std::ios_base::binary);
+      CHECK(fs) << "Fail to open " << deltaFile;
+      para->saveDelta(fs, deltaBase);
+    } else {
+      remove(deltaFile.c_str());
+      para->save(filename);
+    }
+    para->clearUpdatedRows();
+  }
+}
+
+void ParameterUtil::saveParametersAsync(const std::string &saveDir,
+                                        const std::string &deltaBase) {
+  // Keep at most one copy of the parameters in memory.
+  saveWorker_->wait();
+
+  auto snapshots = std::make_shared<std::vector<ParameterSnapshot>>();
+  for (auto &para : gserver_->getParameters()) {
+    if (!para->isFullSize()) continue;
+    ParameterSnapshot snapshot;
+    if (para->isRowTracked() && !deltaBase.empty()) {
+      snapshot.name = para->getName() + ".delta";
+      snapshot.size = para->getSavedDeltaSize(deltaBase);
+      snapshot.data.reset(new char[snapshot.size]);
+      para->saveDeltaToBuffer(snapshot.data.get(), deltaBase);
+    } else {
+      snapshot.name = para->getName();
+      snapshot.size = para->getSavedSize();
+      snapshot.data.reset(new char[snapshot.size]);
+      para->saveToBuffer(snapshot.data.get());
+    }
+    para->clearUpdatedRows();
+    snapshots->push_back(std::move(snapshot));
+  }
+
+  saveWorker_->addJob([this, snapshots, saveDir]() {
+    Timer timer;
+    std::string tmpDir = saveDir + ".tmp";
+    rmDir(tmpDir.c_str());
+    mkDir(tmpDir.c_str());
+    for (auto &snapshot : *snapshots) {
+      writeFile(path::join(tmpDir, snapshot.name),
+                snapshot.data.get(),
+                snapshot.size);
+    }
+    snapshots->clear();
+    std::ostringstream version;
+    version::printVersion(version);
+    writeFile(path::join(tmpDir, "done"),
+              version.str().data(),
+              version.str().size());
+    saveConfigWithPath(tmpDir);
+    syncDir(tmpDir);
+
+    rmDir(saveDir.c_str());
+    CHECK_EQ(rename(tmpDir.c_str(), saveDir.c_str()), 0)
+        << "Fail to rename " << tmpDir << " to " << saveDir << ": "
+        << strerror(errno);
+    syncFile(path::dirname(saveDir));
+    LOG(INFO) << "Saved parameters to " << saveDir << " in "
+              << timer.stop() / 1000 << " ms";
+  });
 }
 
 void ParameterUtil::deleteParameters(int passId, int passInnerId) {
@@ -127,8 +299,17 @@ void ParameterUtil::deleteParameters(int passId, int passInnerId) {
     snprintf(buf, kBufLen, "%s/pass-%05d", saveDir.c_str(), passId);
   }
   mkDir(saveDir.c_str());
-  LOG(INFO) << "delete dir " << buf;
-  rmDir(buf);
+  std::string dir = buf;
+  if (saveWorker_) {
+    // Delete it after the pending saves.
+    saveWorker_->addJob([dir]() {
+      LOG(INFO) << "delete dir " << dir;
+      rmDir(dir.c_str());
+    });
+    return;
+  }
+  LOG(INFO) << "delete dir " << dir;
+  rmDir(dir.c_str());
 }
 
 void ParameterUtil::saveConfigWithPath(const std::string &path) {
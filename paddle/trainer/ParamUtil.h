@@ -27,6 +27,7 @@ limitations under the License. */
 #include "ParameterUpdater.h"
 #include "TrainerConfig.pb.h"
 #include "TrainerConfigHelper.h"
+#include "paddle/utils/Thread.h"
 
 namespace paddle {
 
@@ -39,16 +40,22 @@ struct ParameterUtilConfig {
   ParameterUtilConfig(bool save_only_one,
                       int saving_period,
                       bool load_save_parameters_in_pserver,
-                      std::string config)
+                      std::string config,
+                      bool async_save = false,
+                      int sparse_full_saving_period = 0)
       : save_only_one_(save_only_one),
         saving_period_(saving_period),
         load_save_param_pserver_(load_save_parameters_in_pserver),
-        config_(config) {}
+        config_(config),
+        async_save_(async_save),
+        sparse_full_saving_period_(sparse_full_saving_period) {}
 
   bool save_only_one_;
   int saving_period_;
   bool load_save_param_pserver_;
   std::string config_;
+  bool async_save_;
+  int sparse_full_saving_period_;
 };
 
 /**
@@ -98,6 +105,11 @@ public:
   /// save config given path info
   void saveConfigWithPath(const std::string &path);
 
+  /// Wait until the saves and deletions queued with async_save are done.
+  void waitForSaves() {
+    if (saveWorker_) saveWorker_->wait();
+  }
+
   /**
    * Try to load parameter from config.
    * @return true if can load from trainer config.
@@ -116,10 +128,27 @@ public:
   }
 
 private:
+  /// Copy the parameters to memory and write them to saveDir in
+  /// saveWorker_. The files are written to a temporary directory, synced
+  /// and renamed to saveDir, so that saveDir is either complete or absent.
+  void saveParametersAsync(const std::string &saveDir,
+                           const std::string &deltaBase);
+
+  /// Save the parameters to saveDir, the ones whose rows are tracked as
+  /// deltas over deltaBase if it is not empty.
+  void saveParametersWithDelta(const std::string &saveDir,
+                               const std::string &deltaBase);
+
   std::shared_ptr<TrainerConfigHelper> config_;
   std::unique_ptr<ParameterUtilConfig> intConfig_;
   GradientMachinePtr gserver_;
   std::shared_ptr<ParameterUpdater> pUpdater_;
+  /// writes the parameters to disk if async_save is set
+  std::unique_ptr<ThreadWorker> saveWorker_;
+  /// name of the last saved directory, the base of the next delta
+  std::string lastSaveName_;
+  /// number of saves since the last full save of the tracked rows
+  int numDeltaSaves_;
 };
 
 }  //  namespace paddle
@@ -0,0 +1,192 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "RingAllReduceParameterUpdater.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "paddle/utils/Stat.h"
+#include "paddle/utils/StringUtil.h"
+
+DEFINE_string(ring_trainers,
+              "",
+              "Comma separated host:port of all the trainers, in the order "
+              "of trainer_id. If set, the trainers sum their gradients with "
+              "a ring all-reduce instead of using parameter servers");
+DEFINE_int32(ring_bucket_size,
+             4 << 20,
+             "Bytes of gradients the ring all-reduce sums at once");
+DEFINE_int32(ring_chunk_size,
+             256 << 10,
+             "Bytes of gradients in one message of the ring all-reduce");
+
+DECLARE_int32(trainer_id);
+
+namespace paddle {
+
+const size_t RingAllReduceParameterUpdater::kStopBucket =
+    std::numeric_limits<size_t>::max();
+
+static std::vector<std::string> ringTrainers() {
+  std::vector<std::string> peers;
+  str::split(FLAGS_ring_trainers, ',', &peers);
+  return peers;
+}
+
+RingAllReduceParameterUpdater::RingAllReduceParameterUpdater(
+    const OptimizationConfig& config)
+    : RingAllReduceParameterUpdater(config, ringTrainers(), FLAGS_trainer_id) {
+}
+
+RingAllReduceParameterUpdater::RingAllReduceParameterUpdater(
+    const OptimizationConfig& config,
+    const std::vector<std::string>& peers,
+    int rank)
+    : SgdLocalUpdater(config),
+      peers_(peers),
+      rank_(rank),
+      batchReduced_(false) {}
+
+RingAllReduceParameterUpdater::~RingAllReduceParameterUpdater() {
+  if (reduceThread_) {
+    readyBuckets_.enqueue(kStopBucket);
+    reduceThread_->join();
+  }
+}
+
+void RingAllReduceParameterUpdater::init(
+    const std::vector<ParameterPtr>& parameters) {
+  SgdLocalUpdater::init(parameters);
+
+  reducer_.reset(new RingAllReducer(
+      peers_, rank_, FLAGS_ring_chunk_size / sizeof(real)));
+
+  // Backward produces the gradients of the last parameters first.
+  size_t maxBucketSize = FLAGS_ring_bucket_size / sizeof(real);
+  bucketIds_.resize(parameters_.size());
+  for (size_t i = parameters_.size(); i-- > 0;) {
+    Parameter* para = parameters_[i].get();
+    CHECK(!para->isGradSparseUpdate())
+        << "sparse update is not supported by the ring all-reduce: "
+        << para->getName();
+    if (buckets_.empty() || buckets_.back()->size >= maxBucketSize) {
+      buckets_.emplace_back(new Bucket);
+      buckets_.back()->size = 0;
+    }
+    Bucket& bucket = *buckets_.back();
+    bucket.parameters.push_back(para);
+    bucket.size += para->getSize();
+    bucketIds_[i] = buckets_.size() - 1;
+  }
+  size_t bufferSize = 0;
+  for (auto& bucket : buckets_) {
+    bucket->pending = bucket->parameters.size();
+    bufferSize = std::max(bufferSize, bucket->size);
+  }
+  buffer_.resize(bufferSize);
+  LOG(INFO) << "ring all-reduce of " << parameters_.size()
+            << " parameters in " << buckets_.size() << " buckets";
+
+  // Start from the values of trainer 0: the others add zeros to them.
+  for (auto& para : parameters_) {
+    SetDevice device(para->getDeviceId());
+    const VectorPtr& value = para->getBuf(PARAMETER_VALUE);
+    CpuVector cpuValue(para->getSize(), buffer_.data());
+    if (reducer_->getRank() == 0) {
+      cpuValue.copyFrom(*value);
+    } else {
+      cpuValue.zeroMem();
+    }
+    reducer_->allReduce(buffer_.data(), para->getSize());
+    value->copyFrom(cpuValue);
+    para->setValueUpdated();
+  }
+
+  reduceThread_.reset(new std::thread([this]() { reduceBuckets(); }));
+}
+
+PassType RingAllReduceParameterUpdater::startBatch(int64_t batchSize) {
+  return SgdLocalUpdater::startBatch(batchSize * reducer_->getNumPeers());
+}
+
+void RingAllReduceParameterUpdater::updateImpl(Parameter* para) {
+  size_t bucketId = bucketIds_[nonStaticParaIDMap_[para->getID()]];
+  Bucket& bucket = *buckets_[bucketId];
+  if (--bucket.pending == 0) {
+    // No other gradient of the bucket comes before the next batch.
+    bucket.pending = bucket.parameters.size();
+    readyBuckets_.enqueue(bucketId);
+  }
+}
+
+void RingAllReduceParameterUpdater::finishBatch(real cost) {
+  {
+    REGISTER_TIMER("waitRingAllReduce");
+    batchReducedCond_.wait([this]() { return batchReduced_; });
+    batchReduced_ = false;
+  }
+  for (auto& para : parameters_) {
+    SetDevice device(para->getDeviceId());
+    SgdLocalUpdater::updateImpl(para.get());
+  }
+  SgdLocalUpdater::finishBatch(cost);
+}
+
+void RingAllReduceParameterUpdater::reduceBuckets() {
+  while (true) {
+    // The buckets may be complete out of order, but all the trainers must
+    // all-reduce them in the same order.
+    std::vector<bool> ready(buckets_.size(), false);
+    for (size_t bucketId = 0; bucketId < buckets_.size(); ++bucketId) {
+      while (!ready[bucketId]) {
+        size_t id = readyBuckets_.dequeue();
+        if (id == kStopBucket) {
+          return;
+        }
+        ready[id] = true;
+      }
+      reduceBucket(bucketId);
+    }
+    batchReducedCond_.notify_all([this]() { batchReduced_ = true; });
+  }
+}
+
+void RingAllReduceParameterUpdater::reduceBucket(size_t bucketId) {
+  REGISTER_TIMER("ringAllReduce");
+  Bucket& bucket = *buckets_[bucketId];
+  if (bucket.parameters.size() == 1 && !bucket.parameters[0]->useGpu()) {
+    const VectorPtr& grad = bucket.parameters[0]->getBuf(PARAMETER_GRADIENT);
+    reducer_->allReduce(grad->getData(), grad->getSize());
+    return;
+  }
+
+  size_t offset = 0;
+  for (auto para : bucket.parameters) {
+    SetDevice device(para->getDeviceId());
+    CpuVector(para->getSize(), buffer_.data() + offset)
+        .copyFrom(*para->getBuf(PARAMETER_GRADIENT));
+    offset += para->getSize();
+  }
+  reducer_->allReduce(buffer_.data(), bucket.size);
+  offset = 0;
+  for (auto para : bucket.parameters) {
+    SetDevice device(para->getDeviceId());
+    para->getBuf(PARAMETER_GRADIENT)
+        ->copyFrom(CpuVector(para->getSize(), buffer_.data() + offset));
+    offset += para->getSize();
+  }
+}
+
+}  // namespace paddle
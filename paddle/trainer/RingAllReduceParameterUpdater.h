@@ -0,0 +1,105 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ParameterUpdater.h"
+#include "paddle/pserver/RingAllReducer.h"
+#include "paddle/utils/Locks.h"
+#include "paddle/utils/Queue.h"
+
+namespace paddle {
+
+/**
+ * Synchronous SGD between trainers without parameter servers.
+ *
+ * The trainers sum their gradients with a ring all-reduce (see
+ * RingAllReducer), then each one runs the optimizer locally, as
+ * SgdLocalUpdater does, on the same summed gradients. The parameters of
+ * trainer 0 are copied to the others at init(), so that all the trainers
+ * keep the same values.
+ *
+ * The gradients are all-reduced by buckets of parameters, taken in the
+ * reverse order of the model, as backward produces them. A bucket is
+ * handed to a communication thread as soon as all its gradients are ready,
+ * so that the communication of the last layers overlaps the backward of
+ * the first ones. The buckets are all-reduced in the same order by all
+ * the trainers.
+ *
+ * Sparse remote updates are not supported.
+ */
+class RingAllReduceParameterUpdater : public SgdLocalUpdater {
+public:
+  /// the trainers are given by --ring_trainers, this one by --trainer_id.
+  explicit RingAllReduceParameterUpdater(const OptimizationConfig& config);
+
+  /**
+   * @param peers  the "host:port" of all the trainers, in ring order.
+   * @param rank   the index of this trainer in peers.
+   */
+  RingAllReduceParameterUpdater(const OptimizationConfig& config,
+                                const std::vector<std::string>& peers,
+                                int rank);
+  ~RingAllReduceParameterUpdater();
+
+  virtual void init(const std::vector<ParameterPtr>& parameters);
+
+  /**
+   * @note the samples of every trainer are counted by the learning rate
+   *       schedule, assuming the trainers' batches are of the same size.
+   */
+  virtual PassType startBatch(int64_t batchSize);
+
+  /// waits for the gradients to be all-reduced and updates the parameters.
+  virtual void finishBatch(real cost);
+
+protected:
+  /// marks the gradient of para as ready, and queues its bucket once
+  /// complete.
+  virtual void updateImpl(Parameter* para);
+
+  /// the communication thread
+  void reduceBuckets();
+  void reduceBucket(size_t bucketId);
+
+  struct Bucket {
+    std::vector<Parameter*> parameters;
+    size_t size;
+    /// the gradients not ready yet in the current batch
+    std::atomic<int> pending;
+  };
+
+  std::vector<std::string> peers_;
+  int rank_;
+  std::unique_ptr<RingAllReducer> reducer_;
+  std::vector<std::unique_ptr<Bucket>> buckets_;
+  /// the bucket of each parameter, by its index in parameters_
+  std::vector<size_t> bucketIds_;
+  /// the gradients of a bucket are gathered here to be all-reduced
+  std::vector<real> buffer_;
+
+  /// the ids of the complete buckets, or kStopBucket
+  Queue<size_t> readyBuckets_;
+  static const size_t kStopBucket;
+  LockedCondition batchReducedCond_;
+  bool batchReduced_;
+  std::unique_ptr<std::thread> reduceThread_;
+};
+
+}  // namespace paddle
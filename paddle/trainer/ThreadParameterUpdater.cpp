@@ -21,6 +21,7 @@ limitations under the License. */
 #include "paddle/utils/Thread.h"
 
 DECLARE_int32(trainer_count);
+DECLARE_int32(sparse_full_saving_period);
 
 namespace paddle {
 
@@ -43,14 +44,20 @@ void SgdThreadUpdater::init(const std::vector<ParameterPtr>& parameters) {
   }
 
   optimizers_.resize(maxId + 1);
+  mainParameters_.resize(maxId + 1);
   for (auto& para : parameters_) {
     int pid = para->getID();
+    mainParameters_[pid] = para.get();
     optimizers_[pid].reset(sgdOptimizerCreate(config_,
                                               para->getConfig(),
                                               para->isGradSparseUpdate(),
                                               false /*inPserver*/));
     size_t numRows = para->isGradSparseUpdate() ? para->getConfig().dims(0) : 0;
     optimizers_[pid]->init(numRows, &para->getConfig());
+    if (para->isGradSparseUpdate() && FLAGS_sparse_full_saving_period > 0) {
+      // ParameterUtil saves only the updated rows between full saves.
+      para->enableRowTracking();
+    }
     if (para->isGradSparseUpdate() && FLAGS_trainer_count == 1) {
       // For trainer_count=1, the gradient machine is NeuralNetwork, which does
       // not create parameter buf for PARAMETER_GRADIENT for sparse update in
@@ -82,6 +89,10 @@ bool SgdThreadUpdater::finishPass() {
 }
 
 void SgdThreadUpdater::updateImpl(Parameter* para) {
+  if (para->isHogwildSparseUpdate()) {
+    updateSparseHogwild(para);
+    return;
+  }
   if (!para->useGpu()) return;
   SetDevice setDevice(para->getDeviceId());
   ParameterOptimizer* optimizer = optimizers_[para->getID()].get();
@@ -109,6 +120,7 @@ void SgdThreadUpdater::threadTraverse(
         vecs[type]->subVecFrom(*para->getBuf(type), i * width, width);
       }
       callback(vecs, para->getConfig(), i);
+      para->markRowUpdated(i);
     }
   } else {  // dense
     // setup sub bufs
@@ -234,6 +246,7 @@ void SgdThreadUpdater::threadUpdateSparse(int tid,
       }
       optimizer->update(vecs, para->getConfig(), id);
       vecs[PARAMETER_GRADIENT]->zeroMem();
+      para->markRowUpdated(id);
     }
     sparseIds.clear();
   } else if (dynamic_cast<SparseRowCpuMatrix*>(
@@ -260,6 +273,7 @@ void SgdThreadUpdater::threadUpdateSparse(int tid,
       }
       optimizer->update(vecs, para->getConfig(), id);
       vecs[PARAMETER_GRADIENT]->zeroMem();
+      para->markRowUpdated(id);
     }
     // For numThreads > 1, MultiGradientMachine is used, which goes
     // to the above branch.
@@ -278,8 +292,43 @@ void SgdThreadUpdater::threadUpdateSparse(int tid,
         vecs[type]->subVecFrom(*para->getBuf(type), i * width, width);
       }
       callback(vecs, para->getConfig(), i);
+      para->markRowUpdated(i);
+    }
+  }
+}
+
+void SgdThreadUpdater::updateSparseHogwild(Parameter* para) {
+  int pid = para->getID();
+  ParameterOptimizer* optimizer = optimizers_[pid].get();
+  Parameter* mainPara = mainParameters_[pid];
+  VectorPtr* vecs = parameter::getThreadLocalBuffer();
+  size_t width = para->getConfig().dims(1);
+
+  // The gradient rows of the calling thread only. Concurrent threads write
+  // the rows they share without any lock, an update may be partly lost but
+  // none of them waits for another.
+  SparseRowCpuMatrix* mat =
+      dynamic_cast<SparseRowCpuMatrix*>(para->getMat(PARAMETER_GRADIENT).get());
+  CHECK(mat) << "Hogwild update needs a sparse row gradient for "
+             << para->getName();
+  std::vector<unsigned int>& localIndices =
+      mat->getIndexDictHandle()->localIndices;
+  for (size_t i = 0; i < localIndices.size(); ++i) {
+    auto id = localIndices[i];
+    // setup sub bufs, the value and the optimizer states of the main
+    // parameter are shared by all the threads.
+    for (auto type : parameterTypes_) {
+      if (type == PARAMETER_GRADIENT) {
+        vecs[type]->subVecFrom(mat->getLocalRow(i), 0, width);
+      } else {
+        vecs[type]->subVecFrom(*mainPara->getBuf(type), id * width, width);
+      }
     }
+    optimizer->update(vecs, para->getConfig(), id);
+    vecs[PARAMETER_GRADIENT]->zeroMem();
+    mainPara->markRowUpdated(id);
   }
+  mat->clearIndices();
 }
 
 void SgdThreadUpdater::threadUpdateDense(int tid,
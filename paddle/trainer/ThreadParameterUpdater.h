@@ -37,6 +37,9 @@ namespace paddle {
    and forwardBackward().
    For CPU, the parameter updates happens in separate threads maintained by this
    class.
+   With --hogwild_sparse_update, the sparse CPU parameters are instead updated
+   in updateImpl() by the computing threads of the gradient machine, each one
+   with its own gradient, as soon as backward() computed it.
  */
 class SgdThreadUpdater : public ParameterUpdater {
 public:
@@ -67,9 +70,17 @@ protected:
   // One optimizers for each parameter.
   std::vector<std::unique_ptr<ParameterOptimizer>> optimizers_;
 
+  // The parameters given to init(), indexed by parameter id.
+  std::vector<Parameter*> mainParameters_;
+
   // The update function for CPU sparse parameters.
   void threadUpdateSparse(int tid, size_t numThreads, Parameter* para);
 
+  // The update function for CPU sparse parameters with
+  // --hogwild_sparse_update, called by each computing thread during backward
+  // with its own copy of the parameter.
+  void updateSparseHogwild(Parameter* para);
+
   // The update function for CPU dense parameters.
   void threadUpdateDense(int tid, size_t numThreads, Parameter* para);
   // The update function for after update operations, such as averager.
@@ -82,6 +82,20 @@ DEFINE_bool(save_only_one,
             false,
             "Save only parameters in last pass, remove previous.");
 
+DEFINE_bool(async_save,
+            false,
+            "Copy parameters to memory when saving them and write them to "
+            "save_dir in background, so that training is not blocked by disk. "
+            "Only for this trainer: the fluid save and save_combine "
+            "operators still write synchronously.");
+
+DEFINE_int32(sparse_full_saving_period,
+             0,
+             "If > 0, the parameters updated by sparse rows are saved as the "
+             "rows updated since the previous save, and fully saved every so "
+             "many saves. The rows are merged with the previous saves when "
+             "loading, which must be kept.");
+
 DEFINE_string(feat_file, "", "File name of extracted feature.");
 DEFINE_string(predict_output_dir,
               "",
@@ -179,7 +193,9 @@ void Trainer::init(const std::shared_ptr<TrainerConfigHelper>& config,
       new ParameterUtilConfig(FLAGS_save_only_one,
                               FLAGS_saving_period,
                               FLAGS_loadsave_parameters_in_pserver,
-                              FLAGS_config));
+                              FLAGS_config,
+                              FLAGS_async_save,
+                              FLAGS_sparse_full_saving_period));
 
   paramUtil_.reset(
       new paddle::ParameterUtil(config_,
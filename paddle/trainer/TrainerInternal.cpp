@@ -32,8 +32,11 @@ limitations under the License. */
 #include "paddle/utils/Util.h"
 
 #include "RemoteParameterUpdater.h"
+#include "RingAllReduceParameterUpdater.h"
 #include "ThreadParameterUpdater.h"
 
+DECLARE_string(ring_trainers);
+
 namespace paddle {
 
 void TrainerInternal::init(const std::shared_ptr<TrainerConfigHelper>& config,
@@ -222,6 +225,15 @@ void TrainerInternal::createParameterUpdater(bool testing) {
     return;
   }
 
+  if (!intconfig_->local && !testing && !FLAGS_ring_trainers.empty()) {
+    CHECK(alg == TrainAlgorithm::SGD)
+        << "Unsupported algorithm with ring all-reduce: " << alg;
+    CHECK(!config_->getOptConfig().use_sparse_remote_updater())
+        << "Sparse remote update is not supported with ring all-reduce";
+    parameterUpdater_.reset(new RingAllReduceParameterUpdater(*config_));
+    return;
+  }
+
   if (!intconfig_->local) {
     if (testing && config_->getOptConfig().use_sparse_remote_updater()) {
       std::unique_ptr<ParameterUpdater> localUpdater;
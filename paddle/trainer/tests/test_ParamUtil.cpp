@@ -0,0 +1,143 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <paddle/utils/PythonUtil.h>
+#include "paddle/trainer/ParamUtil.h"
+#include "paddle/utils/Util.h"
+
+using namespace paddle;  // NOLINT
+using namespace std;     // NOLINT
+
+static const string& configFile = "trainer/tests/sample_trainer_config.conf";
+
+class AsyncSaveTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    char dir[] = "/tmp/test_ParamUtil_XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(dir));
+    saveDir_ = dir;
+
+    config_ = make_shared<TrainerConfigHelper>(configFile);
+    config_->getMutableConfig().set_save_dir(saveDir_);
+    gm_.reset(GradientMachine::create(config_->getModelConfig()));
+    gm_->randParameters();
+    updater_ = make_shared<SgdLocalUpdater>(config_->getOptConfig());
+    updater_->init(gm_->getParameters());
+  }
+
+  void TearDown() override { rmDir(saveDir_.c_str()); }
+
+  unique_ptr<ParameterUtil> createParameterUtil(bool saveOnlyOne) {
+    return unique_ptr<ParameterUtil>(new ParameterUtil(
+        config_,
+        unique_ptr<ParameterUtilConfig>(new ParameterUtilConfig(
+            saveOnlyOne, 1, false, configFile, true /* async_save */)),
+        gm_,
+        updater_));
+  }
+
+  string passDir(int passId) {
+    char buf[100];
+    snprintf(buf, sizeof(buf), "pass-%05d", passId);
+    return path::join(saveDir_, buf);
+  }
+
+  /// Expects every file of a save to be in dir, with its full size.
+  void expectComplete(const string& dir) {
+    EXPECT_TRUE(fileExist(path::join(dir, "done").c_str())) << dir;
+    for (auto& para : gm_->getParameters()) {
+      struct stat st;
+      string filename = path::join(dir, para->getName());
+      ASSERT_EQ(0, stat(filename.c_str(), &st)) << filename;
+      EXPECT_EQ(para->getSavedSize(), static_cast<size_t>(st.st_size))
+          << filename;
+    }
+  }
+
+  string saveDir_;
+  shared_ptr<TrainerConfigHelper> config_;
+  GradientMachinePtr gm_;
+  shared_ptr<ParameterUpdater> updater_;
+};
+
+TEST_F(AsyncSaveTest, snapshotBeforeUpdates) {
+  auto paramUtil = createParameterUtil(false);
+  vector<vector<real>> values;
+  for (auto& para : gm_->getParameters()) {
+    const real* data = para->getBuf(PARAMETER_VALUE)->getData();
+    values.emplace_back(data, data + para->getSize());
+  }
+  paramUtil->saveParameters(0);
+  // Updates made while the save is written are not saved.
+  for (auto& para : gm_->getParameters()) {
+    para->getBuf(PARAMETER_VALUE)->add(1.0f);
+  }
+  paramUtil->waitForSaves();
+
+  auto& parameters = gm_->getParameters();
+  for (size_t i = 0; i < parameters.size(); ++i) {
+    Parameter saved(parameters[i]->getConfig(), /* useGpu= */ false);
+    ASSERT_TRUE(saved.load(path::join(passDir(0), saved.getName())));
+    const real* data = saved.getBuf(PARAMETER_VALUE)->getData();
+    for (size_t j = 0; j < saved.getSize(); ++j) {
+      ASSERT_EQ(values[i][j], data[j]) << saved.getName() << " " << j;
+    }
+  }
+}
+
+TEST_F(AsyncSaveTest, renameAfterWrite) {
+  auto paramUtil = createParameterUtil(false);
+  paramUtil->saveParameters(0);
+  // pass-00000 only appears once all its files are written.
+  for (int i = 0; i < 1000 && !fileExist(passDir(0).c_str()); ++i) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  if (fileExist(passDir(0).c_str())) {
+    expectComplete(passDir(0));
+  }
+  paramUtil->waitForSaves();
+  expectComplete(passDir(0));
+  EXPECT_FALSE(fileExist((passDir(0) + ".tmp").c_str()));
+}
+
+TEST_F(AsyncSaveTest, deleteAfterSave) {
+  auto paramUtil = createParameterUtil(true);
+  // save_only_one deletes pass-00000 and pass-00001 after their saves.
+  for (int passId = 0; passId < 3; ++passId) {
+    paramUtil->saveParametersOnePass(passId);
+  }
+  // A deletion queued right behind the save of the same pass.
+  paramUtil->saveParameters(3);
+  paramUtil->deleteParameters(3);
+  paramUtil->waitForSaves();
+
+  EXPECT_FALSE(fileExist(passDir(0).c_str()));
+  EXPECT_FALSE(fileExist(passDir(1).c_str()));
+  expectComplete(passDir(2));
+  EXPECT_FALSE(fileExist(passDir(3).c_str()));
+  EXPECT_FALSE(fileExist((passDir(3) + ".tmp").c_str()));
+}
+
+int main(int argc, char** argv) {
+  initMain(argc, argv);
+  initPython(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
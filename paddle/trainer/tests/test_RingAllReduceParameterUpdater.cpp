@@ -0,0 +1,147 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "paddle/trainer/RingAllReduceParameterUpdater.h"
+#include "paddle/utils/Flags.h"
+#include "paddle/utils/Util.h"
+
+using namespace paddle;  // NOLINT
+
+DECLARE_int32(ring_bucket_size);
+DECLARE_int32(ring_chunk_size);
+
+static const int kNumTrainers = 3;
+static const int kNumBatches = 4;
+static const int64_t kBatchSize = 8;
+/// small enough to give several buckets and several chunks per bucket.
+static const size_t kParameterSizes[] = {37, 300, 5, 1000};
+
+static OptimizationConfig optimizationConfig() {
+  OptimizationConfig config;
+  config.set_algorithm("sgd");
+  config.set_learning_method("momentum");
+  config.set_learning_rate(0.01);
+  config.set_learning_rate_schedule("constant");
+  config.set_batch_size(kBatchSize);
+  return config;
+}
+
+static std::vector<ParameterPtr> createParameters(int rank) {
+  std::vector<ParameterPtr> parameters;
+  for (size_t i = 0; i < sizeof(kParameterSizes) / sizeof(size_t); ++i) {
+    ParameterConfig config;
+    config.set_name("para" + std::to_string(i));
+    config.set_size(kParameterSizes[i]);
+    config.set_momentum(0.9);
+    ParameterPtr para(new Parameter(config, /* useGpu= */ false));
+    para->setID(i);
+    // Every trainer starts from different values, trainer 0's are kept.
+    real* value = para->getBuf(PARAMETER_VALUE)->getData();
+    for (size_t j = 0; j < para->getSize(); ++j) {
+      value[j] = (rank + 1) * 0.01 * (j % 17);
+    }
+    parameters.push_back(para);
+  }
+  return parameters;
+}
+
+/// The gradient of trainer rank for element j of para in the given batch.
+static real gradientOf(int rank, int batch, const Parameter& para, size_t j) {
+  return 0.001 * (rank + 1) * ((j + para.getID() + batch) % 13) - 0.005;
+}
+
+/**
+ * Trains the parameters for kNumBatches batches, with the gradients of the
+ * trainers rank, ..., rank + numGradients - 1 summed. Backward is emulated
+ * by giving the gradients from the last parameter to the first, so that
+ * the buckets are all-reduced while the next gradients are computed.
+ */
+static void train(ParameterUpdater* updater,
+                  const std::vector<ParameterPtr>& parameters,
+                  int64_t batchSize,
+                  int rank,
+                  int numGradients) {
+  updater->startPass();
+  for (int batch = 0; batch < kNumBatches; ++batch) {
+    updater->startBatch(batchSize);
+    for (size_t i = parameters.size(); i-- > 0;) {
+      Parameter& para = *parameters[i];
+      real* grad = para.getBuf(PARAMETER_GRADIENT)->getData();
+      for (size_t j = 0; j < para.getSize(); ++j) {
+        grad[j] = 0;
+        for (int r = rank; r < rank + numGradients; ++r) {
+          grad[j] += gradientOf(r, batch, para, j);
+        }
+      }
+      updater->update(&para);
+    }
+    updater->finishBatch(0);
+  }
+  updater->finishPass();
+}
+
+TEST(RingAllReduceParameterUpdater, trainersStayIdentical) {
+  FLAGS_ring_bucket_size = 400 * sizeof(real);
+  FLAGS_ring_chunk_size = 64 * sizeof(real);
+  std::vector<std::string> peers;
+  for (int i = 0; i < kNumTrainers; ++i) {
+    std::ostringstream peer;
+    peer << "127.0.0.1:" << FLAGS_port + i;
+    peers.push_back(peer.str());
+  }
+
+  std::vector<std::vector<ParameterPtr>> parameters(kNumTrainers);
+  std::vector<std::thread> threads;
+  for (int rank = 0; rank < kNumTrainers; ++rank) {
+    parameters[rank] = createParameters(rank);
+    threads.emplace_back([&, rank]() {
+      RingAllReduceParameterUpdater updater(
+          optimizationConfig(), peers, rank);
+      updater.init(parameters[rank]);
+      // The ring updater counts the samples of all the trainers.
+      train(&updater, parameters[rank], kBatchSize, rank, 1);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // A local SGD from the values of trainer 0, on the summed gradients of
+  // the samples of all the trainers.
+  std::vector<ParameterPtr> expected = createParameters(0);
+  SgdLocalUpdater local(optimizationConfig());
+  local.init(expected);
+  train(&local, expected, kBatchSize * kNumTrainers, 0, kNumTrainers);
+
+  for (size_t i = 0; i < expected.size(); ++i) {
+    const real* want = expected[i]->getBuf(PARAMETER_VALUE)->getData();
+    for (int rank = 0; rank < kNumTrainers; ++rank) {
+      const real* got =
+          parameters[rank][i]->getBuf(PARAMETER_VALUE)->getData();
+      const real* first =
+          parameters[0][i]->getBuf(PARAMETER_VALUE)->getData();
+      for (size_t j = 0; j < expected[i]->getSize(); ++j) {
+        // The trainers run the same updates on the same reduced gradients.
+        ASSERT_EQ(first[j], got[j]) << "rank=" << rank << " para=" << i
+                                    << " j=" << j;
+        ASSERT_NEAR(want[j], got[j], 1e-5) << "para=" << i << " j=" << j;
+      }
+    }
+  }
+}
@@ -36,6 +36,7 @@ DECLARE_int32(gpu_id);
 DECLARE_int32(seed);
 DECLARE_int32(num_passes);
 DECLARE_int32(saving_period);
+DECLARE_bool(hogwild_sparse_update);
 
 class TrainerForTest : public paddle::Trainer {
 public:
@@ -305,6 +306,13 @@ TEST(SgdThreadUpdater, simpleSparseNN) {
   trainerOnePassTest(configFileSimpleSparse, false, false, 1, 0.5, true);
 }
 
+TEST(SgdThreadUpdater, simpleSparseNNHogwild) {
+  FLAGS_hogwild_sparse_update = true;
+  trainerOnePassTest(configFileSimpleSparse, false, false, 1);
+  trainerOnePassTest(configFileSimpleSparse, false, false, 4);
+  FLAGS_hogwild_sparse_update = false;
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   initMain(argc, argv);
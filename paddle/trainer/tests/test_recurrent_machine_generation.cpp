@@ -31,6 +31,7 @@ static string expectFile =                                           // NOLINT
     "trainer/tests/rnn_gen_test_model_dir/r1.test";                  // NOLINT
 
 DECLARE_string(config_args);
+DECLARE_bool(rnn_incremental_generation);
 
 vector<float> readRetFile(const string& fname) {
   ifstream inFile(fname);
@@ -124,10 +125,16 @@ TEST(RecurrentGradientMachine, test_generation) {
                      bool beam_search) {
     FLAGS_config_args = beam_search ? "beam_search=1" : "beam_search=0";
     for (auto useGpu : useGpuConfs) {
-      LOG(INFO) << configFile << " useGpu=" << useGpu
-                << " beam_search=" << beam_search;
-      testGeneration(configFile, useGpu, hasSubseq, expRetFile);
+      // The incremental generation must not change the results.
+      for (auto incremental : {false, true}) {
+        FLAGS_rnn_incremental_generation = incremental;
+        LOG(INFO) << configFile << " useGpu=" << useGpu
+                  << " beam_search=" << beam_search
+                  << " incremental=" << incremental;
+        testGeneration(configFile, useGpu, hasSubseq, expRetFile);
+      }
     }
+    FLAGS_rnn_incremental_generation = false;
   };
   testGen(CONFIG_FILE, false, expectFile + ".nobeam", false);  // no beam search
   testGen(CONFIG_FILE, false, expectFile + ".beam", true);     // beam search
@@ -18,6 +18,7 @@ limitations under the License. */
 
 /// for MSVC
 #define CPUID(info, x) __cpuidex(info, x, 0)
+static inline unsigned long long xgetbv0() { return _xgetbv(0); }
 
 #else
 
@@ -25,6 +26,13 @@ limitations under the License. */
 #include <cpuid.h>
 /// for GCC/Clang
 #define CPUID(info, x) __cpuid_count(x, 0, info[0], info[1], info[2], info[3])
+
+/// XCR0, which tells the register states the OS saves
+static inline unsigned long long xgetbv0() {
+  unsigned int eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return ((unsigned long long)edx << 32) | eax;
+}
 #endif
 
 #endif
@@ -47,10 +55,18 @@ SIMDFlags::SIMDFlags() {
   simd_flags_ |= cpuInfo[2] & (1 << 20) ? SIMD_SSE42 : SIMD_NONE;
   simd_flags_ |= cpuInfo[2] & (1 << 12) ? SIMD_FMA3  : SIMD_NONE;
   simd_flags_ |= cpuInfo[2] & (1 << 28) ? SIMD_AVX   : SIMD_NONE;
+  // clang-format on
 
+  // The ZMM registers can only be used if the OS saves the opmask and the
+  // upper halves of the ZMM registers (XCR0 bits 5-7) along with the SSE
+  // and AVX states (bits 1-2).
+  bool osSavesZmm = (cpuInfo[2] & (1 << 27)) && (xgetbv0() & 0xE6) == 0xE6;
+
+  // clang-format off
   CPUID(cpuInfo, 0x00000007);
   simd_flags_ |= cpuInfo[1] & (1 <<  5) ? SIMD_AVX2  : SIMD_NONE;
-  simd_flags_ |= cpuInfo[1] & (1 << 16) ? SIMD_AVX512: SIMD_NONE;
+  simd_flags_ |= cpuInfo[1] & (1 << 16) && osSavesZmm ? SIMD_AVX512
+                                                      : SIMD_NONE;
 
   CPUID(cpuInfo, 0x80000001);
   simd_flags_ |= cpuInfo[2] & (1 << 16) ? SIMD_FMA4  : SIMD_NONE;
@@ -62,6 +62,7 @@ void Stat::reset() {
 
 std::ostream& operator<<(std::ostream& outPut, const Stat& stat) {
   std::lock_guard<std::mutex> guard(const_cast<Stat&>(stat).lock_);
+  const double scale = stat.getBytes() ? 1 : 0.001;
   auto showStat = [&](const StatInfo* info, pid_t tid, bool isFirst = true) {
     uint64_t average = 0;
     if (info->count_ > 0) {
@@ -74,10 +75,10 @@ std::ostream& operator<<(std::ostream& outPut, const Stat& stat) {
       if (tid) {
         outPut << " TID=" << std::setw(6) << tid;
       }
-      outPut << " total=" << std::setw(10) << info->total_ * 0.001
-             << " avg=" << std::setw(10) << average * 0.001
-             << " max=" << std::setw(10) << info->max_ * 0.001
-             << " min=" << std::setw(10) << info->min_ * 0.001
+      outPut << " total=" << std::setw(10) << info->total_ * scale
+             << " avg=" << std::setw(10) << average * scale
+             << " max=" << std::setw(10) << info->max_ * scale
+             << " min=" << std::setw(10) << info->min_ * scale
              << " count=" << std::setw(10) << info->count_ << std::endl;
     }
   };
@@ -114,7 +114,10 @@ extern StatSet globalStat;
 class Stat {
 public:
   explicit Stat(const std::string& statName)
-      : destructStat_(nullptr), name_(statName), openThreadInfo_(false) {}
+      : destructStat_(nullptr),
+        name_(statName),
+        openThreadInfo_(false),
+        bytes_(false) {}
   ~Stat() {}
 
   typedef std::list<std::pair<StatInfo*, pid_t>> ThreadLocalBuf;
@@ -135,6 +138,13 @@ public:
 
   bool getThreadInfo() const { return openThreadInfo_; }
 
+  /*  Set whether the samples are byte counts, which operator << prints as
+   *  they are. Otherwise they are times in microseconds, printed in ms.
+   */
+  void setBytes(bool flag) { bytes_ = flag; }
+
+  bool getBytes() const { return bytes_; }
+
   friend class StatInfo;
 
 private:
@@ -146,6 +156,7 @@ private:
   ThreadLocal<StatInfo> statInfo_;
   const std::string name_;
   bool openThreadInfo_;
+  bool bytes_;
 };
 
 extern StatSet globalStat;
@@ -79,7 +79,7 @@ public:
   /**
    * @brief Construct Function. Default size of job queue is 0 and not stopping.
    */
-  ThreadWorker() : stopping_(false), empty_(true) { start(); }
+  ThreadWorker() : stopping_(false), pendingJobs_(0) { start(); }
 
   /**
    * @brief Destruct Function.
@@ -105,38 +105,40 @@ public:
    * @brief Add a new job to the job queue.
    */
   void addJob(JobFunc func) {
-    empty_ = false;
+    {
+      std::lock_guard<std::mutex> guard(*finishCV_.mutex());
+      ++pendingJobs_;
+    }
     jobs_.enqueue(func);
   }
 
   /**
-   * @brief Wait until all jobs was done (the job queue was empty).
+   * @brief Wait until all the jobs added before were done.
    */
   void wait() {
-    finishCV_.wait([this] { return empty_; });
+    finishCV_.wait([this] { return pendingJobs_ == 0; });
   }
 
 protected:
   /**
    * @brief Execute jobs in the job queue sequentianlly,
-   * @note If finish all the jobs in the job queue,
-   * notifies all the waiting threads the job queue was empty.
+   * @note After each job, notifies all the waiting threads, which return
+   * when no job is pending.
    */
   virtual void run() {
     while (true) {
       JobFunc func = jobs_.dequeue();
       if (stopping_) break;
       func();
-      if (jobs_.empty()) {
-        finishCV_.notify_all([this] { empty_ = true; });
-      }
+      finishCV_.notify_all([this] { --pendingJobs_; });
     }
   }
 
   Queue<JobFunc> jobs_;
   bool stopping_;
   LockedCondition finishCV_;
-  bool empty_;
+  // The jobs added and not done yet, guarded by the mutex of finishCV_.
+  size_t pendingJobs_;
 };
 
 /**
@@ -372,6 +372,7 @@ def provider(input_types=None,
              check=False,
              check_fail_continue=False,
              init_hook=None,
+             num_workers=0,
              **outter_kwargs):
     """
     Provider decorator. Use it to make a function into PyDataProvider2 object.
@@ -450,6 +451,15 @@ def provider(input_types=None,
                                 drop the wrong format data when it is True. Has
                                 no effect when check set to False.
     :type check_fail_continue: bool
+
+    :param num_workers: Number of processes running the generator. Each of them
+                        reads a part of the files, so the python code of the
+                        data provider can run on more than one core. The
+                        processes are forked when each pass starts, and pass
+                        the samples to PaddlePaddle through shared memory.
+                        0 means to run the generator in the trainer process.
+                        It has no effect when cache is set. Default is 0.
+    :type num_workers: int
     """
 
     def __wrapper__(generator):
@@ -491,6 +501,7 @@ def provider(input_types=None,
                 self.min_pool_size = min_pool_size
                 self.input_order = kwargs['input_order']
                 self.check = check
+                self.num_workers = num_workers
                 if init_hook is not None:
                     init_hook(self, file_list=file_list, **kwargs)
 
@@ -85,6 +85,8 @@ def convert_np_dtype_to_dtype_(np_dtype):
         return core.DataType.INT64
     elif dtype == np.bool:
         return core.DataType.BOOL
+    elif dtype == np.int8:
+        return core.DataType.INT8
     else:
         raise ValueError("Not supported numpy dtype " + str(dtype))
 
@@ -1143,7 +1143,8 @@ def conv2d(input,
            param_attr=None,
            bias_attr=None,
            use_cudnn=True,
-           act=None):
+           act=None,
+           use_winograd=False):
     """
     **Convlution2D Layer**
 
@@ -1214,6 +1215,8 @@ def conv2d(input,
        use_cudnn(bool): Use cudnn kernel or not, it is valid only when the cudnn
            library is installed. Default: True
        act(str): Activation type. Default: None
+       use_winograd(bool): Compute the 3x3 convolutions of stride 1 on CPU
+           by the Winograd algorithm or not. Default: False
 
     Returns:
         Variable: The tensor variable storing the convolution and \
@@ -1286,7 +1289,8 @@ def conv2d(input,
             'strides': stride,
             'paddings': padding,
             'groups': groups,
-            'use_cudnn': use_cudnn
+            'use_cudnn': use_cudnn,
+            'use_winograd': use_winograd
         })
 
     pre_act = helper.append_bias_op(pre_bias, dim_start=1, dim_end=2)
@@ -26,7 +26,8 @@ dtype_to_size = {
     core.DataType.INT16: 2,
     core.DataType.INT32: 4,
     core.DataType.INT64: 8,
-    core.DataType.BOOL: 1
+    core.DataType.BOOL: 1,
+    core.DataType.INT8: 1
 }
 
 
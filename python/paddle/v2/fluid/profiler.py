@@ -73,7 +73,7 @@ def reset_profiler():
 
 
 @contextmanager
-def profiler(state, sorted_key=None):
+def profiler(state, sorted_key=None, trace_path=None):
     """The profiler interface.
     Different from cuda_profiler, this profiler can be used to profile both CPU
     and GPU program. By defalut, it records the CPU and GPU operator kernels,
@@ -95,6 +95,12 @@ def profiler(state, sorted_key=None):
             The `max` means sorting by the maximum execution time.
             The `min` means sorting by the minimum execution time.
             The `ave` means sorting by the average execution time.
+        trace_path (string) : If not None, the timeline of the events is also
+            written to this file in the Chrome trace format, which can be
+            loaded in chrome://tracing. The operator events carry their input
+            shapes and estimated FLOPs. The memory each operator allocates,
+            minus what it frees, is only recorded when the
+            FLAGS_profile_memory environment variable is set to true.
     """
 
     if state not in ['CPU', 'GPU']:
@@ -117,4 +123,4 @@ def profiler(state, sorted_key=None):
     }
     # TODO(qingqing) : redirect C++ ostream to Python stream.
     # with core.ostream_redirect(stdout=True, stderr=True):
-    core.disable_profiler(key_map[sorted_key])
+    core.disable_profiler(key_map[sorted_key], trace_path or "")
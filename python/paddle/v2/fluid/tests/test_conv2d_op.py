@@ -64,6 +64,7 @@ def conv2d_forward_naive(input, filter, group, conv_param):
 class TestConv2dOp(OpTest):
     def setUp(self):
         self.use_cudnn = False
+        self.use_winograd = False
         self.init_op_type()
         self.init_group()
         self.init_dilation()
@@ -85,7 +86,8 @@ class TestConv2dOp(OpTest):
             'paddings': self.pad,
             'groups': self.groups,
             'dilations': self.dilations,
-            'use_cudnn': self.use_cudnn
+            'use_cudnn': self.use_cudnn,
+            'use_winograd': self.use_winograd
         }
         self.outputs = {'Output': output}
 
@@ -241,6 +243,24 @@ class TestCUDNNWith1x1(TestWith1x1):
         self.op_type = "conv2d"
 
 
+class TestWinograd(TestConv2dOp):
+    def init_op_type(self):
+        self.use_winograd = True
+        self.op_type = "conv2d"
+
+
+class TestWinogradWithPad(TestWithPad):
+    def init_op_type(self):
+        self.use_winograd = True
+        self.op_type = "conv2d"
+
+
+class TestWinogradWithStride(TestWithStride):
+    def init_op_type(self):
+        self.use_winograd = True
+        self.op_type = "conv2d"
+
+
 class TestDepthwiseConv(TestConv2dOp):
     def init_test_case(self):
         self.pad = [1, 1]
@@ -13,6 +13,7 @@
 # limitations under the License.
 
 import unittest
+import json
 import os
 import numpy as np
 import paddle.v2.fluid as fluid
@@ -41,7 +42,7 @@ class TestProfiler(unittest.TestCase):
                 exe.run(fluid.default_main_program(), feed={'data': input})
         os.remove(output_file)
 
-    def net_profiler(self, state):
+    def net_profiler(self, state, trace_path=None):
         if state == 'GPU' and not core.is_compiled_with_cuda():
             return
         startup_program = fluid.Program()
@@ -65,7 +66,7 @@ class TestProfiler(unittest.TestCase):
         exe.run(startup_program)
 
         accuracy.reset(exe)
-        with profiler.profiler(state, 'total') as prof:
+        with profiler.profiler(state, 'total', trace_path) as prof:
             for iter in range(10):
                 if iter == 2:
                     profiler.reset_profiler()
@@ -82,6 +83,18 @@ class TestProfiler(unittest.TestCase):
     def test_cpu_profiler(self):
         self.net_profiler('CPU')
 
+    def test_chrome_trace(self):
+        trace_path = 'profiler_trace.json'
+        self.net_profiler('CPU', trace_path)
+        with open(trace_path) as f:
+            events = json.load(f)['traceEvents']
+        os.remove(trace_path)
+        muls = [e for e in events if e['name'] == 'mul' and e['ph'] == 'X']
+        self.assertEqual(len(muls), 3 * 8)
+        # The first fc multiplies [32, 784] by [784, 128].
+        self.assertEqual(muls[0]['args']['detail'], 'X=[32, 784] Y=[784, 128]')
+        self.assertEqual(muls[0]['args']['flops'], 2.0 * 32 * 784 * 128)
+
     def test_cuda_profiler(self):
         self.net_profiler('GPU')
 
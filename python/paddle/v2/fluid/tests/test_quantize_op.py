@@ -0,0 +1,37 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+class TestQuantizeOp(OpTest):
+    def setUp(self):
+        self.op_type = "quantize"
+        x = np.random.uniform(-1.5, 1.5, (8, 16)).astype("float32")
+        scale = 127.0 / 1.2
+        self.inputs = {'X': x}
+        self.attrs = {'scale': scale}
+        # Values beyond the calibrated range of 1.2 saturate.
+        self.outputs = {
+            'Out': np.clip(np.round(x * scale), -127, 127).astype("int8")
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,70 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import numpy as np
+from op_test import OpTest
+from test_conv2d_op import conv2d_forward_naive
+
+
+class TestQuantizedConv2dOp(OpTest):
+    def setUp(self):
+        self.op_type = "quantized_conv2d"
+        self.stride = [1, 1]
+        self.pad = [0, 0]
+        self.init_test_case()
+
+        input = np.random.randint(-127, 128, (2, 3, 5, 5)).astype("int8")
+        filter = np.random.randint(-127, 128, (4, 3, 3, 3)).astype("int8")
+        bias = np.random.random(4).astype("float32")
+        input_scale = 30.0
+        weight_scale = np.random.uniform(50, 100, 4).astype("float32")
+
+        conv2d_param = {
+            'stride': self.stride,
+            'pad': self.pad,
+            'dilation': [1, 1]
+        }
+        out = conv2d_forward_naive(
+            input.astype("float64"), filter.astype("float64"), 1, conv2d_param)
+        out = out / (input_scale * weight_scale.reshape(1, 4, 1, 1))
+        out = np.maximum(out + bias.reshape(1, 4, 1, 1), 0)
+
+        self.inputs = {'Input': input, 'Filter': filter, 'Bias': bias}
+        self.attrs = {
+            'strides': self.stride,
+            'paddings': self.pad,
+            'groups': 1,
+            'dilations': [1, 1],
+            'activation': 'relu',
+            'input_scale': input_scale,
+            'weight_scale': weight_scale.tolist()
+        }
+        self.outputs = {'Output': out.astype("float32")}
+
+    def init_test_case(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output(atol=1e-3)
+
+
+class TestQuantizedConv2dOpWithPadAndStride(TestQuantizedConv2dOp):
+    def init_test_case(self):
+        self.stride = [2, 2]
+        self.pad = [1, 1]
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,60 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserve.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+class TestQuantizedFCOp(OpTest):
+    def setUp(self):
+        self.op_type = "quantized_fc"
+        self.activation = "identity"
+        self.init_activation()
+        input = np.random.randint(-127, 128, (10, 3, 12)).astype("int8")
+        # The weight is stored transposed, [N, K].
+        w = np.random.randint(-127, 128, (6, 36)).astype("int8")
+        bias = np.random.random(6).astype("float32")
+        input_scale = 20.0
+        weight_scale = np.random.uniform(50, 100, 6).astype("float32")
+
+        out = np.dot(input.reshape(10, 36).astype("float64"),
+                     w.astype("float64").T)
+        out = out / (input_scale * weight_scale) + bias
+        if self.activation == "relu":
+            out = np.maximum(out, 0)
+
+        self.inputs = {'Input': input, 'W': w, 'Bias': bias}
+        self.attrs = {
+            'in_num_col_dims': 1,
+            'activation_type': self.activation,
+            'input_scale': input_scale,
+            'weight_scale': weight_scale.tolist()
+        }
+        self.outputs = {'Out': out.astype("float32")}
+
+    def init_activation(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output(atol=1e-3)
+
+
+class TestQuantizedFCOpRelu(TestQuantizedFCOp):
+    def init_activation(self):
+        self.activation = "relu"
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -15,13 +15,14 @@
 import unittest
 import paddle.v2.fluid.layers as layers
 from paddle.v2.fluid.executor import Executor
+from paddle.v2.fluid.framework import Program, program_guard
 import paddle.v2.fluid.core as core
 from paddle.v2.fluid.backward import append_backward
 import numpy
 
 
 class TestWhileOp(unittest.TestCase):
-    def test_simple_forward(self):
+    def simple_forward(self, is_test):
         d0 = layers.data(
             "d0", shape=[10], append_batch_size=False, dtype='float32')
         d1 = layers.data(
@@ -47,7 +48,7 @@ class TestWhileOp(unittest.TestCase):
         array_len.stop_gradient = True
         cond = layers.less_than(x=i, y=array_len)
 
-        while_op = layers.While(cond=cond)
+        while_op = layers.While(cond=cond, is_test=is_test)
         with while_op.block():
             d = layers.array_read(array=data_array, i=i)
             prev = layers.array_read(array=mem_array, i=i)
@@ -60,7 +61,8 @@ class TestWhileOp(unittest.TestCase):
         sum_result = layers.array_read(array=mem_array, i=i)
         loss = layers.mean(x=sum_result)
 
-        append_backward(loss)
+        if not is_test:
+            append_backward(loss)
 
         cpu = core.CPUPlace()
         exe = Executor(cpu)
@@ -75,6 +77,15 @@ class TestWhileOp(unittest.TestCase):
                        fetch_list=[sum_result])
         self.assertAlmostEqual(numpy.sum(d), numpy.sum(outs[0]), delta=0.01)
 
+    def test_simple_forward(self):
+        with program_guard(Program(), Program()):
+            self.simple_forward(is_test=False)
+
+    def test_simple_forward_is_test(self):
+        # The steps share one scope, the result must not change.
+        with program_guard(Program(), Program()):
+            self.simple_forward(is_test=True)
+
 
 if __name__ == '__main__':
     unittest.main()